@@ -5,6 +5,7 @@
   Originally from Snem, with some bugfixes*/
 
 #include <stdio.h>
+#include <string.h>
 #include "65816.h"
 
 #include "../tube-ula.h"
@@ -66,6 +67,24 @@ static int cycles = 0;
 
 static uint8_t def = 1, divider = 0, banking = 0, banknum = 0;
 static uint32_t w65816mask = 0xFFFF;
+
+// Where each 8KB page of the address space is in host memory, taking the
+// ROM and the banking windows into account. Rebuilt by map_pages() whenever
+// def, banking or banknum change.
+#define W65816_PAGE_SHIFT 13
+#define W65816_PAGE_MASK  ((1u << W65816_PAGE_SHIFT) - 1)
+#define W65816_NUM_PAGES  (W65816_RAM_SIZE >> W65816_PAGE_SHIFT)
+
+// The Tube registers and the control latch at FEF0-FEFF are the only part
+// of the map that isn't plain memory, so accesses there must go through
+// do_readmem65816()/do_writemem65816(). The rest of the page with them in
+// (E000-FFFF, the client ROM) is mapped as normal.
+#define W65816_TUBE_BYTE(addr) (((addr) & ~0xFu) == 0xFEF0)
+#define W65816_TUBE_WORD(addr) ((uint32_t)((addr) - 0xFEEF) <= 0x10)
+
+static uint8_t *readmap[W65816_NUM_PAGES];
+static uint8_t *writemap[W65816_NUM_PAGES];
+
 static uint32_t toldpc;
 
 #ifdef INCLUDE_DEBUGGER
@@ -296,9 +315,29 @@ static uint32_t do_readmem65816(uint32_t addr)
     return w65816ram[addr];
 }
 
+static void map_pages(void)
+{
+    for (uint32_t page = 0; page < W65816_NUM_PAGES; page++) {
+        uint32_t addr = page << W65816_PAGE_SHIFT;
+        uint8_t *ram = w65816ram + addr;
+        if ((addr & 0x7C000) == 0x4000 && !def && (banking & 1))
+            ram = w65816ram + ((addr & 0x3FFF) | ((banknum & 7) << 14));
+        if ((addr & 0x7C000) == 0x8000 && !def && (banking & 2))
+            ram = w65816ram + ((addr & 0x3FFF) | (((banknum >> 3) & 7) << 14));
+        readmap[page] = writemap[page] = ram;
+        if ((addr & 0x78000) == 0x8000 && (def || (banking & 8)))
+            readmap[page] = w65816rom + (addr & 0x7FFF);
+    }
+}
+
 static uint8_t readmem65816(uint32_t addr)
 {
-    uint8_t value = (uint8_t)do_readmem65816(addr);
+    uint32_t maddr = addr & w65816mask;
+    uint8_t value;
+    if (!W65816_TUBE_BYTE(maddr))
+        value = readmap[maddr >> W65816_PAGE_SHIFT][maddr & W65816_PAGE_MASK];
+    else
+        value = (uint8_t)do_readmem65816(maddr);
     cycles--;
 #ifdef INCLUDE_DEBUGGER
     if (dbg_w65816)
@@ -312,7 +351,11 @@ static uint16_t readmemw65816(uint32_t addr)
     uint16_t value;
 
     addr &= w65816mask;
-    value = (uint16_t) (do_readmem65816(addr) | (do_readmem65816(addr + 1) << 8));
+    uint8_t *page = readmap[addr >> W65816_PAGE_SHIFT];
+    if ((addr & W65816_PAGE_MASK) != W65816_PAGE_MASK && !W65816_TUBE_WORD(addr))
+        value = (uint16_t) (page[addr & W65816_PAGE_MASK] | (page[(addr & W65816_PAGE_MASK) + 1] << 8));
+    else
+        value = (uint16_t) (do_readmem65816(addr) | (do_readmem65816(addr + 1) << 8));
 #ifdef INCLUDE_DEBUGGER
     if (dbg_w65816)
         debug_memread(&w65816_cpu_debug, addr, value, 2);
@@ -348,6 +391,7 @@ static void do_writemem65816(uint32_t addr, uint32_t val)
             w65816mask = 0xFFFF;
         else
             w65816mask = W65816_RAM_SIZE - 1;
+        map_pages();
         printf("def=%x divider=%x banking=%x banknum=%x mask=%"PRIX32"\r\n", def, divider, banking, banknum, w65816mask);
         return;
     }
@@ -374,7 +418,11 @@ static void writemem65816(uint32_t addr, uint8_t val)
         debug_memwrite(&w65816_cpu_debug, addr, val, 1);
 #endif
     cycles--;
-    do_writemem65816(addr, val);
+    uint32_t maddr = addr & w65816mask;
+    if (!W65816_TUBE_BYTE(maddr))
+        writemap[maddr >> W65816_PAGE_SHIFT][maddr & W65816_PAGE_MASK] = val;
+    else
+        do_writemem65816(maddr, val);
 }
 
 static void writememw65816(uint32_t addr, uint16_t v)
@@ -385,8 +433,14 @@ static void writememw65816(uint32_t addr, uint16_t v)
 #endif
     addr &= w65816mask;
     cycles -= 2;
-    do_writemem65816(addr, v);
-    do_writemem65816(addr + 1, v >> 8);
+    uint8_t *page = writemap[addr >> W65816_PAGE_SHIFT];
+    if ((addr & W65816_PAGE_MASK) != W65816_PAGE_MASK && !W65816_TUBE_WORD(addr)) {
+        page[addr & W65816_PAGE_MASK] = (uint8_t)v;
+        page[(addr & W65816_PAGE_MASK) + 1] = (uint8_t)(v >> 8);
+    } else {
+        do_writemem65816(addr, v);
+        do_writemem65816(addr + 1, v >> 8);
+    }
 }
 
 #define readmem(a)     readmem65816(a)
@@ -4210,6 +4264,83 @@ static void wai(void)
     pc--;
 }
 
+// Cycles taken by each byte of MVN/MVP when executed one byte at a time
+#define W65816_MOVE_CYCLES 7
+
+// How many of n bytes can be moved from addr onwards (step 1) or downwards
+// (step -1) before reaching the end of its page or the Tube registers.
+// Stopping at the page ends also stops x and y wrapping within the bank.
+static uint32_t block_move_limit(uint32_t addr, int step, uint32_t n)
+{
+    uint32_t avail;
+    if (W65816_TUBE_BYTE(addr))
+        return 0;
+    if (step > 0) {
+        avail = W65816_PAGE_MASK + 1 - (addr & W65816_PAGE_MASK);
+        if (addr < 0xFEF0 && addr + avail > 0xFEF0)
+            avail = 0xFEF0 - addr;
+    } else {
+        avail = (addr & W65816_PAGE_MASK) + 1;
+        if (addr > 0xFEFF && addr - avail < 0xFEFF)
+            avail = addr - 0xFEFF;
+    }
+    return (n < avail) ? n : avail;
+}
+
+// Perform as much of an MVN (step 1) or MVP (step -1) as possible with a
+// single memmove, as long as both ends stay within a page and clear of the
+// Tube registers, there is no interrupt pending and the time slice isn't
+// used up. At least one
+// byte is always left for the caller to move the normal way, so that it
+// still decides whether the instruction repeats.
+static void block_move(uint32_t srcbank, int step)
+{
+    uint32_t src, dst, n;
+    uint8_t *srcpage, *dstpage, *srcp, *dstp;
+
+#ifdef INCLUDE_DEBUGGER
+    if (dbg_w65816)
+        return;
+#endif
+    if (tube_irq & (RESET_BIT | NMI_BIT | IRQ_BIT))
+        return;
+    src = (srcbank | x.w) & w65816mask;
+    dst = (dbr | y.w) & w65816mask;
+    srcpage = readmap[src >> W65816_PAGE_SHIFT];
+    dstpage = writemap[dst >> W65816_PAGE_SHIFT];
+    n = a.w;
+    if (cycles > 0 && n > (uint32_t)cycles / W65816_MOVE_CYCLES)
+        n = (uint32_t)cycles / W65816_MOVE_CYCLES;
+    n = block_move_limit(src, step, n);
+    n = block_move_limit(dst, step, n);
+    if (cycles <= 0 || n == 0)
+        return;
+    srcp = srcpage + (src & W65816_PAGE_MASK);
+    dstp = dstpage + (dst & W65816_PAGE_MASK);
+    if (step > 0) {
+        // Copying upwards onto an overlapping destination repeats the data
+        if (dstp > srcp && dstp < srcp + n) {
+            for (uint32_t i = 0; i < n; i++)
+                dstp[i] = srcp[i];
+        } else {
+            memmove(dstp, srcp, n);
+        }
+        x.w = (uint16_t)(x.w + n);
+        y.w = (uint16_t)(y.w + n);
+    } else {
+        if (dstp < srcp && dstp > srcp - n) {
+            for (uint32_t i = 0; i < n; i++)
+                *dstp-- = *srcp--;
+        } else {
+            memmove(dstp - n + 1, srcp - n + 1, n);
+        }
+        x.w = (uint16_t)(x.w - n);
+        y.w = (uint16_t)(y.w - n);
+    }
+    a.w = (uint16_t)(a.w - n);
+    cycles -= (int)(n * W65816_MOVE_CYCLES);
+}
+
 static void mvp(void)
 {
     uint8_t temp;
@@ -4218,6 +4349,7 @@ static void mvp(void)
     pc++;
     addr = (readmem(pbr | pc)) << 16;
     pc++;
+    block_move(addr, -1);
     temp = readmem(addr | x.w);
     writemem(dbr | y.w, temp);
     x.w--;
@@ -4237,6 +4369,7 @@ static void mvn(void)
     pc++;
     addr = (readmem(pbr | pc)) << 16;
     pc++;
+    block_move(addr, 1);
     temp = readmem(addr | x.w);
     writemem(dbr | y.w, temp);
     x.w++;
@@ -5642,6 +5775,7 @@ void w65816_reset(void)
     //else
     //    w65816mask = 0x7FFFF;
     w65816mask = 0xFFFF;
+    map_pages();
     pbr = dbr = 0;
     s.w = 0x1FF;
     set_cpu_mode(4);
@@ -5833,6 +5967,7 @@ void w65816_exec(int tubecycles)
         opcode = readmem(ia);
         modeptr[opcode]();
         wins++;
+        tubeTick();
         if ((tube_irq & NMI_BIT)) {
             nmi65816();
             tube_ack_nmi();
@@ -17,9 +17,7 @@
 #include "../tube-ula.h"
 #include "../tube.h"
 
-#ifdef PROFILING
 #include "Profile.h"
-#endif
 
 #ifdef INCLUDE_DEBUGGER
 #include "32016_debug.h"
@@ -47,6 +45,66 @@ static OperandSizeType OpSize;
 
 static const uint32_t IndexLKUP[8] = { 0x0, 0x1, 0x4, 0x5, 0x8, 0x9, 0xC, 0xD };                    // See Page 2-3 of the manual!
 
+#ifdef NS_DECODE_CACHE
+// Decoded instruction cache
+//
+// Keeps what n32016_exec() decodes from the bytes of an instruction (the
+// opcode, Function, operand sizes, the RegLKU of each general operand and
+// the displacements or immediate values that follow them) for recently
+// executed instructions, direct mapped by address, so a hit doesn't read
+// the instruction from memory at all. Only the addresses of memory operands
+// are worked out again each time. The blocks of memory holding decoded
+// instructions are marked (see MarkCodeBlocks()) so that writes to them
+// invalidate the entries; a flush clears the marks as well.
+
+#define DECODE_CACHE_SIZE 4096                                       // Must be a power of 2
+#define DECODE_EMPTY      0xFFFFFFFF
+
+typedef struct
+{
+   uint32_t Address;                                                 // startpc & MEM_MASK, or DECODE_EMPTY
+   uint32_t Opcode;
+   uint16_t Function;
+   uint8_t WriteIndex;
+   uint8_t Length;                                                   // Bytes up to the end of the displacements
+   OperandSizeType OpSize;
+   RegLKU Regs[2];
+   uint32_t Disp[2][2];
+   uint32_t BranchDisp;
+} DecodedInstruction;
+
+static DecodedInstruction DecodeCache[DECODE_CACHE_SIZE];
+
+void n32016_flush_decode(void)
+{
+   memset(DecodeCache, 0xFF, sizeof(DecodeCache));
+   memset(CodeBlocks, 0, sizeof(CodeBlocks));
+}
+
+void n32016_invalidate_decode(uint32_t start, uint32_t size)
+{
+   if (size >= DECODE_CACHE_SIZE)
+   {
+      n32016_flush_decode();
+      return;
+   }
+
+   // Any entry that overlaps the write starts at most DECODE_MAX_LENGTH - 1
+   // bytes before it
+   uint32_t entry = start - (DECODE_MAX_LENGTH - 1);
+   uint32_t count = size + DECODE_MAX_LENGTH - 1;
+   while (count--)
+   {
+      DecodedInstruction* pEntry = &DecodeCache[entry & (DECODE_CACHE_SIZE - 1)];
+      if (pEntry->Address == (entry & MEM_MASK))
+      {
+         pEntry->Address = DECODE_EMPTY;
+      }
+      entry++;
+   }
+}
+#endif
+
 /* A custom warning logger for n32016 that logs the PC */
 
 void n32016_warn(const char *fmt, ...)
@@ -105,6 +163,9 @@ const uint32_t OpSizeLookup[6] =
 void n32016_init()
 {
    init_ram();
+#ifdef NS_DECODE_CACHE
+   n32016_flush_decode();
+#endif
 }
 #if 0
 static void n32016_close()
@@ -356,7 +417,75 @@ static void getgen(uint32_t gen, int c)
    }
 }
 
-static void GetGenPhase2(RegLKU gen, int c)
+// Fetch the displacements (or the immediate value) that follow the opcode
+// for a general operand, leaving pc after them
+
+static void GetGenDisps(RegLKU gen, int c, uint32_t* pDisp)
+{
+   if (gen.Whole < 0xFFFF)                                              // Does this Operand exist ?
+   {
+      if (gen.OpType <= R7)
+      {
+         return;
+      }
+
+      if (gen.OpType == Immediate)
+      {
+         MultiReg temp3;
+
+         if (OpSize.Op[c] == sz64)
+         {
+            pDisp[0] = SWAP32(read_x32(pc));
+            pDisp[1] = SWAP32(read_x32(pc + 4));
+         }
+         else
+         {
+            // Why can't they just decided on an endian and then stick to it?
+            temp3.u32 = SWAP32(read_x32(pc));
+            if (OpSize.Op[c] == sz8)
+               pDisp[0] = temp3.u8;
+            else if (OpSize.Op[c] == sz16)
+               pDisp[0] = temp3.u16;
+            else
+               pDisp[0] = temp3.u32;
+         }
+
+         pc += OpSize.Op[c];
+         return;
+      }
+
+      if (gen.OpType >= EaPlusRn)
+      {
+         RegLKU NewPattern;
+         NewPattern.Whole = gen.IdxType;
+         GetGenDisps(NewPattern, c, pDisp);
+         return;
+      }
+
+      switch (gen.OpType)
+      {
+         case FrameRelative:
+         case StackRelative:
+         case StaticRelative:
+         case External:
+            pDisp[0] = (uint32_t)GetDisplacement(&pc);
+            pDisp[1] = (uint32_t)GetDisplacement(&pc);
+            break;
+
+         case IllegalOperand:
+         case TopOfStack:
+            break;
+
+         default:
+            pDisp[0] = (uint32_t)GetDisplacement(&pc);
+            break;
+      }
+   }
+}
+
+// Work out where a general operand is, from its displacements
+
+static void GetGenAddress(RegLKU gen, int c, const uint32_t* pDisp)
 {
    if (gen.Whole < 0xFFFF)                                              // Does this Operand exist ?
    {
@@ -394,28 +523,15 @@ static void GetGenPhase2(RegLKU gen, int c)
 
       if (gen.OpType == Immediate)
       {
-         MultiReg temp3;
-
          if (OpSize.Op[c] == sz64)
          {
-            temp3.u32 = SWAP32(read_x32(pc));
-            Immediate64.u64 = (((uint64_t) temp3.u32) << 32);
-            temp3.u32 = SWAP32(read_x32(pc + 4));
-            Immediate64.u64 |= temp3.u32;
+            Immediate64.u64 = (((uint64_t) pDisp[0]) << 32) | pDisp[1];
          }
          else
          {
-            // Why can't they just decided on an endian and then stick to it?
-            temp3.u32 = SWAP32(read_x32(pc));
-            if (OpSize.Op[c] == sz8)
-               genaddr[c] = temp3.u8;
-            else if (OpSize.Op[c] == sz16)
-               genaddr[c] = temp3.u16;
-            else
-               genaddr[c] = temp3.u32;
+            genaddr[c] = pDisp[0];
          }
 
-         pc += OpSize.Op[c];
          gentype[c] = OpImmediate;
          return;
       }
@@ -424,18 +540,16 @@ static void GetGenPhase2(RegLKU gen, int c)
 
       if (gen.OpType <= R7_Offset)
       {
-         genaddr[c] =(uint32_t)((int)r[gen.Whole & 7] + GetDisplacement(&pc));
+         genaddr[c] = r[gen.Whole & 7] + pDisp[0];
          return;
       }
 
-      uint32_t temp, temp2;
-
       if (gen.OpType >= EaPlusRn)
       {
          uint32_t Shift = gen.Whole & 3;
          RegLKU NewPattern;
          NewPattern.Whole = gen.IdxType;
-         GetGenPhase2(NewPattern, c);
+         GetGenAddress(NewPattern, c, pDisp);
 
          uint32_t Offset = r[gen.IdxReg] * (1 << Shift);
          if (gentype[c] != Register)
@@ -454,35 +568,26 @@ static void GetGenPhase2(RegLKU gen, int c)
       switch (gen.OpType)
       {
          case FrameRelative:
-            temp = (uint32_t)GetDisplacement(&pc);
-            temp2 = (uint32_t)GetDisplacement(&pc);
-            genaddr[c] = read_x32(fp + temp);
-            genaddr[c] += temp2;
+            genaddr[c] = read_x32(fp + pDisp[0]);
+            genaddr[c] += pDisp[1];
             break;
 
          case StackRelative:
-            temp = (uint32_t)GetDisplacement(&pc);
-            temp2 = (uint32_t)GetDisplacement(&pc);
-            genaddr[c] = read_x32(GET_SP() + temp);
-            genaddr[c] += temp2;
+            genaddr[c] = read_x32(GET_SP() + pDisp[0]);
+            genaddr[c] += pDisp[1];
             break;
 
          case StaticRelative:
-            temp = (uint32_t)GetDisplacement(&pc);
-            temp2 = (uint32_t)GetDisplacement(&pc);
-            genaddr[c] = read_x32(sb + temp);
-            genaddr[c] += temp2;
+            genaddr[c] = read_x32(sb + pDisp[0]);
+            genaddr[c] += pDisp[1];
             break;
 
          case Absolute:
-            genaddr[c] = (uint32_t)GetDisplacement(&pc);
+            genaddr[c] = pDisp[0];
             break;
 
          case External:
-            temp = read_x32(mod + 4);
-            temp += (uint32_t) ((GetDisplacement(&pc)) * 4);
-            temp2 = read_x32(temp);
-            genaddr[c] = temp2 + (uint32_t)GetDisplacement(&pc);
+            genaddr[c] = read_x32(read_x32(mod + 4) + pDisp[0] * 4) + pDisp[1];
             break;
 
          case TopOfStack:
@@ -491,19 +596,19 @@ static void GetGenPhase2(RegLKU gen, int c)
             break;
 
          case FpRelative:
-            genaddr[c] = (uint32_t)GetDisplacement(&pc) + fp;
+            genaddr[c] = pDisp[0] + fp;
             break;
 
          case SpRelative:
-            genaddr[c] = (uint32_t)GetDisplacement(&pc) + GET_SP();
+            genaddr[c] = pDisp[0] + GET_SP();
             break;
 
          case SbRelative:
-            genaddr[c] = (uint32_t)GetDisplacement(&pc) + sb;
+            genaddr[c] = pDisp[0] + sb;
             break;
 
          case PcRelative:
-            genaddr[c] = (uint32_t)GetDisplacement(&pc) + startpc;
+            genaddr[c] = pDisp[0] + startpc;
             break;
 
          default:
@@ -513,6 +618,12 @@ static void GetGenPhase2(RegLKU gen, int c)
    }
 }
 
+static void GetGenPhase2(RegLKU gen, int c, uint32_t* pDisp)
+{
+   GetGenDisps(gen, c, pDisp);
+   GetGenAddress(gen, c, pDisp);
+}
+
 // From: http://homepage.cs.uiowa.edu/~jones/bcd/bcd.html
 static uint32_t bcd_add_16(uint32_t a, uint32_t b, uint32_t *carry)
 {
@@ -997,6 +1108,10 @@ void n32016_exec()
    uint32_t temp, temp2, temp3;
    Temp64Type temp64;
    uint32_t Function;
+   uint32_t Disp[2][2];
+#ifdef NS_DECODE_CACHE
+   DecodedInstruction* Decoded;
+#endif
 
    // Avoid a "might be uninitialized" warning
    temp = 0;
@@ -1035,14 +1150,41 @@ void n32016_exec()
       }
 #endif
 
-      opcode = read_x32(pc);
-
       if (pc == PR.BPC)
       {
          SET_TRAP(BreakPointHit);
          goto DoTrap;
       }
 
+#ifdef NS_DECODE_CACHE
+      Decoded = &DecodeCache[startpc & (DECODE_CACHE_SIZE - 1)];
+      if (Decoded->Address == (startpc & MEM_MASK))
+      {
+         opcode      = Decoded->Opcode;
+#ifdef INCLUDE_DEBUGGER
+         if (n32016_debug_enabled)
+         {
+            opcode = read_x32(pc);                                            // So the debugger still sees the fetch
+         }
+#endif
+         BreakPoint(startpc, opcode);
+         Function    = Decoded->Function;
+         WriteIndex  = Decoded->WriteIndex;
+         OpSize      = Decoded->OpSize;
+         Regs[0]     = Decoded->Regs[0];
+         Regs[1]     = Decoded->Regs[1];
+         pc          = startpc + Decoded->Length;
+         GetGenAddress(Regs[0], 0, Decoded->Disp[0]);
+         GetGenAddress(Regs[1], 1, Decoded->Disp[1]);
+         if (Function <= RETT)
+         {
+            temp = Decoded->BranchDisp;
+         }
+         goto Execute;
+      }
+#endif
+
+      opcode = read_x32(pc);
       BreakPoint(startpc, opcode);
 
       Function = FunctionLookup[opcode & 0xFF];
@@ -1299,14 +1441,34 @@ void n32016_exec()
       n32016_show_instruction(startpc, &Temp, opcode, Function, &OpSize);
 #endif
 
-      GetGenPhase2(Regs[0], 0);
-      GetGenPhase2(Regs[1], 1);
+      GetGenPhase2(Regs[0], 0, Disp[0]);
+      GetGenPhase2(Regs[1], 1, Disp[1]);
 
       if (Function <= RETT)
       {
          temp = (uint32_t)GetDisplacement(&pc);
       }
 
+#ifdef NS_DECODE_CACHE
+      // Nothing is cached near the top of memory, so instructions never
+      // wrap round or read the Tube registers
+      if (!TrapFlags && (pc - startpc) <= DECODE_MAX_LENGTH && (startpc & MEM_MASK) < IO_BASE - 2 * DECODE_MAX_LENGTH)
+      {
+         Decoded->Opcode      = opcode;
+         Decoded->Function    = (uint16_t) Function;
+         Decoded->WriteIndex  = (uint8_t) WriteIndex;
+         Decoded->Length      = (uint8_t) (pc - startpc);
+         Decoded->OpSize      = OpSize;
+         Decoded->Regs[0]     = Regs[0];
+         Decoded->Regs[1]     = Regs[1];
+         Decoded->BranchDisp  = temp;
+         memcpy(Decoded->Disp, Disp, sizeof(Disp));
+         Decoded->Address     = startpc & MEM_MASK;                                 // As the memory system sees it
+         // The opcode is always read as 32 bits
+         MarkCodeBlocks(startpc, (pc - startpc) < sizeof(uint32_t) ? sizeof(uint32_t) : pc - startpc);
+      }
+#endif
+
       if (TrapFlags)
       {
          DoTrap:
@@ -1314,13 +1476,15 @@ void n32016_exec()
          continue;
       }
 
+#ifdef NS_DECODE_CACHE
+      Execute:
+#endif
+
 #ifdef INSTRUCTION_PROFILING
       IP[startpc]++;
 #endif
 
-#ifdef PROFILING
       ProfileAdd(Function, Regs[0].Whole, Regs[1].Whole);
-#endif
 
       switch (Function)
       {
@@ -1667,6 +1831,12 @@ void n32016_exec()
                default:
                {
                   PR.Direct[temp2] = temp;
+#ifdef NS_DECODE_CACHE
+                  if (temp2 == 12)
+                  {
+                     n32016_flush_decode();                                       // CFG, so the FPU instructions may now decode differently
+                  }
+#endif
                }
                break;
             }
@@ -1939,6 +2109,9 @@ void n32016_exec()
             }
 
             nscfg.lsb = (uint8_t)(opcode >> 15);                                  // Only sets the bottom 8 bits of which the lower 4 are used!
+#ifdef NS_DECODE_CACHE
+            n32016_flush_decode();                                                // The FPU instructions may now decode differently
+#endif
             continue;
          }
          // No break due to continue
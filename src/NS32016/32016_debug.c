@@ -8,6 +8,7 @@
 #include "32016_debug.h"
 #include "mem32016.h"
 #include "NSDis.h"
+#include "Profile.h"
 
 /*****************************************************
  * CPU Debug Interface
@@ -223,6 +224,8 @@ cpu_debug_t n32016_cpu_debug = {
    .reg_print      = dbg_reg_print,
    .reg_parse      = dbg_reg_parse,
    .get_instr_addr = dbg_get_instr_addr,
-   .trap_names     = dbg_trap_names
+   .trap_names     = dbg_trap_names,
+   .profile_enable = ProfileEnable,
+   .profile_dump   = ProfileDump
 };
 
@@ -167,6 +167,11 @@ static const char InstuctionText[InstructionCount][8] =
    "TRAP"
 };
 
+const char* n32016_function_name(uint32_t Function)
+{
+   return (Function < InstructionCount) ? InstuctionText[Function] : "???";
+}
+
 static void GetOperandText(uint32_t Start, uint32_t* pPC, RegLKU Pattern, uint32_t c, OperandSizeType *OperandSize)
 {
    const char RegLetter[] = "RFD*****";
@@ -1,2 +1,3 @@
 void n32016_show_instruction(uint32_t StartPc, uint32_t* pPC, uint32_t opcode, uint32_t Function, OperandSizeType *OperandSize);
 uint32_t n32016_disassemble(uint32_t address, char *buf, size_t bufsize);
+const char* n32016_function_name(uint32_t Function);
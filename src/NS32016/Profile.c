@@ -7,14 +7,30 @@
 #include "Decode.h"
 #include "mem32016.h"
 #include "defs.h"
+#include "NSDis.h"
 #include "Profile.h"
 
-#ifdef PROFILING
-
 #define NUM_OPERAND_TYPES 80
 
-uint32_t Frequencies[InstructionCount][NUM_OPERAND_TYPES][NUM_OPERAND_TYPES];
+// The counts are kept in a small open addressed hash table, keyed on
+// Function << 16 | operand 0 type << 8 | operand 1 type, as only a few
+// hundred of the possible combinations are ever seen
+
+#define PROFILE_HASH_SIZE  4096                                        // Must be a power of 2
+#define PROFILE_EMPTY      0xFFFFFFFF
+
+typedef struct
+{
+   uint32_t Key;
+   uint32_t Count;
+} ProfileEntry;
+
+static ProfileEntry ProfileTable[PROFILE_HASH_SIZE];
+static uint32_t ProfileOverflow;                                        // Samples lost because the table was full
+static uint8_t ProfileValid;                                            // The table has been initialised
 
+static uint32_t ProfileRate;                                            // Sample every n'th instruction, 0 when off
+uint32_t ProfileCountdown;                                              // Instructions until the next sample
 
 const char operandStrings[NUM_OPERAND_TYPES][20] =
 {
@@ -38,10 +54,23 @@ const char operandStrings[NUM_OPERAND_TYPES][20] =
 
 void ProfileInit(void)
 {
-   memset(Frequencies, 0, sizeof(Frequencies));
+   memset(ProfileTable, 0xFF, sizeof(ProfileTable));
+   ProfileOverflow = 0;
+   ProfileValid = 1;
+}
+
+void ProfileEnable(uint32_t Rate)
+{
+   if (Rate && !ProfileRate)
+   {
+      ProfileInit();
+   }
+
+   ProfileRate = Rate;
+   ProfileCountdown = Rate;
 }
 
-uint16_t processOperand(uint16_t operand)
+static uint16_t processOperand(uint16_t operand)
 {
    // Mask off bits 15..8 which carry the base mode in indexed modes
    if (operand == 0xFFFF)
@@ -62,7 +91,7 @@ uint16_t processOperand(uint16_t operand)
    }
    else if ((operand & 0xff) >= 28 && (operand & 0xff) <= 31)
    {
-      return 16 + ((operand & 0xff) - 27) * 16 + processOperand(operand >> 11) ; // scaled indexed
+      return (uint16_t)(16 + ((operand & 0xff) - 27) * 16 + processOperand(operand >> 11)); // scaled indexed
    }
    else
    {
@@ -70,17 +99,35 @@ uint16_t processOperand(uint16_t operand)
    }
 }
 
-void ProfileAdd(uint32_t Function, uint16_t Regs0, uint16_t Regs1)
+void ProfileSample(uint32_t Function, uint16_t Regs0, uint16_t Regs1)
 {
-   if (Function < InstructionCount)
+   ProfileCountdown = ProfileRate;
+
+   uint32_t Key = (Function << 16) | (processOperand(Regs0) << 8) | processOperand(Regs1);
+   uint32_t Hash = (Key * 0x9E3779B1) >> 20;                            // 12 bits
+   uint32_t Probe;
+
+   for (Probe = 0; Probe < PROFILE_HASH_SIZE; Probe++)
    {
-      Regs0 = processOperand(Regs0);
-      Regs1 = processOperand(Regs1);
-      Frequencies[Function][Regs0][Regs1]++;
+      ProfileEntry* pEntry = &ProfileTable[(Hash + Probe) & (PROFILE_HASH_SIZE - 1)];
+      if (pEntry->Key == Key)
+      {
+         pEntry->Count++;
+         return;
+      }
+
+      if (pEntry->Key == PROFILE_EMPTY)
+      {
+         pEntry->Key = Key;
+         pEntry->Count = 1;
+         return;
+      }
    }
+
+   ProfileOverflow++;
 }
 
-char *operandText(uint16_t Reg)
+static char *operandText(uint16_t Reg)
 {
    static char result[80];
    if (Reg < 16)
@@ -94,41 +141,65 @@ char *operandText(uint16_t Reg)
    return result;
 }
 
+static int CompareEntries(const void* pA, const void* pB)
+{
+   uint32_t A = ((const ProfileEntry*) pA)->Key;
+   uint32_t B = ((const ProfileEntry*) pB)->Key;
+
+   return (A > B) - (A < B);
+}
+
 void ProfileDump(void)
 {
-   uint32_t Function;
-   uint16_t Regs0;
-   uint16_t Regs1;
-   uint32_t total;
+   static ProfileEntry Sorted[PROFILE_HASH_SIZE];
+   uint32_t Count = 0;
+   uint32_t Index;
+
+   // Nothing to dump if profiling has never been enabled
+   if (!ProfileValid)
+   {
+      return;
+   }
+
+   for (Index = 0; Index < PROFILE_HASH_SIZE; Index++)
+   {
+      if (ProfileTable[Index].Key != PROFILE_EMPTY && ProfileTable[Index].Count)
+      {
+         Sorted[Count++] = ProfileTable[Index];
+      }
+   }
+
+   if (Count == 0)
+   {
+      return;
+   }
+
+   qsort(Sorted, Count, sizeof(ProfileEntry), CompareEntries);
 
-   printf("\"Function\", \"Name\", \"Operand 0\", \"Operand 1\", \"Frequency\"\n");
+   printf("\"Function\", \"Name\", \"Operand 0\", \"Operand 1\", \"Frequency\"\r\n");
 
-   for (Function = 0; Function < InstructionCount; Function++)
+   for (Index = 0; Index < Count; Index++)
    {
+      uint32_t Function = Sorted[Index].Key >> 16;
 
       // Skip the TRAP instruction as it's not real
-      if (strcmp(InstuctionText[Function], "TRAP") == 0)
+      if (strcmp(n32016_function_name(Function), "TRAP") == 0)
          continue;
 
-      total = 0;
-      for (Regs0 = 0; Regs0 < NUM_OPERAND_TYPES; Regs0++)
-         for (Regs1 = 0; Regs1 < NUM_OPERAND_TYPES; Regs1++)
-            if (Frequencies[Function][Regs0][Regs1])
-               total++;
-      if (total) {
-         // Break down of addressing modes
-         for (Regs0 = 0; Regs0 < NUM_OPERAND_TYPES; Regs0++)
-            for (Regs1 = 0; Regs1 < NUM_OPERAND_TYPES; Regs1++)
-               if (Frequencies[Function][Regs0][Regs1])
-               {
-                  printf("%02" PRIX32 ", ", Function);
-                  printf("%-8s, ", InstuctionText[Function]);
-                  printf("%-24s, ", operandText(Regs1));
-                  printf("%-24s, ", operandText(Regs0));
-                  printf("%9" PRIu32 "\n", Frequencies[Function][Regs0][Regs1]);
-               }
-         printf("\n");
+      if (Index && Function != (Sorted[Index - 1].Key >> 16))
+      {
+         printf("\r\n");
       }
+
+      printf("%02" PRIX32 ", ", Function);
+      printf("%-8s, ", n32016_function_name(Function));
+      printf("%-24s, ", operandText(Sorted[Index].Key & 0xFF));
+      printf("%-24s, ", operandText((Sorted[Index].Key >> 8) & 0xFF));
+      printf("%9" PRIu32 "\r\n", Sorted[Index].Count);
+   }
+
+   if (ProfileOverflow)
+   {
+      printf("%" PRIu32 " samples not recorded\r\n", ProfileOverflow);
    }
 }
-#endif
@@ -1,13 +1,14 @@
-#ifdef PROFILING
+// Sampling profiler of (Function, operand 0 mode, operand 1 mode)
+//
+// Off by default; ProfileEnable(n) counts every n'th instruction executed.
+
+extern uint32_t ProfileCountdown;
 
 extern void ProfileInit(void);
-extern void ProfileAdd(uint32_t Function, uint16_t Regs0, uint16_t Regs1);
+extern void ProfileEnable(uint32_t Rate);
+extern void ProfileSample(uint32_t Function, uint16_t Regs0, uint16_t Regs1);
 extern void ProfileDump(void);
 
-#else
-
-#define ProfileInit()
-#define ProfileAdd(a)
-#define ProfileDump()
-
-#endif
+// Only one test and decrement per instruction while profiling is off
+#define ProfileAdd(Function, Regs0, Regs1) \
+   do { if (ProfileCountdown && --ProfileCountdown == 0) ProfileSample(Function, Regs0, Regs1); } while (0)
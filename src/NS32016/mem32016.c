@@ -49,6 +49,21 @@ static uint8_t * ns32016ram;
 #define PANDORA_VERSION PandoraV2_00
 #endif
 
+#ifdef NS_DECODE_CACHE
+uint8_t CodeBlocks[MEG16 >> CODE_BLOCK_SHIFT];
+
+void MarkCodeBlocks(uint32_t addr, uint32_t size)
+{
+   uint32_t Block;
+
+   addr &= MEM_MASK;
+   for (Block = addr >> CODE_BLOCK_SHIFT; Block <= (addr + size - 1) >> CODE_BLOCK_SHIFT; Block++)
+   {
+      CodeBlocks[Block] = 1;
+   }
+}
+#endif
+
 void init_ram(void)
 {
    if (copro_memory_size > 0)
@@ -236,6 +251,7 @@ void write_x8_internal(uint32_t addr, uint8_t val)
 #else
       *(unsigned char *)(addr) = val;
 #endif
+      CHECK_CODE_WRITE(addr, sizeof(uint8_t));
       return;
    }
 
@@ -282,6 +298,7 @@ void write_x16(uint32_t addr, uint16_t val)
 #else
       *((uint16_t*) (addr)) = val;
 #endif
+      CHECK_CODE_WRITE(addr, sizeof(uint16_t));
       return;
    }
 #endif
@@ -308,6 +325,7 @@ void write_x32(uint32_t addr, uint32_t val)
 #else
       *((uint32_t*) (addr)) = val;
 #endif
+      CHECK_CODE_WRITE(addr, sizeof(uint32_t));
       return;
    }
 #endif
@@ -356,6 +374,17 @@ void write_Arbitary(uint32_t addr, void* pData, uint32_t Size)
 #endif
    {
       memcpy(ns32016ram + addr, pData, Size);
+#ifdef NS_DECODE_CACHE
+      uint32_t Block;
+      for (Block = addr >> CODE_BLOCK_SHIFT; Block <= (addr + Size - 1) >> CODE_BLOCK_SHIFT; Block++)
+      {
+         if (CodeBlocks[Block])
+         {
+            n32016_invalidate_decode(addr, Size);
+            break;
+         }
+      }
+#endif
       return;
    }
 #endif
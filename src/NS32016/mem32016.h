@@ -9,6 +9,30 @@
 
 //#define PANDORA_ROM_PAGE_OUT
 #define NS_FAST_RAM
+#ifndef NS_NO_DECODE_CACHE
+#define NS_DECODE_CACHE
+#endif
+
+#ifdef NS_DECODE_CACHE
+// The longest instruction the decoded instruction cache will hold
+#define DECODE_MAX_LENGTH 32
+
+// Memory is marked in blocks of this size as holding decoded instructions
+#define CODE_BLOCK_SHIFT 8
+
+extern uint8_t CodeBlocks[MEG16 >> CODE_BLOCK_SHIFT];
+
+void MarkCodeBlocks(uint32_t addr, uint32_t size);
+
+void n32016_flush_decode(void);
+void n32016_invalidate_decode(uint32_t start, uint32_t size);
+
+#define CHECK_CODE_WRITE(addr, size) \
+   do { if (CodeBlocks[(addr) >> CODE_BLOCK_SHIFT] | CodeBlocks[((addr) + (size) - 1) >> CODE_BLOCK_SHIFT]) \
+      n32016_invalidate_decode(addr, size); } while (0)
+#else
+#define CHECK_CODE_WRITE(addr, size)
+#endif
 
 void init_ram(void);
 
@@ -25,14 +25,14 @@
 
 #define TUBE_ROM_ARM tuberom_arm_v100
 
-#define RAM_MASK8    ((UINT32) 0x003fffff)
+#define RAM_MASK8    ARM2_RAM_MASK8
 #define ROM_MASK8    ((UINT32) 0x00003fff)
-#define RAM_MASK32   ((UINT32) 0x003ffffc)
+#define RAM_MASK32   ARM2_RAM_MASK32
 #define ROM_MASK32   ((UINT32) 0x00003ffc)
 
 // 4MB of RAM starting at 0x00000000
 #define ARM_RAM_SIZE (1024 * 1024 * 4)
-static UINT8 * arm2_ram;
+UINT8 * arm2_ram;
 
 // 16KB of ROM starting at 0x03000000
 //UINT8 arm2_rom[0x4000] __attribute__((aligned(0x10000)));
@@ -142,6 +142,7 @@ void copro_arm2_write8(unsigned int addr, UINT8 data)
 #else
       *(UINT8*) ( (addr & RAM_MASK8)) = data;
 #endif
+      ARM2_CHECK_CODE_WRITE(addr & RAM_MASK32);
       break;
    case 1:
       tube_parasite_write((addr >> 2) & 7, data);
@@ -163,6 +164,7 @@ void copro_arm2_write32(unsigned int addr, UINT32 data) {
 #else
       *(UINT32*) ( (addr & RAM_MASK32)) = data;
 #endif
+      ARM2_CHECK_CODE_WRITE(addr & RAM_MASK32);
       break;
    case 1:
       tube_parasite_write((addr >> 2) & 7, (unsigned char)data);
@@ -27,7 +27,11 @@ void copro_null_emulator() {
    while (1) {
 
       while (!tube_is_rst_active())
+#ifdef NATIVE_BUILD
+         ;
+#else
          asm volatile("wfi");
+#endif
       tube_wait_for_rst_release();
 
       // Exit on a change of copro ( changed in the FIQ handler)
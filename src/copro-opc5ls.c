@@ -31,6 +31,7 @@ void copro_opc5ls_write(uint16_t addr, uint16_t data) {
       DBG_PRINT("write: %d = %x\r\n", addr & 7, data);
    } else {
       memory[addr] = data;
+      OPC5LS_INVALIDATE(addr);
    }
 }
 
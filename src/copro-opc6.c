@@ -27,6 +27,7 @@ void copro_opc6_write_mem(uint16_t addr, uint16_t data) {
    }
 #endif
    memory[addr] = data;
+   OPC6_INVALIDATE(addr);
 }
 
 uint16_t copro_opc6_read_mem(uint16_t addr) {
@@ -28,6 +28,7 @@ void copro_opc7_write_mem(uint32_t addr, uint32_t data) {
    }
 #endif
    memory[addr] = data;
+   OPC7_INVALIDATE(addr);
 }
 
 uint32_t copro_opc7_read_mem(uint32_t addr) {
@@ -117,9 +117,9 @@ void copro_z80_emulator()
    while (1)
    {
       int tube_irq_copy;
-      // Execute emulator for one instruction
+      // Execute emulator until RST or NMI (it takes IRQs itself)
       simz80_execute(1);
-      tube_irq_copy = tube_irq & ( RESET_BIT + NMI_BIT + IRQ_BIT );
+      tube_irq_copy = tube_irq & ( RESET_BIT + NMI_BIT );
       if (tube_irq_copy) {
          // Reset the processor on active edge of rst
          if (tube_irq_copy & RESET_BIT) {
@@ -136,14 +136,6 @@ void copro_z80_emulator()
             simz80_NMI();
             tube_ack_nmi();
          }
-
-         // IRQ is level sensitive,
-         if (tube_irq_copy & IRQ_BIT) {
-            // check if the emulator IRQ is enabled
-            if (simz80_is_IRQ_enabled()) {
-               simz80_IRQ();
-            }
-         }
       }
    }
 }
@@ -71,6 +71,86 @@ static uint16_t oper1, oper2, res16, disp16, temp16, dummy, stacksize, frametemp
 static uint8_t oper1b, oper2b, res8, disp8, nestlev, addrbyte;
 static uint32_t temp1, temp2, temp3, ea;
 
+// Lazy flags
+//
+// Most instructions that set ZF, SF, PF, AF and OF are never followed by
+// anything that reads them, so the ALU helpers (flag_add8() etc.) just
+// record the operation, its operands and result, and the flags are worked
+// out from the record only when needed. CF is still set as it is cheap and
+// read by ADC, SBB, INC, DEC etc.
+//
+// While lazy_op is not LAZY_NONE the zf, sf, pf, af and of variables are
+// stale: read them with lazy_zf() etc., and call sync_flags() before code
+// that reads or writes them directly.
+
+// The 8 bit operations are odd
+#define LAZY_NONE  0
+#define LAZY_LOG8  1
+#define LAZY_LOG16 2
+#define LAZY_ADD8  3
+#define LAZY_ADD16 4
+#define LAZY_SUB8  5
+#define LAZY_SUB16 6
+
+static uint8_t lazy_op;
+static uint16_t lazy_v1, lazy_v2, lazy_res;
+
+static inline uint16_t lazy_sign()
+{
+  return (lazy_op & 1) ? 0x80 : 0x8000;
+}
+
+static inline uint8_t lazy_zf()
+{
+  return lazy_op ? !lazy_res : zf;
+}
+
+static inline uint8_t lazy_sf()
+{
+  return lazy_op ? ((lazy_res & lazy_sign()) ? 1 : 0) : sf;
+}
+
+static inline uint8_t lazy_pf()
+{
+  return lazy_op ? parity[lazy_res & 0xFF] : pf;
+}
+
+static inline uint8_t lazy_af()
+{
+  // Logic ops leave AF alone
+  return (lazy_op > LAZY_LOG16) ? (((lazy_v1 ^ lazy_v2 ^ lazy_res) & 0x10) ? 1 : 0) : af;
+}
+
+static inline uint8_t lazy_of()
+{
+  switch (lazy_op)
+  {
+    case LAZY_NONE:
+      return of;
+    case LAZY_ADD8:
+    case LAZY_ADD16:
+      return ((lazy_res ^ lazy_v1) & (lazy_res ^ lazy_v2) & lazy_sign()) ? 1 : 0;
+    case LAZY_SUB8:
+    case LAZY_SUB16:
+      return ((lazy_res ^ lazy_v1) & (lazy_v1 ^ lazy_v2) & lazy_sign()) ? 1 : 0;
+    default:
+      return 0;
+  }
+}
+
+static void sync_flags()
+{
+  if (lazy_op)
+  {
+    zf = lazy_zf();
+    sf = lazy_sf();
+    pf = lazy_pf();
+    af = lazy_af();
+    of = lazy_of();
+    lazy_op = LAZY_NONE;
+  }
+}
+
 //uint64_t totalexec;
 //#define INC_TOTAL_EXEC() totalexec++; loopcount++
 #define INC_TOTAL_EXEC()
@@ -81,14 +161,18 @@ static uint8_t verbose = 1, didbootstrap = 0;
 // debugmode, showcsip, mouseemu,
 //uint8_t ethif;
 
-#define makeflagsword() \
-	((uint16_t)(\
-	(uint16_t)2 | (uint16_t) cf | ((uint16_t) (pf << 2)) | ((uint16_t) (af << 4)) | ((uint16_t) (zf << 6)) | ((uint16_t) (sf << 7)) | \
-	((uint16_t) (tf << 8)) | ((uint16_t) (ifl << 9)) | ((uint16_t) (df << 10)) | ((uint16_t) (of << 11)) \
-	))
+static uint16_t makeflagsword()
+{
+  sync_flags();
+  return (uint16_t)(
+	(uint16_t)2 | (uint16_t) cf | ((uint16_t) (pf << 2)) | ((uint16_t) (af << 4)) | ((uint16_t) (zf << 6)) | ((uint16_t) (sf << 7)) |
+	((uint16_t) (tf << 8)) | ((uint16_t) (ifl << 9)) | ((uint16_t) (df << 10)) | ((uint16_t) (of << 11))
+	);
+}
 
 #define decodeflagsword(x) { \
 	temp16 = x; \
+	lazy_op = LAZY_NONE; \
 	cf = temp16 & 1; \
 	pf = (temp16 >> 2) & 1; \
 	af = (temp16 >> 4) & 1; \
@@ -293,6 +377,8 @@ static void trace_instruction(uint16_t cs, uint16_t pc) {
 
 #endif
 
+// For instructions that set the flags directly, after sync_flags()
+
 static void flag_szp8(uint8_t value)
 {
   zf = (!value) ? 1 : 0;															// set or clear zero flag
@@ -309,16 +395,18 @@ static void flag_szp16(uint16_t value)
 
 static void flag_log8(uint8_t value)
 {
-  flag_szp8(value);
-  cf = 0;
-  of = 0; 									// bitwise logic ops always clear carry and overflow
+  af = lazy_af();
+  lazy_op = LAZY_LOG8;
+  lazy_res = value;
+  cf = 0; 									// bitwise logic ops always clear carry and overflow
 }
 
 static void flag_log16(uint16_t value)
 {
-  flag_szp16(value);
-  cf = 0;
-  of = 0; 									// bitwise logic ops always clear carry and overflow
+  af = lazy_af();
+  lazy_op = LAZY_LOG16;
+  lazy_res = value;
+  cf = 0; 									// bitwise logic ops always clear carry and overflow
 }
 
 static void flag_adc8(uint8_t v1, uint8_t v2, uint8_t v3)					// v1 = destination operand, v2 = source operand, v3 = carry flag
@@ -326,10 +414,11 @@ static void flag_adc8(uint8_t v1, uint8_t v2, uint8_t v3)					// v1 = destinatio
   uint16_t dst;
 
   dst = (uint16_t)((uint16_t) v1 + (uint16_t) v2 + (uint16_t) v3);
-  flag_szp8((uint8_t) dst);
-  of = (((dst ^ v1) & (dst ^ v2) & 0x80) == 0x80) ? 1 : 0;          // set or clear overflow flag
   cf = (dst & 0xFF00) ? 1 : 0;												// set or clear carry flag
-  af = (((v1 ^ v2 ^ dst) & 0x10) == 0x10) ? 1 : 0;					// set or clear auxiliary flag
+  lazy_op = LAZY_ADD8;
+  lazy_v1 = v1;
+  lazy_v2 = v2;
+  lazy_res = (uint8_t) dst;
 }
 
 static void flag_adc16(uint16_t v1, uint16_t v2, uint16_t v3)
@@ -337,32 +426,21 @@ static void flag_adc16(uint16_t v1, uint16_t v2, uint16_t v3)
   uint32_t dst;
 
   dst = (uint32_t) v1 + (uint32_t) v2 + (uint32_t) v3;
-  flag_szp16((uint16_t) dst);
-  of = ((((dst ^ v1) & (dst ^ v2)) & 0x8000) == 0x8000) ? 1 : 0;
   cf = (dst & 0xFFFF0000) ? 1 : 0;
-  af = (((v1 ^ v2 ^ dst) & 0x10) == 0x10) ? 1 : 0;
+  lazy_op = LAZY_ADD16;
+  lazy_v1 = v1;
+  lazy_v2 = v2;
+  lazy_res = (uint16_t) dst;
 }
 
 static void flag_add8(uint8_t v1, uint8_t v2)					// v1 = destination operand, v2 = source operand
 {
-  uint16_t dst;
-
-  dst = (uint16_t) v1 + (uint16_t) v2;
-  flag_szp8((uint8_t) dst);
-  cf = (dst & 0xFF00) ? 1 : 0;
-  of = (((dst ^ v1) & (dst ^ v2) & 0x80) == 0x80) ? 1 : 0;
-  af = (((v1 ^ v2 ^ dst) & 0x10) == 0x10) ? 1 : 0;
+  flag_adc8(v1, v2, 0);
 }
 
 static void flag_add16(uint16_t v1, uint16_t v2)          // v1 = destination operand, v2 = source operand
 {
-  uint32_t dst;
-
-  dst = (uint32_t) v1 + (uint32_t) v2;
-  flag_szp16((uint16_t) dst);
-  cf = (dst & 0xFFFF0000) ? 1 : 0;
-  of = (((dst ^ v1) & (dst ^ v2) & 0x8000) == 0x8000) ? 1 : 0;
-  af = (((v1 ^ v2 ^ dst) & 0x10) == 0x10) ? 1 : 0;
+  flag_adc16(v1, v2, 0);
 }
 
 static void flag_sbb8(uint8_t v1, uint8_t v2, uint8_t v3)
@@ -372,33 +450,11 @@ static void flag_sbb8(uint8_t v1, uint8_t v2, uint8_t v3)
   uint16_t dst;
 
   dst = (uint16_t) ((uint16_t) v1 - (uint16_t) v2 - v3);
-  flag_szp8((uint8_t) dst);
-  if (dst & 0xFF00)
-  {
-    cf = 1;
-  }
-  else
-  {
-    cf = 0;
-  }
-
-  if ((dst ^ v1) & (v1 ^ v2) & 0x80)
-  {
-    of = 1;
-  }
-  else
-  {
-    of = 0;
-  }
-
-  if ((v1 ^ v2 ^ dst) & 0x10)
-  {
-    af = 1;
-  }
-  else
-  {
-    af = 0;
-  }
+  cf = (dst & 0xFF00) ? 1 : 0;
+  lazy_op = LAZY_SUB8;
+  lazy_v1 = v1;
+  lazy_v2 = v2;
+  lazy_res = (uint8_t) dst;
 }
 
 static void flag_sbb16(uint16_t v1, uint16_t v2, uint16_t v3)
@@ -407,104 +463,23 @@ static void flag_sbb16(uint16_t v1, uint16_t v2, uint16_t v3)
   uint32_t dst;
 
   dst = (uint32_t) v1 - (uint32_t) v2 - v3;
-  flag_szp16((uint16_t) dst);
-  if (dst & 0xFFFF0000)
-  {
-    cf = 1;
-  }
-  else
-  {
-    cf = 0;
-  }
-
-  if ((dst ^ v1) & (v1 ^ v2) & 0x8000)
-  {
-    of = 1;
-  }
-  else
-  {
-    of = 0;
-  }
-
-  if ((v1 ^ v2 ^ dst) & 0x10)
-  {
-    af = 1;
-  }
-  else
-  {
-    af = 0;
-  }
+  cf = (dst & 0xFFFF0000) ? 1 : 0;
+  lazy_op = LAZY_SUB16;
+  lazy_v1 = v1;
+  lazy_v2 = v2;
+  lazy_res = (uint16_t) dst;
 }
 
 static void flag_sub8(uint8_t v1, uint8_t v2)
 {
   /* v1 = destination operand, v2 = source operand */
-  uint16_t dst;
-
-  dst = (uint16_t) v1 - (uint16_t) v2;
-  flag_szp8((uint8_t) dst);
-  if (dst & 0xFF00)
-  {
-    cf = 1;
-  }
-  else
-  {
-    cf = 0;
-  }
-
-  if ((dst ^ v1) & (v1 ^ v2) & 0x80)
-  {
-    of = 1;
-  }
-  else
-  {
-    of = 0;
-  }
-
-  if ((v1 ^ v2 ^ dst) & 0x10)
-  {
-    af = 1;
-  }
-  else
-  {
-    af = 0;
-  }
+  flag_sbb8(v1, v2, 0);
 }
 
 static void flag_sub16(uint16_t v1, uint16_t v2)
 {
-
   /* v1 = destination operand, v2 = source operand */
-  uint32_t dst;
-
-  dst = (uint32_t) v1 - (uint32_t) v2;
-  flag_szp16((uint16_t) dst);
-  if (dst & 0xFFFF0000)
-  {
-    cf = 1;
-  }
-  else
-  {
-    cf = 0;
-  }
-
-  if ((dst ^ v1) & (v1 ^ v2) & 0x8000)
-  {
-    of = 1;
-  }
-  else
-  {
-    of = 0;
-  }
-
-  if ((v1 ^ v2 ^ dst) & 0x10)
-  {
-    af = 1;
-  }
-  else
-  {
-    af = 0;
-  }
+  flag_sbb16(v1, v2, 0);
 }
 
 static void op_adc8()
@@ -731,7 +706,7 @@ static uint16_t readrm16(uint8_t rmval)
   if (mode < 3)
   {
     getea(rmval);
-    return (uint16_t)(read86(ea) | ( read86(ea + 1) << 8));
+    return readw86(ea);
   }
   else
   {
@@ -757,8 +732,7 @@ static void writerm16(uint8_t rmval, uint16_t value)
   if (mode < 3)
   {
     getea(rmval);
-    write86(ea, (uint8_t)value & 0xFF);
-    write86(ea + 1, (uint8_t)(value >> 8));
+    writew86(ea, value);
   }
   else
   {
@@ -780,6 +754,7 @@ static void writerm8(uint8_t rmval, uint8_t value)
 }
 
 static void op_daa_das(int8_t low_nibble, int8_t high_nibble) {
+  sync_flags();
   oldal = regs.byteregs[regal];
   uint8_t oldcftemp = cf;
 
@@ -811,6 +786,7 @@ static uint8_t op_grp2_8(uint8_t cnt)
   uint16_t oldcftemp;
   uint16_t msb;
 
+  sync_flags();
   s = oper1b;
 
 #ifdef CPU_V20 //80186/V20 class CPUs limit shift count to 31
@@ -961,6 +937,7 @@ static uint16_t op_grp2_16(uint8_t cnt)
   uint32_t oldcftemp;
   uint32_t msb;
 
+  sync_flags();
   s = oper1;
 
 #ifdef CPU_V20 //80186/V20 class CPUs limit shift count to 31
@@ -1200,6 +1177,7 @@ static void op_grp3_8()
     break;
 
     case 4: /* MUL */
+      sync_flags();
       temp1 = (uint32_t) oper1b * (uint32_t) regs.byteregs[regal];
       putreg16(regax, temp1 & 0xFFFF);
       flag_szp8((uint8_t) temp1);
@@ -1219,6 +1197,7 @@ static void op_grp3_8()
     break;
 
     case 5: /* IMUL */
+      sync_flags();
       oper1 = (uint16_t)signext(oper1b);
       temp1 = (uint32_t)signext(regs.byteregs[regal]);
       temp2 = oper1;
@@ -1354,6 +1333,7 @@ static void op_grp3_16()
     break;
 
     case 4: /* MUL */
+      sync_flags();
       temp1 = (uint32_t) oper1 * (uint32_t) getreg16(regax);
       putreg16(regax,(uint16_t) (temp1 ));
       putreg16(regdx,(uint16_t) (temp1 >> 16));
@@ -1374,6 +1354,7 @@ static void op_grp3_16()
     break;
 
     case 5: /* IMUL */
+      sync_flags();
       temp1 = getreg16(regax);
       temp2 = oper1;
       if (temp1 & 0x8000)
@@ -1443,8 +1424,8 @@ static void op_grp5()
       push(segregs[regcs]);
       push(ip);
       getea(rm);
-      ip = (uint16_t) (read86(ea) + read86(ea + 1) * 256);
-      segregs[regcs] = (uint16_t) (read86(ea + 2) + read86(ea + 3) * 256);
+      ip = readw86(ea);
+      segregs[regcs] = readw86(ea + 2);
     break;
 
     case 4: /* JMP Ev */
@@ -1453,8 +1434,8 @@ static void op_grp5()
 
     case 5: /* JMP Mp */
       getea(rm);
-      ip = (uint16_t) (read86(ea) + read86(ea + 1) * 256);
-      segregs[regcs] = (uint16_t) (read86(ea + 2) + read86(ea + 3) * 256);
+      ip = readw86(ea);
+      segregs[regcs] = readw86(ea + 2);
     break;
 
     case 6: /* PUSH Ev */
@@ -2027,6 +2008,7 @@ void exec86(uint32_t tube_cycles)
       break;
 
       case 0x37: /* 37 AAA ASCII */
+        sync_flags();
         if (((regs.byteregs[regal] & 0xF) > 9) || (af == 1))
         {
           regs.byteregs[regal] = regs.byteregs[regal] + 6;
@@ -2090,6 +2072,7 @@ void exec86(uint32_t tube_cycles)
       break;
 
       case 0x3F: /* 3F AAS ASCII */
+        sync_flags();
         if (((regs.byteregs[regal] & 0xF) > 9) || (af == 1))
         {
           regs.byteregs[regal] = regs.byteregs[regal] - 6;
@@ -2364,6 +2347,7 @@ void exec86(uint32_t tube_cycles)
 
         case 0x69: /* 69 IMUL Gv Ev Iv (80186+) */
         modregrm();
+        sync_flags();
         temp1 = readrm16 (rm);
         temp2 = getmem16 (segregs[regcs], ip);
         StepIP (2);
@@ -2398,6 +2382,7 @@ void exec86(uint32_t tube_cycles)
 
         case 0x6B: /* 6B IMUL Gv Eb Ib (80186+) */
         modregrm();
+        sync_flags();
         temp1 = readrm16 (rm);
         temp2 = (uint32_t)signext (getmem8 (segregs[regcs], ip));
         StepIP (1);
@@ -2550,7 +2535,7 @@ void exec86(uint32_t tube_cycles)
         case 0x70: /* 70 JO Jb */
         temp16 = (uint16_t)signext(getmem8(segregs[regcs], ip));
         StepIP(1);
-        if (of)
+        if (lazy_of())
         {
           ip = ip + temp16;
         }
@@ -2559,7 +2544,7 @@ void exec86(uint32_t tube_cycles)
         case 0x71: /* 71 JNO Jb */
         temp16 = (uint16_t)signext(getmem8(segregs[regcs], ip));
         StepIP(1);
-        if (!of)
+        if (!lazy_of())
         {
           ip = ip + temp16;
         }
@@ -2586,7 +2571,7 @@ void exec86(uint32_t tube_cycles)
         case 0x74: /* 74 JZ Jb */
         temp16 = (uint16_t)signext(getmem8(segregs[regcs], ip));
         StepIP(1);
-        if (zf)
+        if (lazy_zf())
         {
           ip = ip + temp16;
         }
@@ -2595,7 +2580,7 @@ void exec86(uint32_t tube_cycles)
         case 0x75: /* 75 JNZ Jb */
         temp16 = (uint16_t)signext(getmem8(segregs[regcs], ip));
         StepIP(1);
-        if (!zf)
+        if (!lazy_zf())
         {
           ip = ip + temp16;
         }
@@ -2604,7 +2589,7 @@ void exec86(uint32_t tube_cycles)
         case 0x76: /* 76 JBE Jb */
         temp16 = (uint16_t)signext(getmem8(segregs[regcs], ip));
         StepIP(1);
-        if (cf || zf)
+        if (cf || lazy_zf())
         {
           ip = ip + temp16;
         }
@@ -2613,7 +2598,7 @@ void exec86(uint32_t tube_cycles)
         case 0x77: /* 77 JA Jb */
         temp16 = (uint16_t)signext(getmem8(segregs[regcs], ip));
         StepIP(1);
-        if (!cf && !zf)
+        if (!cf && !lazy_zf())
         {
           ip = ip + temp16;
         }
@@ -2622,7 +2607,7 @@ void exec86(uint32_t tube_cycles)
         case 0x78: /* 78 JS Jb */
         temp16 = (uint16_t)signext(getmem8(segregs[regcs], ip));
         StepIP(1);
-        if (sf)
+        if (lazy_sf())
         {
           ip = ip + temp16;
         }
@@ -2631,7 +2616,7 @@ void exec86(uint32_t tube_cycles)
         case 0x79: /* 79 JNS Jb */
         temp16 = (uint16_t)signext(getmem8(segregs[regcs], ip));
         StepIP(1);
-        if (!sf)
+        if (!lazy_sf())
         {
           ip = ip + temp16;
         }
@@ -2640,7 +2625,7 @@ void exec86(uint32_t tube_cycles)
         case 0x7A: /* 7A JPE Jb */
         temp16 = (uint16_t)signext(getmem8(segregs[regcs], ip));
         StepIP(1);
-        if (pf)
+        if (lazy_pf())
         {
           ip = ip + temp16;
         }
@@ -2649,7 +2634,7 @@ void exec86(uint32_t tube_cycles)
         case 0x7B: /* 7B JPO Jb */
         temp16 = (uint16_t)signext(getmem8(segregs[regcs], ip));
         StepIP(1);
-        if (!pf)
+        if (!lazy_pf())
         {
           ip = ip + temp16;
         }
@@ -2658,7 +2643,7 @@ void exec86(uint32_t tube_cycles)
         case 0x7C: /* 7C JL Jb */
         temp16 = (uint16_t)signext(getmem8(segregs[regcs], ip));
         StepIP(1);
-        if (sf != of)
+        if (lazy_sf() != lazy_of())
         {
           ip = ip + temp16;
         }
@@ -2667,7 +2652,7 @@ void exec86(uint32_t tube_cycles)
         case 0x7D: /* 7D JGE Jb */
         temp16 = (uint16_t)signext(getmem8(segregs[regcs], ip));
         StepIP(1);
-        if (sf == of)
+        if (lazy_sf() == lazy_of())
         {
           ip = ip + temp16;
         }
@@ -2676,7 +2661,7 @@ void exec86(uint32_t tube_cycles)
         case 0x7E: /* 7E JLE Jb */
         temp16 = (uint16_t)signext(getmem8(segregs[regcs], ip));
         StepIP(1);
-        if ((sf != of) || zf)
+        if ((lazy_sf() != lazy_of()) || lazy_zf())
         {
           ip = ip + temp16;
         }
@@ -2685,7 +2670,7 @@ void exec86(uint32_t tube_cycles)
         case 0x7F: /* 7F JG Jb */
         temp16 = (uint16_t)signext(getmem8(segregs[regcs], ip));
         StepIP(1);
-        if (!zf && (sf == of))
+        if (!lazy_zf() && (lazy_sf() == lazy_of()))
         {
           ip = ip + temp16;
         }
@@ -3061,11 +3046,11 @@ void exec86(uint32_t tube_cycles)
           putreg16(regcx, getreg16(regcx) - 1);
         }
 
-        if ((reptype == 1) && !zf)
+        if ((reptype == 1) && !lazy_zf())
         {
           break;
         }
-        else if ((reptype == 2) && (zf == 1))
+        else if ((reptype == 2) && (lazy_zf() == 1))
         {
           break;
         }
@@ -3104,12 +3089,12 @@ void exec86(uint32_t tube_cycles)
           putreg16(regcx, getreg16(regcx) - 1);
         }
 
-        if ((reptype == 1) && !zf)
+        if ((reptype == 1) && !lazy_zf())
         {
           break;
         }
 
-        if ((reptype == 2) && (zf == 1))
+        if ((reptype == 2) && (lazy_zf() == 1))
         {
           break;
         }
@@ -3281,11 +3266,11 @@ void exec86(uint32_t tube_cycles)
           putreg16(regcx, getreg16(regcx) - 1);
         }
 
-        if ((reptype == 1) && !zf)
+        if ((reptype == 1) && !lazy_zf())
         {
           break;
         }
-        else if ((reptype == 2) && (zf == 1))
+        else if ((reptype == 2) && (lazy_zf() == 1))
         {
           break;
         }
@@ -3322,11 +3307,11 @@ void exec86(uint32_t tube_cycles)
           putreg16(regcx, getreg16(regcx) - 1);
         }
 
-        if ((reptype == 1) && !zf)
+        if ((reptype == 1) && !lazy_zf())
         {
           break;
         }
-        else if ((reptype == 2) && (zf == 1))
+        else if ((reptype == 2) && (lazy_zf() == 1))
         {
           break;
         }
@@ -3453,15 +3438,15 @@ void exec86(uint32_t tube_cycles)
         case 0xC4: /* C4 LES Gv Mp */
         modregrm();
         getea(rm);
-        putreg16(reg, (uint16_t)(read86(ea) + read86(ea + 1) * 256));
-        segregs[reges] = (uint16_t)(read86(ea + 2) + read86(ea + 3) * 256);
+        putreg16(reg, readw86(ea));
+        segregs[reges] = readw86(ea + 2);
         break;
 
         case 0xC5: /* C5 LDS Gv Mp */
         modregrm();
         getea(rm);
-        putreg16(reg, (uint16_t)(read86(ea) + read86(ea + 1) * 256));
-        segregs[regds] = (uint16_t)(read86(ea + 2) + read86(ea + 3) * 256);
+        putreg16(reg, readw86(ea));
+        segregs[regds] = readw86(ea + 2);
         break;
 
         case 0xC6: /* C6 MOV Eb Ib */
@@ -3528,7 +3513,7 @@ void exec86(uint32_t tube_cycles)
         break;
 
         case 0xCE: /* CE INTO */
-        if (of)
+        if (lazy_of())
         {
           intcall86(4);
         }
@@ -3579,6 +3564,7 @@ void exec86(uint32_t tube_cycles)
 
         regs.byteregs[regah] = (uint8_t)(regs.byteregs[regal] / oper1);
         regs.byteregs[regal] = (uint8_t)(regs.byteregs[regal] % oper1);
+        sync_flags();
         flag_szp16(getreg16(regax));
         break;
 
@@ -3587,6 +3573,7 @@ void exec86(uint32_t tube_cycles)
         StepIP(1);
         regs.byteregs[regal] = (uint8_t)(regs.byteregs[regah] * oper1 + regs.byteregs[regal]);
         regs.byteregs[regah] = 0;
+        sync_flags();
         flag_szp16((uint16_t)(regs.byteregs[regah] * oper1 + regs.byteregs[regal]));
         sf = 0;
         break;
@@ -3616,7 +3603,7 @@ void exec86(uint32_t tube_cycles)
         temp16 = (uint16_t)signext(getmem8(segregs[regcs], ip));
         StepIP(1);
         putreg16(regcx, getreg16(regcx) - 1);
-        if ((getreg16(regcx)) && !zf)
+        if ((getreg16(regcx)) && !lazy_zf())
         {
           ip = ip + temp16;
         }
@@ -3626,7 +3613,7 @@ void exec86(uint32_t tube_cycles)
         temp16 = (uint16_t)signext(getmem8(segregs[regcs], ip));
         StepIP(1);
         putreg16(regcx, (getreg16(regcx)) - 1);
-        if ((getreg16(regcx)) && (zf == 1))
+        if ((getreg16(regcx)) && (lazy_zf() == 1))
         {
           ip = ip + temp16;
         }
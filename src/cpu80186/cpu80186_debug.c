@@ -65,6 +65,8 @@ static const char *dbg_trap_names[] = {
 static int dbg_debug_enable(int newvalue) {
    int oldvalue = cpu80186_debug_enabled;
    cpu80186_debug_enabled = newvalue;
+   // Memory accesses only reach the debugger through the slow path
+   Map80186Pages();
    return oldvalue;
 }
 
@@ -67,6 +67,9 @@ uint8_t* RAM = (uint8_t*) m186_RamBase;
 // 14 -> 896KB   no remapping
 // 15 -> 960KB   no remapping
 
+uintptr_t mem_read_page[MEM_NUM_PAGES];
+uintptr_t mem_write_page[MEM_NUM_PAGES];
+
 static inline uint32_t map_address(uint32_t addr) {
    // Implement the Upper RAM alias
    if (addr > 0x80000 && addr <= 0xBFFFF && addr >= RAM_LIMIT) {
@@ -75,7 +78,10 @@ static inline uint32_t map_address(uint32_t addr) {
    return addr;
 }
 
-void write86(uint32_t addr32, uint8_t value)
+// The slow path, for pages marked MEM_PAGE_SLOW and for addresses beyond
+// the page table
+
+void write86_slow(uint32_t addr32, uint8_t value)
 {
    addr32 &= 0xFFFFFF;
 #ifdef INCLUDE_DEBUGGER
@@ -93,13 +99,7 @@ void write86(uint32_t addr32, uint8_t value)
    }
 }
 
-void writew86(uint32_t addr32, uint16_t value)
-{
-   write86(addr32, (uint8_t) value);
-   write86(addr32 + 1, (uint8_t)(value >> 8));
-}
-
-uint8_t read86(uint32_t addr32)
+uint8_t read86_slow(uint32_t addr32)
 {
    addr32 &= 0xFFFFFF;
    uint32_t addr = map_address(addr32);
@@ -116,9 +116,33 @@ uint8_t read86(uint32_t addr32)
    return value;
 }
 
-uint16_t readw86(uint32_t addr32)
+// Build the page table used by read86() etc. (see mem80186.h). This must be
+// called again whenever RAM_LIMIT or the debugger state changes.
+void Map80186Pages(void)
 {
-   return (uint16_t) (read86(addr32) | (read86(addr32 + 1) << 8));
+   for (uint32_t page = 0; page < MEM_NUM_PAGES; page++) {
+      uint32_t base = page << MEM_PAGE_SHIFT;
+      // RAM_LIMIT is a multiple of 64KB, so a whole page is mapped the same way
+      uint32_t addr = map_address(base | 1) & ~MEM_PAGE_MASK;
+#ifdef USE_MEMORY_POINTER
+      uintptr_t offset = (uintptr_t)(RAM + addr) - base;
+#else
+      uintptr_t offset = (uintptr_t)addr - base;
+#endif
+      mem_read_page[page] = offset;
+      mem_write_page[page] = addr < RAM_LIMIT ? offset : MEM_PAGE_SLOW;
+      // The alias starts at 0x80001, so its first page is mapped byte by byte
+      if (addr != base && base == 0x80000) {
+         mem_read_page[page] = MEM_PAGE_SLOW;
+         mem_write_page[page] = MEM_PAGE_SLOW;
+      }
+#ifdef INCLUDE_DEBUGGER
+      if (cpu80186_debug_enabled) {
+         mem_read_page[page] = MEM_PAGE_SLOW;
+         mem_write_page[page] = MEM_PAGE_SLOW;
+      }
+#endif
+   }
 }
 
 void Cleari80186Ram(void)
@@ -139,6 +163,7 @@ void Cleari80186Ram(void)
       // Default is 896KB
       RAM_LIMIT = 0xE0000;
    }
+   Map80186Pages();
 }
 
 // The ARM must call RomCopy before starting the Processor
@@ -1,3 +1,9 @@
+#ifndef MEM80186_H
+#define MEM80186_H
+
+
+#include <stdint.h>
+#include <string.h>
 
 #define DECLARE_RAM
 
@@ -26,9 +32,78 @@ extern uint8_t* RAM;
 extern uint8_t* RAM;
 #endif
 
-extern void write86(uint32_t addr32, uint8_t value);
-extern void writew86(uint32_t addr32, uint16_t value);
-extern uint8_t read86(uint32_t addr32);
-extern uint16_t readw86(uint32_t addr32);
+// Memory is accessed through a table of 4KB pages, built by Map80186Pages()
+// from the RAM size. Each entry is added to an address in that page to
+// give the host address, or is MEM_PAGE_SLOW where the access must go
+// through the slow path in mem80186.c (writes to ROM or to unpopulated
+// RAM, the one address at the start of the Upper RAM alias that isn't
+// aliased, and everything while the debugger is watching). Segment:offset
+// addresses can reach 0x10FFEF, so the table covers 1MB + 64KB.
+
+#define MEM_PAGE_SHIFT 12
+#define MEM_PAGE_MASK  ((1u << MEM_PAGE_SHIFT) - 1)
+#define MEM_NUM_PAGES  ((ONE_MEG + 0x10000) >> MEM_PAGE_SHIFT)
+#define MEM_PAGE_SLOW  1
+
+extern uintptr_t mem_read_page[MEM_NUM_PAGES];
+extern uintptr_t mem_write_page[MEM_NUM_PAGES];
+
+extern void write86_slow(uint32_t addr32, uint8_t value);
+extern uint8_t read86_slow(uint32_t addr32);
 extern void Cleari80186Ram(void);
+extern void Map80186Pages(void);
 extern void RomCopy(void);
+
+static inline void write86(uint32_t addr32, uint8_t value)
+{
+   if (addr32 < (MEM_NUM_PAGES << MEM_PAGE_SHIFT)) {
+      uintptr_t page = mem_write_page[addr32 >> MEM_PAGE_SHIFT];
+      if (!(page & MEM_PAGE_SLOW)) {
+         *(uint8_t *)(page + addr32) = value;
+         return;
+      }
+   }
+   write86_slow(addr32, value);
+}
+
+static inline uint8_t read86(uint32_t addr32)
+{
+   if (addr32 < (MEM_NUM_PAGES << MEM_PAGE_SHIFT)) {
+      uintptr_t page = mem_read_page[addr32 >> MEM_PAGE_SHIFT];
+      if (!(page & MEM_PAGE_SLOW)) {
+         return *(uint8_t *)(page + addr32);
+      }
+   }
+   return read86_slow(addr32);
+}
+
+// Words that don't cross a page are a single (possibly unaligned) load or
+// store; both the Pi and the native hosts are little endian like the 80186
+
+static inline void writew86(uint32_t addr32, uint16_t value)
+{
+   if (addr32 < (MEM_NUM_PAGES << MEM_PAGE_SHIFT) && (addr32 & MEM_PAGE_MASK) != MEM_PAGE_MASK) {
+      uintptr_t page = mem_write_page[addr32 >> MEM_PAGE_SHIFT];
+      if (!(page & MEM_PAGE_SLOW)) {
+         memcpy((void *)(page + addr32), &value, sizeof(value));
+         return;
+      }
+   }
+   write86(addr32, (uint8_t) value);
+   write86(addr32 + 1, (uint8_t)(value >> 8));
+}
+
+static inline uint16_t readw86(uint32_t addr32)
+{
+   if (addr32 < (MEM_NUM_PAGES << MEM_PAGE_SHIFT) && (addr32 & MEM_PAGE_MASK) != MEM_PAGE_MASK) {
+      uintptr_t page = mem_read_page[addr32 >> MEM_PAGE_SHIFT];
+      if (!(page & MEM_PAGE_SLOW)) {
+         uint16_t value;
+         memcpy(&value, (const void *)(page + addr32), sizeof(value));
+         return value;
+      }
+   }
+   return (uint16_t) (read86(addr32) | (read86(addr32 + 1) << 8));
+}
+
+#endif
@@ -28,6 +28,8 @@ typedef struct {
   const int mem_width;                                                // Width of value returned from memread(): 0=8-bit, 1=16-bit, 2=32-bit
   const int io_width;                                                 // Width of value returned from  ioread(): 0=8-bit, 1=16-bit, 2=32-bit
   const int default_base;                                             // Allows a co pro to override the default base of 16
+  void     (*profile_enable)(uint32_t rate);                          // Optional: sample every rate'th instruction, 0 to stop
+  void     (*profile_dump)(void);                                     // Optional: print the samples collected so far
 } cpu_debug_t;
 
 extern void debug_init    ();
@@ -23,7 +23,7 @@ static const char * prompt_str = ">> ";
 
 extern unsigned int copro;
 
-#define NUM_CMDS 24
+#define NUM_CMDS 25
 #define NUM_IO_CMDS 6
 
 // The Atom CRC Polynomial
@@ -78,6 +78,7 @@ static void doCmdList(const char *params);
 static void doCmdMem(const char *params);
 static void doCmdNext(const char *params);
 static void doCmdOut(const char *params);
+static void doCmdProfile(const char *params);
 static void doCmdRd(const char *params);
 static void doCmdRegs(const char *params);
 static void doCmdStep(const char *params);
@@ -120,6 +121,7 @@ static const char *dbgCmdStrings[NUM_CMDS + NUM_IO_CMDS] = {
    "watchw",
    "base",
    "width",
+   "profile",
    "in",
    "out",
    "breaki",
@@ -153,6 +155,7 @@ static const char *dbgHelpStrings[NUM_CMDS + NUM_IO_CMDS] = {
    "<address> [ <mask> ]",   // watchw
    "8 | 16",                 // base
    "8 | 16 | 32",            // width
+   "on [ <rate> ] | off | dump", // profile
    "<address>",              // in
    "<address> <data>",       // out
    "<address> [ <mask> ]",   // breaki
@@ -187,6 +190,7 @@ static void (*dbgCmdFuncs[NUM_CMDS + NUM_IO_CMDS])(const char *params) = {
    doCmdWatchWr,
    doCmdBase,
    doCmdWidth,
+   doCmdProfile,
    doCmdIn,
    doCmdOut,
    doCmdBreakIn,
@@ -725,6 +729,32 @@ static void doCmdWidth(const char *params) {
       printf("Setting data width to %s\r\n", width_names[i]);
    }
 }
+static void doCmdProfile(const char *params) {
+   const cpu_debug_t *cpu = getCpu();
+   char mode[100];
+   unsigned int rate = 100;
+   if (!cpu->profile_enable) {
+      printf("No profiler implemented in %s\r\n", cpu->cpu_name);
+      return;
+   }
+   int num_params = sscanf(params, "%99s %u", mode, &rate);
+   if (num_params > 0 && strcasecmp(mode, "on") == 0) {
+      if (rate == 0) {
+         printf("Rate must be positive\r\n");
+         return;
+      }
+      cpu->profile_enable(rate);
+      printf("Profiling every %u instructions\r\n", rate);
+   } else if (num_params > 0 && strcasecmp(mode, "off") == 0) {
+      cpu->profile_enable(0);
+      printf("Profiling disabled\r\n");
+   } else if (num_params > 0 && strcasecmp(mode, "dump") == 0) {
+      cpu->profile_dump();
+   } else {
+      printf("Usage: profile on [ <rate> ] | off | dump\r\n");
+   }
+}
+
 static void doCmdInfo(const char *params) {
    dump_useful_info();
 }
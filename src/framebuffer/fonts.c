@@ -54,6 +54,38 @@
 
 static font_t current_font;
 
+static uint32_t font_generation;
+
+// Glyph cache: characters already rendered at the current font, scale, depth
+// and colours, stored as rows of pixels ready to copy to the frame buffer
+
+#define GLYPH_CACHE_SIZE 512
+
+// Larger glyphs (e.g. very big scale factors) are drawn a pixel at a time
+#define GLYPH_CACHE_MAX_BYTES 4096
+
+typedef struct {
+   int c;
+   pixel_t fg_col;
+   pixel_t bg_col;
+} glyph_tag_t;
+
+static struct {
+   // What the cache was built for; valid is cleared when the font changes
+   int valid;
+   font_t *font;
+   uint32_t number;
+   int scale_w;
+   int rounding;
+   int log2bpp;
+   int rows;
+   int row_bytes;
+   size_t glyph_bytes;
+   glyph_tag_t tag[GLYPH_CACHE_SIZE];
+   uint8_t *data;
+   size_t size;
+} glyph_cache;
+
 // ==========================================================================
 // Font Definitions
 // ==========================================================================
@@ -131,6 +163,9 @@ static void copy_font_character(font_t *font, uint8_t *src, int c, int is_graphi
    if (c > font->num_chars) {
       return;
    }
+   // Any glyphs already rendered may now be stale
+   glyph_cache.valid = 0;
+   font->generation = ++font_generation;
    uint16_t *dst = font->buffer + c * (font->height << font->rounding);
    // Skip any padding bytes
    src += font->offset;
@@ -238,7 +273,94 @@ static int default_get_overall_h(font_t *font) {
    return ((font->height + font->spacing_h) << font->rounding) * font->scale_h;
 }
 
+// Returns the cache entry for character c, rendering it if necessary, or NULL
+// if the glyph is too big to be cached
+static uint8_t *get_glyph(font_t *font, screen_mode_t *screen, int c, pixel_t fg_col, pixel_t bg_col) {
+   int width  = font->width  << font->rounding;
+   int height = font->height << font->rounding;
+   if (!glyph_cache.valid || glyph_cache.font != font || glyph_cache.number != font->number ||
+       glyph_cache.scale_w != font->scale_w || glyph_cache.rounding != font->rounding ||
+       glyph_cache.log2bpp != screen->log2bpp) {
+      // Rebuild the cache for the new font metrics
+      size_t row_bytes = (size_t)((width * font->scale_w) << (screen->log2bpp - 3));
+      size_t glyph_bytes = row_bytes * (size_t)height;
+      if (glyph_bytes > GLYPH_CACHE_MAX_BYTES) {
+         return NULL;
+      }
+      if (glyph_bytes * GLYPH_CACHE_SIZE > glyph_cache.size) {
+         uint8_t *data = realloc(glyph_cache.data, glyph_bytes * GLYPH_CACHE_SIZE);
+         if (data == NULL) {
+            return NULL;
+         }
+         glyph_cache.data = data;
+         glyph_cache.size = glyph_bytes * GLYPH_CACHE_SIZE;
+      }
+      glyph_cache.font        = font;
+      glyph_cache.number      = font->number;
+      glyph_cache.scale_w     = font->scale_w;
+      glyph_cache.rounding    = font->rounding;
+      glyph_cache.log2bpp     = screen->log2bpp;
+      glyph_cache.rows        = height;
+      glyph_cache.row_bytes   = (int)row_bytes;
+      glyph_cache.glyph_bytes = glyph_bytes;
+      for (int i = 0; i < GLYPH_CACHE_SIZE; i++) {
+         glyph_cache.tag[i].c = -1;
+      }
+      glyph_cache.valid = 1;
+   }
+   unsigned int index = ((unsigned int)c ^ (fg_col * 31) ^ (bg_col * 17)) & (GLYPH_CACHE_SIZE - 1);
+   glyph_tag_t *tag = &glyph_cache.tag[index];
+   uint8_t *glyph = glyph_cache.data + index * glyph_cache.glyph_bytes;
+   if (tag->c == c && tag->fg_col == fg_col && tag->bg_col == bg_col) {
+      return glyph;
+   }
+   // Render the character, one row of pixels per font row
+   uint8_t  *dst8  = glyph;
+   uint16_t *dst16 = (uint16_t *)glyph;
+   uint32_t *dst32 = (uint32_t *)glyph;
+   int p    = c * height;
+   int mask = 1 << (width - 1);
+   for (int i = 0; i < height; i++) {
+      int data = font->buffer[p++];
+      for (int j = 0; j < width; j++) {
+         pixel_t col = (data & mask) ? fg_col : bg_col;
+         for (int sx = 0; sx < font->scale_w; sx++) {
+            switch (screen->log2bpp) {
+            case 3:
+               *dst8++ = (uint8_t)col;
+               break;
+            case 4:
+               *dst16++ = (uint16_t)col;
+               break;
+            default:
+               *dst32++ = col;
+               break;
+            }
+         }
+         data <<= 1;
+      }
+   }
+   tag->c = c;
+   tag->fg_col = fg_col;
+   tag->bg_col = bg_col;
+   return glyph;
+}
+
 static void default_write_char(font_t *font, screen_mode_t *screen, int c, int x, int y, pixel_t fg_col, pixel_t bg_col) {
+   uint8_t *glyph = get_glyph(font, screen, c, fg_col, bg_col);
+   if (glyph) {
+      // Copy each row of the glyph scale_h times
+      uint8_t *fbptr = (uint8_t *)get_fb_address() + (screen->height - y - 1) * screen->pitch + (x << (screen->log2bpp - 3));
+      size_t row_bytes = (size_t)glyph_cache.row_bytes;
+      for (int i = 0; i < glyph_cache.rows; i++) {
+         for (int sy = 0; sy < font->scale_h; sy++) {
+            memcpy(fbptr - sy * screen->pitch, glyph, row_bytes);
+         }
+         glyph += row_bytes;
+         fbptr += font->scale_h * screen->pitch;
+      }
+      return;
+   }
    int x_pos = x;
    int width  = font->width  << font->rounding;
    int height = font->height << font->rounding;
@@ -261,6 +383,23 @@ static void default_write_char(font_t *font, screen_mode_t *screen, int c, int x
    }
 }
 
+// Match rows of pixels against the font; returns 0 if there is no match
+static int match_character(font_t *font, int *screendata) {
+   int height = font->height << font->rounding;
+   for (int c = 0x20; c < font->num_chars; c++) {
+      int y;
+      for (y = 0; y < height; y++) {
+         if (font->buffer[c * height + y] != screendata[y]) {
+            break;
+         }
+      }
+      if (y == height) {
+         return c;
+      }
+   }
+   return 0;
+}
+
 static int default_read_char(font_t *font, screen_mode_t *screen, int x, int y, pixel_t bg_col) {
    int screendata[MAX_FONT_HEIGHT];
    // Read the character from screen memory
@@ -278,17 +417,7 @@ static int default_read_char(font_t *font, screen_mode_t *screen, int x, int y,
       *dp++ = row;
    }
    // Match against font
-   for (int c = 0x20; c < font->num_chars; c++) {
-      for (y = 0; y < height; y++) {
-         if (font->buffer[c * height + y] != screendata[y]) {
-            break;
-         }
-      }
-      if (y == height) {
-         return c;
-      }
-   }
-   return 0;
+   return match_character(font, screendata);
 }
 
 // ==========================================================================
@@ -382,3 +511,17 @@ font_t *get_font_by_name(char *name) {
 void define_character(font_t *font, uint8_t c, uint8_t *data) {
    copy_font_character(font, data, c, 0);
 }
+
+// Returns what read_char() would return for a cell holding character c drawn
+// in the current font, or for a blank cell if c is negative, without needing
+// to read the pixels back from the screen
+int font_read_back(font_t *font, int c) {
+   int screendata[MAX_FONT_HEIGHT];
+   int width  = font->width  << font->rounding;
+   int height = font->height << font->rounding;
+   for (int i = 0; i < height; i++) {
+      // Only the width of the character is visible on screen
+      screendata[i] = (c < 0) ? 0 : font->buffer[c * height + i] & ((1 << width) - 1);
+   }
+   return match_character(font, screendata);
+}
@@ -31,6 +31,9 @@ typedef struct font {
    // The working copy of the font data
    uint16_t *buffer;
 
+   // Changes whenever the working copy is updated
+   uint32_t generation;
+
    void  (*set_spacing_w)(struct font *font, int spacing_w);
    void  (*set_spacing_h)(struct font *font, int spacing_h);
    void    (*set_scale_w)(struct font *font, int scale_w);
@@ -60,4 +63,6 @@ font_t *get_font_by_name(char *name);
 
 void define_character(font_t *font, uint8_t c, uint8_t *data);
 
+int font_read_back(font_t *font, int c);
+
 #endif
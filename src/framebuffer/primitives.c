@@ -64,12 +64,17 @@ static uint8_t g_dot_pattern[64];
 static int     g_dot_pattern_len;
 static int     g_dot_pattern_index;
 
-#define FLOOD_QUEUE_SIZE 16384
+// Flood fill span stack; each entry is a run of pixels on row y to be
+// scanned, reached from the row y - dy. The stack grows as needed.
+typedef struct {
+   int16_t xl;
+   int16_t xr;
+   int16_t y;
+   int16_t dy;
+} flood_span_t;
 
-static int16_t flood_queue_x[FLOOD_QUEUE_SIZE];
-static int16_t flood_queue_y[FLOOD_QUEUE_SIZE];
-static int flood_queue_wr;
-static int flood_queue_rd;
+static flood_span_t *flood_stack;
+static int flood_stack_size;
 
 // Rodders: Quadrant definitions for arc rendering
 typedef enum {
@@ -121,88 +126,224 @@ static pixel_t get_pixel(screen_mode_t *screen, int x, int y) {
    }
 }
 
-static void set_pixel(screen_mode_t *screen, int x, int y, plotcol_t col) {
-   plotmode_t plotmode;
-   pixel_t colour;
-   if (x < g_x_min  || x > g_x_max || y < g_y_min || y > g_y_max) {
-      return;
-   }
+static inline void resolve_plotcol(plotcol_t col, plotmode_t *plotmode, pixel_t *colour) {
    switch (col) {
    case PC_FG:
-      plotmode = g_fg_plotmode;
-      colour   = g_fg_col;
+      *plotmode = g_fg_plotmode;
+      *colour   = g_fg_col;
       break;
    case PC_BG:
-      plotmode = g_bg_plotmode;
-      colour   = g_bg_col;
+      *plotmode = g_bg_plotmode;
+      *colour   = g_bg_col;
       break;
    default:
-      plotmode = PM_INVERT;
-      colour   = 0; // not used
+      *plotmode = PM_INVERT;
+      *colour   = 0; // not used
+   }
+}
+
+// The row of the ECF pattern for line y; the pattern for pixel x is then ecf_colour()
+static inline const pixel_t *ecf_row(plotmode_t plotmode, int y) {
+   int ecfnum = (plotmode >> 4) - 1;
+   // Giant ECF selects the pattern per pixel, relative to pattern 0
+   if (ecfnum >= 4) {
+      ecfnum = 0;
+   }
+   return g_ecf_pattern[ecfnum] + (((y - g_ecf_origin_y) & 7) << 3);
+}
+
+static inline pixel_t ecf_colour(const pixel_t *row, int giant, int x) {
+   int offset = (x - g_ecf_origin_x) & g_ecf_mask;
+   if (giant) {
+      offset += (((x - g_ecf_origin_x) >> g_ecf_giant_shift) & 3) * 64;
+   }
+   return row[offset];
+}
+
+// Combine the existing pixel (with the marker bits clear) and the plot colour
+static inline pixel_t plot_pixel(plotmode_t plotmode, pixel_t existing, pixel_t colour) {
+   switch (plotmode) {
+   case PM_OR:
+      return colour | existing;
+   case PM_AND:
+      return colour & existing;
+   case PM_XOR:
+      return colour ^ existing;
+   case PM_INVERT:
+      return max_col - existing;
+   case PM_UNCHANGED:
+      return existing;
+   case PM_AND_INVERTED:
+      return existing & (max_col - colour);
+   case PM_OR_INVERTED:
+      return existing & (max_col - colour);
+   default:
+      return colour;
+   }
+}
+
+static void set_pixel(screen_mode_t *screen, int x, int y, plotcol_t col) {
+   plotmode_t plotmode;
+   pixel_t colour;
+   if (x < g_x_min  || x > g_x_max || y < g_y_min || y > g_y_max) {
+      return;
    }
+   mark_text_dirty(screen, x, y, x, y);
+   resolve_plotcol(col, &plotmode, &colour);
    if (plotmode >= PM_ECF) {
-      int ecfnum = (plotmode >> 4) - 1;
-      // Giant ECF
-      if (ecfnum >= 4) {
-         ecfnum = ((x - g_ecf_origin_x) >> g_ecf_giant_shift) & 3;
-      }
-      colour = g_ecf_pattern[ecfnum][(((y - g_ecf_origin_y) & 7) << 3) + ((x - g_ecf_origin_x) & g_ecf_mask)];
+      colour = ecf_colour(ecf_row(plotmode, y), (plotmode >> 4) > 4, x);
       plotmode &= 0x0F;
    }
    if (plotmode != PM_NORMAL) {
       // Make sure the marker bits are clear; this is safe in all modes
       pixel_t existing = screen->get_pixel(screen, x, y) & ~marker;
-      switch (plotmode) {
-      case PM_OR:
-         colour |= existing;
-         break;
-      case PM_AND:
-         colour &= existing;
-         break;
-      case PM_XOR:
-         colour ^= existing;
-         break;
-      case PM_INVERT:
-         colour = max_col - existing;
-         break;
-      case PM_UNCHANGED:
-         colour = existing;
-         break;
-      case PM_AND_INVERTED:
-         colour = existing & (max_col - colour);
-         break;
-      case PM_OR_INVERTED:
-         colour = existing & (max_col - colour);
-         break;
-      default:
-         break;
-      }
+      colour = plot_pixel(plotmode, existing, colour);
    }
    screen->set_pixel(screen, x, y, colour);
 }
 
-static void draw_hline(screen_mode_t *screen, int x1, int x2, int y, plotcol_t colour) {
+static inline uint8_t *fb_row(screen_mode_t *screen, int y) {
+   return (uint8_t *)get_fb_address() + (screen->height - y - 1) * screen->pitch;
+}
+
+// Plot modes normal, OR, AND and XOR with a solid colour work on a whole
+// word of pixels at a time; colour and keep are replicated across the word
+static inline uint32_t plot_word(plotmode_t plotmode, uint32_t existing, uint32_t colour, uint32_t keep) {
+   switch (plotmode) {
+   case PM_OR:
+      return (existing & keep) | colour;
+   case PM_AND:
+      return existing & keep & colour;
+   case PM_XOR:
+      return (existing & keep) ^ colour;
+   default:
+      return colour;
+   }
+}
+
+static void fill_span_words(uint8_t *ptr, uint8_t *end, int log2bpp, plotmode_t plotmode, uint32_t colour, uint32_t keep) {
+   // Pixels up to the first word boundary
+   while (ptr < end && ((uintptr_t)ptr & 3)) {
+      if (log2bpp == 3) {
+         *ptr = (uint8_t)plot_word(plotmode, *ptr, colour, keep);
+         ptr += 1;
+      } else {
+         *(uint16_t *)ptr = (uint16_t)plot_word(plotmode, *(uint16_t *)ptr, colour, keep);
+         ptr += 2;
+      }
+   }
+   // Whole words, four at a time
+   uint32_t *wptr = (uint32_t *)ptr;
+   uint32_t *wend = (uint32_t *)((uintptr_t)end & ~(uintptr_t)3);
+   if (plotmode == PM_NORMAL) {
+      while (wptr + 4 <= wend) {
+         wptr[0] = colour;
+         wptr[1] = colour;
+         wptr[2] = colour;
+         wptr[3] = colour;
+         wptr += 4;
+      }
+      while (wptr < wend) {
+         *wptr++ = colour;
+      }
+   } else {
+      while (wptr < wend) {
+         *wptr = plot_word(plotmode, *wptr, colour, keep);
+         wptr++;
+      }
+   }
+   // Any remaining pixels
+   ptr = (uint8_t *)wptr;
+   while (ptr < end) {
+      if (log2bpp == 3) {
+         *ptr = (uint8_t)plot_word(plotmode, *ptr, colour, keep);
+         ptr += 1;
+      } else {
+         *(uint16_t *)ptr = (uint16_t)plot_word(plotmode, *(uint16_t *)ptr, colour, keep);
+         ptr += 2;
+      }
+   }
+}
+
+// Plot a horizontal span of pixels from x1 to x2 inclusive. The span is clipped,
+// and the plot mode and ECF row resolved, once; the pixels are then written
+// directly to the frame buffer.
+static void fill_span(screen_mode_t *screen, int x1, int x2, int y, plotcol_t col) {
+   plotmode_t plotmode;
+   pixel_t colour;
    if (x1 > x2) {
       int tmp = x1;
       x1 = x2;
       x2 = tmp;
    }
-   for (int x = x1; x <= x2; x++) {
-      set_pixel(screen, x, y, colour);
+   if (y < g_y_min || y > g_y_max) {
+      return;
+   }
+   x1 = max(x1, g_x_min);
+   x2 = min(x2, g_x_max);
+   if (x1 > x2) {
+      return;
+   }
+   mark_text_dirty(screen, x1, y, x2, y);
+   resolve_plotcol(col, &plotmode, &colour);
+   const pixel_t *pattern = NULL;
+   int giant = 0;
+   if (plotmode >= PM_ECF) {
+      pattern = ecf_row(plotmode, y);
+      giant = (plotmode >> 4) > 4;
+      plotmode &= 0x0F;
+   }
+   int log2bpp = screen->log2bpp;
+   uint8_t *row = fb_row(screen, y);
+   uint8_t *ptr = row + (x1 << (log2bpp - 3));
+   uint8_t *end = row + ((x2 + 1) << (log2bpp - 3));
+   pixel_t keep = ~marker;
+
+   if (pattern == NULL && plotmode <= PM_XOR) {
+      // Replicate the colour and the marker mask across a word
+      if (log2bpp == 3) {
+         colour = (colour & 0xFF) * 0x01010101;
+         keep   = (keep   & 0xFF) * 0x01010101;
+      } else if (log2bpp == 4) {
+         colour = (colour & 0xFFFF) * 0x00010001;
+         keep   = (keep   & 0xFFFF) * 0x00010001;
+      }
+      fill_span_words(ptr, end, log2bpp, plotmode, colour, keep);
+      return;
+   }
+
+   // Everything else (ECF patterns and the remaining plot modes) goes a pixel at a time
+#define FILL_SPAN_PIXELS(type) { \
+      type *p = (type *)ptr; \
+      for (int x = x1; x <= x2; x++, p++) { \
+         pixel_t c = pattern ? ecf_colour(pattern, giant, x) : colour; \
+         if (plotmode != PM_NORMAL) { \
+            c = plot_pixel(plotmode, *p & keep, c); \
+         } \
+         *p = (type)c; \
+      } \
+   }
+   if (log2bpp == 3) {
+      FILL_SPAN_PIXELS(uint8_t);
+   } else if (log2bpp == 4) {
+      FILL_SPAN_PIXELS(uint16_t);
+   } else {
+      FILL_SPAN_PIXELS(uint32_t);
    }
+#undef FILL_SPAN_PIXELS
 }
 
 static void fill_bottom_flat_triangle(screen_mode_t *screen, int x1, int y1, int x2, int y2, int x3, int y3, plotcol_t colour) {
    // Note: y2 and y3 are the same, so the below test is slightly redundant
    if (y1 == y2 || y1 == y3) {
-      draw_hline(screen, (int)x2, (int)x3, y1, colour);
+      fill_span(screen, (int)x2, (int)x3, y1, colour);
    } else {
       float invslope1 = ((float) (x2 - x1)) / ((float) (y1 - y2));
       float invslope2 = ((float) (x3 - x1)) / ((float) (y1 - y3));
       float curx1 = 0.5f + (float)x1;
       float curx2 = curx1;
       for (int scanlineY = y1; scanlineY >= y2; scanlineY--) {
-         draw_hline(screen, (int)curx1, (int)curx2, scanlineY, colour);
+         fill_span(screen, (int)curx1, (int)curx2, scanlineY, colour);
          curx1 += invslope1;
          curx2 += invslope2;
       }
@@ -212,14 +353,14 @@ static void fill_bottom_flat_triangle(screen_mode_t *screen, int x1, int y1, int
 static void fill_top_flat_triangle(screen_mode_t *screen, int x1, int y1, int x2, int y2, int x3, int y3, plotcol_t colour) {
    // Note: y1 and y2 are the same, so the below test is slightly redundant
    if (y1 == y3 || y2 == y3) {
-      draw_hline(screen, (int)x1, (int)x2, y3, colour);
+      fill_span(screen, (int)x1, (int)x2, y3, colour);
    } else {
       float invslope1 = ((float) (x3 - x1)) / ((float) (y1 - y3));
       float invslope2 = ((float) (x3 - x2)) / ((float) (y2 - y3));
       float curx1 = 0.5f + (float)x3;
       float curx2 = curx1;
       for (int scanlineY = y3; scanlineY <= y1; scanlineY++) {
-         draw_hline(screen, (int)curx1, (int)curx2, scanlineY, colour);
+         fill_span(screen, (int)curx1, (int)curx2, scanlineY, colour);
          curx1 -= invslope1;
          curx2 -= invslope2;
       }
@@ -368,24 +509,24 @@ static void fill_circle(screen_mode_t *screen, int xc, int yc, int r, plotcol_t
    int y = r;
    int p = 3 - (2 * r);
    while (x < y) {
-      draw_hline(screen, xc + y, xc - y, yc + x, colour);
+      fill_span(screen, xc + y, xc - y, yc + x, colour);
       if (x > 0) {
-         draw_hline(screen, xc + y, xc - y, yc - x, colour);
+         fill_span(screen, xc + y, xc - y, yc - x, colour);
       }
       if (p < 0) {
          p += 4 * x + 6;
          x++;
       } else {
-         draw_hline(screen, xc + x, xc - x, yc - y, colour);
-         draw_hline(screen, xc + x, xc - x, yc + y, colour);
+         fill_span(screen, xc + x, xc - x, yc - y, colour);
+         fill_span(screen, xc + x, xc - x, yc + y, colour);
          p += 4 * (x - y) + 10;
          x++;
          y--;
       }
    }
    if (x == y) {
-      draw_hline(screen, xc + x, xc - x, yc - y, colour);
-      draw_hline(screen, xc + x, xc - x, yc + y, colour);
+      fill_span(screen, xc + x, xc - x, yc - y, colour);
+      fill_span(screen, xc + x, xc - x, yc + y, colour);
    }
 }
 
@@ -433,7 +574,7 @@ static void draw_normal_ellipse(screen_mode_t *screen, int xc, int yc, int width
 static void draw_sheared_ellipse(screen_mode_t *screen, int xc, int yc, int width, int height, int shear, plotcol_t colour) {
    // Draw the ellipse
    if (height == 0) {
-      draw_hline(screen, xc - width, xc + width, yc, colour);
+      fill_span(screen, xc - width, xc + width, yc, colour);
    } else {
       float axis_ratio = (float) width / (float) height;
       float shear_per_line = (float) (shear) / (float) height;
@@ -467,11 +608,11 @@ static void draw_sheared_ellipse(screen_mode_t *screen, int xc, int yc, int widt
             int xl = max(xl_this, max(xl_prev, xl_next) - 1);
             // Right line runs from xr_this leftwards to min(xr_this, min(xr_prev, xr_next) + 1)
             int xr = min(xr_this, min(xr_prev, xr_next) + 1);
-            draw_hline(screen, xc + xl_this, xc + xl, yc + y, colour);
-            draw_hline(screen, xc + xr_this, xc + xr, yc + y, colour);
+            fill_span(screen, xc + xl_this, xc + xl, yc + y, colour);
+            fill_span(screen, xc + xr_this, xc + xr, yc + y, colour);
             if (y > 0) {
-               draw_hline(screen, xc - xl_this, xc - xl, yc - y, colour);
-               draw_hline(screen, xc - xr_this, xc - xr, yc - y, colour);
+               fill_span(screen, xc - xl_this, xc - xl, yc - y, colour);
+               fill_span(screen, xc - xr_this, xc - xr, yc - y, colour);
             }
          }
          xl_prev = xl_this;
@@ -480,8 +621,8 @@ static void draw_sheared_ellipse(screen_mode_t *screen, int xc, int yc, int widt
          xr_this = xr_next;
       }
       // Draw the final slice
-      draw_hline(screen, xc + xl_this, xc + xr_this, yc + height, colour);
-      draw_hline(screen, xc - xl_this, xc - xr_this, yc - height, colour);
+      fill_span(screen, xc + xl_this, xc + xr_this, yc + height, colour);
+      fill_span(screen, xc - xl_this, xc - xr_this, yc - height, colour);
    }
 }
 
@@ -539,8 +680,8 @@ static void fill_normal_ellipse(screen_mode_t *screen, int xc, int yc, int width
    /* First half */
    for (x = 0, y = height, sigma = 2 * b2 + a2 * (1 - 2 * height); b2 * x <= a2 * y; x++) {
       if (sigma >= 0) {
-         draw_hline(screen, xc + x, xc - x, yc + y, colour);
-         draw_hline(screen, xc + x, xc - x, yc - y, colour);
+         fill_span(screen, xc + x, xc - x, yc + y, colour);
+         fill_span(screen, xc + x, xc - x, yc - y, colour);
          sigma += fa2 * (1 - y);
          y--;
       }
@@ -548,9 +689,9 @@ static void fill_normal_ellipse(screen_mode_t *screen, int xc, int yc, int width
    }
    /* Second half */
    for (x = width, y = 0, sigma = 2 * a2 + b2 * (1 - 2 * width); a2 * y <= b2 * x; y++) {
-      draw_hline(screen, xc + x, xc - x, yc + y, colour);
+      fill_span(screen, xc + x, xc - x, yc + y, colour);
       if (y > 0) {
-         draw_hline(screen, xc + x, xc - x, yc - y, colour);
+         fill_span(screen, xc + x, xc - x, yc - y, colour);
       }
       if (sigma >= 0) {
          sigma += fb2 * (1 - x);
@@ -563,7 +704,7 @@ static void fill_normal_ellipse(screen_mode_t *screen, int xc, int yc, int width
 static void fill_sheared_ellipse(screen_mode_t *screen, int xc, int yc, int width, int height, int shear, plotcol_t colour) {
    // Fill the ellipse
    if (height == 0) {
-      draw_hline(screen, xc - width, xc + width, yc, colour);
+      fill_span(screen, xc - width, xc + width, yc, colour);
    } else {
       float axis_ratio = (float) width / (float) height;
       float shear_per_line = (float) (shear) / (float) height;
@@ -580,9 +721,9 @@ static void fill_sheared_ellipse(screen_mode_t *screen, int xc, int yc, int widt
          y_squared += odd_sequence;
          odd_sequence += 2;
          // Draw the slice as a single horizintal line
-         draw_hline(screen, xc + xl, xc + xr, yc + y, colour);
+         fill_span(screen, xc + xl, xc + xr, yc + y, colour);
          if (y > 0) {
-            draw_hline(screen, xc - xl, xc - xr, yc - y, colour);
+            fill_span(screen, xc - xl, xc - xr, yc - y, colour);
          }
       }
    }
@@ -599,8 +740,8 @@ static void fill_sheared_ellipse(screen_mode_t *screen, int xc, int yc, int widt
    for (x = 0, y = height, sigma = 2 * b2 + a2 * (1 - 2 * height); b2 * x <= a2 * y; x++) {
       if (sigma >= 0) {
          int s = shear * y / height;
-         draw_hline(screen, xc + x + s, xc - x + s, yc + y, colour);
-         draw_hline(screen, xc + x - s, xc - x - s, yc - y, colour);
+         fill_span(screen, xc + x + s, xc - x + s, yc + y, colour);
+         fill_span(screen, xc + x - s, xc - x - s, yc - y, colour);
          sigma += fa2 * (1 - y);
          y--;
       }
@@ -609,9 +750,9 @@ static void fill_sheared_ellipse(screen_mode_t *screen, int xc, int yc, int widt
    /* Second half */
    for (x = width, y = 0, sigma = 2 * a2 + b2 * (1 - 2 * width); a2 * y <= b2 * x; y++) {
       int s = shear * y / height;
-      draw_hline(screen, xc + x + s, xc - x + s, yc + y, colour);
+      fill_span(screen, xc + x + s, xc - x + s, yc + y, colour);
       if (y > 0) {
-         draw_hline(screen, xc + x - s, xc - x - s, yc - y, colour);
+         fill_span(screen, xc + x - s, xc - x - s, yc - y, colour);
       }
       if (sigma >= 0) {
          sigma += fb2 * (1 - x);
@@ -939,140 +1080,162 @@ void prim_draw_line(screen_mode_t *screen, int x1, int y1, int x2, int y2, plotc
 }
 
 
-typedef int (*fill_test_fn)(screen_mode_t *, int, int);
-
-static int test_pixel_bg_col(screen_mode_t *screen, int x, int y) {
-   return get_pixel(screen, x, y) == g_bg_col;
-}
-
-
-static int test_pixel_bg_ecf(screen_mode_t *screen, int x, int y) {
-   int ecfnum = (g_bg_plotmode >> 4) - 1;
-   // Giant ECF
-   if (ecfnum >= 4) {
-      ecfnum = ((x - g_ecf_origin_x) >> g_ecf_giant_shift) & 3;
-   }
-   pixel_t colour = g_ecf_pattern[ecfnum][(((y - g_ecf_origin_y) & 7) << 3) + ((x - g_ecf_origin_x) & g_ecf_mask)];
-   return get_pixel(screen, x, y) == colour;
-}
-
-static int test_pixel_not_bg_col(screen_mode_t *screen, int x, int y) {
-   // No need to explicitely test for the marker as the test succeed fail on marked bits anyway
-   return get_pixel(screen, x, y) != g_bg_col;
-}
-
-static int test_pixel_not_bg_ecf(screen_mode_t *screen, int x, int y) {
-   // No need to explicitely test for the marker as the test succeed fail on marked bits anyway
-   int ecfnum = (g_bg_plotmode >> 4) - 1;
-   // Giant ECF
-   if (ecfnum >= 4) {
-      ecfnum = ((x - g_ecf_origin_x) >> g_ecf_giant_shift) & 3;
-   }
-   pixel_t colour = g_ecf_pattern[ecfnum][(((y - g_ecf_origin_y) & 7) << 3) + ((x - g_ecf_origin_x) & g_ecf_mask)];
-   return get_pixel(screen, x, y) != colour;
-}
+// The pixels that stop a flood fill
+typedef enum {
+   FT_BG,      // the background colour/pattern
+   FT_NOT_BG,  // anything but the background colour/pattern
+   FT_FG,      // the foreground colour/pattern, or a marked pixel
+   FT_MARKER   // an unmarked pixel
+} fill_test_t;
 
-static int test_pixel_fg_col(screen_mode_t *screen, int x, int y) {
-   pixel_t px = get_pixel(screen, x, y);
-   if (px & marker) {
-      // terminate the fill if a marked pixel is found
-      return 1;
+// The fill test resolved for one row of the frame buffer
+typedef struct {
+   fill_test_t test;
+   int log2bpp;
+   const uint8_t *row;
+   const pixel_t *pattern;
+   int giant;
+   pixel_t colour;
+} flood_row_t;
+
+static void flood_row(screen_mode_t *screen, fill_test_t test, int y, flood_row_t *r) {
+   plotmode_t plotmode = (test == FT_FG) ? g_fg_plotmode : g_bg_plotmode;
+   r->test = test;
+   r->log2bpp = screen->log2bpp;
+   r->row = fb_row(screen, y);
+   r->colour = (test == FT_FG) ? g_fg_col : g_bg_col;
+   r->pattern = NULL;
+   r->giant = 0;
+   if (plotmode >= PM_ECF && test != FT_MARKER) {
+      r->pattern = ecf_row(plotmode, y);
+      r->giant = (plotmode >> 4) > 4;
+   }
+}
+
+// Returns true if the pixel at x on the row stops the fill
+static inline int flood_boundary(const flood_row_t *r, int x) {
+   pixel_t px;
+   if (r->log2bpp == 3) {
+      px = r->row[x];
+   } else if (r->log2bpp == 4) {
+      px = ((const uint16_t *)r->row)[x];
    } else {
-      // or at a FG pixel
-      return px == g_fg_col;
+      px = ((const uint32_t *)r->row)[x];
+   }
+   switch (r->test) {
+   case FT_BG:
+      return px == (r->pattern ? ecf_colour(r->pattern, r->giant, x) : r->colour);
+   case FT_NOT_BG:
+      // No need to explicitely test for the marker as the test succeed fail on marked bits anyway
+      return px != (r->pattern ? ecf_colour(r->pattern, r->giant, x) : r->colour);
+   case FT_FG:
+      // terminate the fill if a marked pixel is found, or at a FG pixel
+      return (px & marker) || px == (r->pattern ? ecf_colour(r->pattern, r->giant, x) : r->colour);
+   default:
+      return !(px & marker);
    }
 }
 
-static int test_pixel_fg_ecf(screen_mode_t *screen, int x, int y) {
-   pixel_t px = get_pixel(screen, x, y);
-   if (px & marker) {
-      // terminate the fill if a marked pixel is found
-      return 1;
-   } else {
-      int ecfnum = (g_fg_plotmode >> 4) - 1;
-      // Giant ECF
-      if (ecfnum >= 4) {
-         ecfnum = ((x - g_ecf_origin_x) >> g_ecf_giant_shift) & 3;
+static int flood_push(int *sp, int xl, int xr, int y, int dy) {
+   if (*sp == flood_stack_size) {
+      int size = flood_stack_size ? flood_stack_size * 2 : 1024;
+      flood_span_t *stack = realloc(flood_stack, (size_t)size * sizeof(flood_span_t));
+      if (stack == NULL) {
+         printf("Flood fill out of memory\r\n");
+         return 0;
       }
-      pixel_t colour = g_ecf_pattern[ecfnum][(((y - g_ecf_origin_y) & 7) << 3) + ((x - g_ecf_origin_x) & g_ecf_mask)];
-      // of at a pixel that matches the ECF pattern
-      return (px == colour);
+      flood_stack = stack;
+      flood_stack_size = size;
    }
+   flood_stack[*sp].xl = (int16_t)xl;
+   flood_stack[*sp].xr = (int16_t)xr;
+   flood_stack[*sp].y  = (int16_t)y;
+   flood_stack[*sp].dy = (int16_t)dy;
+   (*sp)++;
+   return 1;
 }
 
-static void prim_flood_fill(screen_mode_t *screen, int x, int y, plotcol_t fill, fill_test_fn test_pixel) {
+// Scanline flood fill: each run of fillable pixels is plotted as a single span,
+// and the runs next to it on the rows above and below are pushed onto the stack
+static void prim_flood_fill(screen_mode_t *screen, int x, int y, plotcol_t fill, fill_test_t test) {
+   flood_row_t r;
 #ifdef DEBUG_VDU
-   int maxq = 0;
+   int maxsp = 0;
    printf("Flood fill @ %d,%d with fill %d; initial pixel %"PRIx32"\r\n", x, y, fill, get_pixel(screen, x, y));
 #endif
-   if ((*test_pixel)(screen, x, y)) {
+   if (x < g_x_min || x > g_x_max || y < g_y_min || y > g_y_max) {
       return;
    }
-   flood_queue_x[0] = (int16_t)x;
-   flood_queue_y[0] = (int16_t)y;
-   flood_queue_rd = 0;
-   flood_queue_wr = 1;
-   while (flood_queue_rd != flood_queue_wr) {
-
-      x = flood_queue_x[flood_queue_rd];
-      y = flood_queue_y[flood_queue_rd];
-      flood_queue_rd ++;
-      flood_queue_rd &= FLOOD_QUEUE_SIZE - 1;
-
-      if ((*test_pixel)(screen, x, y)) {
+   flood_row(screen, test, y, &r);
+   if (flood_boundary(&r, x)) {
+      return;
+   }
+   // Every pixel is filled at most once, unless the fill colour doesn't stop the
+   // fill (e.g. filling with the background colour); bound the work in that case
+   long limit = (long)(g_x_max - g_x_min + 1) * (g_y_max - g_y_min + 1);
+   // Fill the run containing the seed, then work outwards from it in both directions
+   int xl = x;
+   int xr = x;
+   while (xl > g_x_min && !flood_boundary(&r, xl - 1)) {
+      xl--;
+   }
+   while (xr < g_x_max && !flood_boundary(&r, xr + 1)) {
+      xr++;
+   }
+   fill_span(screen, xl, xr, y, fill);
+   limit -= xr - xl + 1;
+   int sp = 0;
+   int ok = flood_push(&sp, xl, xr, y + 1, 1) && flood_push(&sp, xl, xr, y - 1, -1);
+   while (ok && sp > 0 && limit > 0) {
+      sp--;
+      xl = flood_stack[sp].xl;
+      xr = flood_stack[sp].xr;
+      int dy = flood_stack[sp].dy;
+      y = flood_stack[sp].y;
+      if (y < g_y_min || y > g_y_max) {
          continue;
       }
-
-      int xl = x;
-      int xr = x;
-      while (xl > g_x_min && !(*test_pixel)(screen, xl - 1, y)) {
-         xl--;
-      }
-      while (xr < g_x_max && !(*test_pixel)(screen, xr + 1, y)) {
-         xr++;
-      }
-      for (x = xl; x <= xr; x++) {
-         set_pixel(screen, x, y, fill);
-         if (y > g_y_min && !(*test_pixel)(screen, x, y - 1)) {
-            flood_queue_x[flood_queue_wr] = (int16_t)x;
-            flood_queue_y[flood_queue_wr] = (int16_t)(y - 1);
-            flood_queue_wr ++;
-            flood_queue_wr &= FLOOD_QUEUE_SIZE - 1;
-#ifdef DEBUG_VDU
-            if (flood_queue_wr == flood_queue_rd) {
-               printf("queue wrapped\r\n");
-            }
-#endif
+      flood_row(screen, test, y, &r);
+      x = xl;
+      while (ok && x <= xr) {
+         // Skip to the next fillable pixel
+         while (x <= xr && flood_boundary(&r, x)) {
+            x++;
          }
-         if (y < g_y_max && !(*test_pixel)(screen, x, y + 1)) {
-            flood_queue_x[flood_queue_wr] = (int16_t)x;
-            flood_queue_y[flood_queue_wr] = (int16_t)(y + 1);
-            flood_queue_wr ++;
-            flood_queue_wr &= FLOOD_QUEUE_SIZE - 1;
-#ifdef DEBUG_VDU
-            if (flood_queue_wr == flood_queue_rd) {
-               printf("queue wrapped\r\n");
-            }
-#endif
+         if (x > xr) {
+            break;
+         }
+         // Find the extent of the run
+         int l = x;
+         while (l > g_x_min && !flood_boundary(&r, l - 1)) {
+            l--;
+         }
+         while (x < g_x_max && !flood_boundary(&r, x + 1)) {
+            x++;
+         }
+         fill_span(screen, l, x, y, fill);
+         limit -= x - l + 1;
+         // Continue in the same direction, and back where the run overhangs its parent
+         ok = flood_push(&sp, l, x, y + dy, dy);
+         if (ok && l < xl - 1) {
+            ok = flood_push(&sp, l, xl - 2, y - dy, -dy);
          }
+         if (ok && x > xr + 1) {
+            ok = flood_push(&sp, xr + 2, x, y - dy, -dy);
+         }
+         x += 2;
       }
 #ifdef DEBUG_VDU
-      int size = (FLOOD_QUEUE_SIZE + flood_queue_wr - flood_queue_rd) & (FLOOD_QUEUE_SIZE - 1);
-      if (size > maxq) {
-         maxq = size;
+      if (sp > maxsp) {
+         maxsp = sp;
       }
 #endif
    }
 #ifdef DEBUG_VDU
-   printf("Max queue size = %d\r\n", maxq);
+   printf("Max stack size = %d\r\n", maxsp);
 #endif
 }
 
-// Return false for pixels that are marked
-static int test_pixel_marker(screen_mode_t *screen, int x, int y) {
-   return !(get_pixel(screen, x, y) & marker);
-}
-
 static void prim_flood_fill_wrapper(screen_mode_t *screen, int x, int y, plotcol_t colour, fill_t mode) {
 
    // Are we in a low colour mode, with a spare bit in the frame buffer?
@@ -1083,36 +1246,36 @@ static void prim_flood_fill_wrapper(screen_mode_t *screen, int x, int y, plotcol
 
       // Pass 1: Fill the region with a marker
       if (mode == AF_TOFGD) {
-         // Use the BG colour to fill, because the test_pixel fn uses the FG colour
+         // Use the BG colour to fill, because the FT_FG test uses the FG colour
          pixel_t old_col = g_bg_col;
          plotmode_t old_plotmode = g_bg_plotmode;
          g_bg_col = marker;
          g_bg_plotmode = PM_XOR;
-         prim_flood_fill(screen, x, y, PC_BG, g_fg_plotmode < PM_ECF ? test_pixel_fg_col : test_pixel_fg_ecf);
+         prim_flood_fill(screen, x, y, PC_BG, FT_FG);
          g_bg_col = old_col;
          g_bg_plotmode = old_plotmode;
       } else {
-         // Use the FG colour to fill, because the test_pixel fn uses the BG colour
+         // Use the FG colour to fill, because the FT_NOT_BG test uses the BG colour
          pixel_t old_col = g_fg_col;
          plotmode_t old_plotmode = g_fg_plotmode;
          g_fg_col = marker;
          g_fg_plotmode = PM_XOR;
-         prim_flood_fill(screen, x, y, PC_FG, g_bg_plotmode < PM_ECF ? test_pixel_not_bg_col : test_pixel_not_bg_ecf);
+         prim_flood_fill(screen, x, y, PC_FG, FT_NOT_BG);
          g_fg_col = old_col;
          g_fg_plotmode = old_plotmode;
       }
 
       // Pass 2: Replace the marker with the required colour/pattern
-      prim_flood_fill(screen, x, y, colour, test_pixel_marker);
+      prim_flood_fill(screen, x, y, colour, FT_MARKER);
 
    } else {
 
       // No, then well do our best...
 
       if (mode == AF_TOFGD) {
-         prim_flood_fill(screen, x, y, colour, g_fg_plotmode < PM_ECF ? test_pixel_fg_col : test_pixel_fg_ecf);
+         prim_flood_fill(screen, x, y, colour, FT_FG);
       } else {
-         prim_flood_fill(screen, x, y, colour, g_bg_plotmode < PM_ECF ? test_pixel_not_bg_col : test_pixel_not_bg_ecf);
+         prim_flood_fill(screen, x, y, colour, FT_NOT_BG);
       }
    }
 }
@@ -1142,7 +1305,7 @@ void prim_fill_area(screen_mode_t *screen, int x, int y, plotcol_t colour, fill_
       while (get_pixel(screen, x_left - 1, y) == bg_col && x_left - 1 > g_x_min) {
          x_left--;
       }
-      draw_hline(screen, x_left, x_right, y, colour);
+      fill_span(screen, x_left, x_right, y, colour);
       break;
 
    case HL_RO_BG:
@@ -1152,7 +1315,7 @@ void prim_fill_area(screen_mode_t *screen, int x, int y, plotcol_t colour, fill_
       while (get_pixel(screen, x_right + 1, y) != bg_col && x_right + 1 < g_x_max) {
          x_right++;
       }
-      draw_hline(screen, x_left, x_right, y, colour);
+      fill_span(screen, x_left, x_right, y, colour);
       break;
 
    case HL_LR_FG:
@@ -1165,7 +1328,7 @@ void prim_fill_area(screen_mode_t *screen, int x, int y, plotcol_t colour, fill_
       while (get_pixel(screen, x_left - 1, y) != fg_col && x_left - 1 > g_x_min) {
          x_left--;
       }
-      draw_hline(screen, x_left, x_right, y, colour);
+      fill_span(screen, x_left, x_right, y, colour);
       break;
 
    case HL_RO_NF:
@@ -1175,7 +1338,7 @@ void prim_fill_area(screen_mode_t *screen, int x, int y, plotcol_t colour, fill_
       while (get_pixel(screen, x_right + 1, y) == fg_col && x_right + 1 < g_x_max) {
          x_right++;
       }
-      draw_hline(screen, x_left, x_right, y, colour);
+      fill_span(screen, x_left, x_right, y, colour);
       break;
 
    case AF_NONBG:
@@ -1223,7 +1386,7 @@ void prim_fill_triangle(screen_mode_t *screen, int x1, int y1, int x2, int y2, i
       fill_bottom_flat_triangle(screen, x1, y1, x2, y2, x4, y4, colour);
       fill_top_flat_triangle(screen, x2, y2, x4, y4, x3, y3, colour);
       // draw the overlapping line again, incase we are XOR plotting
-      draw_hline(screen, x2, x4, y4, colour);
+      fill_span(screen, x2, x4, y4, colour);
    }
 }
 
@@ -1348,21 +1511,7 @@ void prim_draw_arc(screen_mode_t *screen, int xc, int yc, int x1, int y1, int x2
 
 // Common to prim_fill_chord and prim_fill_sector
 static void prim_fill_interior(screen_mode_t *screen, int x, int y, plotcol_t colour) {
-   fill_test_fn test_pixel;
-   if (colour == PC_BG) {
-      if (g_bg_plotmode < PM_ECF) {
-         test_pixel = test_pixel_bg_col;
-      } else {
-         test_pixel = test_pixel_bg_ecf;
-      }
-   } else {
-      if (g_fg_plotmode < PM_ECF) {
-         test_pixel = test_pixel_fg_col;
-      } else {
-         test_pixel = test_pixel_fg_ecf;
-      }
-   }
-   prim_flood_fill(screen, arc_fill_x, arc_fill_y, colour, test_pixel);
+   prim_flood_fill(screen, arc_fill_x, arc_fill_y, colour, colour == PC_BG ? FT_BG : FT_FG);
 }
 
 void prim_fill_chord(screen_mode_t *screen, int xc, int yc, int x1, int y1, int x2, int y2, plotcol_t colour) {
@@ -1413,6 +1562,15 @@ void prim_move_copy_rectangle(screen_mode_t *screen, int x1, int y1, int x2, int
    int ox = x3 - x1;
    int oy = y3 - y1;
 
+   // The destination is drawn over
+   int dx1 = max(x3, g_x_min);
+   int dy1 = max(y3, g_y_min);
+   int dx2 = min(x3 + x2 - x1, g_x_max);
+   int dy2 = min(y3 + y2 - y1, g_y_max);
+   if (dx1 <= dx2 && dy1 <= dy2) {
+      mark_text_dirty(screen, dx1, dy1, dx2, dy2);
+   }
+
    // Copy/Move a pixel at a time (slow.......)
    int dy = ystart + oy;
    for (int sy = ystart; sy != yend; sy += ystep, dy += ystep) {
@@ -1444,7 +1602,7 @@ void prim_fill_rectangle(screen_mode_t *screen, int x1, int y1, int x2, int y2,
       y2 = tmp;
    }
    for (int y = y1; y <= y2; y++) {
-      draw_hline(screen, x1, x2, y, colour);
+      fill_span(screen, x1, x2, y, colour);
    }
 }
 
@@ -1640,6 +1798,15 @@ void prim_draw_sprite(screen_mode_t *screen, int n, int x, int y) {
    printf("drawing sprite %d at %d,%d\r\n", n, x, y);
 #endif
 
+   // The area the sprite is drawn over
+   int sx1 = max(x, g_x_min);
+   int sy1 = max(y, g_y_min);
+   int sx2 = min(x + sprite->width - 1, g_x_max);
+   int sy2 = min(y + sprite->height - 1, g_y_max);
+   if (sx1 <= sx2 && sy1 <= sy2) {
+      mark_text_dirty(screen, sx1, sy1, sx2, sy2);
+   }
+
    // Write the sprite, allowing clipping to take care of off-screen pixels
    if (screen->log2bpp == 4) {
       uint16_t data;
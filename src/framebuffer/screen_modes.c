@@ -1,4 +1,5 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "../startup.h"
@@ -896,6 +897,249 @@ static int is_full_screen(screen_mode_t *screen, rectangle_t *r) {
 static void null_handler() {
 }
 
+static inline uint8_t *fb_row(screen_mode_t *screen, int y) {
+   return fb + (screen->height - y - 1) * screen->pitch;
+}
+
+// The colour used to blank row y; the black lines in BBC Gap Modes are special cased
+static inline pixel_t blank_colour(screen_mode_t *screen, int y, pixel_t bg_col) {
+   return (screen->mode_flags & F_BBC_GAP) && (y % 10 < 2) ? BBC_GAP_COL : bg_col;
+}
+
+// Fill pixels x1..x2 of row y with a colour, a word at a time where possible
+static void fill_row(screen_mode_t *screen, int y, int x1, int x2, pixel_t col) {
+   uint8_t *ptr = fb_row(screen, y);
+   uint8_t *end = ptr + ((x2 + 1) << (screen->log2bpp - 3));
+   ptr += x1 << (screen->log2bpp - 3);
+   if (screen->log2bpp == 3) {
+      col = (col & 0xFF) * 0x01010101;
+   } else if (screen->log2bpp == 4) {
+      col = (col & 0xFFFF) * 0x00010001;
+   }
+   while (ptr < end && ((uintptr_t)ptr & 3)) {
+      if (screen->log2bpp == 3) {
+         *ptr = (uint8_t)col;
+         ptr += 1;
+      } else {
+         *(uint16_t *)ptr = (uint16_t)col;
+         ptr += 2;
+      }
+   }
+   uint32_t *wptr = (uint32_t *)ptr;
+   uint32_t *wend = (uint32_t *)((uintptr_t)end & ~(uintptr_t)3);
+   while (wptr < wend) {
+      *wptr++ = col;
+   }
+   ptr = (uint8_t *)wptr;
+   while (ptr < end) {
+      if (screen->log2bpp == 3) {
+         *ptr = (uint8_t)col;
+         ptr += 1;
+      } else {
+         *(uint16_t *)ptr = (uint16_t)col;
+         ptr += 2;
+      }
+   }
+}
+
+// ==========================================================================
+// Shadow text buffer
+// ==========================================================================
+
+// The character last written to each text cell, so default_read_character()
+// doesn't normally need to read the cell back from the frame buffer. Cells
+// are marked invalid when graphics are drawn over them, and then fall back to
+// matching the pixels against the font.
+
+typedef struct {
+   int16_t c;       // character code, or -1 for a blank cell
+   uint8_t valid;   // cleared when the cell has been drawn over
+   pixel_t bg_col;
+} text_cell_t;
+
+static struct {
+   // What the grid was built for; it is rebuilt if any of these change
+   screen_mode_t *screen;
+   font_t *font;
+   uint32_t generation;
+   int width;
+   int height;
+   int font_width;
+   int font_height;
+   int scale_w;
+   int scale_h;
+   // The grid itself
+   int cols;
+   int rows;
+   text_cell_t *cells;
+   size_t size;
+   // The column/row of each pixel, used when graphics are drawn
+   uint16_t *col_of_x;
+   uint16_t *row_of_y;
+} shadow;
+
+static int shadow_current(screen_mode_t *screen) {
+   font_t *font = screen->font;
+   return shadow.cells != NULL && shadow.screen == screen && shadow.font == font &&
+      shadow.generation == font->generation && shadow.width == screen->width && shadow.height == screen->height &&
+      shadow.font_width == font->get_overall_w(font) && shadow.font_height == font->get_overall_h(font) &&
+      shadow.scale_w == font->scale_w && shadow.scale_h == font->scale_h;
+}
+
+static void shadow_free(void) {
+   free(shadow.cells);
+   free(shadow.col_of_x);
+   free(shadow.row_of_y);
+   shadow.cells = NULL;
+   shadow.size = 0;
+   shadow.col_of_x = NULL;
+   shadow.row_of_y = NULL;
+}
+
+static void shadow_reset(screen_mode_t *screen) {
+   font_t *font = screen->font;
+   shadow.screen      = screen;
+   shadow.font        = font;
+   shadow.generation  = font->generation;
+   shadow.width       = screen->width;
+   shadow.height      = screen->height;
+   shadow.font_width  = font->get_overall_w(font);
+   shadow.font_height = font->get_overall_h(font);
+   shadow.scale_w     = font->scale_w;
+   shadow.scale_h     = font->scale_h;
+   shadow.cols = screen->width / shadow.font_width;
+   shadow.rows = screen->height / shadow.font_height;
+   if (shadow.cols == 0 || shadow.rows == 0) {
+      // A large font scale can leave no whole cells on the screen
+      shadow_free();
+      return;
+   }
+   size_t size = (size_t)(shadow.cols * shadow.rows) * sizeof(text_cell_t);
+   if (size > shadow.size) {
+      free(shadow.cells);
+      shadow.cells = malloc(size);
+      shadow.size = shadow.cells ? size : 0;
+   }
+   free(shadow.col_of_x);
+   free(shadow.row_of_y);
+   shadow.col_of_x = malloc((size_t)screen->width * sizeof(uint16_t));
+   shadow.row_of_y = malloc((size_t)screen->height * sizeof(uint16_t));
+   if (shadow.cells == NULL || shadow.col_of_x == NULL || shadow.row_of_y == NULL) {
+      // Without the shadow, characters are always read from the screen
+      shadow_free();
+      return;
+   }
+   memset(shadow.cells, 0, size);
+   // Pixels in a partial column or row are clamped to the last whole one
+   for (int x = 0; x < screen->width; x++) {
+      int col = x / shadow.font_width;
+      shadow.col_of_x[x] = (uint16_t)(col < shadow.cols ? col : shadow.cols - 1);
+   }
+   for (int y = 0; y < screen->height; y++) {
+      int row = (screen->height - 1 - y) / shadow.font_height;
+      shadow.row_of_y[y] = (uint16_t)(row < shadow.rows ? row : shadow.rows - 1);
+   }
+}
+
+static inline text_cell_t *shadow_cell(int col, int row) {
+   return shadow.cells + row * shadow.cols + col;
+}
+
+// The cell can only be read back from the shadow if the pixels read back
+// exactly; this fails if the colours have bits beyond the screen depth
+static inline void shadow_set(screen_mode_t *screen, int col, int row, int c, pixel_t fg_col, pixel_t bg_col) {
+   text_cell_t *cell = shadow_cell(col, row);
+   pixel_t mask = (screen->log2bpp == 5) ? 0xFFFFFFFF : (1u << (1 << screen->log2bpp)) - 1;
+   if ((fg_col & mask) == bg_col) {
+      // The character is invisible
+      c = -1;
+   }
+   cell->c = (int16_t)c;
+   cell->valid = (bg_col & mask) == bg_col;
+   cell->bg_col = bg_col;
+}
+
+// Blank (or invalidate, if bg_col is NULL) a rectangle of cells
+// A blanked row only reads back as spaces if none of its glyph rows were
+// painted in the BBC gap colour
+static int shadow_row_blank(screen_mode_t *screen, int row, pixel_t bg_col) {
+   font_t *font = screen->font;
+   int y = screen->height - row * shadow.font_height - 1;
+   int h = (font->height << font->rounding) * font->scale_h;
+   for (int i = 0; i < h; i++) {
+      if (blank_colour(screen, y - i, bg_col) != bg_col) {
+         return 0;
+      }
+   }
+   return 1;
+}
+
+static void shadow_fill(screen_mode_t *screen, int left, int top, int right, int bottom, pixel_t *bg_col) {
+   if (shadow.cells == NULL) {
+      return;
+   }
+   for (int row = top; row <= bottom; row++) {
+      int blank = bg_col && shadow_row_blank(screen, row, *bg_col);
+      for (int col = left; col <= right; col++) {
+         if (blank) {
+            shadow_set(screen, col, row, -1, *bg_col, *bg_col);
+         } else {
+            shadow_cell(col, row)->valid = 0;
+         }
+      }
+   }
+}
+
+static void shadow_scroll(screen_mode_t *screen, t_clip_window_t *text_window, pixel_t bg_col, scroll_dir_t dir) {
+   if (!shadow_current(screen)) {
+      return;
+   }
+   int left, top, right, bottom;
+   if (text_window == NULL) {
+      // The pixels don't move a whole number of cells if there's a partial row or column
+      if (shadow.cols * shadow.font_width != screen->width || shadow.rows * shadow.font_height != screen->height) {
+         shadow_fill(screen, 0, 0, shadow.cols - 1, shadow.rows - 1, NULL);
+         return;
+      }
+      left = 0;
+      top = 0;
+      right = shadow.cols - 1;
+      bottom = shadow.rows - 1;
+   } else {
+      left = text_window->left;
+      top = text_window->top;
+      right = text_window->right;
+      bottom = text_window->bottom;
+   }
+   size_t len = (size_t)(right - left + 1) * sizeof(text_cell_t);
+   switch (dir) {
+   case SCROLL_UP:
+      for (int row = top; row < bottom; row++) {
+         memcpy(shadow_cell(left, row), shadow_cell(left, row + 1), len);
+      }
+      shadow_fill(screen, left, bottom, right, bottom, &bg_col);
+      break;
+   case SCROLL_DOWN:
+      for (int row = bottom; row > top; row--) {
+         memcpy(shadow_cell(left, row), shadow_cell(left, row - 1), len);
+      }
+      shadow_fill(screen, left, top, right, top, &bg_col);
+      break;
+   case SCROLL_LEFT:
+      for (int row = top; row <= bottom; row++) {
+         memmove(shadow_cell(left, row), shadow_cell(left + 1, row), len - sizeof(text_cell_t));
+      }
+      shadow_fill(screen, right, top, right, bottom, &bg_col);
+      break;
+   case SCROLL_RIGHT:
+      for (int row = top; row <= bottom; row++) {
+         memmove(shadow_cell(left + 1, row), shadow_cell(left, row), len - sizeof(text_cell_t));
+      }
+      shadow_fill(screen, left, top, left, bottom, &bg_col);
+      break;
+   }
+}
+
 // ==========================================================================
 // Default handlers
 // ==========================================================================
@@ -1032,10 +1276,17 @@ void default_clear_screen(screen_mode_t *screen, t_clip_window_t *text_window, p
    to_rectangle(screen, text_window, &r);
    // Clear to the background colour
    for (int y = r.y1; y <= r.y2; y++) {
-      // Special case the black lines in BBC Gap Modes
-      pixel_t col = (screen->mode_flags & F_BBC_GAP) && (y % 10 < 2) ? BBC_GAP_COL : bg_col;
-      for (int x = r.x1; x <= r.x2; x++) {
-         screen->set_pixel(screen, x, y, col);
+      fill_row(screen, y, r.x1, r.x2, blank_colour(screen, y, bg_col));
+   }
+   // Blank the shadow text buffer to match
+   if (!shadow_current(screen)) {
+      shadow_reset(screen);
+   }
+   if (shadow.cells) {
+      if (text_window == NULL) {
+         shadow_fill(screen, 0, 0, shadow.cols - 1, shadow.rows - 1, &bg_col);
+      } else {
+         shadow_fill(screen, text_window->left, text_window->top, text_window->right, text_window->bottom, &bg_col);
       }
    }
 }
@@ -1043,56 +1294,58 @@ void default_clear_screen(screen_mode_t *screen, t_clip_window_t *text_window, p
 void default_scroll_screen(screen_mode_t *screen, t_clip_window_t *text_window, pixel_t bg_col, scroll_dir_t dir) {
    rectangle_t r;
    font_t *font = screen->font;
+   int font_width = font->get_overall_w(font);
    int font_height = font->get_overall_h(font);
-   int blank;
+   // Scroll the shadow text buffer to match
+   shadow_scroll(screen, text_window, bg_col, dir);
    // Convert text window to screen graphics coordinates (0,0 = bottom left)
    to_rectangle(screen, text_window, &r);
-   if (dir == SCROLL_UP && is_full_screen(screen, &r)) {
-      // Scroll the screen upwards one row, and clear the bottom text line to the background colour
-      if (screen->log2bpp == 3) {
-         bg_col = bg_col | (bg_col << 8) | (bg_col << 16) | (bg_col << 24);
-      } else if (screen->log2bpp == 4) {
-         bg_col = bg_col | (bg_col << 16);
-      }
-      _fast_scroll(fb, fb + font_height * screen->pitch, (screen->height - font_height) * screen->pitch);
-      // Now blank the bottom line
-      blank = r.y1;
-   } else {
-      switch (dir) {
-      case SCROLL_UP:
+   int shift = screen->log2bpp - 3;
+   size_t len = (size_t)((r.x2 - r.x1 + 1) << shift);
+   switch (dir) {
+   case SCROLL_UP:
+      if (is_full_screen(screen, &r)) {
+         // Scroll the screen upwards one row
+         _fast_scroll(fb, fb + font_height * screen->pitch, (screen->height - font_height) * screen->pitch);
+      } else {
          // Scroll from upwards, working top to bottom
          for (int y = r.y2 ; y >= r.y1 + font_height; y--) {
-            int z = y - font_height;
-            for (int x = r.x1; x <= r.x2; x++) {
-               screen->set_pixel(screen, x, y, screen->get_pixel(screen, x, z));
-            }
-         }
-         // Now blank the bottom line
-         blank = r.y1;
-         break;
-      case SCROLL_DOWN:
-         // Scroll downwards, working bottom to top
-         for (int y = r.y1 ; y <= r.y2 - font_height; y++) {
-            int z = y + font_height;
-            for (int x = r.x1; x <= r.x2; x++) {
-               screen->set_pixel(screen, x, y, screen->get_pixel(screen, x, z));
-            }
+            memcpy(fb_row(screen, y) + (r.x1 << shift), fb_row(screen, y - font_height) + (r.x1 << shift), len);
          }
-         // Now blank the top line
-         blank = r.y2 - (font_height - 1);
-         break;
-      default:
-         // TODO - Left and Right not implemented
-         return;
       }
-   }
-   // Blank the top/bottom line
-   for (int y = blank; y <  blank + font_height; y++) {
-      // Special case the black lines in BBC Gap Modes
-      pixel_t col = (screen->mode_flags & F_BBC_GAP) && (y % 10 < 2) ? BBC_GAP_COL : bg_col;
-      for (int x = r.x1; x <= r.x2; x++) {
-         screen->set_pixel(screen, x, y, col);
+      // Now blank the bottom line
+      for (int y = r.y1; y < r.y1 + font_height; y++) {
+         fill_row(screen, y, r.x1, r.x2, blank_colour(screen, y, bg_col));
       }
+      break;
+   case SCROLL_DOWN:
+      // Scroll downwards, working bottom to top
+      for (int y = r.y1 ; y <= r.y2 - font_height; y++) {
+         memcpy(fb_row(screen, y) + (r.x1 << shift), fb_row(screen, y + font_height) + (r.x1 << shift), len);
+      }
+      // Now blank the top line
+      for (int y = r.y2 - (font_height - 1); y <= r.y2; y++) {
+         fill_row(screen, y, r.x1, r.x2, blank_colour(screen, y, bg_col));
+      }
+      break;
+   case SCROLL_LEFT:
+      // Scroll left one character, and blank the right column
+      len -= (size_t)(font_width << shift);
+      for (int y = r.y1; y <= r.y2; y++) {
+         uint8_t *row = fb_row(screen, y);
+         memmove(row + (r.x1 << shift), row + ((r.x1 + font_width) << shift), len);
+         fill_row(screen, y, r.x2 - (font_width - 1), r.x2, blank_colour(screen, y, bg_col));
+      }
+      break;
+   case SCROLL_RIGHT:
+      // Scroll right one character, and blank the left column
+      len -= (size_t)(font_width << shift);
+      for (int y = r.y1; y <= r.y2; y++) {
+         uint8_t *row = fb_row(screen, y);
+         memmove(row + ((r.x1 + font_width) << shift), row + (r.x1 << shift), len);
+         fill_row(screen, y, r.x1, r.x1 + (font_width - 1), blank_colour(screen, y, bg_col));
+      }
+      break;
    }
 }
 
@@ -1212,10 +1465,24 @@ void default_write_character(screen_mode_t *screen, int c, int col, int row, pix
    int y = screen->height - row * font->get_overall_h(font) - 1;
    // Pass down to font to do the drawing
    font->write_char(font, screen, c, x, y, fg_col, bg_col);
+   // Remember the character for default_read_character()
+   if (!shadow_current(screen)) {
+      shadow_reset(screen);
+   }
+   if (shadow.cells && col < shadow.cols && row < shadow.rows) {
+      shadow_set(screen, col, row, c, fg_col, bg_col);
+   }
 }
 
 int default_read_character(screen_mode_t *screen, int col, int row, pixel_t bg_col) {
    font_t *font = screen->font;
+   // Use the shadow text buffer, unless graphics have been drawn over the cell
+   if (shadow_current(screen) && col < shadow.cols && row < shadow.rows) {
+      text_cell_t *cell = shadow_cell(col, row);
+      if (cell->valid && cell->bg_col == bg_col) {
+         return font_read_back(font, cell->c);
+      }
+   }
    // Convert Row/Col to screen coordinates
    int x = col * font->get_overall_w(font);
    int y = screen->height - row * font->get_overall_h(font) - 1;
@@ -1319,6 +1586,16 @@ screen_mode_t *get_screen_mode(int mode_num) {
    return sm;
 }
 
+// Called when graphics are drawn over the rectangle x1,y1 - x2,y2 (0,0 = bottom
+// left), which must be on the screen. This only uses the shadow's own idea of
+// the screen, as it's called for every pixel plotted.
+void mark_text_dirty(screen_mode_t *screen, int x1, int y1, int x2, int y2) {
+   if (shadow.cells == NULL || shadow.screen != screen || x2 >= shadow.width || y2 >= shadow.height) {
+      return;
+   }
+   shadow_fill(screen, shadow.col_of_x[x1], shadow.row_of_y[y2], shadow.col_of_x[x2], shadow.row_of_y[y1], NULL);
+}
+
 uint32_t get_fb_address() {
    return (uint32_t) fb;
 }
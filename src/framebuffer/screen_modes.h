@@ -149,6 +149,8 @@ screen_mode_t *get_screen_mode(int mode_num);
 
 uint32_t get_fb_address();
 
+void mark_text_dirty(screen_mode_t *screen, int x1, int y1, int x2, int y2);
+
 int32_t fb_read_mode_variable(mode_variable_t v, screen_mode_t *screen);
 
 #endif
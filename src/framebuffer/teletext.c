@@ -295,8 +295,21 @@ static void tt_scroll(screen_mode_t *screen, t_clip_window_t *text_window, pixel
          tt.mode7screen[text_window->top][col] = TT_SPACE;
       }
       break;
-   default:
-      // TODO - Left and Right not implemented
+   case SCROLL_LEFT:
+      for (int row = text_window->top; row <= text_window->bottom; row++) {
+         for (int col = text_window->left; col < text_window->right; col++) {
+            tt.mode7screen[row][col] = tt.mode7screen[row][col + 1];
+         }
+         tt.mode7screen[row][text_window->right] = TT_SPACE;
+      }
+      break;
+   case SCROLL_RIGHT:
+      for (int row = text_window->top; row <= text_window->bottom; row++) {
+         for (int col = text_window->right; col > text_window->left; col--) {
+            tt.mode7screen[row][col] = tt.mode7screen[row][col - 1];
+         }
+         tt.mode7screen[row][text_window->left] = TT_SPACE;
+      }
       break;
    }
    // Recalculate the double height counts
@@ -30,6 +30,7 @@
 
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wpedantic"
+
 #define notick
 
 #include <stdio.h>
@@ -37,14 +38,13 @@
 #include <string.h>
 
 #include "lib6502.h"
+#include "tube.h"
 static void   M6502_dump(M6502 *mpu, char buffer[124]);
 
 #ifdef INCLUDE_DEBUGGER
 #include "lib6502_debug.h"
 #endif
 
-extern volatile int tube_irq;
-
 typedef uint8_t  byte;
 typedef uint16_t word;
 typedef uint32_t dword;
@@ -83,6 +83,10 @@ static int elapsed;
 #define tick(n)    elapsed+=n
 #define tickIf(p)  elapsed +=(p)?1:0
 #endif
+
+/* the most instructions M6502_run() executes between interrupt polls */
+
+#define M6502_POLL_BUDGET 64
 /* memory access (indirect if callback installed) -- ARGUMENTS ARE EVALUATED MORE THAN ONCE! */
 
 #ifdef USE_MEMORY_POINTER
@@ -91,6 +95,12 @@ static int elapsed;
 #define MEM(addr) *(unsigned char *)(( int)addr )
 #endif
 
+/* callback lookup: a byte per page, and only pages with callbacks go further */
+
+#define readCallback(ADDR)   (readPages[(ADDR) >> M6502_PAGE_SHIFT] ? M6502_lookupCallback(mpu->callbacks->read, ADDR) : 0)
+#define writeCallback(ADDR)  (writePages[(ADDR) >> M6502_PAGE_SHIFT] ? M6502_lookupCallback(mpu->callbacks->write, ADDR) : 0)
+#define callCallback(ADDR)   M6502_getCallback(mpu, call, ADDR)
+
 #define getword(addr)   ((uint16_t)((MEM(addr) + (MEM((addr + 1)    ) << 8))))
 #define getwordzp(addr) ((uint16_t)((MEM(addr) + (MEM((addr + 1) &0xff) << 8))))
 
@@ -99,27 +109,27 @@ static int elapsed;
 static byte tmpr;
 
 #define putMemory(ADDR, BYTE)                   \
-  if (lib6502_debug_enabled) {                  \
+  if (debugging()) {                            \
     externalise();                              \
     debug_memwrite(&lib6502_cpu_debug, ADDR, BYTE, 1); \
     internalise();                              \
   }                                             \
-  ( writeCallback[ADDR]				\
-      ? writeCallback[ADDR](mpu, ADDR, BYTE)	\
+  ( writeCallback(ADDR)				\
+      ? (pollsoon(), writeCallback(ADDR)(mpu, ADDR, BYTE))	\
       : (MEM(ADDR)= BYTE) )
 
 #define getMemory(ADDR)				\
-  tmpr = (byte)( readCallback[ADDR]			\
-    ?  readCallback[ADDR](mpu, ADDR, 0)	        \
+  tmpr = (byte)( readCallback(ADDR)			\
+    ?  (pollsoon(), readCallback(ADDR)(mpu, ADDR, 0))	\
     :  MEM(ADDR) ) ;				\
-  if (lib6502_debug_enabled) {                  \
+  if (debugging()) {                            \
     externalise();                              \
     debug_memread(&lib6502_cpu_debug, ADDR, tmpr, 1);  \
     internalise();                              \
   }
 
 #define trap(ADDR, n)                           \
-  if (lib6502_debug_enabled) {                  \
+  if (debugging()) {                            \
     externalise();                              \
     debug_trap(&lib6502_cpu_debug, ADDR, n);    \
     internalise();                              \
@@ -129,13 +139,13 @@ static byte tmpr;
 
 
 #define putMemory(ADDR, BYTE)			\
-  ( writeCallback[ADDR]				\
-      ? writeCallback[ADDR](mpu, ADDR, BYTE)	\
+  ( writeCallback(ADDR)				\
+      ? (pollsoon(), writeCallback(ADDR)(mpu, ADDR, BYTE))	\
       : (MEM(ADDR)= BYTE) )
 
 #define getMemory(ADDR)				\
-  ((uint8_t)( readCallback[ADDR]				\
-      ?  readCallback[ADDR](mpu, ADDR, 0)	\
+  ((uint8_t)( readCallback(ADDR)				\
+      ?  (pollsoon(), readCallback(ADDR)(mpu, ADDR, 0))	\
       :  MEM(ADDR) ))
 
 
@@ -649,6 +659,7 @@ static byte tmpr;
       adrmode(ticks);				\
       PC += (word)ea;					\
       tick(1);					\
+      checkints();				\
     }						\
   else						\
     {						\
@@ -672,6 +683,7 @@ static byte tmpr;
   PC += (word)ea;					\
   fetch();					\
   tick(1);					\
+  checkints();					\
   next();
 
 #define bbr0(ticks, adrmode)	branch(ticks, adrmode, !(MEM(MEM(PC++)) & (1<<0)))
@@ -695,17 +707,18 @@ static byte tmpr;
 #define jmp(ticks, adrmode)				\
   adrmode(ticks);					\
   PC= (word)ea;						\
-  if (mpu->callbacks->call[ea])				\
+  if (callCallback(ea))				\
     {							\
       word addr;					\
       externalise();					\
-      if ((addr= (word)mpu->callbacks->call[ea](mpu, ea, 0)))	\
+      if ((addr= (word)callCallback(ea)(mpu, ea, 0)))	\
 	{						\
 	  internalise();				\
 	  PC= addr;					\
 	}						\
     }							\
   fetch();						\
+  checkints();						\
   next();
 
 #define jsr(ticks, adrmode)				\
@@ -714,20 +727,22 @@ static byte tmpr;
   push((byte) PC );					\
   PC--;							\
   adrmode(ticks);					\
-  if (mpu->callbacks->call[ea])				\
+  if (callCallback(ea))				\
     {							\
       word addr;					\
       externalise();					\
-      if ((addr= (word)mpu->callbacks->call[ea](mpu, ea, 0)))	\
+      if ((addr= (word)callCallback(ea)(mpu, ea, 0)))	\
 	{						\
 	  internalise();				\
 	  PC= addr;					\
 	  fetch();					\
+	  checkints();					\
 	  next();					\
 	}						\
     }							\
   PC=(word)ea;						\
   fetch();						\
+  checkints();						\
   next();
 
 #define rts(ticks, adrmode)			\
@@ -736,6 +751,7 @@ static byte tmpr;
   PC |= (word) ((pop() << 8));				\
   PC++;						\
   fetch();					\
+  checkints();					\
   next();
 
 #define brk(ticks, adrmode)					\
@@ -751,11 +767,11 @@ static byte tmpr;
     byte blo = getMemory(0xfffe);                               \
     byte bhi = getMemory(0xffff);                               \
     word hdlr= (word)(blo + (bhi << 8));                                \
-    if (mpu->callbacks->call[hdlr])				\
+    if (callCallback(hdlr))				\
       {								\
 	word addr;						\
 	externalise();						\
-	if ((addr= (word)mpu->callbacks->call[hdlr](mpu, PC - 2, 0)))	\
+	if ((addr= (word)callCallback(hdlr)(mpu, PC - 2, 0)))	\
 	  {							\
 	    internalise();					\
 	    hdlr= addr;						\
@@ -764,6 +780,7 @@ static byte tmpr;
     PC= hdlr;							\
   }								\
   fetch();							\
+  checkints();							\
   next();
 
 #define rti(ticks, adrmode)			\
@@ -772,6 +789,7 @@ static byte tmpr;
   PC=    pop();					\
   PC |= (word)((pop() << 8));				\
   fetch();					\
+  checkints();					\
   next();
 
 #define nop(ticks, adrmode)			\
@@ -962,6 +980,14 @@ void M6502_trace(M6502 *mpu)
   previousPC = mpu->registers->pc;
 }
 
+/* Without an interrupt poll in every next(), GCC's SLP vectoriser packs A,
+ * X, Y and P of the run loop into one register. That has to be unpacked
+ * where all the computed gotos meet, which stops GCC copying the dispatch
+ * into each instruction; the Dormann tests then take 1.5 to 2.5 times as
+ * long. The rest of the file doesn't need this, so it's only applied here. */
+#if defined(__GNUC__) && !defined(__clang__)
+__attribute__((optimize("no-tree-slp-vectorize")))
+#endif
 void M6502_run(M6502 *mpu, M6502_PollInterruptsCallback poll)
 //void M6502_run(M6502 *mpu)
 {
@@ -984,24 +1010,59 @@ void M6502_run(M6502 *mpu, M6502_PollInterruptsCallback poll)
 			    &&_e0, &&_e1, &&_e2, &&_e3, &&_e4, &&_e5, &&_e6, &&_e7, &&_e8, &&_e9, &&_ea, &&_eb, &&_ec, &&_ed, &&_ee, &&_ef,
 			    &&_f0, &&_f1, &&_f2, &&_f3, &&_f4, &&_f5, &&_f6, &&_f7, &&_f8, &&_f9, &&_fa, &&_fb, &&_fc, &&_fd, &&_fe, &&_ff };
 
-  register void **itabp= &itab[0];
+  /* Interrupts are polled for at taken branches, jumps, calls and
+   * returns, and before the instruction after a callback (e.g. a Tube
+   * register access). Otherwise a poll is put off for no more than
+   * M6502_POLL_BUDGET instructions.
+   *
+   * The instructions are expanded twice: into itab without the debugger
+   * hooks, and (in INCLUDE_DEBUGGER builds) into dtab with them, where
+   * every instruction goes through _debug. A poll switches to dtab when
+   * the debugger is enabled, and _debug switches back when it isn't, so
+   * the normal dispatch pays nothing for the debugger. */
+
+#ifdef INCLUDE_DEBUGGER
+  static void *dtab[256]= { &&_d00, &&_d01, &&_d02, &&_d03, &&_d04, &&_d05, &&_d06, &&_d07, &&_d08, &&_d09, &&_d0a, &&_d0b, &&_d0c, &&_d0d, &&_d0e, &&_d0f,
+			    &&_d10, &&_d11, &&_d12, &&_d13, &&_d14, &&_d15, &&_d16, &&_d17, &&_d18, &&_d19, &&_d1a, &&_d1b, &&_d1c, &&_d1d, &&_d1e, &&_d1f,
+			    &&_d20, &&_d21, &&_d22, &&_d23, &&_d24, &&_d25, &&_d26, &&_d27, &&_d28, &&_d29, &&_d2a, &&_d2b, &&_d2c, &&_d2d, &&_d2e, &&_d2f,
+			    &&_d30, &&_d31, &&_d32, &&_d33, &&_d34, &&_d35, &&_d36, &&_d37, &&_d38, &&_d39, &&_d3a, &&_d3b, &&_d3c, &&_d3d, &&_d3e, &&_d3f,
+			    &&_d40, &&_d41, &&_d42, &&_d43, &&_d44, &&_d45, &&_d46, &&_d47, &&_d48, &&_d49, &&_d4a, &&_d4b, &&_d4c, &&_d4d, &&_d4e, &&_d4f,
+			    &&_d50, &&_d51, &&_d52, &&_d53, &&_d54, &&_d55, &&_d56, &&_d57, &&_d58, &&_d59, &&_d5a, &&_d5b, &&_d5c, &&_d5d, &&_d5e, &&_d5f,
+			    &&_d60, &&_d61, &&_d62, &&_d63, &&_d64, &&_d65, &&_d66, &&_d67, &&_d68, &&_d69, &&_d6a, &&_d6b, &&_d6c, &&_d6d, &&_d6e, &&_d6f,
+			    &&_d70, &&_d71, &&_d72, &&_d73, &&_d74, &&_d75, &&_d76, &&_d77, &&_d78, &&_d79, &&_d7a, &&_d7b, &&_d7c, &&_d7d, &&_d7e, &&_d7f,
+			    &&_d80, &&_d81, &&_d82, &&_d83, &&_d84, &&_d85, &&_d86, &&_d87, &&_d88, &&_d89, &&_d8a, &&_d8b, &&_d8c, &&_d8d, &&_d8e, &&_d8f,
+			    &&_d90, &&_d91, &&_d92, &&_d93, &&_d94, &&_d95, &&_d96, &&_d97, &&_d98, &&_d99, &&_d9a, &&_d9b, &&_d9c, &&_d9d, &&_d9e, &&_d9f,
+			    &&_da0, &&_da1, &&_da2, &&_da3, &&_da4, &&_da5, &&_da6, &&_da7, &&_da8, &&_da9, &&_daa, &&_dab, &&_dac, &&_dad, &&_dae, &&_daf,
+			    &&_db0, &&_db1, &&_db2, &&_db3, &&_db4, &&_db5, &&_db6, &&_db7, &&_db8, &&_db9, &&_dba, &&_dbb, &&_dbc, &&_dbd, &&_dbe, &&_dbf,
+			    &&_dc0, &&_dc1, &&_dc2, &&_dc3, &&_dc4, &&_dc5, &&_dc6, &&_dc7, &&_dc8, &&_dc9, &&_dca, &&_dcb, &&_dcc, &&_dcd, &&_dce, &&_dcf,
+			    &&_dd0, &&_dd1, &&_dd2, &&_dd3, &&_dd4, &&_dd5, &&_dd6, &&_dd7, &&_dd8, &&_dd9, &&_dda, &&_ddb, &&_ddc, &&_ddd, &&_dde, &&_ddf,
+			    &&_de0, &&_de1, &&_de2, &&_de3, &&_de4, &&_de5, &&_de6, &&_de7, &&_de8, &&_de9, &&_dea, &&_deb, &&_dec, &&_ded, &&_dee, &&_def,
+			    &&_df0, &&_df1, &&_df2, &&_df3, &&_df4, &&_df5, &&_df6, &&_df7, &&_df8, &&_df9, &&_dfa, &&_dfb, &&_dfc, &&_dfd, &&_dfe, &&_dff };
+#endif
   register void  *tpc;
+  register int    budget= M6502_POLL_BUDGET;
 
 #ifdef INCLUDE_DEBUGGER
-# define debug() 	   if (lib6502_debug_enabled) { lib6502_last_PC = PC; externalise(); debug_preexec(&lib6502_cpu_debug, PC); internalise(); }
+# define checkdebug()      if (lib6502_debug_enabled) goto _debug
 #else
-# define debug()
+# define checkdebug()
 #endif
 
 # define pollints()        if (tube_irq & 7) { externalise(); if (poll(mpu)) return; internalise(); }
-# define begin()				fetch();  next()
+# define debugging()       0
+# define checkints()       budget= M6502_POLL_BUDGET; pollints(); checkdebug()
+# define pollsoon()        (budget= 1)
+# define begin()				checkdebug(); fetch();  next()
 # define fetch()
-# define next()            debug(); pollints(); tpc= itabp[MEM(PC++)]; goto *tpc
+# define next()            tubeTick(); if (!--budget) goto _poll; tpc= itab[MEM(PC++)]; goto *tpc
 # define dispatch(num, name, mode, cycles)	_##num: name(cycles, mode) //oops();  next()
 # define end()
 
 #else /* (!__GNUC__) || (__STRICT_ANSI__) */
 
+# define debugging()       lib6502_debug_enabled
+# define checkints()
+# define pollsoon()        ((void)0)
 # define begin()				for (;;) switch (MEM(PC++)) {
 # define fetch()
 # define next()
@@ -1020,8 +1081,8 @@ void M6502_run(M6502 *mpu, M6502_PollInterruptsCallback poll)
   word		  ea;
 #endif
   byte		  A, X, Y, P, S;
-  M6502_Callback *readCallback=  mpu->callbacks->read;
-  M6502_Callback *writeCallback= mpu->callbacks->write;
+  const uint8_t  *readPages=  mpu->callbacks->read.page;
+  const uint8_t  *writePages= mpu->callbacks->write.page;
 
 # define internalise()	A= mpu->registers->a;  X= mpu->registers->x;  Y= mpu->registers->y;  P= mpu->registers->p;  S= mpu->registers->s;  PC= mpu->registers->pc
 # define externalise()	mpu->registers->a= A;  mpu->registers->x= X;  mpu->registers->y= Y;  mpu->registers->p= P;  mpu->registers->s= S;  mpu->registers->pc= PC
@@ -1032,6 +1093,41 @@ void M6502_run(M6502 *mpu, M6502_PollInterruptsCallback poll)
   do_insns(dispatch);
   end();
 
+#if defined(__GNUC__) && !defined(__STRICT_ANSI__)
+ _poll:
+  checkints();
+  tpc= itab[MEM(PC++)];
+  goto *tpc;
+
+#ifdef INCLUDE_DEBUGGER
+# undef debugging
+# undef checkints
+# undef pollsoon
+# undef next
+# undef dispatch
+# define debugging()       1
+# define checkints()
+# define pollsoon()        ((void)0)
+# define next()            goto _debug
+# define dispatch(num, name, mode, cycles)	_d##num: name(cycles, mode)
+
+  do_insns(dispatch);
+
+ _debug:
+  tubeTick();
+  if (!lib6502_debug_enabled)
+    {
+      budget= M6502_POLL_BUDGET;
+      tpc= itab[MEM(PC++)];
+      goto *tpc;
+    }
+  lib6502_last_PC = PC; externalise(); debug_preexec(&lib6502_cpu_debug, PC); internalise();
+  pollints();
+  tpc= dtab[MEM(PC++)];
+  goto *tpc;
+#endif
+#endif
+
 # undef begin
 # undef internalise
 # undef externalise
@@ -1039,6 +1135,11 @@ void M6502_run(M6502 *mpu, M6502_PollInterruptsCallback poll)
 # undef next
 # undef dispatch
 # undef end
+# undef checkints
+# undef checkdebug
+# undef pollints
+# undef pollsoon
+# undef debugging
 
  // (void)oops;
 }
@@ -1131,6 +1232,25 @@ M6502 *M6502_new(M6502_Registers *registers, M6502_Memory memory, M6502_Callback
 }
 
 
+int M6502_setPageCallback(M6502_CallbackTable *table, addr_t addr, M6502_Callback fn)
+{
+  unsigned int page= addr >> M6502_PAGE_SHIFT;
+  if (!table->page[page])
+    {
+      if (!fn) return 0;
+      if (table->used == M6502_CALLBACK_PAGES)
+	{
+	  fflush(stdout);
+	  fprintf(stderr, "\ntoo many callback pages\n");
+	  return -1;
+	}
+      table->page[page]= ++table->used;
+    }
+  table->callbacks[table->page[page] - 1][addr & (M6502_PAGE_SIZE - 1)]= fn;
+  return 0;
+}
+
+
 void M6502_delete(M6502 *mpu)
 {
   if (mpu->flags & M6502_CallbacksAllocated) free(mpu->callbacks);
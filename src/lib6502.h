@@ -21,13 +21,29 @@ typedef uint16_t addr_t;
 typedef int   (*M6502_Callback)(M6502 *mpu, addr_t address, uint8_t data);
 
 #ifdef TURBO
-typedef M6502_Callback  M6502_CallbackTable[0x40000];
 typedef uint8_t         M6502_Memory[0x40000];
 #else
-typedef M6502_Callback  M6502_CallbackTable[0x10000];
 typedef uint8_t         M6502_Memory[0x10000];
 #endif
 
+// Callbacks are found in two steps. Each 256 byte page has a byte that is
+// zero unless some address in the page has a callback, in which case it is
+// one more than the index of that page's table of per-address callbacks.
+// Only a few pages (the Tube registers) ever have callbacks, so this keeps
+// the tables small and the common case to a single byte lookup.
+
+#define M6502_PAGE_SHIFT     8
+#define M6502_PAGE_SIZE      (1 << M6502_PAGE_SHIFT)
+#define M6502_NUM_PAGES      (sizeof(M6502_Memory) >> M6502_PAGE_SHIFT)
+#define M6502_CALLBACK_PAGES 4
+
+typedef struct
+{
+  uint8_t         page[M6502_NUM_PAGES];
+  M6502_Callback  callbacks[M6502_CALLBACK_PAGES][M6502_PAGE_SIZE];
+  uint8_t         used;
+} M6502_CallbackTable;
+
 // For testing for IRQ
 typedef int (*M6502_PollInterruptsCallback)(M6502 *mpu);
 
@@ -89,8 +105,13 @@ extern void   M6502_delete(M6502 *mpu);
   ( ( ((MPU)->memory[M6502_##VEC##VectorLSB]= ((uint8_t)(ADDR)) & 0xff) )       \
     , ((MPU)->memory[M6502_##VEC##VectorMSB]= (uint8_t)((ADDR) >> 8)) )
 
-#define M6502_getCallback(MPU, TYPE, ADDR)      ((MPU)->callbacks->TYPE[ADDR])
-#define M6502_setCallback(MPU, TYPE, ADDR, FN)  ((MPU)->callbacks->TYPE[ADDR]= (FN))
+extern int    M6502_setPageCallback(M6502_CallbackTable *table, addr_t addr, M6502_Callback fn);
+
+#define M6502_callbackPage(TABLE, ADDR)         ((TABLE).page[(ADDR) >> M6502_PAGE_SHIFT])
+#define M6502_lookupCallback(TABLE, ADDR)       ((TABLE).callbacks[M6502_callbackPage(TABLE, ADDR) - 1][(ADDR) & (M6502_PAGE_SIZE - 1)])
+
+#define M6502_getCallback(MPU, TYPE, ADDR)      (M6502_callbackPage((MPU)->callbacks->TYPE, ADDR) ? M6502_lookupCallback((MPU)->callbacks->TYPE, ADDR) : 0)
+#define M6502_setCallback(MPU, TYPE, ADDR, FN)  M6502_setPageCallback(&(MPU)->callbacks->TYPE, ADDR, FN)
 
 
 #endif /* __m6502_h */
@@ -37,14 +37,18 @@ int m_trace;
 #endif
 
 static UINT32 decodeShift(UINT32 insn, UINT32 *pCarry);
+static inline UINT32 ShiftOperand(UINT32 rm, UINT32 type, UINT32 k, UINT32 *pCarry);
 static UINT32 DecimalToBCD(UINT32 value);
-static void HandleBranch( UINT32 insn );
 static void HandleMemSingle( UINT32 insn );
+static inline void HandleMemSingleOffset( UINT32 insn, UINT32 off );
 static void HandleALU( UINT32 insn );
+static inline void HandleALUOperand( UINT32 insn, UINT32 op2, UINT32 sc );
 static void HandleMul( UINT32 insn);
 static void HandleMemBlock( UINT32 insn );
 static void HandleCoProVL86C020( UINT32 insn );
 static void HandleCoPro( UINT32 insn );
+static void HandleSWI( void );
+static void InitDecode( void );
 
 static UINT32 GetRegister( unsigned int rIndex );
 static void SetRegister( unsigned int rIndex, UINT32 value );
@@ -235,6 +239,77 @@ enum
   COND_NV /* never */
 };
 
+/***************************************************************************/
+
+/* Ordinary RAM accesses are done here. Everything else, and every access
+ * while the debugger is active, goes through the copro_arm2_* functions.
+ */
+
+#ifdef USE_MEMORY_POINTER
+#define RAM_PTR(addr) (arm2_ram + (addr))
+#else
+#define RAM_PTR(addr) ((UINT8 *) (addr))
+#endif
+
+#ifdef INCLUDE_DEBUGGER
+#define RAM_DIRECT (!arm2_debug_enabled)
+#else
+#define RAM_DIRECT 1
+#endif
+
+static inline UINT8 cpu_read8(UINT32 addr)
+{
+  if (addr <= ARM2_RAM_MASK8 && RAM_DIRECT)
+  {
+    return *RAM_PTR(addr);
+  }
+  return copro_arm2_read8(addr);
+}
+
+static inline UINT32 cpu_read32(UINT32 addr)
+{
+  if (!(addr & ~ARM2_RAM_MASK32) && RAM_DIRECT)
+  {
+    return *(UINT32 *) RAM_PTR(addr);
+  }
+  return copro_arm2_read32(addr);
+}
+
+static inline void cpu_write8(UINT32 addr, UINT8 data)
+{
+  if (addr <= ARM2_RAM_MASK8 && RAM_DIRECT)
+  {
+    *RAM_PTR(addr) = data;
+    ARM2_CHECK_CODE_WRITE(addr & ARM2_RAM_MASK32);
+    return;
+  }
+  copro_arm2_write8(addr, data);
+}
+
+static inline void cpu_write32(UINT32 addr, UINT32 data)
+{
+  if (!(addr & ~ARM2_RAM_MASK32) && RAM_DIRECT)
+  {
+    *(UINT32 *) RAM_PTR(addr) = data;
+    ARM2_CHECK_CODE_WRITE(addr);
+    return;
+  }
+  copro_arm2_write32(addr, data);
+}
+
+/* The RAM holding count words from addr, if they are all in RAM, for
+ * transferring a whole LDM/STM register list at once */
+static inline UINT32 *RamBlock(UINT32 addr, unsigned int count)
+{
+  UINT32 last = addr + 4 * (count - 1);
+
+  if (count && !((addr | last) & ~ARM2_RAM_MASK32) && RAM_DIRECT)
+  {
+    return (UINT32 *) RAM_PTR(addr);
+  }
+  return nullptr;
+}
+
 #define LSL(v,s) ((v) << (s))
 #define LSR(v,s) ((v) >> (s))
 #define ROL(v,s) (LSL((v),(s)) | (LSR((v),32u - (s))))
@@ -289,6 +364,381 @@ void arm2_device_reset()
 #ifdef TRACE
   m_trace = 0;
 #endif
+  InitDecode();
+}
+
+/***************************************************************************/
+
+/* Instructions are decoded once into an ARM2Decoded, which holds the handler
+ * to run and any operands that can be worked out in advance. With
+ * ARM2_DECODE_CACHE these are kept in a direct mapped cache indexed by
+ * address; RAM writes discard the entry for the word written (see
+ * ARM2_CHECK_CODE_WRITE in arm.h).
+ */
+
+typedef struct ARM2Decoded ARM2Decoded;
+
+struct ARM2Decoded
+{
+  void (*execute)(const ARM2Decoded *d);
+  UINT32 insn;
+  UINT32 imm;             /* Op2 or offset, when it is a constant */
+  unsigned short cond;    /* bit n is set if the condition passes when NZCV is n */
+  unsigned char rm;
+  unsigned char shift;    /* Rm's shift amount, or the register holding it */
+  unsigned char type;     /* Rm's shift type: 0 LSL, 1 LSR, 2 ASR, 3 ROR */
+};
+
+/* Only RAM (the first 4MB) and ROM are cached; reads elsewhere have side effects */
+#define DECODE_RAM_LIMIT ((UINT32) 0x00400000u)
+#define DECODE_ROM_BASE  ((UINT32) 0x03000000u)
+
+static unsigned short m_condPass[16];
+static ARM2Decoded m_uncached;
+
+#ifdef ARM2_DECODE_CACHE
+UINT32 arm2_decode_addr[ARM2_DECODE_ENTRIES];
+static ARM2Decoded m_decodeCache[ARM2_DECODE_ENTRIES];
+#endif
+
+static int ConditionPassed(UINT32 cond, UINT32 pc)
+{
+  switch (cond)
+  {
+    case COND_EQ:
+    return Z_IS_SET(pc) != 0;
+    case COND_NE:
+    return Z_IS_CLEAR(pc);
+    case COND_CS:
+    return C_IS_SET(pc) != 0;
+    case COND_CC:
+    return C_IS_CLEAR(pc);
+    case COND_MI:
+    return N_IS_SET(pc) != 0;
+    case COND_PL:
+    return N_IS_CLEAR(pc);
+    case COND_VS:
+    return V_IS_SET(pc) != 0;
+    case COND_VC:
+    return V_IS_CLEAR(pc);
+    case COND_HI:
+    return C_IS_SET(pc) && Z_IS_CLEAR(pc);
+    case COND_LS:
+    return C_IS_CLEAR(pc) || Z_IS_SET(pc);
+    case COND_GE:
+    return !(pc & N_MASK) == !(pc & V_MASK);
+    case COND_LT:
+    return !(pc & N_MASK) != !(pc & V_MASK);
+    case COND_GT:
+    return Z_IS_CLEAR(pc) && (!(pc & N_MASK) == !(pc & V_MASK));
+    case COND_LE:
+    return Z_IS_SET(pc) || (!(pc & N_MASK) != !(pc & V_MASK));
+    case COND_NV:
+    return 0;
+  }
+  return 1;
+}
+
+static void InitDecode(void)
+{
+  UINT32 cond, flags;
+
+  for (cond = 0; cond < 16; cond++)
+  {
+    m_condPass[cond] = 0;
+    for (flags = 0; flags < 16; flags++)
+    {
+      if (ConditionPassed(cond, flags << INSN_COND_SHIFT))
+      {
+        m_condPass[cond] |= (unsigned short) (1u << flags);
+      }
+    }
+  }
+  arm2_flush_decode();
+}
+
+void arm2_flush_decode(void)
+{
+#ifdef ARM2_DECODE_CACHE
+  memset(arm2_decode_addr, 0xff, sizeof(arm2_decode_addr));
+#endif
+}
+
+static void ExecMul(const ARM2Decoded *d)
+{
+  HandleMul(d->insn);
+  R15 += 4;
+}
+
+static void ExecALU(const ARM2Decoded *d)
+{
+  HandleALU(d->insn);
+}
+
+/* Immediate Op2 with no rotation, so the carry is unchanged */
+static void ExecALUImm(const ARM2Decoded *d)
+{
+  HandleALUOperand(d->insn, d->imm, R15 & C_MASK);
+}
+
+static void ExecALURotatedImm(const ARM2Decoded *d)
+{
+  HandleALUOperand(d->insn, d->imm, d->imm & SIGN_BIT);
+}
+
+/* Register Op2 (not R15) with no shift */
+static void ExecALUReg(const ARM2Decoded *d)
+{
+  HandleALUOperand(d->insn, GetRegister(d->rm), (d->insn & INSN_S) ? R15 & C_MASK : 0);
+}
+
+/* Register Op2 (not R15) shifted by a constant. There is one handler for
+ * each shift type, so that ShiftOperand() reduces to that case. */
+static inline void ExecALUShifted(const ARM2Decoded *d, UINT32 type)
+{
+  UINT32 sc = 0;
+  UINT32 op2 = ShiftOperand(GetRegister(d->rm), type, d->shift, (d->insn & INSN_S) ? &sc : nullptr);
+
+  HandleALUOperand(d->insn, op2, sc);
+}
+
+static void ExecALULSL(const ARM2Decoded *d)
+{
+  ExecALUShifted(d, 0);
+}
+
+static void ExecALULSR(const ARM2Decoded *d)
+{
+  ExecALUShifted(d, 1);
+}
+
+static void ExecALUASR(const ARM2Decoded *d)
+{
+  ExecALUShifted(d, 2);
+}
+
+static void ExecALUROR(const ARM2Decoded *d)
+{
+  ExecALUShifted(d, 3);
+}
+
+/* Register Op2 (not R15) shifted by the bottom byte of another register */
+static void ExecALURegShift(const ARM2Decoded *d)
+{
+  UINT32 op2, sc = 0;
+  UINT32 k = GetRegister(d->shift) & 0xff;
+
+  CYCLE_COUNT(S_CYCLE);
+  if (k == 0) /* Register shift by 0 is a no-op */
+  {
+    op2 = GetRegister(d->rm);
+    if (d->insn & INSN_S) sc = R15 & C_MASK;
+  }
+  else
+  {
+    op2 = ShiftOperand(GetRegister(d->rm), d->type, k, (d->insn & INSN_S) ? &sc : nullptr);
+  }
+  HandleALUOperand(d->insn, op2, sc);
+}
+
+static void ExecMemSingle(const ARM2Decoded *d)
+{
+  HandleMemSingle(d->insn);
+  R15 += 4;
+}
+
+static void ExecMemSingleImm(const ARM2Decoded *d)
+{
+  HandleMemSingleOffset(d->insn, d->imm);
+  R15 += 4;
+}
+
+/* Register offset (not R15) shifted by a constant */
+static void ExecMemSingleShifted(const ARM2Decoded *d)
+{
+  HandleMemSingleOffset(d->insn, ShiftOperand(GetRegister(d->rm), d->type, d->shift, nullptr));
+  R15 += 4;
+}
+
+static void ExecMemBlock(const ARM2Decoded *d)
+{
+  HandleMemBlock(d->insn);
+  R15 += 4;
+}
+
+/* imm holds the sign extended offset, including the 8 for the pipeline */
+static void ExecBranch(const ARM2Decoded *d)
+{
+  /* Save PC into LR if this is a branch with link */
+  if (d->insn & INSN_BL)
+  {
+    SetRegister(14, R15 + 4);
+  }
+  R15 = ((R15 + d->imm) & ADDRESS_MASK) | (R15 & ~ADDRESS_MASK);
+  CYCLE_COUNT(2 * S_CYCLE + N_CYCLE);
+}
+
+static void ExecCoPro(const ARM2Decoded *d)
+{
+  if (m_copro_type == ARM_COPRO_TYPE_VL86C020)
+    HandleCoProVL86C020(d->insn);
+  else
+    HandleCoPro(d->insn);
+
+  R15 += 4;
+}
+
+static void ExecSWI(const ARM2Decoded *d)
+{
+  HandleSWI();
+}
+
+static void ExecUndefined(const ARM2Decoded *d)
+{
+  logerror("%08x:  Undefined instruction\n",R15);
+  CYCLE_COUNT(S_CYCLE);
+  R15 += 4;
+}
+
+static void Decode(UINT32 insn, ARM2Decoded *d)
+{
+#ifdef TRACE
+  if ((insn & 0x0D900000) == 0x01000000)
+  {
+    printf("S bit not set in %08x at %08x\r\n", insn, R15 & ADDRESS_MASK);
+    insn |= INSN_S;
+  }
+#endif
+  d->insn = insn;
+  d->cond = m_condPass[insn >> INSN_COND_SHIFT];
+
+  if ((insn & 0x0fc000f0u) == 0x00000090u) /* Multiplication */
+  {
+    d->execute = ExecMul;
+  }
+  else if (!(insn & 0x0c000000u)) /* Data processing */
+  {
+    if (insn & INSN_I)
+    {
+      UINT32 by = (insn & INSN_OP2_ROTATE) >> INSN_OP2_ROTATE_SHIFT;
+      if (by)
+      {
+        d->imm = ROR(insn & INSN_OP2_IMM, by << 1);
+        d->execute = ExecALURotatedImm;
+      }
+      else
+      {
+        d->imm = insn & INSN_OP2;
+        d->execute = ExecALUImm;
+      }
+    }
+    else if ((insn & INSN_OP2_RM) != eR15)
+    {
+      static void (*const shifted[4])(const ARM2Decoded *d) =
+      {
+        ExecALULSL, ExecALULSR, ExecALUASR, ExecALUROR
+      };
+      UINT32 k = (insn & INSN_OP2_SHIFT) >> INSN_OP2_SHIFT_SHIFT;
+      UINT32 t = (insn & INSN_OP2_SHIFT_TYPE) >> INSN_OP2_SHIFT_TYPE_SHIFT;
+
+      d->rm = (unsigned char) (insn & INSN_OP2_RM);
+      d->type = (unsigned char) (t >> 1);
+      if (!k && !t)
+      {
+        d->execute = ExecALUReg;
+      }
+      else if (!(t & 1))
+      {
+        d->shift = (unsigned char) k;
+        d->execute = shifted[t >> 1];
+      }
+      else if (!(k & 1)) /* Bit 7 must be clear for a register shift */
+      {
+        d->shift = (unsigned char) (k >> 1);
+        d->execute = ExecALURegShift;
+      }
+      else
+      {
+        d->execute = ExecALU;
+      }
+    }
+    else
+    {
+      d->execute = ExecALU;
+    }
+  }
+  else if ((insn & 0x0c000000u) == 0x04000000u) /* Single data access */
+  {
+    UINT32 t = (insn & INSN_OP2_SHIFT_TYPE) >> INSN_OP2_SHIFT_TYPE_SHIFT;
+
+    if ((insn & INSN_I) && !(t & 1) && (insn & INSN_OP2_RM) != eR15)
+    {
+      d->rm = (unsigned char) (insn & INSN_OP2_RM);
+      d->shift = (unsigned char) ((insn & INSN_OP2_SHIFT) >> INSN_OP2_SHIFT_SHIFT);
+      d->type = (unsigned char) (t >> 1);
+      d->execute = ExecMemSingleShifted;
+    }
+    else if (insn & INSN_I)
+    {
+      d->execute = ExecMemSingle;
+    }
+    else
+    {
+      d->imm = insn & INSN_SDT_IMM;
+      d->execute = ExecMemSingleImm;
+    }
+  }
+  else if ((insn & 0x0e000000u) == 0x08000000u ) /* Block data access */
+  {
+    d->execute = ExecMemBlock;
+  }
+  else if ((insn & 0x0e000000u) == 0x0a000000u) /* Branch */
+  {
+    UINT32 off = (insn & INSN_BRANCH) << 2;
+    if (off & 0x2000000u)
+    {
+      off |= 0xfc000000u;
+    }
+    d->imm = off + 8;
+    d->execute = ExecBranch;
+  }
+  else if ((insn & 0x0f000000u) == 0x0e000000u) /* Coprocessor */
+  {
+    d->execute = ExecCoPro;
+  }
+  else if ((insn & 0x0f000000u) == 0x0f000000u) /* Software interrupt */
+  {
+    d->execute = ExecSWI;
+  }
+  else /* Undefined */
+  {
+    d->execute = ExecUndefined;
+  }
+}
+
+static inline const ARM2Decoded *FetchDecoded(UINT32 addr)
+{
+#ifdef ARM2_DECODE_CACHE
+  UINT32 index = (addr >> 2) & (ARM2_DECODE_ENTRIES - 1);
+#ifdef INCLUDE_DEBUGGER
+  /* Go through cpu_read32() so the debugger sees every fetch */
+  if (!arm2_debug_enabled)
+#endif
+  {
+    if (arm2_decode_addr[index] == addr)
+    {
+      return &m_decodeCache[index];
+    }
+    if (addr < DECODE_RAM_LIMIT || addr >= DECODE_ROM_BASE)
+    {
+      Decode(cpu_read32(addr), &m_decodeCache[index]);
+      arm2_decode_addr[index] = addr;
+      return &m_decodeCache[index];
+    }
+  }
+#endif
+  Decode(cpu_read32(addr), &m_uncached);
+  return &m_uncached;
 }
 
 void arm2_execute_run(int tube_cycles)
@@ -297,7 +747,7 @@ void arm2_execute_run(int tube_cycles)
   int i;
 #endif
   UINT32 pc;
-  UINT32 insn;
+  const ARM2Decoded *di;
   //int m_icount = number;
 
   do
@@ -312,7 +762,7 @@ void arm2_execute_run(int tube_cycles)
          debug_preexec(&arm2_cpu_debug, pc & ADDRESS_MASK);
       }
 #endif
-    insn = cpu_read32( pc & ADDRESS_MASK );
+    di = FetchDecoded(pc & ADDRESS_MASK);
 
 #ifdef TRACE
     if ((pc & ADDRESS_MASK) == 0xa060)
@@ -321,12 +771,12 @@ void arm2_execute_run(int tube_cycles)
     }
     if (m_trace)
     {
-      printf("%08X %08X ", pc, insn);
+      printf("%08X %08X ", pc, di->insn);
       for (i = eR0; i <= eR7; i++)
       {
         printf("%08X ", m_sArmRegister[i]);
       }
-      if(darm_armv7_disasm(&d, insn) == 0 && darm_str2(&d, &str, 0) == 0)
+      if(darm_armv7_disasm(&d, di->insn) == 0 && darm_str2(&d, &str, 0) == 0)
       {
         printf("%s\r\n", str.total);
       }
@@ -343,104 +793,13 @@ void arm2_execute_run(int tube_cycles)
     {
       m_trace = 0;
     }
-    if ((insn & 0x0D900000) == 0x01000000)
-    {
-      printf("S bit not set in %08x at %08x\r\n", insn, pc & ADDRESS_MASK);
-      insn |= INSN_S;
-    }
 #endif
-    switch (insn >> INSN_COND_SHIFT)
-    {
-      case COND_EQ:
-      if (Z_IS_CLEAR(pc)) goto L_Next;
-      break;
-      case COND_NE:
-      if (Z_IS_SET(pc)) goto L_Next;
-      break;
-      case COND_CS:
-      if (C_IS_CLEAR(pc)) goto L_Next;
-      break;
-      case COND_CC:
-      if (C_IS_SET(pc)) goto L_Next;
-      break;
-      case COND_MI:
-      if (N_IS_CLEAR(pc)) goto L_Next;
-      break;
-      case COND_PL:
-      if (N_IS_SET(pc)) goto L_Next;
-      break;
-      case COND_VS:
-      if (V_IS_CLEAR(pc)) goto L_Next;
-      break;
-      case COND_VC:
-      if (V_IS_SET(pc)) goto L_Next;
-      break;
-      case COND_HI:
-      if (C_IS_CLEAR(pc) || Z_IS_SET(pc)) goto L_Next;
-      break;
-      case COND_LS:
-      if (C_IS_SET(pc) && Z_IS_CLEAR(pc)) goto L_Next;
-      break;
-      case COND_GE:
-      if (!(pc & N_MASK) != !(pc & V_MASK)) goto L_Next; /* Use x ^ (x >> ...) method */
-      break;
-      case COND_LT:
-      if (!(pc & N_MASK) == !(pc & V_MASK)) goto L_Next;
-      break;
-      case COND_GT:
-      if (Z_IS_SET(pc) || (!(pc & N_MASK) != !(pc & V_MASK))) goto L_Next;
-      break;
-      case COND_LE:
-      if (Z_IS_CLEAR(pc) && (!(pc & N_MASK) == !(pc & V_MASK))) goto L_Next;
-      break;
-      case COND_NV:
-      goto L_Next;
-    }
-    /* Condition satisfied, so decode the instruction */
-    if ((insn & 0x0fc000f0u) == 0x00000090u) /* Multiplication */
-    {
-      HandleMul(insn);
-      R15 += 4;
-    }
-    else if (!(insn & 0x0c000000u)) /* Data processing */
-    {
-      HandleALU(insn);
-    }
-    else if ((insn & 0x0c000000u) == 0x04000000u) /* Single data access */
-    {
-      HandleMemSingle(insn);
-      R15 += 4;
-    }
-    else if ((insn & 0x0e000000u) == 0x08000000u ) /* Block data access */
-    {
-      HandleMemBlock(insn);
-      R15 += 4;
-    }
-    else if ((insn & 0x0e000000u) == 0x0a000000u) /* Branch */
+    if ((di->cond >> (pc >> INSN_COND_SHIFT)) & 1)
     {
-      HandleBranch(insn);
+      di->execute(di);
     }
-    else if ((insn & 0x0f000000u) == 0x0e000000u) /* Coprocessor */
-    {
-      if (m_copro_type == ARM_COPRO_TYPE_VL86C020)
-      HandleCoProVL86C020(insn);
-      else
-      HandleCoPro(insn);
-
-      R15 += 4;
-    }
-    else if ((insn & 0x0f000000u) == 0x0f000000u) /* Software interrupt */
-    {
-      pc=R15+4;
-      R15 = eARM_MODE_SVC; /* Set SVC mode so PC is saved to correct R14 bank */
-      SetRegister( 14, pc ); /* save PC */
-      R15 = (pc&PSR_MASK)|(pc&IRQ_MASK)|0x8|eARM_MODE_SVC|I_MASK|(pc&MODE_MASK);
-      CYCLE_COUNT(2 * S_CYCLE + N_CYCLE);
-    }
-    else /* Undefined */
+    else
     {
-      logerror("%08x:  Undefined instruction\n",R15);
-      L_Next:
       CYCLE_COUNT(S_CYCLE);
       R15 += 4;
     }
@@ -515,31 +874,21 @@ UINT32 arm2_getR15()
 
 /***************************************************************************/
 
-static void HandleBranch(UINT32 insn)
+static void HandleSWI(void)
 {
-  UINT32 off = (insn & INSN_BRANCH) << 2;
-
-  /* Save PC into LR if this is a branch with link */
-  if (insn & INSN_BL)
-  {
-    SetRegister(14, R15+ 4);
-  }
+  UINT32 pc = R15 + 4;
 
-  /* Sign-extend the 24-bit offset in our calculations */
-  if (off & 0x2000000u)
-  {
-    R15 = ((R15 - (((~(off | 0xfc000000u)) + 1) - 8)) & ADDRESS_MASK) | (R15 & ~ADDRESS_MASK);
-  }
-  else
-  {
-    R15 = ((R15 + (off + 8)) & ADDRESS_MASK) | (R15 & ~ADDRESS_MASK);
-  }
+  R15 = eARM_MODE_SVC; /* Set SVC mode so PC is saved to correct R14 bank */
+  SetRegister( 14, pc ); /* save PC */
+  R15 = (pc&PSR_MASK)|(pc&IRQ_MASK)|0x8|eARM_MODE_SVC|I_MASK|(pc&MODE_MASK);
   CYCLE_COUNT(2 * S_CYCLE + N_CYCLE);
 }
 
+/***************************************************************************/
+
 static void HandleMemSingle(UINT32 insn)
 {
-  UINT32 rn, rnv, off, rd;
+  UINT32 off;
 
   /* Fetch the offset */
   if (insn & INSN_I)
@@ -551,6 +900,13 @@ static void HandleMemSingle(UINT32 insn)
     off = insn & INSN_SDT_IMM;
   }
 
+  HandleMemSingleOffset(insn, off);
+}
+
+static inline void HandleMemSingleOffset(UINT32 insn, UINT32 off)
+{
+  UINT32 rn, rnv, rd;
+
   /* Calculate Rn, accounting for PC */
   rn = (insn & INSN_RN) >> INSN_RN_SHIFT;
 
@@ -739,14 +1095,7 @@ static void HandleMemSingle(UINT32 insn)
 
 static void HandleALU(UINT32 insn)
 {
-  UINT32 op2, sc = 0, rd, rn, opcode;
-  UINT32 rdn;
-
-  opcode = (insn & INSN_OPCODE) >> INSN_OPCODE_SHIFT;
-  CYCLE_COUNT(S_CYCLE);
-
-  rd = 0;
-  rn = 0;
+  UINT32 op2, sc = 0;
 
   /* Construct Op2 */
   if (insn & INSN_I)
@@ -772,6 +1121,21 @@ static void HandleALU(UINT32 insn)
     sc=0;
   }
 
+  HandleALUOperand(insn, op2, sc);
+}
+
+/* The rest of HandleALU, once Op2 and the shifter carry out are known */
+static inline void HandleALUOperand(UINT32 insn, UINT32 op2, UINT32 sc)
+{
+  UINT32 rd, rn, opcode;
+  UINT32 rdn;
+
+  opcode = (insn & INSN_OPCODE) >> INSN_OPCODE_SHIFT;
+  CYCLE_COUNT(S_CYCLE);
+
+  rd = 0;
+  rn = 0;
+
   /* Calculate Rn to account for pipelining */
   if ((opcode & 0xd) != 0xd) /* No Rn in MOV */
   {
@@ -951,9 +1315,50 @@ static void HandleMul(UINT32 insn)
   }
 }
 
+/* Store the registers in pat, lowest first, to the RAM at block (which is
+ * at addr) */
+static unsigned int storeBlock(UINT32 pat, UINT32 *block, UINT32 addr)
+{
+  const int *map = sRegisterTable[MODE];
+  unsigned int result = 0;
+
+  while (pat)
+  {
+    *block++ = m_sArmRegister[map[__builtin_ctz(pat)]];
+    ARM2_CHECK_CODE_WRITE(addr);
+    addr += 4;
+    pat &= pat - 1;
+    result++;
+  }
+  return result;
+}
+
 static unsigned int loadInc(UINT32 pat, UINT32 rbv, UINT32 s)
 {
   unsigned int i, result;
+  UINT32 *block = RamBlock(rbv + 4, (unsigned int) __builtin_popcount(pat));
+
+  if (block)
+  {
+    const int *map = sRegisterTable[MODE];
+    UINT32 regs = pat & 0x7fff;
+
+    result = (unsigned int) __builtin_popcount(pat);
+    while (regs)
+    {
+      m_sArmRegister[map[__builtin_ctz(regs)]] = *block++;
+      regs &= regs - 1;
+    }
+    if (pat & 0x8000)
+    {
+      if (s) /* Pull full contents from stack */
+        R15 = *block;
+      else
+        /* Pull only address, preserve mode & status flags */
+        R15 = (R15&PSR_MASK) | (R15&IRQ_MASK) | (R15&MODE_MASK) | (*block & ADDRESS_MASK);
+    }
+    return result;
+  }
 
   result = 0;
   for (i = 0; i < 16; i++)
@@ -981,6 +1386,31 @@ static unsigned int loadDec(UINT32 pat, UINT32 rbv, UINT32 s, UINT32* deferredR1
 {
   unsigned int result;
   int i;
+  unsigned int count = (unsigned int) __builtin_popcount(pat);
+  UINT32 *block = RamBlock(rbv - 4 * count, count);
+
+  if (block)
+  {
+    /* The lowest register is at the lowest address */
+    const int *map = sRegisterTable[MODE];
+    UINT32 regs = pat & 0x7fff;
+
+    while (regs)
+    {
+      m_sArmRegister[map[__builtin_ctz(regs)]] = *block++;
+      regs &= regs - 1;
+    }
+    if (pat & 0x8000)
+    {
+      *defer = 1;
+      if (s) /* Pull full contents from stack */
+        *deferredR15 = *block;
+      else
+        /* Pull only address, preserve mode & status flags */
+        *deferredR15 = (R15&PSR_MASK) | (R15&IRQ_MASK) | (R15&MODE_MASK) | (*block & ADDRESS_MASK);
+    }
+    return count;
+  }
 
   result = 0;
   for (i = 15; i >= 0; i--)
@@ -1007,6 +1437,12 @@ static unsigned int loadDec(UINT32 pat, UINT32 rbv, UINT32 s, UINT32* deferredR1
 static unsigned int storeInc(UINT32 pat, UINT32 rbv)
 {
   unsigned int i, result;
+  UINT32 *block = RamBlock(rbv + 4, (unsigned int) __builtin_popcount(pat));
+
+  if (block)
+  {
+    return storeBlock(pat, block, rbv + 4);
+  }
 
   result = 0;
   for (i = 0; i < 16; i++)
@@ -1027,7 +1463,14 @@ static unsigned int storeDec(UINT32 pat, UINT32 rbv)
 {
   unsigned int result;
   int i;
-  
+  unsigned int count = (unsigned int) __builtin_popcount(pat);
+  UINT32 *block = RamBlock(rbv - 4 * count, count);
+
+  if (block)
+  {
+    return storeBlock(pat, block, rbv - 4 * count);
+  }
+
   result = 0;
   for (i = 15; i >= 0; i--)
   {
@@ -1213,42 +1656,12 @@ static void HandleMemBlock(UINT32 insn)
     }
   } /* HandleMemBlock */
 
-  /* Decodes an Op2-style shifted-register form.  If @carry@ is non-zero the
-   * shifter carry output will manifest itself as @*carry == 0@ for carry clear
-   * and @*carry != 0@ for carry set.
-   */
-static UINT32 decodeShift(UINT32 insn, UINT32 *pCarry)
+/* Shifts rm by k (0-255) as decodeShift() does, type being 0 for LSL, 1 LSR,
+ * 2 ASR and 3 ROR; a shift by a constant 0 is passed as k = 0.
+ */
+static inline UINT32 ShiftOperand(UINT32 rm, UINT32 type, UINT32 k, UINT32 *pCarry)
 {
-  UINT32 k = (insn & INSN_OP2_SHIFT) >> INSN_OP2_SHIFT_SHIFT;
-  UINT32 rm = GetRegister(insn & INSN_OP2_RM);
-  UINT32 t = (insn & INSN_OP2_SHIFT_TYPE) >> INSN_OP2_SHIFT_TYPE_SHIFT;
-
-  if ((insn & INSN_OP2_RM) == 0xf)
-  {
-    /* If hardwired shift, then PC is 8 bytes ahead, else if register shift
-     is used, then 12 bytes - TODO?? */
-    rm += 8;
-  }
-
-  /* All shift types ending in 1 are Rk, not #k */
-  if (t & 1)
-  {
-//      logerror("%08x:  RegShift %02x %02x\n",R15, k>>1,GetRegister(k >> 1));
-      if (ARM_DEBUG_CORE && (insn & 0x80) == 0x80)
-        logerror("%08x:  RegShift ERROR (p36)\n", R15);
-
-      //see p35 for check on this
-      k = GetRegister(k >> 1)&0xff;
-      CYCLE_COUNT(S_CYCLE);
-      if( k == 0 ) /* Register shift by 0 is a no-op */
-      {
-//          logerror("%08x:  NO-OP Regshift\n",R15);
-        if (pCarry) *pCarry = R15 & C_MASK;
-        return rm;
-      }
-    }
-    /* Decode the shift type and perform the shift */
-  switch (t >> 1)
+  switch (type)
   {
     case 0: /* LSL */
       if (k >= 32)
@@ -1311,6 +1724,44 @@ static UINT32 decodeShift(UINT32 insn, UINT32 *pCarry)
 
   logerror("%08x: Decodeshift error\n", R15);
   return 0;
+}
+
+  /* Decodes an Op2-style shifted-register form.  If @carry@ is non-zero the
+   * shifter carry output will manifest itself as @*carry == 0@ for carry clear
+   * and @*carry != 0@ for carry set.
+   */
+static UINT32 decodeShift(UINT32 insn, UINT32 *pCarry)
+{
+  UINT32 k = (insn & INSN_OP2_SHIFT) >> INSN_OP2_SHIFT_SHIFT;
+  UINT32 rm = GetRegister(insn & INSN_OP2_RM);
+  UINT32 t = (insn & INSN_OP2_SHIFT_TYPE) >> INSN_OP2_SHIFT_TYPE_SHIFT;
+
+  if ((insn & INSN_OP2_RM) == 0xf)
+  {
+    /* If hardwired shift, then PC is 8 bytes ahead, else if register shift
+     is used, then 12 bytes - TODO?? */
+    rm += 8;
+  }
+
+  /* All shift types ending in 1 are Rk, not #k */
+  if (t & 1)
+  {
+//      logerror("%08x:  RegShift %02x %02x\n",R15, k>>1,GetRegister(k >> 1));
+      if (ARM_DEBUG_CORE && (insn & 0x80) == 0x80)
+        logerror("%08x:  RegShift ERROR (p36)\n", R15);
+
+      //see p35 for check on this
+      k = GetRegister(k >> 1)&0xff;
+      CYCLE_COUNT(S_CYCLE);
+      if( k == 0 ) /* Register shift by 0 is a no-op */
+      {
+//          logerror("%08x:  NO-OP Regshift\n",R15);
+        if (pCarry) *pCarry = R15 & C_MASK;
+        return rm;
+      }
+    }
+  /* Decode the shift type and perform the shift */
+  return ShiftOperand(rm, t >> 1, k, pCarry);
 } /* decodeShift */
 
 static UINT32 BCDToDecimal(UINT32 value)
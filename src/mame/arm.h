@@ -16,13 +16,36 @@ extern void   copro_arm2_write32(unsigned int addr, UINT32 data);
 
 extern UINT32 m_sArmRegister[];
 
-#define cpu_read8    copro_arm2_read8
-#define cpu_read32   copro_arm2_read32
-#define cpu_write8   copro_arm2_write8
-#define cpu_write32  copro_arm2_write32
+/* 4MB of RAM starting at 0x00000000, which arm.c accesses directly */
+#define ARM2_RAM_MASK8    ((UINT32) 0x003fffff)
+#define ARM2_RAM_MASK32   ((UINT32) 0x003ffffc)
+
+extern UINT8 *arm2_ram;
 
 #define logerror printf
 
+/* Cache decoded instructions (see arm.c), unless ARM2_NO_DECODE_CACHE */
+#ifndef ARM2_NO_DECODE_CACHE
+#define ARM2_DECODE_CACHE
+#endif
+
+#ifdef ARM2_DECODE_CACHE
+/* Number of entries in the direct mapped cache (a power of two) */
+#define ARM2_DECODE_ENTRIES 16384
+
+/* The address held by each entry, or all ones if it is empty */
+extern UINT32 arm2_decode_addr[ARM2_DECODE_ENTRIES];
+
+/* Discard the decoded copy of the RAM word at addr (a multiple of 4) */
+#define ARM2_CHECK_CODE_WRITE(addr) \
+  do { \
+    if (arm2_decode_addr[((addr) >> 2) & (ARM2_DECODE_ENTRIES - 1)] == (addr)) \
+      arm2_decode_addr[((addr) >> 2) & (ARM2_DECODE_ENTRIES - 1)] = ~0u; \
+  } while (0)
+#else
+#define ARM2_CHECK_CODE_WRITE(addr) do { } while (0)
+#endif
+
 #define ARM_DEBUG_CORE 0
 #define ARM_DEBUG_COPRO 0
 
@@ -57,5 +80,6 @@ void arm2_execute_run(int tube_cycles);
 
 void arm2_execute_set_input(int irqline, int state);
 UINT32 arm2_getR15();
+void arm2_flush_decode(void);
 
 #endif /* __ARM_H__ */
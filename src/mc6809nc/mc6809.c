@@ -1582,10 +1582,155 @@ static void bsr (void)
   change_pc (ea);
 }
 
+/* Instruction dispatch. With GCC every handler goes straight on to the
+ * next instruction through a table for its opcode page, so there is no
+ * switch and no shared bookkeeping after each instruction. Otherwise the
+ * same handlers are the cases of a single switch, with the 0x10 and 0x11
+ * pages at 0x10xx and 0x11xx.
+ */
+
+#if defined(__GNUC__) && !defined(__STRICT_ANSI__)
+# define MC6809_THREADED
+#endif
+
+#ifdef INCLUDE_DEBUGGER
+# define preexec()    do { if (mc6809nc_debug_enabled) debug_preexec (&mc6809nc_cpu_debug, PC); } while (0)
+#else
+# define preexec()    do { } while (0)
+#endif
+
+#ifdef MC6809_THREADED
+# define op(num)      _##num
+# define op10(num)    _10##num
+# define op11(num)    _11##num
+# ifdef H6309
+#  define H6309_OP(label, illegal) &&label
+# else
+#  define H6309_OP(label, illegal) &&illegal
+# endif
+# define fetch()      do { iPC = PC; preexec (); opcode = imm_byte (); goto *page0[opcode]; } while (0)
+# define prefix(page) do { opcode = imm_byte (); goto *page[opcode]; } while (0)
+# define next()       do { tubeUseCycles(1); if (!tubeContinueRunning()) goto done; fetch (); } while (0)
+/* Only instructions that write CC can unmask a pending interrupt */
+# define next_cc()    do { if (cc_changed) cc_modified (); next (); } while (0)
+#else
+# define op(num)      case 0x##num
+# define op10(num)    case 0x10##num
+# define op11(num)    case 0x11##num
+# define fetch()      do { iPC = PC; preexec (); opcode = imm_byte (); } while (0)
+# define prefix(page) do { opcode = (opcode << 8) | imm_byte (); goto dispatch; } while (0)
+# define next()       break
+# define next_cc()    if (cc_changed) cc_modified (); break
+#endif
+
 /* Execute 6809 code for a certain number of cycles. */
 int mc6809nc_execute (int tube_cycles)
 {
   unsigned opcode;
+#ifdef MC6809_THREADED
+  static void *const page0[256] = {
+    &&_00, H6309_OP(_01, _illegal), H6309_OP(_02, _illegal), &&_03, &&_04, H6309_OP(_05, _illegal), &&_06, &&_07,
+    &&_08, &&_09, &&_0a, H6309_OP(_0b, _illegal), &&_0c, &&_0d, &&_0e, &&_0f,
+    &&_10, &&_11, &&_12, &&_13, H6309_OP(_14, _illegal), &&_illegal, &&_16, &&_17,
+    &&_illegal, &&_19, &&_1a, &&_illegal, &&_1c, &&_1d, &&_1e, &&_1f,
+    &&_20, &&_21, &&_22, &&_23, &&_24, &&_25, &&_26, &&_27,
+    &&_28, &&_29, &&_2a, &&_2b, &&_2c, &&_2d, &&_2e, &&_2f,
+    &&_30, &&_31, &&_32, &&_33, &&_34, &&_35, &&_36, &&_37,
+    &&_illegal, &&_39, &&_3a, &&_3b, &&_3c, &&_3d, &&_illegal, &&_3f,
+    &&_40, &&_illegal, &&_illegal, &&_43, &&_44, &&_illegal, &&_46, &&_47,
+    &&_48, &&_49, &&_4a, &&_illegal, &&_4c, &&_4d, &&_illegal, &&_4f,
+    &&_50, &&_illegal, &&_illegal, &&_53, &&_54, &&_illegal, &&_56, &&_57,
+    &&_58, &&_59, &&_5a, &&_illegal, &&_5c, &&_5d, &&_illegal, &&_5f,
+    &&_60, H6309_OP(_61, _illegal), H6309_OP(_62, _illegal), &&_63, &&_64, H6309_OP(_65, _illegal), &&_66, &&_67,
+    &&_68, &&_69, &&_6a, H6309_OP(_6b, _illegal), &&_6c, &&_6d, &&_6e, &&_6f,
+    &&_70, H6309_OP(_71, _illegal), H6309_OP(_72, _illegal), &&_73, &&_74, H6309_OP(_75, _illegal), &&_76, &&_77,
+    &&_78, &&_79, &&_7a, H6309_OP(_7b, _illegal), &&_7c, &&_7d, &&_7e, &&_7f,
+    &&_80, &&_81, &&_82, &&_83, &&_84, &&_85, &&_86, &&_illegal,
+    &&_88, &&_89, &&_8a, &&_8b, &&_8c, &&_8d, &&_8e, &&_illegal,
+    &&_90, &&_91, &&_92, &&_93, &&_94, &&_95, &&_96, &&_97,
+    &&_98, &&_99, &&_9a, &&_9b, &&_9c, &&_9d, &&_9e, &&_9f,
+    &&_a0, &&_a1, &&_a2, &&_a3, &&_a4, &&_a5, &&_a6, &&_a7,
+    &&_a8, &&_a9, &&_aa, &&_ab, &&_ac, &&_ad, &&_ae, &&_af,
+    &&_b0, &&_b1, &&_b2, &&_b3, &&_b4, &&_b5, &&_b6, &&_b7,
+    &&_b8, &&_b9, &&_ba, &&_bb, &&_bc, &&_bd, &&_be, &&_bf,
+    &&_c0, &&_c1, &&_c2, &&_c3, &&_c4, &&_c5, &&_c6, &&_illegal,
+    &&_c8, &&_c9, &&_ca, &&_cb, &&_cc, H6309_OP(_cd, _illegal), &&_ce, &&_illegal,
+    &&_d0, &&_d1, &&_d2, &&_d3, &&_d4, &&_d5, &&_d6, &&_d7,
+    &&_d8, &&_d9, &&_da, &&_db, &&_dc, &&_dd, &&_de, &&_df,
+    &&_e0, &&_e1, &&_e2, &&_e3, &&_e4, &&_e5, &&_e6, &&_e7,
+    &&_e8, &&_e9, &&_ea, &&_eb, &&_ec, &&_ed, &&_ee, &&_ef,
+    &&_f0, &&_f1, &&_f2, &&_f3, &&_f4, &&_f5, &&_f6, &&_f7,
+    &&_f8, &&_f9, &&_fa, &&_fb, &&_fc, &&_fd, &&_fe, &&_ff
+  };
+  static void *const page10[256] = {
+    &&_illegal10, &&_illegal10, &&_illegal10, &&_illegal10, &&_illegal10, &&_illegal10, &&_illegal10, &&_illegal10,
+    &&_illegal10, &&_illegal10, &&_illegal10, &&_illegal10, &&_illegal10, &&_illegal10, &&_illegal10, &&_illegal10,
+    &&_illegal10, &&_illegal10, &&_illegal10, &&_illegal10, &&_illegal10, &&_illegal10, &&_illegal10, &&_illegal10,
+    &&_illegal10, &&_illegal10, &&_illegal10, &&_illegal10, &&_illegal10, &&_illegal10, &&_illegal10, &&_illegal10,
+    &&_illegal10, &&_1021, &&_1022, &&_1023, &&_1024, &&_1025, &&_1026, &&_1027,
+    &&_1028, &&_1029, &&_102a, &&_102b, &&_102c, &&_102d, &&_102e, &&_102f,
+    H6309_OP(_1030, _illegal10), H6309_OP(_1031, _illegal10), H6309_OP(_1032, _illegal10), H6309_OP(_1033, _illegal10), H6309_OP(_1034, _illegal10), H6309_OP(_1035, _illegal10), H6309_OP(_1036, _illegal10), H6309_OP(_1037, _illegal10),
+    H6309_OP(_1038, _illegal10), H6309_OP(_1039, _illegal10), H6309_OP(_103a, _illegal10), H6309_OP(_103b, _illegal10), &&_illegal10, &&_illegal10, &&_illegal10, &&_103f,
+    H6309_OP(_1040, _illegal10), &&_illegal10, &&_illegal10, H6309_OP(_1043, _illegal10), H6309_OP(_1044, _illegal10), &&_illegal10, H6309_OP(_1046, _illegal10), H6309_OP(_1047, _illegal10),
+    H6309_OP(_1048, _illegal10), H6309_OP(_1049, _illegal10), H6309_OP(_104a, _illegal10), &&_illegal10, H6309_OP(_104c, _illegal10), H6309_OP(_104d, _illegal10), &&_illegal10, H6309_OP(_104f, _illegal10),
+    &&_illegal10, &&_illegal10, &&_illegal10, H6309_OP(_1053, _illegal10), H6309_OP(_1054, _illegal10), &&_illegal10, H6309_OP(_1056, _illegal10), &&_illegal10,
+    &&_illegal10, H6309_OP(_1059, _illegal10), H6309_OP(_105a, _illegal10), &&_illegal10, H6309_OP(_105c, _illegal10), H6309_OP(_105d, _illegal10), &&_illegal10, H6309_OP(_105f, _illegal10),
+    &&_illegal10, &&_illegal10, &&_illegal10, &&_illegal10, &&_illegal10, &&_illegal10, &&_illegal10, &&_illegal10,
+    &&_illegal10, &&_illegal10, &&_illegal10, &&_illegal10, &&_illegal10, &&_illegal10, &&_illegal10, &&_illegal10,
+    &&_illegal10, &&_illegal10, &&_illegal10, &&_illegal10, &&_illegal10, &&_illegal10, &&_illegal10, &&_illegal10,
+    &&_illegal10, &&_illegal10, &&_illegal10, &&_illegal10, &&_illegal10, &&_illegal10, &&_illegal10, &&_illegal10,
+    H6309_OP(_1080, _illegal10), H6309_OP(_1081, _illegal10), H6309_OP(_1082, _illegal10), &&_1083, H6309_OP(_1084, _illegal10), H6309_OP(_1085, _illegal10), H6309_OP(_1086, _illegal10), &&_illegal10,
+    H6309_OP(_1088, _illegal10), H6309_OP(_1089, _illegal10), H6309_OP(_108a, _illegal10), H6309_OP(_108b, _illegal10), &&_108c, &&_illegal10, &&_108e, &&_illegal10,
+    H6309_OP(_1090, _illegal10), H6309_OP(_1091, _illegal10), H6309_OP(_1092, _illegal10), &&_1093, &&_illegal10, &&_illegal10, &&_illegal10, &&_illegal10,
+    &&_illegal10, &&_illegal10, &&_illegal10, &&_illegal10, &&_109c, &&_illegal10, &&_109e, &&_109f,
+    &&_illegal10, &&_illegal10, &&_illegal10, &&_10a3, &&_illegal10, &&_illegal10, &&_illegal10, &&_illegal10,
+    &&_illegal10, &&_illegal10, &&_illegal10, &&_illegal10, &&_10ac, &&_illegal10, &&_10ae, &&_10af,
+    &&_illegal10, &&_illegal10, &&_illegal10, &&_10b3, &&_illegal10, &&_illegal10, &&_illegal10, &&_illegal10,
+    &&_illegal10, &&_illegal10, &&_illegal10, &&_illegal10, &&_10bc, &&_illegal10, &&_10be, &&_10bf,
+    &&_illegal10, &&_illegal10, &&_illegal10, &&_illegal10, &&_illegal10, &&_illegal10, &&_illegal10, &&_illegal10,
+    &&_illegal10, &&_illegal10, &&_illegal10, &&_illegal10, &&_illegal10, &&_illegal10, &&_10ce, &&_illegal10,
+    &&_illegal10, &&_illegal10, &&_illegal10, &&_illegal10, &&_illegal10, &&_illegal10, &&_illegal10, &&_illegal10,
+    &&_illegal10, &&_illegal10, &&_illegal10, &&_illegal10, &&_illegal10, &&_illegal10, &&_10de, &&_10df,
+    &&_illegal10, &&_illegal10, &&_illegal10, &&_illegal10, &&_illegal10, &&_illegal10, &&_illegal10, &&_illegal10,
+    &&_illegal10, &&_illegal10, &&_illegal10, &&_illegal10, &&_illegal10, &&_illegal10, &&_10ee, &&_10ef,
+    &&_illegal10, &&_illegal10, &&_illegal10, &&_illegal10, &&_illegal10, &&_illegal10, &&_illegal10, &&_illegal10,
+    &&_illegal10, &&_illegal10, &&_illegal10, &&_illegal10, &&_illegal10, &&_illegal10, &&_10fe, &&_10ff
+  };
+  static void *const page11[256] = {
+    &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11,
+    &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11,
+    &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11,
+    &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11,
+    &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11,
+    &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11,
+    &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11,
+    &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_113f,
+    &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11,
+    &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11,
+    &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11,
+    &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11,
+    &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11,
+    &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11,
+    &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11,
+    &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11,
+    H6309_OP(_1180, _illegal11), H6309_OP(_1181, _illegal11), &&_illegal11, &&_1183, &&_illegal11, &&_illegal11, H6309_OP(_1186, _illegal11), &&_illegal11,
+    &&_illegal11, &&_illegal11, &&_illegal11, H6309_OP(_118b, _illegal11), &&_118c, H6309_OP(_118d, _illegal11), H6309_OP(_118e, _illegal11), H6309_OP(_118f, _illegal11),
+    H6309_OP(_1190, _illegal11), H6309_OP(_1191, _illegal11), &&_illegal11, &&_1193, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11,
+    &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_119c, &&_illegal11, &&_illegal11, &&_illegal11,
+    &&_illegal11, &&_illegal11, &&_illegal11, &&_11a3, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11,
+    &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_11ac, &&_illegal11, &&_illegal11, &&_illegal11,
+    &&_illegal11, &&_illegal11, &&_illegal11, &&_11b3, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11,
+    &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_11bc, &&_illegal11, &&_illegal11, &&_illegal11,
+    &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11,
+    &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11,
+    &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11,
+    &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11,
+    &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11,
+    &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11,
+    &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11,
+    &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11, &&_illegal11
+  };
+#endif
 
   cpu_period = cpu_clk = tube_cycles;
 
@@ -1593,1374 +1738,1366 @@ int mc6809nc_execute (int tube_cycles)
      return cpu_period;
   }
 
+  /* CC may have been written by the debugger */
+  if (cc_changed)
+    cc_modified ();
+
+#ifdef MC6809_THREADED
+  fetch ();
+#else
   do
     {
-
-      iPC = PC;
-
-#ifdef INCLUDE_DEBUGGER
-      if (mc6809nc_debug_enabled)
-      {
-         debug_preexec(&mc6809nc_cpu_debug, PC);
-      }
-#endif
-
-      opcode = imm_byte ();
-
+      fetch ();
+    dispatch:
       switch (opcode)
    {
-   case 0x00:
+#endif
+   op(00):
      direct ();
      cpu_clk -= 4;
      WRMEM (ea, neg (RDMEM (ea)));
-     break;    /* NEG direct */
+     next ();    /* NEG direct */
 #ifdef H6309
-   case 0x01:     /* OIM */
-     break;
-   case 0x02:     /* AIM */
-     break;
+   op(01): /* OIM */
+     next ();
+   op(02): /* AIM */
+     next ();
 #endif
-   case 0x03:
+   op(03):
      direct ();
      cpu_clk -= 4;
      WRMEM (ea, com (RDMEM (ea)));
-     break;    /* COM direct */
-   case 0x04:
+     next ();    /* COM direct */
+   op(04):
      direct ();
      cpu_clk -= 4;
      WRMEM (ea, lsr (RDMEM (ea)));
-     break;    /* LSR direct */
+     next ();    /* LSR direct */
 #ifdef H6309
-   case 0x05:     /* EIM */
-     break;
+   op(05): /* EIM */
+     next ();
 #endif
-   case 0x06:
+   op(06):
      direct ();
      cpu_clk -= 4;
      WRMEM (ea, ror (RDMEM (ea)));
-     break;    /* ROR direct */
-   case 0x07:
+     next ();    /* ROR direct */
+   op(07):
      direct ();
      cpu_clk -= 4;
      WRMEM (ea, asr (RDMEM (ea)));
-     break;    /* ASR direct */
-   case 0x08:
+     next ();    /* ASR direct */
+   op(08):
      direct ();
      cpu_clk -= 4;
      WRMEM (ea, asl (RDMEM (ea)));
-     break;    /* ASL direct */
-   case 0x09:
+     next ();    /* ASL direct */
+   op(09):
      direct ();
      cpu_clk -= 4;
      WRMEM (ea, rol (RDMEM (ea)));
-     break;    /* ROL direct */
-   case 0x0a:
+     next ();    /* ROL direct */
+   op(0a):
      direct ();
      cpu_clk -= 4;
      WRMEM (ea, dec (RDMEM (ea)));
-     break;    /* DEC direct */
+     next ();    /* DEC direct */
 #ifdef H6309
-   case 0x0B:     /* TIM */
-     break;
+   op(0b): /* TIM */
+     next ();
 #endif
-   case 0x0c:
+   op(0c):
      direct ();
      cpu_clk -= 4;
      WRMEM (ea, inc (RDMEM (ea)));
-     break;    /* INC direct */
-   case 0x0d:
+     next ();    /* INC direct */
+   op(0d):
      direct ();
      cpu_clk -= 4;
      tst (RDMEM (ea));
-     break;    /* TST direct */
-   case 0x0e:
+     next ();    /* TST direct */
+   op(0e):
      direct ();
      cpu_clk -= 3;
      PC = ea;
      check_pc ();
-     break;    /* JMP direct */
-   case 0x0f:
+     next ();    /* JMP direct */
+   op(0f):
      direct ();
      cpu_clk -= 4;
      WRMEM (ea, clr (RDMEM (ea)));
-     break;    /* CLR direct */
-   case 0x10:
-     {
-       opcode = imm_byte ();
-
-       switch (opcode)
-         {
-         case 0x21:
-      cpu_clk -= 5;
-      PC += 2;
-      break;
-         case 0x22:
-      long_branch (cond_HI ());
-      break;
-         case 0x23:
-      long_branch (cond_LS ());
-      break;
-         case 0x24:
-      long_branch (cond_HS ());
-      break;
-         case 0x25:
-      long_branch (cond_LO ());
-      break;
-         case 0x26:
-      long_branch (cond_NE ());
-      break;
-         case 0x27:
-      long_branch (cond_EQ ());
-      break;
-         case 0x28:
-      long_branch (cond_VC ());
-      break;
-         case 0x29:
-      long_branch (cond_VS ());
-      break;
-         case 0x2a:
-      long_branch (cond_PL ());
-      break;
-         case 0x2b:
-      long_branch (cond_MI ());
-      break;
-         case 0x2c:
-      long_branch (cond_GE ());
-      break;
-         case 0x2d:
-      long_branch (cond_LT ());
-      break;
-         case 0x2e:
-      long_branch (cond_GT ());
-      break;
-         case 0x2f:
-      long_branch (cond_LE ());
-      break;
+     next ();    /* CLR direct */
+   op(10):
+     prefix (page10);
+   op10(21):
+     cpu_clk -= 5;
+     PC += 2;
+     next ();
+   op10(22):
+     long_branch (cond_HI ());
+     next ();
+   op10(23):
+     long_branch (cond_LS ());
+     next ();
+   op10(24):
+     long_branch (cond_HS ());
+     next ();
+   op10(25):
+     long_branch (cond_LO ());
+     next ();
+   op10(26):
+     long_branch (cond_NE ());
+     next ();
+   op10(27):
+     long_branch (cond_EQ ());
+     next ();
+   op10(28):
+     long_branch (cond_VC ());
+     next ();
+   op10(29):
+     long_branch (cond_VS ());
+     next ();
+   op10(2a):
+     long_branch (cond_PL ());
+     next ();
+   op10(2b):
+     long_branch (cond_MI ());
+     next ();
+   op10(2c):
+     long_branch (cond_GE ());
+     next ();
+   op10(2d):
+     long_branch (cond_LT ());
+     next ();
+   op10(2e):
+     long_branch (cond_GT ());
+     next ();
+   op10(2f):
+     long_branch (cond_LE ());
+     next ();
 #ifdef H6309
-         case 0x30:  /* ADDR */
-      break;
-         case 0x31:  /* ADCR */
-      break;
-         case 0x32:  /* SUBR */
-      break;
-         case 0x33:  /* SBCR */
-      break;
-         case 0x34:  /* ANDR */
-      break;
-         case 0x35:  /* ORR */
-      break;
-         case 0x36:  /* EORR */
-      break;
-         case 0x37:  /* CMPR */
-      break;
-         case 0x38:  /* PSHSW */
-      break;
-         case 0x39:  /* PULSW */
-      break;
-         case 0x3a:  /* PSHUW */
-      break;
-         case 0x3b:  /* PULUW */
-      break;
+   op10(30): /* ADDR */
+     next ();
+   op10(31): /* ADCR */
+     next ();
+   op10(32): /* SUBR */
+     next ();
+   op10(33): /* SBCR */
+     next ();
+   op10(34): /* ANDR */
+     next ();
+   op10(35): /* ORR */
+     next ();
+   op10(36): /* EORR */
+     next ();
+   op10(37): /* CMPR */
+     next ();
+   op10(38): /* PSHSW */
+     next ();
+   op10(39): /* PULSW */
+     next ();
+   op10(3a): /* PSHUW */
+     next ();
+   op10(3b): /* PULUW */
+     next ();
 #endif
-         case 0x3f:
-      swi2 ();
-      break;
+   op10(3f):
+     swi2 ();
+     next ();
 #ifdef H6309
-         case 0x40:  /* NEGD */
-      break;
-         case 0x43:  /* COMD */
-      break;
-         case 0x44:  /* LSRD */
-      break;
-         case 0x46:  /* RORD */
-      break;
-         case 0x47:  /* ASRD */
-      break;
-         case 0x48:  /* ASLD/LSLD */
-      break;
-         case 0x49:  /* ROLD */
-      break;
-         case 0x4a:  /* DECD */
-      break;
-         case 0x4c:  /* INCD */
-      break;
-         case 0x4d:  /* TSTD */
-      break;
-         case 0x4f:  /* CLRD */
-      break;
-         case 0x53:  /* COMW */
-      break;
-         case 0x54:  /* LSRW */
-      break;
-         case 0x56:  /* ??RORW */
-      break;
-         case 0x59:  /* ROLW */
-      break;
-         case 0x5a:  /* DECW */
-      break;
-         case 0x5c:  /* INCW */
-      break;
-         case 0x5d:  /* TSTW */
-      break;
-         case 0x5f:  /* CLRW */
-      break;
-         case 0x80:  /* SUBW */
-      break;
-         case 0x81:  /* CMPW */
-      break;
-         case 0x82:  /* SBCD */
-      break;
+   op10(40): /* NEGD */
+     next ();
+   op10(43): /* COMD */
+     next ();
+   op10(44): /* LSRD */
+     next ();
+   op10(46): /* RORD */
+     next ();
+   op10(47): /* ASRD */
+     next ();
+   op10(48): /* ASLD/LSLD */
+     next ();
+   op10(49): /* ROLD */
+     next ();
+   op10(4a): /* DECD */
+     next ();
+   op10(4c): /* INCD */
+     next ();
+   op10(4d): /* TSTD */
+     next ();
+   op10(4f): /* CLRD */
+     next ();
+   op10(53): /* COMW */
+     next ();
+   op10(54): /* LSRW */
+     next ();
+   op10(56): /* ??RORW */
+     next ();
+   op10(59): /* ROLW */
+     next ();
+   op10(5a): /* DECW */
+     next ();
+   op10(5c): /* INCW */
+     next ();
+   op10(5d): /* TSTW */
+     next ();
+   op10(5f): /* CLRW */
+     next ();
+   op10(80): /* SUBW */
+     next ();
+   op10(81): /* CMPW */
+     next ();
+   op10(82): /* SBCD */
+     next ();
 #endif
-         case 0x83:
-      cpu_clk -= 5;
-      cmp16 (get_d (), imm_word ());
-      break;
+   op10(83):
+     cpu_clk -= 5;
+     cmp16 (get_d (), imm_word ());
+     next ();
 #ifdef H6309
-         case 0x84:  /* ANDD */
-      break;
-         case 0x85:  /* BITD */
-      break;
-         case 0x86:  /* LDW */
-      break;
-         case 0x88:  /* EORD */
-      break;
-         case 0x89:  /* ADCD */
-      break;
-         case 0x8a:  /* ORD */
-      break;
-         case 0x8b:  /* ADDW */
-      break;
+   op10(84): /* ANDD */
+     next ();
+   op10(85): /* BITD */
+     next ();
+   op10(86): /* LDW */
+     next ();
+   op10(88): /* EORD */
+     next ();
+   op10(89): /* ADCD */
+     next ();
+   op10(8a): /* ORD */
+     next ();
+   op10(8b): /* ADDW */
+     next ();
 #endif
-         case 0x8c:
-      cpu_clk -= 5;
-      cmp16 (Y, imm_word ());
-      break;
-         case 0x8e:
-      cpu_clk -= 4;
-      Y = ld16 (imm_word ());
-      break;
+   op10(8c):
+     cpu_clk -= 5;
+     cmp16 (Y, imm_word ());
+     next ();
+   op10(8e):
+     cpu_clk -= 4;
+     Y = ld16 (imm_word ());
+     next ();
 #ifdef H6309
-         case 0x90:  /* SUBW */
-      break;
-         case 0x91:  /* CMPW */
-      break;
-         case 0x92:  /* SBCD */
-      break;
+   op10(90): /* SUBW */
+     next ();
+   op10(91): /* CMPW */
+     next ();
+   op10(92): /* SBCD */
+     next ();
 #endif
-         case 0x93:
-      direct ();
-      cpu_clk -= 5;
-      cmp16 (get_d (), RDMEM16 (ea));
-      cpu_clk--;
-      break;
-         case 0x9c:
-      direct ();
-      cpu_clk -= 5;
-      cmp16 (Y, RDMEM16 (ea));
-      cpu_clk--;
-      break;
-         case 0x9e:
-      direct ();
-      cpu_clk -= 5;
-      Y = ld16 (RDMEM16 (ea));
-      break;
-         case 0x9f:
-      direct ();
-      cpu_clk -= 5;
-      st16 (Y);
-      break;
-         case 0xa3:
-      cpu_clk--;
-      indexed ();
-      cmp16 (get_d (), RDMEM16 (ea));
-      cpu_clk--;
-      break;
-         case 0xac:
-      cpu_clk--;
-      indexed ();
-      cmp16 (Y, RDMEM16 (ea));
-      cpu_clk--;
-      break;
-         case 0xae:
-      cpu_clk--;
-      indexed ();
-      Y = ld16 (RDMEM16 (ea));
-      break;
-         case 0xaf:
-      cpu_clk--;
-      indexed ();
-      st16 (Y);
-      break;
-         case 0xb3:
-      extended ();
-      cpu_clk -= 6;
-      cmp16 (get_d (), RDMEM16 (ea));
-      cpu_clk--;
-      break;
-         case 0xbc:
-      extended ();
-      cpu_clk -= 6;
-      cmp16 (Y, RDMEM16 (ea));
-      cpu_clk--;
-      break;
-         case 0xbe:
-      extended ();
-      cpu_clk -= 6;
-      Y = ld16 (RDMEM16 (ea));
-      break;
-         case 0xbf:
-      extended ();
-      cpu_clk -= 6;
-      st16 (Y);
-      break;
-         case 0xce:
-      cpu_clk -= 4;
-      S = ld16 (imm_word ());
-      break;
-         case 0xde:
-      direct ();
-      cpu_clk -= 5;
-      S = ld16 (RDMEM16 (ea));
-      break;
-         case 0xdf:
-      direct ();
-      cpu_clk -= 5;
-      st16 (S);
-      break;
-         case 0xee:
-      cpu_clk--;
-      indexed ();
-      S = ld16 (RDMEM16 (ea));
-      break;
-         case 0xef:
-      cpu_clk--;
-      indexed ();
-      st16 (S);
-      break;
-         case 0xfe:
-      extended ();
-      cpu_clk -= 6;
-      S = ld16 (RDMEM16 (ea));
-      break;
-         case 0xff:
-      extended ();
-      cpu_clk -= 6;
-      st16 (S);
-      break;
-         default:
-           sim_error ("invalid opcode (1) at %04x\n", iPC);
-      break;
-         }
-     }
-     break;
-
-   case 0x11:
-     {
-       opcode = imm_byte ();
-
-       switch (opcode)
-         {
-         case 0x3f:
-      swi3 ();
-      break;
+   op10(93):
+     direct ();
+     cpu_clk -= 5;
+     cmp16 (get_d (), RDMEM16 (ea));
+     cpu_clk--;
+     next ();
+   op10(9c):
+     direct ();
+     cpu_clk -= 5;
+     cmp16 (Y, RDMEM16 (ea));
+     cpu_clk--;
+     next ();
+   op10(9e):
+     direct ();
+     cpu_clk -= 5;
+     Y = ld16 (RDMEM16 (ea));
+     next ();
+   op10(9f):
+     direct ();
+     cpu_clk -= 5;
+     st16 (Y);
+     next ();
+   op10(a3):
+     cpu_clk--;
+     indexed ();
+     cmp16 (get_d (), RDMEM16 (ea));
+     cpu_clk--;
+     next ();
+   op10(ac):
+     cpu_clk--;
+     indexed ();
+     cmp16 (Y, RDMEM16 (ea));
+     cpu_clk--;
+     next ();
+   op10(ae):
+     cpu_clk--;
+     indexed ();
+     Y = ld16 (RDMEM16 (ea));
+     next ();
+   op10(af):
+     cpu_clk--;
+     indexed ();
+     st16 (Y);
+     next ();
+   op10(b3):
+     extended ();
+     cpu_clk -= 6;
+     cmp16 (get_d (), RDMEM16 (ea));
+     cpu_clk--;
+     next ();
+   op10(bc):
+     extended ();
+     cpu_clk -= 6;
+     cmp16 (Y, RDMEM16 (ea));
+     cpu_clk--;
+     next ();
+   op10(be):
+     extended ();
+     cpu_clk -= 6;
+     Y = ld16 (RDMEM16 (ea));
+     next ();
+   op10(bf):
+     extended ();
+     cpu_clk -= 6;
+     st16 (Y);
+     next ();
+   op10(ce):
+     cpu_clk -= 4;
+     S = ld16 (imm_word ());
+     next ();
+   op10(de):
+     direct ();
+     cpu_clk -= 5;
+     S = ld16 (RDMEM16 (ea));
+     next ();
+   op10(df):
+     direct ();
+     cpu_clk -= 5;
+     st16 (S);
+     next ();
+   op10(ee):
+     cpu_clk--;
+     indexed ();
+     S = ld16 (RDMEM16 (ea));
+     next ();
+   op10(ef):
+     cpu_clk--;
+     indexed ();
+     st16 (S);
+     next ();
+   op10(fe):
+     extended ();
+     cpu_clk -= 6;
+     S = ld16 (RDMEM16 (ea));
+     next ();
+   op10(ff):
+     extended ();
+     cpu_clk -= 6;
+     st16 (S);
+     next ();
+
+   op(11):
+     prefix (page11);
+   op11(3f):
+     swi3 ();
+     next ();
 #ifdef H6309
-         case 0x80: /* SUBE */
-         case 0x81: /* CMPE */
+   op11(80): /* SUBE */
+   op11(81): /* CMPE */
 #endif
-         case 0x83:
-      cpu_clk -= 5;
-      cmp16 (U, imm_word ());
-      break;
+   op11(83):
+     cpu_clk -= 5;
+     cmp16 (U, imm_word ());
+     next ();
 #ifdef H6309
-         case 0x86: /* LDE */
-         case 0x8B: /* ADDE */
+   op11(86): /* LDE */
+   op11(8b): /* ADDE */
 #endif
-         case 0x8c:
-      cpu_clk -= 5;
-      cmp16 (S, imm_word ());
-      break;
+   op11(8c):
+     cpu_clk -= 5;
+     cmp16 (S, imm_word ());
+     next ();
 #ifdef H6309
-         case 0x8D: /* DIVD */
-         case 0x8E: /* DIVQ */
-         case 0x8F: /* MULD */
-         case 0x90: /* SUBE */
-         case 0x91: /* CMPE */
+   op11(8d): /* DIVD */
+   op11(8e): /* DIVQ */
+   op11(8f): /* MULD */
+   op11(90): /* SUBE */
+   op11(91): /* CMPE */
 #endif
-         case 0x93:
-      direct ();
-      cpu_clk -= 5;
-      cmp16 (U, RDMEM16 (ea));
-      cpu_clk--;
-      break;
-         case 0x9c:
-      direct ();
-      cpu_clk -= 5;
-      cmp16 (S, RDMEM16 (ea));
-      cpu_clk--;
-      break;
-         case 0xa3:
-      cpu_clk--;
-      indexed ();
-      cmp16 (U, RDMEM16 (ea));
-      cpu_clk--;
-      break;
-         case 0xac:
-      cpu_clk--;
-      indexed ();
-      cmp16 (S, RDMEM16 (ea));
-      cpu_clk--;
-      break;
-         case 0xb3:
-      extended ();
-      cpu_clk -= 6;
-      cmp16 (U, RDMEM16 (ea));
-      cpu_clk--;
-      break;
-         case 0xbc:
-      extended ();
-      cpu_clk -= 6;
-      cmp16 (S, RDMEM16 (ea));
-      cpu_clk--;
-      break;
-         default:
-           sim_error ("invalid opcode (2) at %04x\n", iPC);
-      break;
-         }
-     }
-     break;
+   op11(93):
+     direct ();
+     cpu_clk -= 5;
+     cmp16 (U, RDMEM16 (ea));
+     cpu_clk--;
+     next ();
+   op11(9c):
+     direct ();
+     cpu_clk -= 5;
+     cmp16 (S, RDMEM16 (ea));
+     cpu_clk--;
+     next ();
+   op11(a3):
+     cpu_clk--;
+     indexed ();
+     cmp16 (U, RDMEM16 (ea));
+     cpu_clk--;
+     next ();
+   op11(ac):
+     cpu_clk--;
+     indexed ();
+     cmp16 (S, RDMEM16 (ea));
+     cpu_clk--;
+     next ();
+   op11(b3):
+     extended ();
+     cpu_clk -= 6;
+     cmp16 (U, RDMEM16 (ea));
+     cpu_clk--;
+     next ();
+   op11(bc):
+     extended ();
+     cpu_clk -= 6;
+     cmp16 (S, RDMEM16 (ea));
+     cpu_clk--;
+     next ();
 
-   case 0x12:
+   op(12):
      nop ();
-     break;
-   case 0x13:
+     next ();
+   op(13):
      sync ();
-     break;
+     next ();
 #ifdef H6309
-   case 0x14:     /* SEXW */
-     break;
+   op(14): /* SEXW */
+     next ();
 #endif
-   case 0x16:
+   op(16):
      long_bra ();
      cpu_clk -= 5;
-     break;
-   case 0x17:
+     next ();
+   op(17):
      long_bsr ();
-     break;
-   case 0x19:
+     next ();
+   op(19):
      daa ();
-     break;
-   case 0x1a:
+     next ();
+   op(1a):
      orcc ();
-     break;
-   case 0x1c:
+     next_cc ();
+   op(1c):
      andcc ();
-     break;
-   case 0x1d:
+     next_cc ();
+   op(1d):
      sex ();
-     break;
-   case 0x1e:
+     next ();
+   op(1e):
      exg ();
-     break;
-   case 0x1f:
+     next_cc ();
+   op(1f):
      tfr ();
-     break;
+     next_cc ();
 
-   case 0x20:
+   op(20):
      bra ();
      cpu_clk -= 3;
-     break;
-   case 0x21:
+     next ();
+   op(21):
      PC++;
      cpu_clk -= 3;
-     break;
-   case 0x22:
+     next ();
+   op(22):
      branch (cond_HI ());
-     break;
-   case 0x23:
+     next ();
+   op(23):
      branch (cond_LS ());
-     break;
-   case 0x24:
+     next ();
+   op(24):
      branch (cond_HS ());
-     break;
-   case 0x25:
+     next ();
+   op(25):
      branch (cond_LO ());
-     break;
-   case 0x26:
+     next ();
+   op(26):
      branch (cond_NE ());
-     break;
-   case 0x27:
+     next ();
+   op(27):
      branch (cond_EQ ());
-     break;
-   case 0x28:
+     next ();
+   op(28):
      branch (cond_VC ());
-     break;
-   case 0x29:
+     next ();
+   op(29):
      branch (cond_VS ());
-     break;
-   case 0x2a:
+     next ();
+   op(2a):
      branch (cond_PL ());
-     break;
-   case 0x2b:
+     next ();
+   op(2b):
      branch (cond_MI ());
-     break;
-   case 0x2c:
+     next ();
+   op(2c):
      branch (cond_GE ());
-     break;
-   case 0x2d:
+     next ();
+   op(2d):
      branch (cond_LT ());
-     break;
-   case 0x2e:
+     next ();
+   op(2e):
      branch (cond_GT ());
-     break;
-   case 0x2f:
+     next ();
+   op(2f):
      branch (cond_LE ());
-     break;
+     next ();
 
-   case 0x30:
+   op(30):
      indexed ();
      X = ea;
      Z = (X !=0);
-     break;    /* LEAX indexed */
-   case 0x31:
+     next ();    /* LEAX indexed */
+   op(31):
      indexed ();
      Y = ea;
      Z = (Y !=0);
-     break;    /* LEAY indexed */
-   case 0x32:
+     next ();    /* LEAY indexed */
+   op(32):
      indexed ();
      S = ea;
-     break;    /* LEAS indexed */
-   case 0x33:
+     next ();    /* LEAS indexed */
+   op(33):
      indexed ();
      U = ea;
-     break;    /* LEAU indexed */
-   case 0x34:
+     next ();    /* LEAU indexed */
+   op(34):
      pshs ();
-     break;    /* PSHS implied */
-   case 0x35:
+     next ();    /* PSHS implied */
+   op(35):
      puls ();
-     break;    /* PULS implied */
-   case 0x36:
+     next_cc ();    /* PULS implied */
+   op(36):
      pshu ();
-     break;    /* PSHU implied */
-   case 0x37:
+     next ();    /* PSHU implied */
+   op(37):
      pulu ();
-     break;    /* PULU implied */
-   case 0x39:
+     next_cc ();    /* PULU implied */
+   op(39):
      rts ();
-     break;    /* RTS implied  */
-   case 0x3a:
+     next ();    /* RTS implied  */
+   op(3a):
      abx ();
-     break;    /* ABX implied  */
-   case 0x3b:
+     next ();    /* ABX implied  */
+   op(3b):
      rti ();
-     break;    /* RTI implied  */
-   case 0x3c:
+     next_cc ();    /* RTI implied  */
+   op(3c):
      cwai ();
-     break;    /* CWAI implied */
-   case 0x3d:
+     next ();    /* CWAI implied */
+   op(3d):
      mul ();
-     break;    /* MUL implied  */
-   case 0x3f:
+     next ();    /* MUL implied  */
+   op(3f):
      swi ();
-     break;    /* SWI implied  */
+     next ();    /* SWI implied  */
 
-   case 0x40:
+   op(40):
      A = neg (A);
-     break;    /* NEGA implied */
-   case 0x43:
+     next ();    /* NEGA implied */
+   op(43):
      A = com (A);
-     break;    /* COMA implied */
-   case 0x44:
+     next ();    /* COMA implied */
+   op(44):
      A = lsr (A);
-     break;    /* LSRA implied */
-   case 0x46:
+     next ();    /* LSRA implied */
+   op(46):
      A = ror (A);
-     break;    /* RORA implied */
-   case 0x47:
+     next ();    /* RORA implied */
+   op(47):
      A = asr (A);
-     break;    /* ASRA implied */
-   case 0x48:
+     next ();    /* ASRA implied */
+   op(48):
      A = asl (A);
-     break;    /* ASLA implied */
-   case 0x49:
+     next ();    /* ASLA implied */
+   op(49):
      A = rol (A);
-     break;    /* ROLA implied */
-   case 0x4a:
+     next ();    /* ROLA implied */
+   op(4a):
      A = dec (A);
-     break;    /* DECA implied */
-   case 0x4c:
+     next ();    /* DECA implied */
+   op(4c):
      A = inc (A);
-     break;    /* INCA implied */
-   case 0x4d:
+     next ();    /* INCA implied */
+   op(4d):
      tst (A);
-     break;    /* TSTA implied */
-   case 0x4f:
+     next ();    /* TSTA implied */
+   op(4f):
      A = clr (A);
-     break;    /* CLRA implied */
+     next ();    /* CLRA implied */
 
-   case 0x50:
+   op(50):
      B = neg (B);
-     break;    /* NEGB implied */
-   case 0x53:
+     next ();    /* NEGB implied */
+   op(53):
      B = com (B);
-     break;    /* COMB implied */
-   case 0x54:
+     next ();    /* COMB implied */
+   op(54):
      B = lsr (B);
-     break;    /* LSRB implied */
-   case 0x56:
+     next ();    /* LSRB implied */
+   op(56):
      B = ror (B);
-     break;    /* RORB implied */
-   case 0x57:
+     next ();    /* RORB implied */
+   op(57):
      B = asr (B);
-     break;    /* ASRB implied */
-   case 0x58:
+     next ();    /* ASRB implied */
+   op(58):
      B = asl (B);
-     break;    /* ASLB implied */
-   case 0x59:
+     next ();    /* ASLB implied */
+   op(59):
      B = rol (B);
-     break;    /* ROLB implied */
-   case 0x5a:
+     next ();    /* ROLB implied */
+   op(5a):
      B = dec (B);
-     break;    /* DECB implied */
-   case 0x5c:
+     next ();    /* DECB implied */
+   op(5c):
      B = inc (B);
-     break;    /* INCB implied */
-   case 0x5d:
+     next ();    /* INCB implied */
+   op(5d):
      tst (B);
-     break;    /* TSTB implied */
-   case 0x5f:
+     next ();    /* TSTB implied */
+   op(5f):
      B = clr (B);
-     break;    /* CLRB implied */
-   case 0x60:
+     next ();    /* CLRB implied */
+   op(60):
      indexed ();
      WRMEM (ea, neg (RDMEM (ea)));
-     break;    /* NEG indexed */
+     next ();    /* NEG indexed */
 #ifdef H6309
-   case 0x61:     /* OIM indexed */
-     break;
-   case 0x62:     /* AIM indexed */
-     break;
+   op(61): /* OIM indexed */
+     next ();
+   op(62): /* AIM indexed */
+     next ();
 #endif
-   case 0x63:
+   op(63):
      indexed ();
      WRMEM (ea, com (RDMEM (ea)));
-     break;    /* COM indexed */
-   case 0x64:
+     next ();    /* COM indexed */
+   op(64):
      indexed ();
      WRMEM (ea, lsr (RDMEM (ea)));
-     break;    /* LSR indexed */
+     next ();    /* LSR indexed */
 #ifdef H6309
-   case 0x65:     /* EIM indexed */
-     break;
+   op(65): /* EIM indexed */
+     next ();
 #endif
-   case 0x66:
+   op(66):
      indexed ();
      WRMEM (ea, ror (RDMEM (ea)));
-     break;    /* ROR indexed */
-   case 0x67:
+     next ();    /* ROR indexed */
+   op(67):
      indexed ();
      WRMEM (ea, asr (RDMEM (ea)));
-     break;    /* ASR indexed */
-   case 0x68:
+     next ();    /* ASR indexed */
+   op(68):
      indexed ();
      WRMEM (ea, asl (RDMEM (ea)));
-     break;    /* ASL indexed */
-   case 0x69:
+     next ();    /* ASL indexed */
+   op(69):
      indexed ();
      WRMEM (ea, rol (RDMEM (ea)));
-     break;    /* ROL indexed */
-   case 0x6a:
+     next ();    /* ROL indexed */
+   op(6a):
      indexed ();
      WRMEM (ea, dec (RDMEM (ea)));
-     break;    /* DEC indexed */
+     next ();    /* DEC indexed */
 #ifdef H6309
-   case 0x6b:     /* TIM indexed */
-     break;
+   op(6b): /* TIM indexed */
+     next ();
 #endif
-   case 0x6c:
+   op(6c):
      indexed ();
      WRMEM (ea, inc (RDMEM (ea)));
-     break;    /* INC indexed */
-   case 0x6d:
+     next ();    /* INC indexed */
+   op(6d):
      indexed ();
      tst (RDMEM (ea));
-     break;    /* TST indexed */
-   case 0x6e:
+     next ();    /* TST indexed */
+   op(6e):
      indexed ();
      cpu_clk += 1;
      PC = ea;
      check_pc ();
-     break;    /* JMP indexed */
-   case 0x6f:
+     next ();    /* JMP indexed */
+   op(6f):
      indexed ();
      WRMEM (ea, clr (RDMEM (ea)));
-     break;    /* CLR indexed */
-   case 0x70:
+     next ();    /* CLR indexed */
+   op(70):
      extended ();
      cpu_clk -= 5;
      WRMEM (ea, neg (RDMEM (ea)));
-     break;    /* NEG extended */
+     next ();    /* NEG extended */
 #ifdef H6309
-   case 0x71:     /* OIM extended */
-     break;
-   case 0x72:     /* AIM extended */
-     break;
+   op(71): /* OIM extended */
+     next ();
+   op(72): /* AIM extended */
+     next ();
 #endif
-   case 0x73:
+   op(73):
      extended ();
      cpu_clk -= 5;
      WRMEM (ea, com (RDMEM (ea)));
-     break;    /* COM extended */
-   case 0x74:
+     next ();    /* COM extended */
+   op(74):
      extended ();
      cpu_clk -= 5;
      WRMEM (ea, lsr (RDMEM (ea)));
-     break;    /* LSR extended */
+     next ();    /* LSR extended */
 #ifdef H6309
-   case 0x75:     /* EIM extended */
-     break;
+   op(75): /* EIM extended */
+     next ();
 #endif
-   case 0x76:
+   op(76):
      extended ();
      cpu_clk -= 5;
      WRMEM (ea, ror (RDMEM (ea)));
-     break;    /* ROR extended */
-   case 0x77:
+     next ();    /* ROR extended */
+   op(77):
      extended ();
      cpu_clk -= 5;
      WRMEM (ea, asr (RDMEM (ea)));
-     break;    /* ASR extended */
-   case 0x78:
+     next ();    /* ASR extended */
+   op(78):
      extended ();
      cpu_clk -= 5;
      WRMEM (ea, asl (RDMEM (ea)));
-     break;    /* ASL extended */
-   case 0x79:
+     next ();    /* ASL extended */
+   op(79):
      extended ();
      cpu_clk -= 5;
      WRMEM (ea, rol (RDMEM (ea)));
-     break;    /* ROL extended */
-   case 0x7a:
+     next ();    /* ROL extended */
+   op(7a):
      extended ();
      cpu_clk -= 5;
      WRMEM (ea, dec (RDMEM (ea)));
-     break;    /* DEC extended */
+     next ();    /* DEC extended */
 #ifdef H6309
-   case 0x7b:     /* TIM indexed */
-     break;
+   op(7b): /* TIM indexed */
+     next ();
 #endif
-   case 0x7c:
+   op(7c):
      extended ();
      cpu_clk -= 5;
      WRMEM (ea, inc (RDMEM (ea)));
-     break;    /* INC extended */
-   case 0x7d:
+     next ();    /* INC extended */
+   op(7d):
      extended ();
      cpu_clk -= 5;
      tst (RDMEM (ea));
-     break;    /* TST extended */
-   case 0x7e:
+     next ();    /* TST extended */
+   op(7e):
      extended ();
      cpu_clk -= 4;
      PC = ea;
      check_pc ();
-     break;    /* JMP extended */
-   case 0x7f:
+     next ();    /* JMP extended */
+   op(7f):
      extended ();
      cpu_clk -= 5;
      WRMEM (ea, clr (RDMEM (ea)));
-     break;    /* CLR extended */
-   case 0x80:
+     next ();    /* CLR extended */
+   op(80):
      cpu_clk -= 2;
      A = sub (A, imm_byte ());
-     break;
-   case 0x81:
+     next ();
+   op(81):
      cpu_clk -= 2;
      cmp (A, imm_byte ());
-     break;
-   case 0x82:
+     next ();
+   op(82):
      cpu_clk -= 2;
      A = sbc (A, imm_byte ());
-     break;
-   case 0x83:
+     next ();
+   op(83):
      cpu_clk -= 4;
      subd (imm_word ());
-     break;
-   case 0x84:
+     next ();
+   op(84):
      cpu_clk -= 2;
      A = and (A, imm_byte ());
-     break;
-   case 0x85:
+     next ();
+   op(85):
      cpu_clk -= 2;
      bit (A, imm_byte ());
-     break;
-   case 0x86:
+     next ();
+   op(86):
      cpu_clk -= 2;
      A = ld (imm_byte ());
-     break;
-   case 0x88:
+     next ();
+   op(88):
      cpu_clk -= 2;
      A = eor (A, imm_byte ());
-     break;
-   case 0x89:
+     next ();
+   op(89):
      cpu_clk -= 2;
      A = adc (A, imm_byte ());
-     break;
-   case 0x8a:
+     next ();
+   op(8a):
      cpu_clk -= 2;
      A = or (A, imm_byte ());
-     break;
-   case 0x8b:
+     next ();
+   op(8b):
      cpu_clk -= 2;
      A = add (A, imm_byte ());
-     break;
-   case 0x8c:
+     next ();
+   op(8c):
      cpu_clk -= 4;
      cmp16 (X, imm_word ());
-     break;
-   case 0x8d:
+     next ();
+   op(8d):
      bsr ();
-     break;
-   case 0x8e:
+     next ();
+   op(8e):
      cpu_clk -= 3;
      X = ld16 (imm_word ());
-     break;
+     next ();
 
-   case 0x90:
+   op(90):
      direct ();
      cpu_clk -= 4;
      A = sub (A, RDMEM (ea));
-     break;
-   case 0x91:
+     next ();
+   op(91):
      direct ();
      cpu_clk -= 4;
      cmp (A, RDMEM (ea));
-     break;
-   case 0x92:
+     next ();
+   op(92):
      direct ();
      cpu_clk -= 4;
      A = sbc (A, RDMEM (ea));
-     break;
-   case 0x93:
+     next ();
+   op(93):
      direct ();
      cpu_clk -= 4;
      subd (RDMEM16 (ea));
      cpu_clk--;
-     break;
-   case 0x94:
+     next ();
+   op(94):
      direct ();
      cpu_clk -= 4;
      A = and (A, RDMEM (ea));
-     break;
-   case 0x95:
+     next ();
+   op(95):
      direct ();
      cpu_clk -= 4;
      bit (A, RDMEM (ea));
-     break;
-   case 0x96:
+     next ();
+   op(96):
      direct ();
      cpu_clk -= 4;
      A = ld (RDMEM (ea));
-     break;
-   case 0x97:
+     next ();
+   op(97):
      direct ();
      cpu_clk -= 4;
      st (A);
-     break;
-   case 0x98:
+     next ();
+   op(98):
      direct ();
      cpu_clk -= 4;
      A = eor (A, RDMEM (ea));
-     break;
-   case 0x99:
+     next ();
+   op(99):
      direct ();
      cpu_clk -= 4;
      A = adc (A, RDMEM (ea));
-     break;
-   case 0x9a:
+     next ();
+   op(9a):
      direct ();
      cpu_clk -= 4;
      A = or (A, RDMEM (ea));
-     break;
-   case 0x9b:
+     next ();
+   op(9b):
      direct ();
      cpu_clk -= 4;
      A = add (A, RDMEM (ea));
-     break;
-   case 0x9c:
+     next ();
+   op(9c):
      direct ();
      cpu_clk -= 4;
      cmp16 (X, RDMEM16 (ea));
      cpu_clk--;
-     break;
-   case 0x9d:
+     next ();
+   op(9d):
      direct ();
      cpu_clk -= 7;
      jsr ();
-     break;
-   case 0x9e:
+     next ();
+   op(9e):
      direct ();
      cpu_clk -= 4;
      X = ld16 (RDMEM16 (ea));
-     break;
-   case 0x9f:
+     next ();
+   op(9f):
      direct ();
      cpu_clk -= 4;
      st16 (X);
-     break;
+     next ();
 
-   case 0xa0:
+   op(a0):
      indexed ();
      A = sub (A, RDMEM (ea));
-     break;
-   case 0xa1:
+     next ();
+   op(a1):
      indexed ();
      cmp (A, RDMEM (ea));
-     break;
-   case 0xa2:
+     next ();
+   op(a2):
      indexed ();
      A = sbc (A, RDMEM (ea));
-     break;
-   case 0xa3:
+     next ();
+   op(a3):
      indexed ();
      subd (RDMEM16 (ea));
      cpu_clk--;
-     break;
-   case 0xa4:
+     next ();
+   op(a4):
      indexed ();
      A = and (A, RDMEM (ea));
-     break;
-   case 0xa5:
+     next ();
+   op(a5):
      indexed ();
      bit (A, RDMEM (ea));
-     break;
-   case 0xa6:
+     next ();
+   op(a6):
      indexed ();
      A = ld (RDMEM (ea));
-     break;
-   case 0xa7:
+     next ();
+   op(a7):
      indexed ();
      st (A);
-     break;
-   case 0xa8:
+     next ();
+   op(a8):
      indexed ();
      A = eor (A, RDMEM (ea));
-     break;
-   case 0xa9:
+     next ();
+   op(a9):
      indexed ();
      A = adc (A, RDMEM (ea));
-     break;
-   case 0xaa:
+     next ();
+   op(aa):
      indexed ();
      A = or (A, RDMEM (ea));
-     break;
-   case 0xab:
+     next ();
+   op(ab):
      indexed ();
      A = add (A, RDMEM (ea));
-     break;
-   case 0xac:
+     next ();
+   op(ac):
      indexed ();
      cmp16 (X, RDMEM16 (ea));
      cpu_clk--;
-     break;
-   case 0xad:
+     next ();
+   op(ad):
      indexed ();
      cpu_clk -= 3;
      jsr ();
-     break;
-   case 0xae:
+     next ();
+   op(ae):
      indexed ();
      X = ld16 (RDMEM16 (ea));
-     break;
-   case 0xaf:
+     next ();
+   op(af):
      indexed ();
      st16 (X);
-     break;
+     next ();
 
-   case 0xb0:
+   op(b0):
      extended ();
      cpu_clk -= 5;
      A = sub (A, RDMEM (ea));
-     break;
-   case 0xb1:
+     next ();
+   op(b1):
      extended ();
      cpu_clk -= 5;
      cmp (A, RDMEM (ea));
-     break;
-   case 0xb2:
+     next ();
+   op(b2):
      extended ();
      cpu_clk -= 5;
      A = sbc (A, RDMEM (ea));
-     break;
-   case 0xb3:
+     next ();
+   op(b3):
      extended ();
      cpu_clk -= 5;
      subd (RDMEM16 (ea));
      cpu_clk--;
-     break;
-   case 0xb4:
+     next ();
+   op(b4):
      extended ();
      cpu_clk -= 5;
      A = and (A, RDMEM (ea));
-     break;
-   case 0xb5:
+     next ();
+   op(b5):
      extended ();
      cpu_clk -= 5;
      bit (A, RDMEM (ea));
-     break;
-   case 0xb6:
+     next ();
+   op(b6):
      extended ();
      cpu_clk -= 5;
      A = ld (RDMEM (ea));
-     break;
-   case 0xb7:
+     next ();
+   op(b7):
      extended ();
      cpu_clk -= 5;
      st (A);
-     break;
-   case 0xb8:
+     next ();
+   op(b8):
      extended ();
      cpu_clk -= 5;
      A = eor (A, RDMEM (ea));
-     break;
-   case 0xb9:
+     next ();
+   op(b9):
      extended ();
      cpu_clk -= 5;
      A = adc (A, RDMEM (ea));
-     break;
-   case 0xba:
+     next ();
+   op(ba):
      extended ();
      cpu_clk -= 5;
      A = or (A, RDMEM (ea));
-     break;
-   case 0xbb:
+     next ();
+   op(bb):
      extended ();
      cpu_clk -= 5;
      A = add (A, RDMEM (ea));
-     break;
-   case 0xbc:
+     next ();
+   op(bc):
      extended ();
      cpu_clk -= 5;
      cmp16 (X, RDMEM16 (ea));
      cpu_clk--;
-     break;
-   case 0xbd:
+     next ();
+   op(bd):
      extended ();
      cpu_clk -= 8;
      jsr ();
-     break;
-   case 0xbe:
+     next ();
+   op(be):
      extended ();
      cpu_clk -= 5;
      X = ld16 (RDMEM16 (ea));
-     break;
-   case 0xbf:
+     next ();
+   op(bf):
      extended ();
      cpu_clk -= 5;
      st16 (X);
-     break;
+     next ();
 
-   case 0xc0:
+   op(c0):
      cpu_clk -= 2;
      B = sub (B, imm_byte ());
-     break;
-   case 0xc1:
+     next ();
+   op(c1):
      cpu_clk -= 2;
      cmp (B, imm_byte ());
-     break;
-   case 0xc2:
+     next ();
+   op(c2):
      cpu_clk -= 2;
      B = sbc (B, imm_byte ());
-     break;
-   case 0xc3:
+     next ();
+   op(c3):
      cpu_clk -= 4;
      addd (imm_word ());
-     break;
-   case 0xc4:
+     next ();
+   op(c4):
      cpu_clk -= 2;
      B = and (B, imm_byte ());
-     break;
-   case 0xc5:
+     next ();
+   op(c5):
      cpu_clk -= 2;
      bit (B, imm_byte ());
-     break;
-   case 0xc6:
+     next ();
+   op(c6):
      cpu_clk -= 2;
      B = ld (imm_byte ());
-     break;
-   case 0xc8:
+     next ();
+   op(c8):
      cpu_clk -= 2;
      B = eor (B, imm_byte ());
-     break;
-   case 0xc9:
+     next ();
+   op(c9):
      cpu_clk -= 2;
      B = adc (B, imm_byte ());
-     break;
-   case 0xca:
+     next ();
+   op(ca):
      cpu_clk -= 2;
      B = or (B, imm_byte ());
-     break;
-   case 0xcb:
+     next ();
+   op(cb):
      cpu_clk -= 2;
      B = add (B, imm_byte ());
-     break;
-   case 0xcc:
+     next ();
+   op(cc):
      cpu_clk -= 3;
      ldd (imm_word ());
-     break;
+     next ();
 #ifdef H6309
-   case 0xcd:     /* LDQ immed */
-     break;
+   op(cd): /* LDQ immed */
+     next ();
 #endif
-   case 0xce:
+   op(ce):
      cpu_clk -= 3;
      U = ld16 (imm_word ());
-     break;
+     next ();
 
-   case 0xd0:
+   op(d0):
      direct ();
      cpu_clk -= 4;
      B = sub (B, RDMEM (ea));
-     break;
-   case 0xd1:
+     next ();
+   op(d1):
      direct ();
      cpu_clk -= 4;
      cmp (B, RDMEM (ea));
-     break;
-   case 0xd2:
+     next ();
+   op(d2):
      direct ();
      cpu_clk -= 4;
      B = sbc (B, RDMEM (ea));
-     break;
-   case 0xd3:
+     next ();
+   op(d3):
      direct ();
      cpu_clk -= 4;
      addd (RDMEM16 (ea));
      cpu_clk--;
-     break;
-   case 0xd4:
+     next ();
+   op(d4):
      direct ();
      cpu_clk -= 4;
      B = and (B, RDMEM (ea));
-     break;
-   case 0xd5:
+     next ();
+   op(d5):
      direct ();
      cpu_clk -= 4;
      bit (B, RDMEM (ea));
-     break;
-   case 0xd6:
+     next ();
+   op(d6):
      direct ();
      cpu_clk -= 4;
      B = ld (RDMEM (ea));
-     break;
-   case 0xd7:
+     next ();
+   op(d7):
      direct ();
      cpu_clk -= 4;
      st (B);
-     break;
-   case 0xd8:
+     next ();
+   op(d8):
      direct ();
      cpu_clk -= 4;
      B = eor (B, RDMEM (ea));
-     break;
-   case 0xd9:
+     next ();
+   op(d9):
      direct ();
      cpu_clk -= 4;
      B = adc (B, RDMEM (ea));
-     break;
-   case 0xda:
+     next ();
+   op(da):
      direct ();
      cpu_clk -= 4;
      B = or (B, RDMEM (ea));
-     break;
-   case 0xdb:
+     next ();
+   op(db):
      direct ();
      cpu_clk -= 4;
      B = add (B, RDMEM (ea));
-     break;
-   case 0xdc:
+     next ();
+   op(dc):
      direct ();
      cpu_clk -= 4;
      ldd (RDMEM16 (ea));
-     break;
-   case 0xdd:
+     next ();
+   op(dd):
      direct ();
      cpu_clk -= 4;
      std ();
-     break;
-   case 0xde:
+     next ();
+   op(de):
      direct ();
      cpu_clk -= 4;
      U = ld16 (RDMEM16 (ea));
-     break;
-   case 0xdf:
+     next ();
+   op(df):
      direct ();
      cpu_clk -= 4;
      st16 (U);
-     break;
+     next ();
 
-   case 0xe0:
+   op(e0):
      indexed ();
      B = sub (B, RDMEM (ea));
-     break;
-   case 0xe1:
+     next ();
+   op(e1):
      indexed ();
      cmp (B, RDMEM (ea));
-     break;
-   case 0xe2:
+     next ();
+   op(e2):
      indexed ();
      B = sbc (B, RDMEM (ea));
-     break;
-   case 0xe3:
+     next ();
+   op(e3):
      indexed ();
      addd (RDMEM16 (ea));
      cpu_clk--;
-     break;
-   case 0xe4:
+     next ();
+   op(e4):
      indexed ();
      B = and (B, RDMEM (ea));
-     break;
-   case 0xe5:
+     next ();
+   op(e5):
      indexed ();
      bit (B, RDMEM (ea));
-     break;
-   case 0xe6:
+     next ();
+   op(e6):
      indexed ();
      B = ld (RDMEM (ea));
-     break;
-   case 0xe7:
+     next ();
+   op(e7):
      indexed ();
      st (B);
-     break;
-   case 0xe8:
+     next ();
+   op(e8):
      indexed ();
      B = eor (B, RDMEM (ea));
-     break;
-   case 0xe9:
+     next ();
+   op(e9):
      indexed ();
      B = adc (B, RDMEM (ea));
-     break;
-   case 0xea:
+     next ();
+   op(ea):
      indexed ();
      B = or (B, RDMEM (ea));
-     break;
-   case 0xeb:
+     next ();
+   op(eb):
      indexed ();
      B = add (B, RDMEM (ea));
-     break;
-   case 0xec:
+     next ();
+   op(ec):
      indexed ();
      ldd (RDMEM16 (ea));
-     break;
-   case 0xed:
+     next ();
+   op(ed):
      indexed ();
      std ();
-     break;
-   case 0xee:
+     next ();
+   op(ee):
      indexed ();
      U = ld16 (RDMEM16 (ea));
-     break;
-   case 0xef:
+     next ();
+   op(ef):
      indexed ();
      st16 (U);
-     break;
+     next ();
 
-   case 0xf0:
+   op(f0):
      extended ();
      cpu_clk -= 5;
      B = sub (B, RDMEM (ea));
-     break;
-   case 0xf1:
+     next ();
+   op(f1):
      extended ();
      cpu_clk -= 5;
      cmp (B, RDMEM (ea));
-     break;
-   case 0xf2:
+     next ();
+   op(f2):
      extended ();
      cpu_clk -= 5;
      B = sbc (B, RDMEM (ea));
-     break;
-   case 0xf3:
+     next ();
+   op(f3):
      extended ();
      cpu_clk -= 5;
      addd (RDMEM16 (ea));
      cpu_clk--;
-     break;
-   case 0xf4:
+     next ();
+   op(f4):
      extended ();
      cpu_clk -= 5;
      B = and (B, RDMEM (ea));
-     break;
-   case 0xf5:
+     next ();
+   op(f5):
      extended ();
      cpu_clk -= 5;
      bit (B, RDMEM (ea));
-     break;
-   case 0xf6:
+     next ();
+   op(f6):
      extended ();
      cpu_clk -= 5;
      B = ld (RDMEM (ea));
-     break;
-   case 0xf7:
+     next ();
+   op(f7):
      extended ();
      cpu_clk -= 5;
      st (B);
-     break;
-   case 0xf8:
+     next ();
+   op(f8):
      extended ();
      cpu_clk -= 5;
      B = eor (B, RDMEM (ea));
-     break;
-   case 0xf9:
+     next ();
+   op(f9):
      extended ();
      cpu_clk -= 5;
      B = adc (B, RDMEM (ea));
-     break;
-   case 0xfa:
+     next ();
+   op(fa):
      extended ();
      cpu_clk -= 5;
      B = or (B, RDMEM (ea));
-     break;
-   case 0xfb:
+     next ();
+   op(fb):
      extended ();
      cpu_clk -= 5;
      B = add (B, RDMEM (ea));
-     break;
-   case 0xfc:
+     next ();
+   op(fc):
      extended ();
      cpu_clk -= 5;
      ldd (RDMEM16 (ea));
-     break;
-   case 0xfd:
+     next ();
+   op(fd):
      extended ();
      cpu_clk -= 5;
      std ();
-     break;
-   case 0xfe:
+     next ();
+   op(fe):
      extended ();
      cpu_clk -= 5;
      U = ld16 (RDMEM16 (ea));
-     break;
-   case 0xff:
+     next ();
+   op(ff):
      extended ();
      cpu_clk -= 5;
      st16 (U);
-     break;
+     next ();
+
 
+#ifndef MC6809_THREADED
    default:
+     if (opcode >= 0x1100)
+       goto _illegal11;
+     if (opcode >= 0x1000)
+       goto _illegal10;
+     goto _illegal;
+#endif
+   _illegal:
      cpu_clk -= 2;
      sim_error ("invalid opcode '%02X'\n", opcode);
      PC = iPC;
-     break;
+     next ();
+   _illegal10:
+     sim_error ("invalid opcode (1) at %04x\n", iPC);
+     next ();
+   _illegal11:
+     sim_error ("invalid opcode (2) at %04x\n", iPC);
+     next ();
+#ifdef MC6809_THREADED
+ done:
+#else
    }
-
-   if (cc_changed)
-     cc_modified ();
-
-   tubeUseCycles(1);
-  } while (tubeContinueRunning());
-  //while (cpu_clk > 0);
+      tubeUseCycles(1);
+    } while (tubeContinueRunning());
+#endif
 
   cpu_period -= cpu_clk;
   cpu_clk = cpu_period;
@@ -0,0 +1,347 @@
+// arm2-check.c
+//
+// Checks the decoded instruction cache in mame/arm.c, and its predecoded
+// operands, against the core as it was before them.
+//
+// This is built twice: arm2-check uses the current core, and
+// arm2-check-uncached the previous one, which is kept in arm2-uncached.c.
+// Both run the same random code one instruction at a time, and arm2-check
+// compares the registers of the two after every instruction, the memory
+// around the code after every program, and all of memory every
+// MEMORY_INTERVAL instructions:
+//
+//   arm2-check -s 1 -n 10000000
+//
+// Each program is restarted every few instructions, so that most of it runs
+// from the cache. Some of the registers point into the program so that it
+// often overwrites itself, directly or through the mirrors of RAM above 4MB.
+// Half the instructions are made unconditional, and IRQs and FIQs are
+// requested at random.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#ifdef ARM2_CHECK_UNCACHED
+#define ARM2_NO_DECODE_CACHE
+#include "arm2-uncached.c"
+#else
+#include "../mame/arm.c"
+#endif
+
+// Instructions between new random programs
+#define PROGRAM_LENGTH 64
+
+// Instructions between going back to the start of the program
+#define RESTART_INTERVAL 16
+
+// Instructions between comparing, and then re-randomising, all of memory
+#define MEMORY_INTERVAL 65536
+
+// The memory around the program that is compared after each one
+#define WINDOW_BEFORE 1024
+#define WINDOW_AFTER  2048
+
+// Mismatches to report individually
+#define MAX_REPORTS 10
+
+#define RAM_SIZE (4 * 1024 * 1024)
+#define ROM_SIZE (16 * 1024)
+
+// With RESET pending, arm2_execute_run() returns after each instruction
+volatile int tube_irq;
+
+int native_ula_ticks;
+uint64_t native_cycles;
+
+UINT8 *arm2_ram;
+
+static UINT32 ram[RAM_SIZE / 4];
+static UINT32 rom[ROM_SIZE / 4];
+
+static UINT32 program_base;
+
+static UINT32 io_hash;
+static UINT8 io_counter;
+
+static UINT8 io_read(unsigned int addr)
+{
+   return (UINT8)((addr * 37u) + io_counter++);
+}
+
+static void io_write(unsigned int addr, UINT8 data)
+{
+   io_hash = (io_hash ^ (addr << 8) ^ data) * 16777619u;
+}
+
+// As copro-arm2.c, with RAM mirrored up to 16MB, the Tube registers at
+// 0x01000000 and the ROM at 0x03000000
+UINT8 copro_arm2_read8(unsigned int addr)
+{
+   switch ((addr >> 24) & 3) {
+   case 0:
+      return arm2_ram[addr & ARM2_RAM_MASK8];
+   case 1:
+      return io_read((addr >> 2) & 7);
+   case 3:
+      return ((UINT8 *)rom)[addr & (ROM_SIZE - 1)];
+   default:
+      return 0;
+   }
+}
+
+UINT32 copro_arm2_read32(unsigned int addr)
+{
+   UINT32 result;
+
+   switch ((addr >> 24) & 3) {
+   case 0:
+      result = ram[(addr & ARM2_RAM_MASK32) >> 2];
+      break;
+   case 1:
+      result = io_read((addr >> 2) & 7);
+      break;
+   case 3:
+      result = rom[(addr & (ROM_SIZE - 1)) >> 2];
+      break;
+   default:
+      result = 0;
+   }
+   // Unaligned reads rotate the word
+   return (addr & 3) ? ROR(result, (addr & 3) * 8) : result;
+}
+
+void copro_arm2_write8(unsigned int addr, UINT8 data)
+{
+   switch ((addr >> 24) & 3) {
+   case 0:
+      arm2_ram[addr & ARM2_RAM_MASK8] = data;
+      ARM2_CHECK_CODE_WRITE(addr & ARM2_RAM_MASK32);
+      break;
+   case 1:
+      io_write((addr >> 2) & 7, data);
+      break;
+   }
+}
+
+void copro_arm2_write32(unsigned int addr, UINT32 data)
+{
+   switch ((addr >> 24) & 3) {
+   case 0:
+      ram[(addr & ARM2_RAM_MASK32) >> 2] = data;
+      ARM2_CHECK_CODE_WRITE(addr & ARM2_RAM_MASK32);
+      break;
+   case 1:
+      io_write((addr >> 2) & 7, (UINT8)data);
+      break;
+   }
+}
+
+// Called after the one instruction each arm2_execute_run() is allowed
+void native_ula_tick(void)
+{
+   tube_irq = RESET_BIT;
+}
+
+static void usage(const char *program)
+{
+   fprintf(stderr, "usage: %s [-s <seed>] [-n <instructions>]\n", program);
+   exit(1);
+}
+
+static uint64_t rng_state;
+
+static uint32_t rng(void)
+{
+   rng_state ^= rng_state << 13;
+   rng_state ^= rng_state >> 7;
+   rng_state ^= rng_state << 17;
+   return (uint32_t)rng_state;
+}
+
+static uint32_t memory_hash(const UINT32 *words, uint32_t count)
+{
+   uint32_t hash = 2166136261u;
+   for (uint32_t i = 0; i < count; i++) {
+      hash = (hash ^ words[i]) * 16777619u;
+   }
+   return hash;
+}
+
+// Half of them unconditional, as otherwise the random flags skip half of
+// the code
+static UINT32 random_code(void)
+{
+   UINT32 code = rng();
+   return (rng() & 1) ? (code & ~INSN_COND) | 0xe0000000u : code;
+}
+
+// An address near the program, so writes to it may hit the code; sometimes
+// in a mirror of RAM
+static UINT32 near_program(void)
+{
+   UINT32 addr = program_base + (rng() & 0x3ff) - 0x100;
+   return (rng() & 7) ? addr : addr + (rng() & 3) * RAM_SIZE;
+}
+
+// Start a new random program with random registers
+static void new_program(uint64_t n)
+{
+   if (n % MEMORY_INTERVAL == 0) {
+      for (uint32_t i = 0; i < RAM_SIZE / 4; i++) {
+         ram[i] = random_code();
+      }
+      for (uint32_t i = 0; i < ROM_SIZE / 4; i++) {
+         rom[i] = random_code();
+      }
+#ifdef ARM2_DECODE_CACHE
+      // Written behind the core's back
+      arm2_flush_decode();
+#endif
+   }
+   program_base = (WINDOW_BEFORE + (rng() % (RAM_SIZE - WINDOW_BEFORE - WINDOW_AFTER))) & ~3u;
+   for (uint32_t addr = program_base; addr < program_base + 1024; addr += 4) {
+      ram[addr >> 2] = random_code();
+      ARM2_CHECK_CODE_WRITE(addr);
+   }
+   for (int i = eR0; i < kNumRegisters; i++) {
+      m_sArmRegister[i] = (rng() & 1) ? near_program() : rng();
+   }
+   for (int i = 0; i < 16; i++) {
+      m_coproRegister[i] = rng();
+   }
+   R15 = (rng() & (PSR_MASK | IRQ_MASK | MODE_MASK)) | program_base;
+   m_pendingIrq = 0;
+   m_pendingFiq = 0;
+}
+
+// Set up for instruction n
+static void prepare(uint64_t n)
+{
+   if (n % PROGRAM_LENGTH == 0) {
+      new_program(n);
+   }
+   if (n % RESTART_INTERVAL == 0) {
+      R15 = (R15 & ~ADDRESS_MASK) | program_base;
+   }
+}
+
+// Run one instruction (after any IRQ or FIQ) and describe the state
+// afterwards
+static void step(uint64_t n, char *line, size_t size)
+{
+   uint32_t r = rng();
+   if ((r & 0x3F) == 0) {
+      arm2_execute_set_input(ARM_IRQ_LINE, (r >> 12) & 1);
+   }
+   if ((r & 0xFC0) == 0) {
+      arm2_execute_set_input(ARM_FIRQ_LINE, 1);
+   }
+   tube_irq = 0;
+   native_ula_ticks = 1;
+   arm2_execute_run(1);
+   int len = snprintf(line, size, "%llu", (unsigned long long)n);
+   for (int i = eR0; i < kNumRegisters; i++) {
+      len += snprintf(line + len, size - (size_t)len, " %08X", m_sArmRegister[i]);
+   }
+   for (int i = 0; i < 16; i++) {
+      len += snprintf(line + len, size - (size_t)len, " %08X", m_coproRegister[i]);
+   }
+   len += snprintf(line + len, size - (size_t)len, " %u %u %u", m_pendingIrq, m_pendingFiq, io_counter);
+   if (n % PROGRAM_LENGTH == PROGRAM_LENGTH - 1) {
+      len += snprintf(line + len, size - (size_t)len, " %08X %08X",
+                      memory_hash(ram + (program_base - WINDOW_BEFORE) / 4, (WINDOW_BEFORE + WINDOW_AFTER) / 4), io_hash);
+   }
+   if (n % MEMORY_INTERVAL == MEMORY_INTERVAL - 1) {
+      snprintf(line + len, size - (size_t)len, " %08X", memory_hash(ram, RAM_SIZE / 4));
+   }
+}
+
+static int run_random(uint64_t seed, uint64_t count, const char *program)
+{
+   char line[1024];
+   rng_state = 88172645463325252ULL + seed;
+   arm2_ram = (UINT8 *)ram;
+   arm2_device_reset();
+
+   // The cores report undefined instructions and unaligned writes on
+   // stdout, so the trace goes to a copy of it
+   FILE *trace = fdopen(dup(1), "w");
+   if (!trace || !freopen("/dev/null", "w", stdout)) {
+      perror("stdout");
+      return 1;
+   }
+
+#ifdef ARM2_CHECK_UNCACHED
+   // Print the trace for arm2-check to compare with
+   for (uint64_t n = 0; n < count; n++) {
+      prepare(n);
+      step(n, line, sizeof(line));
+      fprintf(trace, "%s\n", line);
+   }
+   fclose(trace);
+   return 0;
+#else
+   char expected[1024];
+   char command[4096];
+   uint64_t mismatches = 0;
+   uint64_t n;
+
+   fclose(trace);
+
+   // The uncached build is alongside this one
+   const char *slash = strrchr(program, '/');
+   int dir_len = slash ? (int)(slash - program + 1) : 0;
+   snprintf(command, sizeof(command), "%.*sarm2-check-uncached -s %llu -n %llu",
+            dir_len, program, (unsigned long long)seed, (unsigned long long)count);
+   FILE *uncached = popen(command, "r");
+   if (!uncached) {
+      perror(command);
+      return 1;
+   }
+   for (n = 0; n < count; n++) {
+      prepare(n);
+      UINT32 addr = R15 & ADDRESS_MASK;
+      step(n, line, sizeof(line));
+      if (!fgets(expected, sizeof(expected), uncached)) {
+         fprintf(stderr, "arm2-check: %s stopped after %llu instructions\n", command, (unsigned long long)n);
+         mismatches++;
+         break;
+      }
+      expected[strcspn(expected, "\n")] = 0;
+      if (strcmp(line, expected) != 0) {
+         mismatches++;
+         if (mismatches <= MAX_REPORTS) {
+            fprintf(stderr, "arm2-check: after %08X\n  cached:   %s\n  uncached: %s\n", addr, line, expected);
+         }
+      }
+   }
+   pclose(uncached);
+
+   fprintf(stderr, "arm2-check: %llu instructions, %llu mismatches\n",
+           (unsigned long long)n, (unsigned long long)mismatches);
+   return mismatches ? 1 : 0;
+#endif
+}
+
+int main(int argc, char **argv)
+{
+   int opt;
+   uint64_t seed = 1;
+   uint64_t count = 1000000;
+
+   while ((opt = getopt(argc, argv, "s:n:h")) != -1) {
+      switch (opt) {
+      case 's':
+         seed = strtoull(optarg, NULL, 0);
+         break;
+      case 'n':
+         count = strtoull(optarg, NULL, 0);
+         break;
+      default:
+         usage(argv[0]);
+      }
+   }
+   return run_random(seed, count, argv[0]);
+}
@@ -0,0 +1,675 @@
+// cpu80186-flags.c
+//
+// Checks the lazy flag evaluation in cpu80186.c.
+//
+// The reference is the eager flag code that cpu80186.c had before the flags
+// were made lazy, which is copied below. Every 8 bit case, and a sample of
+// the 16 bit ones, of the lazy flag_add8() etc. is compared with it, and so
+// is the op recorded by every instruction in some random code.
+//
+// That doesn't catch a missing sync_flags(), so this is built twice, and
+// both builds run the same random code one instruction at a time.
+// cpu80186-flags-synced calls sync_flags() before each instruction, so the
+// zf, sf, pf, af and of variables are always up to date when it starts.
+// cpu80186-flags instead sets each of them that is stale to the wrong value,
+// so anything that reads one without a sync_flags() goes wrong. It compares
+// the registers and flags of the two after every instruction, and all of
+// RAM every few thousand:
+//
+//   cpu80186-flags -s 1 -n 10000000
+//
+// The flags are read with lazy_zf() etc. rather than through
+// makeflagsword(), so a missing sync_flags() isn't hidden by the check.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../cpu80186/cpu80186.c"
+#include "../cpu80186/mem80186.c"
+#include "../cpu80186/iop80186.c"
+
+// Instructions between new random programs
+#define PROGRAM_LENGTH 64
+
+// Instructions between comparing, and then re-randomising, all of RAM
+#define RAM_INTERVAL 4096
+
+// Mismatches to report individually
+#define MAX_REPORTS 10
+
+volatile unsigned int copro;
+volatile unsigned int copro_speed;
+volatile unsigned int copro_memory_size = ONE_MEG;
+
+// With RESET pending, exec86() returns after each instruction
+volatile int tube_irq = RESET_BIT;
+
+int native_ula_ticks;
+uint64_t native_cycles;
+
+void native_ula_tick(void)
+{
+}
+
+// Covers the Upper RAM alias, which can reach just beyond 1MB
+static uint8_t memory[2 * ONE_MEG];
+
+unsigned char *copro_mem_reset(unsigned int length)
+{
+   memset(memory, 0, sizeof(memory));
+   return memory;
+}
+
+unsigned int copro_80186_tube_read(uint16_t addr)
+{
+   return (addr * 37u + 11u) & 0xFF;
+}
+
+void copro_80186_tube_write(uint16_t addr, uint8_t data)
+{
+}
+
+static uint64_t rng_state;
+
+static uint32_t rng(void)
+{
+   rng_state ^= rng_state << 13;
+   rng_state ^= rng_state >> 7;
+   rng_state ^= rng_state << 17;
+   return (uint32_t)rng_state;
+}
+
+// The flags as the rest of the core would see them, without a sync_flags()
+static uint16_t visible_flags(void)
+{
+   return (uint16_t)(2 | cf | (lazy_pf() << 2) | (lazy_af() << 4) | (lazy_zf() << 6) | (lazy_sf() << 7) |
+                     (tf << 8) | (ifl << 9) | (df << 10) | (lazy_of() << 11));
+}
+
+static uint32_t ram_hash(void)
+{
+   uint32_t hash = 2166136261u;
+   for (uint32_t addr = 0; addr < ONE_MEG; addr++) {
+      hash = (hash ^ RAM[addr]) * 16777619u;
+   }
+   return hash;
+}
+
+// Start a new random program with random registers
+static void new_program(uint64_t n)
+{
+   for (int i = 0; i < 8; i++) {
+      regs.wordregs[i] = (uint16_t)rng();
+   }
+   for (int i = 0; i < 4; i++) {
+      segregs[i] = (uint16_t)rng();
+   }
+   // Trace mode would make every instruction an INT 1
+   decodeflagsword((uint16_t)(rng() & ~0x100u));
+   if (n % RAM_INTERVAL == 0) {
+      for (uint32_t addr = 0; addr < ONE_MEG; addr++) {
+         RAM[addr] = (uint8_t)rng();
+      }
+   }
+   uint32_t base = rng() & 0xFFFFF;
+   segregs[regcs] = (uint16_t)(base >> 4);
+   ip = 0;
+   for (uint32_t i = 0; i < 256; i++) {
+      RAM[(base + i) & 0xFFFFF] = (uint8_t)rng();
+   }
+}
+
+// MOV to and from segment registers 4-7 would index beyond segregs[]
+static void avoid_bad_segreg(void)
+{
+   uint32_t addr = segbase(segregs[regcs]) + ip;
+   for (int i = 0; i < 15; i++, addr++) {
+      uint8_t opcode = RAM[addr & 0xFFFFF];
+      if (opcode == 0x2E || opcode == 0x3E || opcode == 0x26 || opcode == 0x36 || opcode == 0xF2 || opcode == 0xF3) {
+         continue;
+      }
+      if (opcode == 0x8C || opcode == 0x8E) {
+         RAM[(addr + 1) & 0xFFFFF] &= 0xDF;
+      }
+      break;
+   }
+}
+
+// Set up for instruction n
+static void prepare(uint64_t n)
+{
+   if (n % PROGRAM_LENGTH == 0) {
+      new_program(n);
+   }
+   avoid_bad_segreg();
+#ifdef CPU80186_FLAGS_SYNCED
+   sync_flags();
+#else
+   // Logic ops leave AF up to date
+   if (lazy_op != LAZY_NONE) {
+      zf = !lazy_zf();
+      sf = !lazy_sf();
+      pf = !lazy_pf();
+      of = !lazy_of();
+      if (lazy_op > LAZY_LOG16) {
+         af = !lazy_af();
+      }
+   }
+#endif
+}
+
+// Run one instruction and describe the state afterwards
+static void step(uint64_t n, char *line, size_t size)
+{
+   exec86(1);
+   int len = snprintf(line, size, "%llu %04X %04X %04X %04X %04X %04X %04X %04X %04X %04X %04X %04X %04X %04X",
+                      (unsigned long long)n,
+                      regs.wordregs[0], regs.wordregs[1], regs.wordregs[2], regs.wordregs[3],
+                      regs.wordregs[4], regs.wordregs[5], regs.wordregs[6], regs.wordregs[7],
+                      segregs[0], segregs[1], segregs[2], segregs[3], ip, visible_flags());
+   if (n % RAM_INTERVAL == RAM_INTERVAL - 1) {
+      snprintf(line + len, size - (size_t)len, " %08X", ram_hash());
+   }
+}
+
+static void usage(const char *program)
+{
+   fprintf(stderr, "usage: %s [-s <seed>] [-n <instructions>]\n", program);
+   exit(1);
+}
+
+#ifdef CPU80186_FLAGS_SYNCED
+
+int main(int argc, char **argv)
+{
+   int opt;
+   uint64_t seed = 1;
+   uint64_t count = 1000000;
+   char line[256];
+
+   while ((opt = getopt(argc, argv, "s:n:h")) != -1) {
+      switch (opt) {
+      case 's':
+         seed = strtoull(optarg, NULL, 0);
+         break;
+      case 'n':
+         count = strtoull(optarg, NULL, 0);
+         break;
+      default:
+         usage(argv[0]);
+      }
+   }
+   rng_state = 88172645463325252ULL + seed;
+   verbose = 0;
+   Cleari80186Ram();
+   for (uint64_t n = 0; n < count; n++) {
+      prepare(n);
+      step(n, line, sizeof(line));
+      puts(line);
+   }
+   return 0;
+}
+
+#else
+
+// The eager flag code from cpu80186.c, unchanged except that it sets these
+// rather than the core's flags
+
+static uint8_t eager_cf, eager_zf, eager_sf, eager_pf, eager_af, eager_of;
+
+#define cf eager_cf
+#define zf eager_zf
+#define sf eager_sf
+#define pf eager_pf
+#define af eager_af
+#define of eager_of
+#define flag_szp8 eager_flag_szp8
+#define flag_szp16 eager_flag_szp16
+#define flag_log8 eager_flag_log8
+#define flag_log16 eager_flag_log16
+#define flag_adc8 eager_flag_adc8
+#define flag_adc16 eager_flag_adc16
+#define flag_add8 eager_flag_add8
+#define flag_add16 eager_flag_add16
+#define flag_sbb8 eager_flag_sbb8
+#define flag_sbb16 eager_flag_sbb16
+#define flag_sub8 eager_flag_sub8
+#define flag_sub16 eager_flag_sub16
+
+static void flag_szp8(uint8_t value)
+{
+  zf = (!value) ? 1 : 0;															// set or clear zero flag
+  sf = (value & 0x80) ? 1 : 0;												// set or clear sign flag
+  pf = parity[value]; 								// retrieve parity state from lookup table
+}
+
+static void flag_szp16(uint16_t value)
+{
+  zf = (!value) ? 1 : 0;															// set or clear zero flag
+  sf = (value & 0x8000) ? 1 : 0;											// set or clear sign flag
+  pf = parity[value & 0xFF];					// retrieve parity state from lookup table
+}
+
+static void flag_log8(uint8_t value)
+{
+  flag_szp8(value);
+  cf = 0;
+  of = 0; 									// bitwise logic ops always clear carry and overflow
+}
+
+static void flag_log16(uint16_t value)
+{
+  flag_szp16(value);
+  cf = 0;
+  of = 0; 									// bitwise logic ops always clear carry and overflow
+}
+
+static void flag_adc8(uint8_t v1, uint8_t v2, uint8_t v3)					// v1 = destination operand, v2 = source operand, v3 = carry flag
+{
+  uint16_t dst;
+
+  dst = (uint16_t)((uint16_t) v1 + (uint16_t) v2 + (uint16_t) v3);
+  flag_szp8((uint8_t) dst);
+  of = (((dst ^ v1) & (dst ^ v2) & 0x80) == 0x80) ? 1 : 0;          // set or clear overflow flag
+  cf = (dst & 0xFF00) ? 1 : 0;												// set or clear carry flag
+  af = (((v1 ^ v2 ^ dst) & 0x10) == 0x10) ? 1 : 0;					// set or clear auxiliary flag
+}
+
+static void flag_adc16(uint16_t v1, uint16_t v2, uint16_t v3)
+{
+  uint32_t dst;
+
+  dst = (uint32_t) v1 + (uint32_t) v2 + (uint32_t) v3;
+  flag_szp16((uint16_t) dst);
+  of = ((((dst ^ v1) & (dst ^ v2)) & 0x8000) == 0x8000) ? 1 : 0;
+  cf = (dst & 0xFFFF0000) ? 1 : 0;
+  af = (((v1 ^ v2 ^ dst) & 0x10) == 0x10) ? 1 : 0;
+}
+
+static void flag_add8(uint8_t v1, uint8_t v2)					// v1 = destination operand, v2 = source operand
+{
+  uint16_t dst;
+
+  dst = (uint16_t) v1 + (uint16_t) v2;
+  flag_szp8((uint8_t) dst);
+  cf = (dst & 0xFF00) ? 1 : 0;
+  of = (((dst ^ v1) & (dst ^ v2) & 0x80) == 0x80) ? 1 : 0;
+  af = (((v1 ^ v2 ^ dst) & 0x10) == 0x10) ? 1 : 0;
+}
+
+static void flag_add16(uint16_t v1, uint16_t v2)          // v1 = destination operand, v2 = source operand
+{
+  uint32_t dst;
+
+  dst = (uint32_t) v1 + (uint32_t) v2;
+  flag_szp16((uint16_t) dst);
+  cf = (dst & 0xFFFF0000) ? 1 : 0;
+  of = (((dst ^ v1) & (dst ^ v2) & 0x8000) == 0x8000) ? 1 : 0;
+  af = (((v1 ^ v2 ^ dst) & 0x10) == 0x10) ? 1 : 0;
+}
+
+static void flag_sbb8(uint8_t v1, uint8_t v2, uint8_t v3)
+{
+
+  //v1 = destination operand, v2 = source operand, v3 = carry flag */
+  uint16_t dst;
+
+  dst = (uint16_t) ((uint16_t) v1 - (uint16_t) v2 - v3);
+  flag_szp8((uint8_t) dst);
+  if (dst & 0xFF00)
+  {
+    cf = 1;
+  }
+  else
+  {
+    cf = 0;
+  }
+
+  if ((dst ^ v1) & (v1 ^ v2) & 0x80)
+  {
+    of = 1;
+  }
+  else
+  {
+    of = 0;
+  }
+
+  if ((v1 ^ v2 ^ dst) & 0x10)
+  {
+    af = 1;
+  }
+  else
+  {
+    af = 0;
+  }
+}
+
+static void flag_sbb16(uint16_t v1, uint16_t v2, uint16_t v3)
+{
+  /* v1 = destination operand, v2 = source operand, v3 = carry flag */
+  uint32_t dst;
+
+  dst = (uint32_t) v1 - (uint32_t) v2 - v3;
+  flag_szp16((uint16_t) dst);
+  if (dst & 0xFFFF0000)
+  {
+    cf = 1;
+  }
+  else
+  {
+    cf = 0;
+  }
+
+  if ((dst ^ v1) & (v1 ^ v2) & 0x8000)
+  {
+    of = 1;
+  }
+  else
+  {
+    of = 0;
+  }
+
+  if ((v1 ^ v2 ^ dst) & 0x10)
+  {
+    af = 1;
+  }
+  else
+  {
+    af = 0;
+  }
+}
+
+static void flag_sub8(uint8_t v1, uint8_t v2)
+{
+  /* v1 = destination operand, v2 = source operand */
+  uint16_t dst;
+
+  dst = (uint16_t) v1 - (uint16_t) v2;
+  flag_szp8((uint8_t) dst);
+  if (dst & 0xFF00)
+  {
+    cf = 1;
+  }
+  else
+  {
+    cf = 0;
+  }
+
+  if ((dst ^ v1) & (v1 ^ v2) & 0x80)
+  {
+    of = 1;
+  }
+  else
+  {
+    of = 0;
+  }
+
+  if ((v1 ^ v2 ^ dst) & 0x10)
+  {
+    af = 1;
+  }
+  else
+  {
+    af = 0;
+  }
+}
+
+static void flag_sub16(uint16_t v1, uint16_t v2)
+{
+
+  /* v1 = destination operand, v2 = source operand */
+  uint32_t dst;
+
+  dst = (uint32_t) v1 - (uint32_t) v2;
+  flag_szp16((uint16_t) dst);
+  if (dst & 0xFFFF0000)
+  {
+    cf = 1;
+  }
+  else
+  {
+    cf = 0;
+  }
+
+  if ((dst ^ v1) & (v1 ^ v2) & 0x8000)
+  {
+    of = 1;
+  }
+  else
+  {
+    of = 0;
+  }
+
+  if ((v1 ^ v2 ^ dst) & 0x10)
+  {
+    af = 1;
+  }
+  else
+  {
+    af = 0;
+  }
+}
+
+#undef cf
+#undef zf
+#undef sf
+#undef pf
+#undef af
+#undef of
+#undef flag_szp8
+#undef flag_szp16
+#undef flag_log8
+#undef flag_log16
+#undef flag_adc8
+#undef flag_adc16
+#undef flag_add8
+#undef flag_add16
+#undef flag_sbb8
+#undef flag_sbb16
+#undef flag_sub8
+#undef flag_sub16
+
+static uint64_t flag_errors;
+
+static void check_flag(const char *what, const char *flag, uint32_t v1, uint32_t v2, uint32_t v3, uint8_t value, uint8_t expected)
+{
+   if (value != expected) {
+      flag_errors++;
+      if (flag_errors <= MAX_REPORTS) {
+         fprintf(stderr, "cpu80186-flags: %s &%X, &%X, %u gave %s %u, expected %u\n", what, v1, v2, v3, flag, value, expected);
+      }
+   }
+}
+
+// Compare the lazy flags with the eager ones, then again after a sync
+static void check_flags(const char *what, uint32_t v1, uint32_t v2, uint32_t v3)
+{
+   check_flag(what, "CF", v1, v2, v3, cf, eager_cf);
+   check_flag(what, "ZF", v1, v2, v3, lazy_zf(), eager_zf);
+   check_flag(what, "SF", v1, v2, v3, lazy_sf(), eager_sf);
+   check_flag(what, "PF", v1, v2, v3, lazy_pf(), eager_pf);
+   check_flag(what, "AF", v1, v2, v3, lazy_af(), eager_af);
+   check_flag(what, "OF", v1, v2, v3, lazy_of(), eager_of);
+   sync_flags();
+   check_flag(what, "synced ZF", v1, v2, v3, zf, eager_zf);
+   check_flag(what, "synced SF", v1, v2, v3, sf, eager_sf);
+   check_flag(what, "synced PF", v1, v2, v3, pf, eager_pf);
+   check_flag(what, "synced AF", v1, v2, v3, af, eager_af);
+   check_flag(what, "synced OF", v1, v2, v3, of, eager_of);
+}
+
+static void check_helpers(int bits, uint32_t v1, uint32_t v2, uint32_t v3, uint32_t old_af)
+{
+   uint8_t old_cf = cf;
+
+   if (bits == 8) {
+      flag_adc8((uint8_t)v1, (uint8_t)v2, (uint8_t)v3);
+      eager_flag_adc8((uint8_t)v1, (uint8_t)v2, (uint8_t)v3);
+      check_flags("adc8", v1, v2, v3);
+      flag_sbb8((uint8_t)v1, (uint8_t)v2, (uint8_t)v3);
+      eager_flag_sbb8((uint8_t)v1, (uint8_t)v2, (uint8_t)v3);
+      check_flags("sbb8", v1, v2, v3);
+      flag_add8((uint8_t)v1, (uint8_t)v2);
+      eager_flag_add8((uint8_t)v1, (uint8_t)v2);
+      check_flags("add8", v1, v2, 0);
+      flag_sub8((uint8_t)v1, (uint8_t)v2);
+      eager_flag_sub8((uint8_t)v1, (uint8_t)v2);
+      check_flags("sub8", v1, v2, 0);
+      af = eager_af = (uint8_t)old_af;
+      cf = eager_cf = old_cf;
+      flag_log8((uint8_t)v1);
+      eager_flag_log8((uint8_t)v1);
+      check_flags("log8", v1, 0, 0);
+   } else {
+      flag_adc16((uint16_t)v1, (uint16_t)v2, (uint16_t)v3);
+      eager_flag_adc16((uint16_t)v1, (uint16_t)v2, (uint16_t)v3);
+      check_flags("adc16", v1, v2, v3);
+      flag_sbb16((uint16_t)v1, (uint16_t)v2, (uint16_t)v3);
+      eager_flag_sbb16((uint16_t)v1, (uint16_t)v2, (uint16_t)v3);
+      check_flags("sbb16", v1, v2, v3);
+      flag_add16((uint16_t)v1, (uint16_t)v2);
+      eager_flag_add16((uint16_t)v1, (uint16_t)v2);
+      check_flags("add16", v1, v2, 0);
+      flag_sub16((uint16_t)v1, (uint16_t)v2);
+      eager_flag_sub16((uint16_t)v1, (uint16_t)v2);
+      check_flags("sub16", v1, v2, 0);
+      af = eager_af = (uint8_t)old_af;
+      cf = eager_cf = old_cf;
+      flag_log16((uint16_t)v1);
+      eager_flag_log16((uint16_t)v1);
+      check_flags("log16", v1, 0, 0);
+   }
+}
+
+// Every 8 bit case, and a sample of the 16 bit ones
+static void check_formulas(void)
+{
+   for (uint32_t v1 = 0; v1 < 0x100; v1++) {
+      for (uint32_t v2 = 0; v2 < 0x100; v2++) {
+         for (uint32_t v3 = 0; v3 < 2; v3++) {
+            check_helpers(8, v1, v2, v3, v2 & 1);
+         }
+      }
+   }
+   for (int i = 0; i < 1000000; i++) {
+      uint32_t v = rng();
+      check_helpers(16, v & 0xFFFF, rng() & 0xFFFF, (v >> 16) & 1, (v >> 17) & 1);
+   }
+}
+
+// The flags from the op the last instruction recorded, which must be one
+// that the eager code could have been given. INC and DEC keep CF, so it
+// isn't compared. The op is left recorded, so that prepare() still makes the
+// flags it covers stale.
+static void check_record(void)
+{
+   uint32_t mask = (lazy_op & 1) ? 0xFF : 0xFFFF;
+   uint32_t carry = 0;
+   uint8_t op = lazy_op;
+   uint8_t old_cf = cf;
+
+   switch (lazy_op) {
+   case LAZY_NONE:
+      return;
+   case LAZY_LOG8:
+      eager_af = af;
+      eager_flag_log8((uint8_t)lazy_res);
+      break;
+   case LAZY_LOG16:
+      eager_af = af;
+      eager_flag_log16(lazy_res);
+      break;
+   case LAZY_ADD8:
+      carry = (uint32_t)(lazy_res - lazy_v1 - lazy_v2) & mask;
+      eager_flag_adc8((uint8_t)lazy_v1, (uint8_t)lazy_v2, (uint8_t)carry);
+      break;
+   case LAZY_ADD16:
+      carry = (uint32_t)(lazy_res - lazy_v1 - lazy_v2) & mask;
+      eager_flag_adc16(lazy_v1, lazy_v2, (uint16_t)carry);
+      break;
+   case LAZY_SUB8:
+      carry = (uint32_t)(lazy_v1 - lazy_v2 - lazy_res) & mask;
+      eager_flag_sbb8((uint8_t)lazy_v1, (uint8_t)lazy_v2, (uint8_t)carry);
+      break;
+   case LAZY_SUB16:
+      carry = (uint32_t)(lazy_v1 - lazy_v2 - lazy_res) & mask;
+      eager_flag_sbb16(lazy_v1, lazy_v2, (uint16_t)carry);
+      break;
+   }
+   // The carry in would be more than 1 if v1, v2 and res don't go together
+   check_flag("recorded op", "carry in", lazy_v1, lazy_v2, lazy_res, (uint8_t)carry, carry & 1);
+   eager_cf = cf;
+   check_flags("recorded op", lazy_v1, lazy_v2, lazy_res);
+   lazy_op = op;
+   cf = old_cf;
+}
+
+int main(int argc, char **argv)
+{
+   int opt;
+   uint64_t seed = 1;
+   uint64_t count = 1000000;
+   uint64_t mismatches = 0;
+   char line[256];
+   char expected[256];
+   char command[4096];
+
+   while ((opt = getopt(argc, argv, "s:n:h")) != -1) {
+      switch (opt) {
+      case 's':
+         seed = strtoull(optarg, NULL, 0);
+         break;
+      case 'n':
+         count = strtoull(optarg, NULL, 0);
+         break;
+      default:
+         usage(argv[0]);
+      }
+   }
+   rng_state = 88172645463325252ULL + seed;
+   check_formulas();
+   rng_state = 88172645463325252ULL + seed;
+
+   // The synced build is alongside this one
+   const char *slash = strrchr(argv[0], '/');
+   int dir_len = slash ? (int)(slash - argv[0] + 1) : 0;
+   snprintf(command, sizeof(command), "%.*scpu80186-flags-synced -s %llu -n %llu",
+            dir_len, argv[0], (unsigned long long)seed, (unsigned long long)count);
+   FILE *synced = popen(command, "r");
+   if (!synced) {
+      perror(command);
+      return 1;
+   }
+
+   verbose = 0;
+   Cleari80186Ram();
+   uint64_t n;
+   for (n = 0; n < count; n++) {
+      prepare(n);
+      uint16_t cs = segregs[regcs];
+      uint16_t pc = ip;
+      step(n, line, sizeof(line));
+      if (!fgets(expected, sizeof(expected), synced)) {
+         fprintf(stderr, "cpu80186-flags: %s stopped after %llu instructions\n", command, (unsigned long long)n);
+         mismatches++;
+         break;
+      }
+      expected[strcspn(expected, "\n")] = 0;
+      if (strcmp(line, expected) != 0) {
+         mismatches++;
+         if (mismatches <= MAX_REPORTS) {
+            fprintf(stderr, "cpu80186-flags: after %04X:%04X\n  lazy:   %s\n  synced: %s\n", cs, pc, line, expected);
+         }
+      }
+      check_record();
+   }
+   pclose(synced);
+
+   fprintf(stderr, "cpu80186-flags: %llu flag errors, %llu instructions, %llu mismatches\n",
+           (unsigned long long)flag_errors, (unsigned long long)n, (unsigned long long)mismatches);
+   return (flag_errors || mismatches) ? 1 : 0;
+}
+
+#endif
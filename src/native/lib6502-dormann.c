@@ -0,0 +1,257 @@
+// lib6502-dormann.c
+//
+// Runs Klaus Dormann's 6502 and 65C02 functional tests on lib6502.
+//
+// The test binaries are the ones in programs.c, which the 6502 Co Pros load
+// at &3400 and &C000 (tools/dormann has their listings). Each test reports
+// through OSWRCH, and then waits in OSRDCH for a key: it has passed if it
+// printed "All tests completed" by then, and failed otherwise. A test that
+// runs for too long, or hits an undefined instruction, has also failed.
+// The exit status is 1 if any test failed:
+//
+//   lib6502-dormann
+//   lib6502-dormann -t 65c02 -r 20
+//
+// -r runs each test several times over (pressing R), for timing.
+//
+// lib6502-dormann-debug is built with INCLUDE_DEBUGGER, with stub debugger
+// hooks. With -d it switches the debugger on and off every few thousand
+// instructions, so the tests run through both of M6502_run()'s dispatch
+// loops, and the switches between them.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../lib6502.c"
+#include "../programs.c"
+
+// Instructions between calls to native_ula_tick()
+#define TICK_INTERVAL 4096
+
+#define OSRDCH 0xFFE0
+#define OSWRCH 0xFFEE
+
+volatile int tube_irq;
+volatile unsigned int copro = 16;
+
+uint8_t turbo;
+
+int native_ula_ticks = TICK_INTERVAL;
+uint64_t native_cycles;
+
+static uint64_t instructions;
+static uint64_t max_instructions;
+
+// What the test has printed since it last read a key
+static char output[4096];
+static size_t output_len;
+
+static int repeats;
+static int passes;
+static int failed;
+
+copro_def_t copro_defs[1];
+
+unsigned int num_copros()
+{
+   return 0;
+}
+
+char *get_copro_name(unsigned int i, unsigned int maxlen)
+{
+   return "lib6502";
+}
+
+char *get_info_string()
+{
+   return "native";
+}
+
+#ifdef INCLUDE_DEBUGGER
+
+int lib6502_debug_enabled;
+volatile int lib6502_last_PC;
+cpu_debug_t lib6502_cpu_debug;
+
+static uint64_t debug_calls;
+static int switch_debugger;
+
+void debug_preexec(const cpu_debug_t *cpu, uint32_t addr)
+{
+   debug_calls++;
+}
+
+void debug_memread(const cpu_debug_t *cpu, uint32_t addr, uint32_t value, uint8_t size)
+{
+}
+
+void debug_memwrite(const cpu_debug_t *cpu, uint32_t addr, uint32_t value, uint8_t size)
+{
+}
+
+void debug_trap(const cpu_debug_t *cpu, uint32_t addr, int reason)
+{
+}
+
+#endif
+
+void native_ula_tick(void)
+{
+   instructions += TICK_INTERVAL;
+   native_ula_ticks = TICK_INTERVAL;
+   if (instructions >= max_instructions) {
+      tube_irq = RESET_BIT;
+   }
+#ifdef INCLUDE_DEBUGGER
+   if (switch_debugger) {
+      lib6502_debug_enabled = !lib6502_debug_enabled;
+   }
+#endif
+}
+
+static int dormann_poll(M6502 *mpu)
+{
+   // Only used to stop the test
+   return 1;
+}
+
+static int dormann_oswrch(M6502 *mpu, addr_t addr, uint8_t data)
+{
+   uint8_t c = mpu->registers->a;
+   if (c != 13) {
+      putchar(c);
+   }
+   if (output_len < sizeof(output) - 1) {
+      output[output_len++] = (char)c;
+      output[output_len] = 0;
+   }
+   return 0;
+}
+
+static int dormann_osrdch(M6502 *mpu, addr_t addr, uint8_t data)
+{
+   if (tube_irq) {
+      // Already stopping
+      return 0;
+   }
+   if (strstr(output, "All tests completed")) {
+      passes++;
+   } else {
+      failed = 1;
+   }
+   output_len = 0;
+   output[0] = 0;
+   if (failed || passes == repeats) {
+      tube_irq = RESET_BIT;
+      return 0;
+   }
+   // Repeat the test
+   mpu->registers->a = 'R';
+   return addr;
+}
+
+static void usage(const char *program)
+{
+   fprintf(stderr, "usage: %s [-t 6502|65c02] [-r <repeats>] [-n <instructions per repeat>]", program);
+#ifdef INCLUDE_DEBUGGER
+   fprintf(stderr, " [-d]");
+#endif
+   fprintf(stderr, "\n");
+   exit(1);
+}
+
+static int run_test(M6502 *mpu, const char *name, uint16_t start, uint64_t max_per_repeat)
+{
+   struct timespec t0, t1;
+
+   tube_irq = 0;
+   instructions = 0;
+   native_ula_ticks = TICK_INTERVAL;
+   max_instructions = max_per_repeat * (uint64_t)repeats;
+   output_len = 0;
+   output[0] = 0;
+   passes = 0;
+   failed = 0;
+#ifdef INCLUDE_DEBUGGER
+   lib6502_debug_enabled = 0;
+   debug_calls = 0;
+#endif
+
+   memset(mpu->memory, 0, sizeof(M6502_Memory));
+   copy_test_programs(mpu->memory);
+   mpu->memory[OSRDCH] = 0x60;
+   mpu->memory[OSWRCH] = 0x60;
+   mpu->registers->a = 0;
+   mpu->registers->x = 0;
+   mpu->registers->y = 0;
+   mpu->registers->p = 0x34;
+   mpu->registers->s = 0xFF;
+   mpu->registers->pc = start;
+
+   clock_gettime(CLOCK_MONOTONIC, &t0);
+   M6502_run(mpu, dormann_poll);
+   clock_gettime(CLOCK_MONOTONIC, &t1);
+
+   uint64_t count = instructions + (uint64_t)(TICK_INTERVAL - native_ula_ticks);
+   double elapsed = (double)(t1.tv_sec - t0.tv_sec) + (double)(t1.tv_nsec - t0.tv_nsec) / 1e9;
+   int ok = !failed && passes == repeats;
+   printf("\n");
+   fflush(stdout);
+   fprintf(stderr, "lib6502-dormann: %s %s, %d of %d passes, %llu instructions, %.3f s (%.2f MIPS)\n",
+           name, ok ? "passed" : "FAILED", passes, repeats, (unsigned long long)count, elapsed,
+           elapsed > 0 ? (double)count / elapsed / 1e6 : 0.0);
+#ifdef INCLUDE_DEBUGGER
+   fprintf(stderr, "lib6502-dormann: %s: %llu instructions with the debugger enabled\n",
+           name, (unsigned long long)debug_calls);
+#endif
+   return ok ? 0 : 1;
+}
+
+int main(int argc, char **argv)
+{
+   int opt;
+   const char *test = NULL;
+   uint64_t max_per_repeat = 200000000;
+
+   repeats = 1;
+   while ((opt = getopt(argc, argv, "t:r:n:dh")) != -1) {
+      switch (opt) {
+      case 't':
+         test = optarg;
+         break;
+      case 'r':
+         repeats = atoi(optarg);
+         break;
+      case 'n':
+         max_per_repeat = strtoull(optarg, NULL, 0);
+         break;
+#ifdef INCLUDE_DEBUGGER
+      case 'd':
+         switch_debugger = 1;
+         break;
+#endif
+      default:
+         usage(argv[0]);
+      }
+   }
+   if (repeats < 1 || (test && strcmp(test, "6502") && strcmp(test, "65c02"))) {
+      usage(argv[0]);
+   }
+
+   M6502 *mpu = M6502_new(0, 0, 0);
+   M6502_setCallback(mpu, call, OSRDCH, dormann_osrdch);
+   M6502_setCallback(mpu, call, OSWRCH, dormann_oswrch);
+
+   int result = 0;
+   if (!test || !strcmp(test, "6502")) {
+      result |= run_test(mpu, "6502", D6502_START, max_per_repeat);
+   }
+   if (!test || !strcmp(test, "65c02")) {
+      result |= run_test(mpu, "65C02", D65C02_START, max_per_repeat);
+   }
+   M6502_delete(mpu);
+   return result;
+}
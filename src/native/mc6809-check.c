@@ -0,0 +1,299 @@
+// mc6809-check.c
+//
+// Checks the threaded dispatch in mc6809nc/mc6809.c against the switch it
+// replaced.
+//
+// This is built twice: mc6809-check uses the current core, and
+// mc6809-check-switch the previous one, which is kept in mc6809-switch.c.
+// Both run the same random code one instruction at a time, and
+// mc6809-check compares the registers, the cycles used and a hash of the
+// memory writes of the two after every instruction:
+//
+//   mc6809-check -s 1 -n 10000000
+//
+// The code is made from the disassembler's opcode tables (map0, map1 and
+// map2 in mc6809_dis.c), so that it is mostly valid instructions from all
+// three opcode pages, with valid indexed postbytes. Each program is
+// restarted from a reset, with random registers and some of them pointing
+// into the program, and IRQs and FIRQs are requested at random.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef MC6809_CHECK_SWITCH
+#include "mc6809-switch.c"
+#else
+#include "../mc6809nc/mc6809.c"
+#endif
+#include "../mc6809nc/mc6809_dis.c"
+
+// After the core, as it declares sync() before the core's static sync()
+#include <unistd.h>
+
+// Instructions between new random programs
+#define PROGRAM_LENGTH 64
+
+// Instructions between re-randomising all of memory
+#define MEMORY_INTERVAL 65536
+
+// Mismatches to report individually
+#define MAX_REPORTS 10
+
+volatile int tube_irq;
+
+int native_ula_ticks;
+uint64_t native_cycles;
+
+static uint8_t memory[0x10000];
+
+static uint32_t write_hash;
+
+uint8_t copro_mc6809nc_read(uint16_t addr)
+{
+   return memory[addr];
+}
+
+void copro_mc6809nc_write(uint16_t addr, uint8_t data)
+{
+   memory[addr] = data;
+   write_hash = (write_hash ^ ((uint32_t)addr << 8) ^ data) * 16777619u;
+}
+
+// Called after the one instruction each mc6809nc_execute() is allowed
+void native_ula_tick(void)
+{
+   tube_irq = RESET_BIT;
+}
+
+static void usage(const char *program)
+{
+   fprintf(stderr, "usage: %s [-s <seed>] [-n <instructions>]\n", program);
+   exit(1);
+}
+
+static uint64_t rng_state;
+
+static uint32_t rng(void)
+{
+   rng_state ^= rng_state << 13;
+   rng_state ^= rng_state >> 7;
+   rng_state ^= rng_state << 17;
+   return (uint32_t)rng_state;
+}
+
+// Any indexed postbyte that the core doesn't reject
+static uint8_t random_postbyte(void)
+{
+   for (;;) {
+      uint8_t post = (uint8_t)rng();
+      if (!(post & 0x80)) {
+         return post;
+      }
+      switch (post & 0x1F) {
+      case 0x07: case 0x0A: case 0x0E: case 0x0F:
+      case 0x10: case 0x12: case 0x17: case 0x1A: case 0x1E:
+         break;
+      default:
+         return post;
+      }
+   }
+}
+
+// Write a random instruction at addr, and return the address after it
+static uint16_t random_instruction(uint16_t addr)
+{
+   uint8_t prefix = 0;
+   uint8_t opcode, oi, sm;
+
+   for (;;) {
+      uint32_t r = rng();
+      opcode = (uint8_t)r;
+      oi = map0[2 * opcode];
+      sm = map0[2 * opcode + 1];
+      if (oi == OP_UU) {
+         // 0x10 and 0x11 prefix the opcodes in map1 and map2
+         const unsigned char *map = (opcode == 0x10) ? map1 : map2;
+         size_t entries = ((opcode == 0x10) ? sizeof(map1) : sizeof(map2)) / 3;
+         const unsigned char *entry = map + 3 * ((r >> 8) % entries);
+         prefix = opcode;
+         opcode = entry[0];
+         oi = entry[1];
+         sm = entry[2];
+      }
+      if (oi != OP_XX) {
+         break;
+      }
+      prefix = 0;
+   }
+
+   // The length includes any prefix and the postbyte, but no offset after it
+   uint16_t end = (uint16_t)(addr + (sm >> 4));
+   if (prefix) {
+      memory[addr++] = prefix;
+   }
+   memory[addr++] = opcode;
+   while (addr != end) {
+      memory[addr++] = (uint8_t)rng();
+   }
+   if ((sm & 15) == 3) {
+      uint8_t post = random_postbyte();
+      memory[(uint16_t)(end - 1)] = post;
+      if (post & 0x80) {
+         switch (post & 0x1F) {
+         case 0x08: case 0x0C: case 0x18: case 0x1C:
+            memory[addr++] = (uint8_t)rng();
+            break;
+         case 0x09: case 0x0D: case 0x19: case 0x1D: case 0x1F:
+            memory[addr++] = (uint8_t)rng();
+            memory[addr++] = (uint8_t)rng();
+            break;
+         }
+      }
+   }
+   return addr;
+}
+
+static void random_code(uint16_t addr, uint32_t length)
+{
+   for (uint32_t done = 0; done < length; ) {
+      uint16_t next = random_instruction(addr);
+      done += (uint16_t)(next - addr);
+      addr = next;
+   }
+}
+
+// Start a new random program with random registers
+static void new_program(uint64_t n)
+{
+   if (n % MEMORY_INTERVAL == 0) {
+      random_code(0, 0x10000);
+   }
+   uint16_t base = (uint16_t)rng();
+   random_code(base, 256);
+
+   mc6809nc_reset();
+   set_a(rng() & 0xFF);
+   set_b(rng() & 0xFF);
+   set_dp(rng() & 0xFF);
+   // Pointing into the program, so that writes through them may hit it
+   set_x((rng() & 1) ? base + (rng() & 0xFF) : rng() & 0xFFFF);
+   set_y((rng() & 1) ? base + (rng() & 0xFF) : rng() & 0xFFFF);
+   set_u((rng() & 1) ? base + (rng() & 0xFF) + 0x40 : rng() & 0xFFFF);
+   set_s((rng() & 1) ? base + (rng() & 0xFF) + 0x40 : rng() & 0xFFFF);
+   set_cc(rng() & 0xFF);
+   set_pc(base);
+}
+
+// Set up for instruction n
+static void prepare(uint64_t n)
+{
+   if (n % PROGRAM_LENGTH == 0) {
+      new_program(n);
+   }
+}
+
+// Run one instruction (after any IRQ or FIRQ) and describe the state
+// afterwards
+static void step(uint64_t n, char *line, size_t size)
+{
+   uint32_t r = rng();
+   if ((r & 0x3F) == 0) {
+      mc6809nc_request_irq(1);
+   }
+   if ((r & 0xFC0) == 0) {
+      mc6809nc_request_firq(1);
+   }
+   tube_irq = 0;
+   native_ula_ticks = 1;
+   int cycles = mc6809nc_execute(1);
+   snprintf(line, size, "%llu %02X %02X %04X %04X %04X %04X %04X %02X %02X %d %08X",
+            (unsigned long long)n, get_a(), get_b(), get_x(), get_y(), get_u(), get_s(), get_pc(),
+            get_dp(), get_cc(), cycles, write_hash);
+}
+
+static int run_random(uint64_t seed, uint64_t count, const char *program)
+{
+   char line[256];
+   rng_state = 88172645463325252ULL + seed;
+
+   // The cores report bad opcodes and postbytes on stdout, so the trace goes
+   // to a copy of it
+   FILE *trace = fdopen(dup(1), "w");
+   if (!trace || !freopen("/dev/null", "w", stdout)) {
+      perror("stdout");
+      return 1;
+   }
+
+#ifdef MC6809_CHECK_SWITCH
+   // Print the trace for mc6809-check to compare with
+   for (uint64_t n = 0; n < count; n++) {
+      prepare(n);
+      step(n, line, sizeof(line));
+      fprintf(trace, "%s\n", line);
+   }
+   fclose(trace);
+   return 0;
+#else
+   char expected[256];
+   char command[4096];
+   uint64_t mismatches = 0;
+   uint64_t n;
+
+   fclose(trace);
+
+   // The switch build is alongside this one
+   const char *slash = strrchr(program, '/');
+   int dir_len = slash ? (int)(slash - program + 1) : 0;
+   snprintf(command, sizeof(command), "%.*smc6809-check-switch -s %llu -n %llu",
+            dir_len, program, (unsigned long long)seed, (unsigned long long)count);
+   FILE *reference = popen(command, "r");
+   if (!reference) {
+      perror(command);
+      return 1;
+   }
+   for (n = 0; n < count; n++) {
+      prepare(n);
+      uint16_t addr = get_pc();
+      step(n, line, sizeof(line));
+      if (!fgets(expected, sizeof(expected), reference)) {
+         fprintf(stderr, "mc6809-check: %s stopped after %llu instructions\n", command, (unsigned long long)n);
+         mismatches++;
+         break;
+      }
+      expected[strcspn(expected, "\n")] = 0;
+      if (strcmp(line, expected) != 0) {
+         mismatches++;
+         if (mismatches <= MAX_REPORTS) {
+            fprintf(stderr, "mc6809-check: after %04X\n  threaded: %s\n  switch:   %s\n", addr, line, expected);
+         }
+      }
+   }
+   pclose(reference);
+
+   fprintf(stderr, "mc6809-check: %llu instructions, %llu mismatches\n",
+           (unsigned long long)n, (unsigned long long)mismatches);
+   return mismatches ? 1 : 0;
+#endif
+}
+
+int main(int argc, char **argv)
+{
+   int opt;
+   uint64_t seed = 1;
+   uint64_t count = 1000000;
+
+   while ((opt = getopt(argc, argv, "s:n:h")) != -1) {
+      switch (opt) {
+      case 's':
+         seed = strtoull(optarg, NULL, 0);
+         break;
+      case 'n':
+         count = strtoull(optarg, NULL, 0);
+         break;
+      default:
+         usage(argv[0]);
+      }
+   }
+   return run_random(seed, count, argv[0]);
+}
@@ -0,0 +1,981 @@
+// native-mos.c
+//
+// A minimal BBC Micro MOS and Tube host, used by the native build
+//
+// This runs as the host coroutine (see native-ula.c) and speaks the
+// Acorn Tube protocol to whichever client ROM the Co Pro is running:
+//
+//   R1 parasite to host : VDU stream
+//   R2 parasite to host : MOS calls (RDCH, OSCLI, OSBYTE, OSWORD, ...)
+//   R2 host to parasite : MOS call results
+//   R4 host to parasite : data transfer set up and errors
+//   R3                  : data transfer bytes
+//
+// Input comes from the configured command lines and then from a FILE.
+// When the input runs out the session is ended by selecting a different
+// Co Pro (as *FX 151,230,N would) and asserting RST, which makes the
+// emulator loop return.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <time.h>
+#include <dirent.h>
+#include "../tube.h"
+#include "native-ula.h"
+#include "native-mos.h"
+
+#define R1STAT 0
+#define R1DATA 1
+#define R2STAT 2
+#define R2DATA 3
+#define R3STAT 4
+#define R3DATA 5
+#define R4STAT 6
+#define R4DATA 7
+
+#define STAT_DATA_AVAILABLE 0x80
+#define STAT_NOT_FULL       0x40
+
+// Host control register (written to R1STAT), bit 7 selects set/clear
+#define CTRL_SET   0x80
+#define CTRL_M     0x08
+
+// Co Pro instructions to wait before releasing the tube after a transfer
+#define RELEASE_DELAY 64
+
+// R4 transfer types
+#define TUBE_TYPE_FROM_PARASITE 0
+#define TUBE_TYPE_TO_PARASITE   1
+#define TUBE_TYPE_EXECUTE       4
+#define TUBE_TYPE_RELEASE       5
+
+// Claim ID used for all host initiated transfers
+#define TUBE_ID 0x3F
+
+#define NUM_HANDLES 8
+#define FIRST_HANDLE 0x30
+
+static native_mos_config_t *cfg;
+
+static unsigned int wait_addr;
+static uint8_t wait_mask;
+
+static int next_command;
+static char line[256];
+static int line_pos;
+static int line_len;
+static int vdu_queue;
+static int column;
+
+static struct timespec time_origin;
+static int64_t time_offset;
+
+static FILE *handles[NUM_HANDLES];
+
+// Host memory, only visible through OSWORD 5 and 6
+static uint8_t io_memory[0x10000];
+
+// ============================================================
+// Low level register access
+// ============================================================
+
+static int status_set(void)
+{
+   return native_host_read(wait_addr) & wait_mask;
+}
+
+static void wait_status(unsigned int addr, uint8_t mask)
+{
+   wait_addr = addr;
+   wait_mask = mask;
+   native_host_wait(status_set);
+}
+
+static uint8_t reg_read(unsigned int addr)
+{
+   wait_status(addr - 1, STAT_DATA_AVAILABLE);
+   return native_host_read(addr);
+}
+
+static void reg_write(unsigned int addr, uint8_t data)
+{
+   wait_status(addr - 1, STAT_NOT_FULL);
+   native_host_write(addr, data);
+}
+
+static uint8_t r2_read(void)
+{
+   return reg_read(R2DATA);
+}
+
+static void r2_write(uint8_t data)
+{
+   reg_write(R2DATA, data);
+}
+
+static uint32_t r2_read_word(void)
+{
+   // Words are sent most significant byte first
+   uint32_t word = 0;
+   for (int i = 0; i < 4; i++) {
+      word = (word << 8) | r2_read();
+   }
+   return word;
+}
+
+static void r2_write_word(uint32_t word)
+{
+   for (int i = 3; i >= 0; i--) {
+      r2_write((uint8_t)(word >> (i * 8)));
+   }
+}
+
+static void r2_read_string(char *buf, int len)
+{
+   int i = 0;
+   uint8_t c;
+   while ((c = r2_read()) != 13) {
+      if (i < len - 1) {
+         buf[i++] = (char)c;
+      }
+   }
+   buf[i] = 0;
+}
+
+// ============================================================
+// VDU output
+// ============================================================
+
+// Number of parameter bytes following each VDU control code
+static const uint8_t vdu_params[32] = {
+   0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+   0, 1, 2, 5, 0, 0, 1, 9, 8, 5, 0, 0, 4, 4, 0, 2
+};
+
+static void vdu_write(uint8_t c)
+{
+   if (cfg->raw_vdu) {
+      putchar(c);
+      return;
+   }
+   if (vdu_queue) {
+      vdu_queue--;
+      return;
+   }
+   if (c < 32) {
+      vdu_queue = vdu_params[c];
+      if (c == 10) {
+         putchar('\n');
+         column = 0;
+      } else if (c == 8 && column > 0) {
+         column--;
+      }
+   } else if (c < 127) {
+      putchar(c);
+      column++;
+   }
+}
+
+static void service_r1(void)
+{
+   while (native_host_read(R1STAT) & STAT_DATA_AVAILABLE) {
+      vdu_write(native_host_read(R1DATA));
+   }
+}
+
+// ============================================================
+// Input
+// ============================================================
+
+static int next_line(void)
+{
+   fflush(stdout);
+   if (next_command < cfg->num_commands) {
+      strncpy(line, cfg->commands[next_command++], sizeof(line) - 1);
+      line[sizeof(line) - 1] = 0;
+   } else if (!cfg->input || !fgets(line, sizeof(line), cfg->input)) {
+      return 0;
+   }
+   line_len = (int)strcspn(line, "\r\n");
+   line[line_len] = 0;
+   line_pos = 0;
+   return 1;
+}
+
+void native_mos_end(void)
+{
+   fflush(stdout);
+   // Select a different Co Pro, then reset, so the emulator loop exits
+   native_host_write(6, (uint8_t)(copro | 0x80));
+   native_host_set_rst(1);
+   native_host_yield();
+   // Some Co Pros wait for the reset to be released before checking
+   native_host_set_rst(0);
+   while (1) {
+      native_host_yield();
+   }
+}
+
+// ============================================================
+// Files
+// ============================================================
+
+static void host_error(uint8_t num, const char *msg)
+{
+   reg_write(R4DATA, 0xFF);
+   r2_write(0x00);
+   r2_write(num);
+   while (*msg) {
+      r2_write((uint8_t)*msg++);
+   }
+   r2_write(0x00);
+}
+
+static void file_path(char *path, size_t len, const char *name)
+{
+   // Strip any drive and directory prefix, e.g. :0.$.NAME
+   const char *p = strrchr(name, '.');
+   if (p && (p - name) <= 4) {
+      name = p + 1;
+   }
+   snprintf(path, len, "%s/%s", cfg->dir ? cfg->dir : ".", name);
+   // Fall back to a case insensitive match, as the Acorn filing systems are
+   DIR *d = opendir(cfg->dir ? cfg->dir : ".");
+   if (d) {
+      struct dirent *e;
+      while ((e = readdir(d))) {
+         if (!strcasecmp(e->d_name, name)) {
+            snprintf(path, len, "%s/%s", cfg->dir ? cfg->dir : ".", e->d_name);
+            break;
+         }
+      }
+      closedir(d);
+   }
+}
+
+static uint8_t *file_load(const char *name, uint32_t *length, uint32_t *load, uint32_t *exec)
+{
+   char path[512];
+   char inf[520];
+   file_path(path, sizeof(path), name);
+   FILE *f = fopen(path, "rb");
+   if (!f) {
+      return NULL;
+   }
+   fseek(f, 0, SEEK_END);
+   long size = ftell(f);
+   fseek(f, 0, SEEK_SET);
+   uint8_t *data = malloc(size ? (size_t)size : 1);
+   if (!data || fread(data, 1, (size_t)size, f) != (size_t)size) {
+      free(data);
+      fclose(f);
+      return NULL;
+   }
+   fclose(f);
+   *length = (uint32_t)size;
+   // Pick up the load/exec addresses from a .inf file if there is one
+   snprintf(inf, sizeof(inf), "%s.inf", path);
+   f = fopen(inf, "r");
+   if (f) {
+      char fname[256];
+      unsigned int l, e;
+      if (fscanf(f, "%255s %x %x", fname, &l, &e) == 3) {
+         *load = l;
+         *exec = e;
+      }
+      fclose(f);
+   }
+   return data;
+}
+
+static int file_save(const char *name, uint8_t *data, uint32_t length, uint32_t load, uint32_t exec)
+{
+   char path[512];
+   char inf[520];
+   file_path(path, sizeof(path), name);
+   FILE *f = fopen(path, "wb");
+   if (!f) {
+      return 0;
+   }
+   fwrite(data, 1, length, f);
+   fclose(f);
+   snprintf(inf, sizeof(inf), "%s.inf", path);
+   f = fopen(inf, "w");
+   if (f) {
+      fprintf(f, "%s %08X %08X %08X\n", name, load, exec, length);
+      fclose(f);
+   }
+   return 1;
+}
+
+// ============================================================
+// Data transfers
+// ============================================================
+
+static void transfer_start(uint8_t type, uint32_t addr)
+{
+   reg_write(R4DATA, type);
+   reg_write(R4DATA, TUBE_ID);
+   if (type == TUBE_TYPE_RELEASE) {
+      return;
+   }
+   for (int i = 3; i >= 0; i--) {
+      reg_write(R4DATA, (uint8_t)(addr >> (i * 8)));
+   }
+   // Synchronisation byte
+   reg_write(R4DATA, type);
+}
+
+static void transfer_to_parasite(uint32_t addr, uint8_t *data, uint32_t length)
+{
+   transfer_start(TUBE_TYPE_TO_PARASITE, addr);
+   // The client flushes R3 before it reads the sync byte, so don't
+   // send any data until the sync byte has been taken
+   wait_status(R4STAT, STAT_NOT_FULL);
+   for (uint32_t i = 0; i < length; i++) {
+      reg_write(R3DATA, data[i]);
+   }
+   // Wait for the last byte to be taken before releasing the tube
+   wait_status(R3STAT, STAT_NOT_FULL);
+   transfer_start(TUBE_TYPE_RELEASE, 0);
+}
+
+static void transfer_from_parasite(uint32_t addr, uint8_t *data, uint32_t length)
+{
+   transfer_start(TUBE_TYPE_FROM_PARASITE, addr);
+   // Wait for the parasite to take the sync byte, then trigger the first
+   // NMI: either by flushing a stale byte left in R3, or if R3 is already
+   // empty by re-enabling NMIs, as the real host code does on every
+   // transfer
+   wait_status(R4STAT, STAT_NOT_FULL);
+   if (native_host_read(R3STAT) & STAT_DATA_AVAILABLE) {
+      native_host_read(R3DATA);
+   } else {
+      native_host_write(R1STAT, CTRL_M);
+      native_host_write(R1STAT, CTRL_SET | CTRL_M);
+   }
+   for (uint32_t i = 0; i < length; i++) {
+      data[i] = reg_read(R3DATA);
+   }
+   // Reading the last byte raises one more NMI, give the parasite a
+   // chance to service it before the release arrives, as it would with
+   // a real (much slower) host
+   native_host_sleep(RELEASE_DELAY);
+   transfer_start(TUBE_TYPE_RELEASE, 0);
+}
+
+static int load_file(const char *name, uint32_t addr, int use_file_addr, uint32_t *exec)
+{
+   uint32_t length = 0;
+   uint32_t load = addr;
+   uint32_t file_exec = addr;
+   uint8_t *data = file_load(name, &length, &load, &file_exec);
+   if (!data) {
+      host_error(214, "Not found");
+      return 0;
+   }
+   if (!use_file_addr) {
+      load = addr;
+   }
+   transfer_to_parasite(load, data, length);
+   free(data);
+   if (exec) {
+      *exec = file_exec;
+   }
+   return 1;
+}
+
+static int save_file(const char *name, uint32_t start, uint32_t end, uint32_t load, uint32_t exec)
+{
+   uint32_t length = end - start;
+   uint8_t *data = malloc(length ? length : 1);
+   if (!data) {
+      host_error(192, "No room");
+      return 0;
+   }
+   transfer_from_parasite(start, data, length);
+   int ok = file_save(name, data, length, load, exec);
+   free(data);
+   if (!ok) {
+      host_error(193, "Can't save");
+   }
+   return ok;
+}
+
+// ============================================================
+// MOS calls
+// ============================================================
+
+static uint32_t centiseconds(void)
+{
+   struct timespec now;
+   clock_gettime(CLOCK_MONOTONIC, &now);
+   int64_t cs = (now.tv_sec - time_origin.tv_sec) * 100 + (now.tv_nsec - time_origin.tv_nsec) / 10000000;
+   return (uint32_t)(cs + time_offset);
+}
+
+static void mos_rdch(void)
+{
+   uint8_t c;
+   if (line_pos > line_len && !next_line()) {
+      native_mos_end();
+   }
+   if (line_pos < line_len) {
+      c = (uint8_t)line[line_pos];
+   } else {
+      c = 13;
+   }
+   line_pos++;
+   r2_write(0x00);
+   r2_write(c);
+}
+
+static void mos_rdline(void)
+{
+   // Block bytes 4, 3, 2 (max char, min char, max length) then the
+   // buffer address (&0700), which the host side can ignore
+   uint8_t max_char = r2_read();
+   uint8_t min_char = r2_read();
+   uint8_t max_len = r2_read();
+   r2_read();
+   r2_read();
+   if (!next_line()) {
+      native_mos_end();
+   }
+   // Echo the line, as the MOS would while it was being typed
+   fputs(line, stdout);
+   putchar('\n');
+   column = 0;
+   r2_write(0x7F);
+   for (int i = 0; i < line_len && i < max_len; i++) {
+      uint8_t c = (uint8_t)line[i];
+      if (c >= min_char && c <= max_char) {
+         r2_write(c);
+      }
+   }
+   r2_write(13);
+   // Consume the line, so a following RDCH asks for the next one
+   line_pos = line_len + 1;
+}
+
+static FILE *get_handle(uint8_t handle)
+{
+   unsigned int h = (unsigned int)handle - FIRST_HANDLE;
+   return h < NUM_HANDLES ? handles[h] : NULL;
+}
+
+static int file_eof(uint8_t handle)
+{
+   FILE *f = get_handle(handle);
+   if (!f) {
+      return 1;
+   }
+   int c = fgetc(f);
+   if (c == EOF) {
+      return 1;
+   }
+   ungetc(c, f);
+   return 0;
+}
+
+static void mos_osbyte(uint8_t a, uint8_t *x, uint8_t *y, int *carry)
+{
+   *carry = 0;
+   switch (a) {
+   case 0x00:
+      // OS version: OS 1.20
+      *x = 1;
+      break;
+   case 0x7A:
+      // Keyboard scan: no key pressed
+      *x = 0xFF;
+      break;
+   case 0x7F:
+      // EOF check
+      *x = file_eof(*x) ? 0xFF : 0x00;
+      break;
+   case 0x82:
+      // Machine high order address
+      *x = 0xFF;
+      *y = 0xFF;
+      break;
+   case 0x83:
+      // OSHWM
+      *x = 0x00;
+      *y = 0x0E;
+      break;
+   case 0x84:
+      // HIMEM
+      *x = 0x00;
+      *y = 0x80;
+      break;
+   case 0x86:
+      // Text cursor position
+      *x = (uint8_t)column;
+      *y = 0;
+      break;
+   case 0x87:
+      // Character at cursor and screen mode
+      *x = 0;
+      *y = 7;
+      break;
+   case 0xFD:
+      // Last break type: power on
+      *x = 1;
+      break;
+   default:
+      *x = 0;
+      *y = 0;
+      break;
+   }
+}
+
+static void mos_osword(uint8_t a, uint8_t *block)
+{
+   uint32_t t;
+   switch (a) {
+   case 0x01:
+      // Read system clock
+      t = centiseconds();
+      memset(block, 0, 5);
+      for (int i = 0; i < 4; i++) {
+         block[i] = (uint8_t)(t >> (i * 8));
+      }
+      break;
+   case 0x02:
+      // Write system clock
+      t = block[0] | (block[1] << 8) | (block[2] << 16) | ((uint32_t)block[3] << 24);
+      time_offset += (int64_t)t - (int64_t)centiseconds();
+      break;
+   case 0x05:
+      // Read I/O processor memory
+      block[4] = io_memory[block[0] | (block[1] << 8)];
+      break;
+   case 0x06:
+      // Write I/O processor memory
+      io_memory[block[0] | (block[1] << 8)] = block[4];
+      break;
+   default:
+      break;
+   }
+}
+
+static int parse_hex(char **p, uint32_t *value)
+{
+   char *end;
+   while (**p == ' ') {
+      (*p)++;
+   }
+   if (**p == '&') {
+      (*p)++;
+   }
+   *value = (uint32_t)strtoul(*p, &end, 16);
+   if (end == *p) {
+      return 0;
+   }
+   *p = end;
+   return 1;
+}
+
+static char *parse_name(char **p)
+{
+   while (**p == ' ') {
+      (*p)++;
+   }
+   char *name = *p;
+   while (**p && **p != ' ') {
+      (*p)++;
+   }
+   if (**p) {
+      *(*p)++ = 0;
+   }
+   return name;
+}
+
+static int match_command(char **p, const char *cmd)
+{
+   size_t n = strlen(cmd);
+   if (strncasecmp(*p, cmd, n) || isalpha((unsigned char)(*p)[n])) {
+      return 0;
+   }
+   *p += n;
+   return 1;
+}
+
+static void mos_oscli(void)
+{
+   char buf[256];
+   char *p = buf;
+   uint32_t addr;
+   uint32_t exec;
+   r2_read_string(buf, sizeof(buf));
+   while (*p == ' ' || *p == '*') {
+      p++;
+   }
+   if (match_command(&p, "LOAD")) {
+      char *name = parse_name(&p);
+      int use_file_addr = !parse_hex(&p, &addr);
+      if (!load_file(name, addr, use_file_addr, NULL)) {
+         return;
+      }
+   } else if (match_command(&p, "RUN") || *p == '/') {
+      if (*p == '/') {
+         p++;
+      }
+      char *name = parse_name(&p);
+      if (!load_file(name, 0, 1, &exec)) {
+         return;
+      }
+      transfer_start(TUBE_TYPE_EXECUTE, exec);
+      r2_write(0x80);
+      if (cfg->on_execute) {
+         cfg->on_execute();
+      }
+      return;
+   } else if (match_command(&p, "SAVE")) {
+      uint32_t start, end, load;
+      char *name = parse_name(&p);
+      if (!parse_hex(&p, &start)) {
+         host_error(252, "Bad address");
+         return;
+      }
+      while (*p == ' ') {
+         p++;
+      }
+      if (*p == '+') {
+         p++;
+         if (!parse_hex(&p, &end)) {
+            host_error(252, "Bad address");
+            return;
+         }
+         end += start;
+      } else if (!parse_hex(&p, &end)) {
+         host_error(252, "Bad address");
+         return;
+      }
+      if (!parse_hex(&p, &exec)) {
+         exec = start;
+      }
+      if (!parse_hex(&p, &load)) {
+         load = start;
+      }
+      if (!save_file(name, start, end, load, exec)) {
+         return;
+      }
+   } else if (match_command(&p, "HELP")) {
+      fputs("\nOS 1.20\n", stdout);
+      column = 0;
+   } else if (match_command(&p, "FX") || match_command(&p, "TV") ||
+              match_command(&p, "KEY") || match_command(&p, "OPT") ||
+              match_command(&p, "ADFS") || match_command(&p, "FADFS") ||
+              match_command(&p, "DISC") || match_command(&p, "DISK") || *p == 0) {
+      // Accepted and ignored
+   } else {
+      host_error(254, "Bad command");
+      return;
+   }
+   r2_write(0x7F);
+}
+
+static void mos_osfile(void)
+{
+   uint8_t block[18];
+   char name[256];
+   for (int i = 17; i >= 2; i--) {
+      block[i] = r2_read();
+   }
+   r2_read_string(name, sizeof(name));
+   uint8_t a = r2_read();
+   uint32_t load = block[2] | (block[3] << 8) | (block[4] << 16) | ((uint32_t)block[5] << 24);
+   uint32_t exec = block[6] | (block[7] << 8) | (block[8] << 16) | ((uint32_t)block[9] << 24);
+   uint32_t start = block[10] | (block[11] << 8) | (block[12] << 16) | ((uint32_t)block[13] << 24);
+   uint32_t end = block[14] | (block[15] << 8) | (block[16] << 16) | ((uint32_t)block[17] << 24);
+   uint32_t length = 0;
+   uint32_t info_load = load;
+   uint32_t info_exec = exec;
+   uint8_t type = 1;
+   uint8_t *data;
+   switch (a) {
+   case 0x00:
+      // Save a block of memory
+      if (!save_file(name, start, end, load, exec)) {
+         return;
+      }
+      length = end - start;
+      info_load = load;
+      info_exec = exec;
+      break;
+   case 0xFF:
+      // Load a file, at its own address if the exec address LSB is non-zero
+      data = file_load(name, &length, &info_load, &info_exec);
+      if (!data) {
+         host_error(214, "Not found");
+         return;
+      }
+      transfer_to_parasite(block[6] ? info_load : load, data, length);
+      free(data);
+      break;
+   case 0x05:
+      // Read catalogue information
+      data = file_load(name, &length, &info_load, &info_exec);
+      if (data) {
+         free(data);
+      } else {
+         type = 0;
+      }
+      break;
+   default:
+      // Writing attributes and deleting are not supported
+      type = 0;
+      break;
+   }
+   if (type) {
+      for (int i = 0; i < 4; i++) {
+         block[2 + i] = (uint8_t)(info_load >> (i * 8));
+         block[6 + i] = (uint8_t)(info_exec >> (i * 8));
+         block[10 + i] = (uint8_t)(length >> (i * 8));
+         block[14 + i] = 0;
+      }
+   }
+   r2_write(type);
+   for (int i = 17; i >= 2; i--) {
+      r2_write(block[i]);
+   }
+}
+
+static void mos_osfind(void)
+{
+   char name[256];
+   char path[512];
+   uint8_t a = r2_read();
+   if (a == 0) {
+      uint8_t handle = r2_read();
+      FILE *f = get_handle(handle);
+      if (f) {
+         fclose(f);
+         handles[handle - FIRST_HANDLE] = NULL;
+      }
+      r2_write(0x7F);
+      return;
+   }
+   r2_read_string(name, sizeof(name));
+   file_path(path, sizeof(path), name);
+   uint8_t result = 0;
+   for (int h = 0; h < NUM_HANDLES; h++) {
+      if (!handles[h]) {
+         const char *mode = (a & 0xC0) == 0x40 ? "rb" : (a & 0xC0) == 0x80 ? "wb" : "r+b";
+         handles[h] = fopen(path, mode);
+         if (handles[h]) {
+            result = (uint8_t)(h + FIRST_HANDLE);
+         }
+         break;
+      }
+   }
+   r2_write(result);
+}
+
+static void mos_osargs(void)
+{
+   uint8_t handle = r2_read();
+   uint32_t data = r2_read_word();
+   uint8_t a = r2_read();
+   FILE *f = get_handle(handle);
+   if (f) {
+      long pos;
+      switch (a) {
+      case 0x00:
+         data = (uint32_t)ftell(f);
+         break;
+      case 0x01:
+         fseek(f, (long)data, SEEK_SET);
+         break;
+      case 0x02:
+         pos = ftell(f);
+         fseek(f, 0, SEEK_END);
+         data = (uint32_t)ftell(f);
+         fseek(f, pos, SEEK_SET);
+         break;
+      default:
+         break;
+      }
+   } else if (handle == 0 && a == 0) {
+      // Filing system number: DFS
+      a = 4;
+   }
+   r2_write(a);
+   r2_write_word(data);
+}
+
+static void mos_osbget(void)
+{
+   FILE *f = get_handle(r2_read());
+   int c = f ? fgetc(f) : EOF;
+   r2_write(c == EOF ? 0x80 : 0x00);
+   r2_write(c == EOF ? 0xFE : (uint8_t)c);
+}
+
+static void mos_osbput(void)
+{
+   FILE *f = get_handle(r2_read());
+   uint8_t c = r2_read();
+   if (f) {
+      fputc(c, f);
+   }
+   r2_write(0x7F);
+}
+
+static void mos_osgbpb(void)
+{
+   uint8_t block[13];
+   for (int i = 12; i >= 0; i--) {
+      block[i] = r2_read();
+   }
+   uint8_t a = r2_read();
+   // Not supported: return the block unchanged with carry set
+   for (int i = 12; i >= 0; i--) {
+      r2_write(block[i]);
+   }
+   r2_write(0x80);
+   r2_write(a);
+}
+
+static void service_r2(void)
+{
+   uint8_t a, x, y;
+   int carry;
+   uint8_t block[256];
+   uint8_t cmd = native_host_read(R2DATA);
+   switch (cmd) {
+   case 0x00:
+      mos_rdch();
+      break;
+   case 0x02:
+      mos_oscli();
+      break;
+   case 0x04:
+      x = r2_read();
+      a = r2_read();
+      mos_osbyte(a, &x, &y, &carry);
+      r2_write(x);
+      break;
+   case 0x06:
+      x = r2_read();
+      y = r2_read();
+      a = r2_read();
+      mos_osbyte(a, &x, &y, &carry);
+      if (a != 0x9D) {
+         r2_write(carry ? 0x80 : 0x00);
+         r2_write(y);
+         r2_write(x);
+      }
+      break;
+   case 0x08: {
+      a = r2_read();
+      int in_len = r2_read();
+      memset(block, 0, sizeof(block));
+      for (int i = in_len - 1; i >= 0; i--) {
+         block[i] = r2_read();
+      }
+      int out_len = r2_read();
+      mos_osword(a, block);
+      for (int i = out_len - 1; i >= 0; i--) {
+         r2_write(block[i]);
+      }
+      break;
+   }
+   case 0x0A:
+      mos_rdline();
+      break;
+   case 0x0C:
+      mos_osargs();
+      break;
+   case 0x0E:
+      mos_osbget();
+      break;
+   case 0x10:
+      mos_osbput();
+      break;
+   case 0x12:
+      mos_osfind();
+      break;
+   case 0x14:
+      mos_osfile();
+      break;
+   case 0x16:
+      mos_osgbpb();
+      break;
+   default:
+      fprintf(stderr, "native-mos: unknown R2 command &%02X\n", cmd);
+      break;
+   }
+}
+
+// ============================================================
+// Host main loop
+// ============================================================
+
+static int r1_or_r2_available(void)
+{
+   return (native_host_read(R1STAT) & STAT_DATA_AVAILABLE) ||
+          (native_host_read(R2STAT) & STAT_DATA_AVAILABLE);
+}
+
+static int r1_available_or_tube_disabled(void)
+{
+   return (native_host_read(R1STAT) & STAT_DATA_AVAILABLE) || !(tube_irq & TUBE_ENABLE_BIT);
+}
+
+void native_mos_boot(void)
+{
+   uint8_t c;
+   // Release RST and read the banner, which is terminated by a zero
+   native_host_set_rst(0);
+   native_host_wait(r1_available_or_tube_disabled);
+   if (!(tube_irq & TUBE_ENABLE_BIT)) {
+      // The Null Co Pro disables the tube, so there is nothing to talk to
+      native_mos_end();
+   }
+   do {
+      c = reg_read(R1DATA);
+      vdu_write(c);
+   } while (c);
+   if (cfg->language) {
+      uint32_t exec = cfg->language_addr;
+      if (!load_file(cfg->language, cfg->language_addr, 0, NULL)) {
+         fprintf(stderr, "native-mos: can't load %s\n", cfg->language);
+         native_mos_end();
+      }
+      transfer_start(TUBE_TYPE_EXECUTE, exec);
+      r2_write(0x80);
+   } else {
+      r2_write(0x00);
+   }
+}
+
+void native_mos_init(native_mos_config_t *config)
+{
+   cfg = config;
+   next_command = 0;
+   // Start with the line consumed, so the first RDCH reads a new one
+   line_pos = 1;
+   line_len = 0;
+   vdu_queue = 0;
+   column = 0;
+   time_offset = 0;
+   clock_gettime(CLOCK_MONOTONIC, &time_origin);
+}
+
+void native_mos_run(void)
+{
+   native_mos_boot();
+   while (1) {
+      native_host_wait(r1_or_r2_available);
+      service_r1();
+      if (native_host_read(R2STAT) & STAT_DATA_AVAILABLE) {
+         service_r2();
+      }
+   }
+}
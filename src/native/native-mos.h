@@ -0,0 +1,45 @@
+// native-mos.h
+
+#ifndef NATIVE_MOS_H
+#define NATIVE_MOS_H
+
+#include <inttypes.h>
+#include <stdio.h>
+
+// A minimal BBC Micro MOS and Tube host, used by the native build to
+// drive the Co Pro client ROMs without a real Beeb
+
+#define NATIVE_MOS_MAX_COMMANDS 64
+
+typedef struct {
+   // Lines of input to type at the Co Pro, before falling back to input
+   const char *commands[NATIVE_MOS_MAX_COMMANDS];
+   int num_commands;
+   // Where further input comes from when the commands run out (or NULL)
+   FILE *input;
+   // Optional language image to copy across after the banner
+   const char *language;
+   uint32_t language_addr;
+   // Directory used for OSFILE/OSFIND/*LOAD/*RUN/*SAVE
+   const char *dir;
+   // Pass the raw VDU stream to stdout, rather than filtering it
+   int raw_vdu;
+   // Called on the host once *RUN has started some code (or NULL)
+   void (*on_execute)(void);
+} native_mos_config_t;
+
+extern void native_mos_init(native_mos_config_t *config);
+
+// Entry point for the host coroutine (see native-ula.h)
+extern void native_mos_run(void);
+
+// The parts of native_mos_run(), for hosts that want to take over from the
+// MOS after the Co Pro has started (e.g. tube-bench)
+
+// Release RST, read the banner and start the language
+extern void native_mos_boot(void);
+
+// Make the emulator loop return, never returns itself
+extern void native_mos_end(void);
+
+#endif
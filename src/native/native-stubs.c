@@ -0,0 +1,188 @@
+// native-stubs.c
+//
+// Stand-ins for the bare metal platform code, used by the native build
+//
+// This replaces tube-client.c, performance.c, info.c, cache.c and the
+// framebuffer with just enough to let the portable Co Pro cores link
+// and run as an ordinary Linux process.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../tube-defs.h"
+#include "../tube.h"
+#include "../tube-client.h"
+#include "../startup.h"
+#include "../performance.h"
+#include "../info.h"
+#include "../cache.h"
+#include "../copro-65tube.h"
+#include "../copro-65tubejit.h"
+#include "../framebuffer/framebuffer.h"
+#include "native-ula.h"
+
+// Large enough for the biggest Co Pro memory (copro_memory_size <= 32MB)
+#define NATIVE_MEMORY_SIZE (32 * 1024 * 1024)
+
+volatile unsigned int copro;
+volatile unsigned int copro_speed;
+volatile unsigned int copro_memory_size = 0;
+unsigned int tube_delay = 0;
+unsigned int arm_speed = 1000000000;
+
+uint64_t native_cycles;
+
+// ============================================================
+// tube-client.c
+// ============================================================
+
+unsigned char * copro_mem_reset(unsigned int length)
+{
+   // On the Pi, Co Pro memory starts at physical address zero
+   static unsigned char *memory;
+   if (!memory) {
+      memory = malloc(NATIVE_MEMORY_SIZE);
+      if (!memory) {
+         fprintf(stderr, "copro_mem_reset: failed to allocate Co Pro memory\n");
+         exit(1);
+      }
+   }
+   if (length > NATIVE_MEMORY_SIZE) {
+      length = NATIVE_MEMORY_SIZE;
+   }
+   memset(memory, 0, length);
+   return memory;
+}
+
+void copro_memcpy(unsigned char * dst,unsigned char * src,unsigned int length)
+{
+   memcpy(dst, src, length);
+}
+
+unsigned int get_copro_mhz(unsigned int copro_num)
+{
+   return 0;
+}
+
+// ============================================================
+// Interrupt masking
+// ============================================================
+
+// Every parasite access to the ULA masks interrupts first, which is the
+// last point at which the FIQ for a host access could have got in
+
+int _disable_interrupts(void)
+{
+   native_ula_poll();
+   return 0;
+}
+
+void _enable_interrupts(void)
+{
+}
+
+void _set_interrupts(int cpsr)
+{
+}
+
+// ============================================================
+// Cores that only exist as ARM code
+// ============================================================
+
+static void not_available(const char *name)
+{
+   fprintf(stderr, "The %s Co Pro is not available in the native build\n", name);
+}
+
+void copro_65tube_emulator()
+{
+   not_available("65tube");
+}
+
+void copro_65tubejit_emulator()
+{
+   not_available("65tube JIT");
+}
+
+void copro_armnative_emulator()
+{
+   not_available("ARM native");
+}
+
+// ============================================================
+// cache.c
+// ============================================================
+
+void map_4k_page(unsigned int logical, unsigned int physical)
+{
+}
+
+// ============================================================
+// info.c
+// ============================================================
+
+char *get_info_string()
+{
+   return "Native";
+}
+
+char *get_cmdline_prop(const char *prop)
+{
+   return NULL;
+}
+
+// ============================================================
+// performance.c
+// ============================================================
+
+void reset_performance_counters(perf_counters_t *pct)
+{
+}
+
+void read_performance_counters(perf_counters_t *pct)
+{
+}
+
+void print_performance_counters(const perf_counters_t *pct)
+{
+}
+
+// ============================================================
+// framebuffer
+// ============================================================
+
+void fb_initialize()
+{
+}
+
+void fb_destroy()
+{
+}
+
+void fb_writec_buffered(char c)
+{
+}
+
+void fb_writec(char c)
+{
+}
+
+int fb_get_cursor_x()
+{
+   return 0;
+}
+
+int fb_get_cursor_y()
+{
+   return 0;
+}
+
+int fb_get_cursor_char()
+{
+   return 0;
+}
+
+uint8_t fb_read_legacy_vdu_variable(uint8_t v)
+{
+   return 0;
+}
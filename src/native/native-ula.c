@@ -0,0 +1,206 @@
+// native-ula.c
+//
+// Software backend for the Tube ULA, used by the native (Linux) build
+//
+// The host runs on its own stack as a ucontext coroutine. Every parasite
+// access to the ULA calls native_ula_poll() (from _disable_interrupts()),
+// which is the native equivalent of the FIQ window on the Pi. A Co Pro
+// that goes quiet (e.g. a 6809 in SYNC) still needs the host to make
+// progress, so tubeContinueRunning() also ticks the host once a core has
+// gone TICK_INTERVAL calls without touching the ULA. Letting the host in
+// any sooner than that can catch a client's NMI handler half way through
+// a byte, which no real (much slower) host could do. If the host
+// is waiting for a condition that is still false the poll is just a
+// function call, so this costs very little in the common case.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <ucontext.h>
+#include "../tube-ula.h"
+#include "native-ula.h"
+#include "tube-capture.h"
+
+#define HOST_STACK_SIZE (256 * 1024)
+
+// Number of tubeContinueRunning() calls without a ULA access before the
+// host is ticked
+#define TICK_INTERVAL 1024
+
+static ucontext_t copro_context;
+static ucontext_t host_context;
+
+static native_host_t host_fn;
+static native_cond_t host_cond;
+static int host_running;
+static int host_finished;
+static int rst_active;
+static int host_sleeping;
+
+int native_ula_ticks = TICK_INTERVAL;
+
+// Every call to tubeContinueRunning()/tubeTick() decrements the tick count,
+// so the number of calls (i.e. emulated instructions) can be recovered from
+// how far it has got each time it is reloaded, without any extra work in
+// the cores
+static int ticks_loaded = TICK_INTERVAL;
+static uint64_t ticks_counted;
+
+static void load_ticks(int ticks)
+{
+   ticks_counted += (uint64_t)(ticks_loaded - native_ula_ticks);
+   native_ula_ticks = ticks_loaded = ticks;
+}
+
+uint64_t native_ula_instructions(void)
+{
+   return ticks_counted + (uint64_t)(ticks_loaded - native_ula_ticks);
+}
+
+static int never(void)
+{
+   return 0;
+}
+
+static void host_entry(void)
+{
+   host_fn();
+   // The host should never return, but if it does then park it for good
+   host_finished = 1;
+   host_cond = never;
+   swapcontext(&host_context, &copro_context);
+}
+
+void native_ula_init(native_host_t host)
+{
+   static char *stack;
+   if (!stack) {
+      stack = malloc(HOST_STACK_SIZE);
+      if (!stack) {
+         fprintf(stderr, "native_ula_init: failed to allocate host stack\n");
+         exit(1);
+      }
+   }
+   host_fn = host;
+   host_cond = NULL;
+   host_running = 0;
+   host_finished = 0;
+   host_sleeping = 0;
+   native_ula_ticks = ticks_loaded = TICK_INTERVAL;
+   ticks_counted = 0;
+   // The host starts with RST asserted, as if it had just been powered on
+   rst_active = 1;
+   getcontext(&host_context);
+   host_context.uc_stack.ss_sp = stack;
+   host_context.uc_stack.ss_size = HOST_STACK_SIZE;
+   host_context.uc_link = NULL;
+   makecontext(&host_context, host_entry, 0);
+}
+
+static int host_awake(void)
+{
+   return !host_sleeping;
+}
+
+void native_ula_poll(void)
+{
+   if (!host_sleeping) {
+      load_ticks(TICK_INTERVAL);
+   }
+   // Guard against re-entry from the ULA accesses the host itself makes
+   if (host_running || host_finished) {
+      return;
+   }
+   if (host_cond && !host_cond()) {
+      return;
+   }
+   host_cond = NULL;
+   host_running = 1;
+   swapcontext(&copro_context, &host_context);
+   host_running = 0;
+}
+
+void native_ula_tick(void)
+{
+   host_sleeping = 0;
+   native_ula_poll();
+}
+
+int native_ula_rst_active(void)
+{
+   native_ula_poll();
+   return rst_active;
+}
+
+// ============================================================
+// Capture of the host accesses (see tube-capture.h)
+// ============================================================
+
+static capture_t *capture;
+static uint64_t capture_origin;
+
+void native_ula_capture(capture_t *c)
+{
+   capture = c;
+   capture_origin = native_ula_instructions();
+}
+
+static void capture_access(uint32_t mail)
+{
+   // The simulated host has no clock of its own, so it counts one host
+   // cycle per Co Pro instruction, which keeps the capture deterministic
+   if (capture) {
+      capture_write(capture, native_ula_instructions() - capture_origin, mail);
+   }
+}
+
+// ============================================================
+// Host accesses
+// ============================================================
+
+uint8_t native_host_read(unsigned int addr)
+{
+   uint32_t mail = (1 << 11) | ((addr & 7) << 8);
+   uint8_t data = tube_vc_access(mail);
+   capture_access(mail | ((uint32_t)data << 16));
+   return data;
+}
+
+void native_host_write(unsigned int addr, uint8_t data)
+{
+   uint32_t mail = ((uint32_t)data << 16) | ((addr & 7) << 8);
+   tube_vc_access(mail);
+   capture_access(mail);
+}
+
+void native_host_set_rst(int active)
+{
+   rst_active = active;
+   if (active) {
+      tube_vc_access(1 << 12);
+      capture_access(1 << 12);
+   } else {
+      capture_access(CAPTURE_RST_RELEASE);
+   }
+}
+
+void native_host_wait(native_cond_t cond)
+{
+   if (cond()) {
+      return;
+   }
+   host_cond = cond;
+   swapcontext(&host_context, &copro_context);
+}
+
+// Let the Co Pro run on for a while, to mimic the latency of a real host
+void native_host_sleep(int ticks)
+{
+   host_sleeping = 1;
+   load_ticks(ticks);
+   native_host_wait(host_awake);
+}
+
+void native_host_yield(void)
+{
+   swapcontext(&host_context, &copro_context);
+}
@@ -0,0 +1,53 @@
+// native-ula.h
+
+#ifndef NATIVE_ULA_H
+#define NATIVE_ULA_H
+
+#include <inttypes.h>
+#include "tube-capture.h"
+
+// Software backend for the Tube ULA, used by the native (Linux) build
+//
+// On the Pi the host (BBC Micro) side of the ULA is driven by the VideoCore,
+// which interrupts the ARM with an FIQ for every host access. Here the host
+// is simulated by a coroutine. It gets control whenever the Co Pro touches
+// the ULA (i.e. whenever the Pi would have taken a pending FIQ), or has been
+// idle for a while, and hands control back whenever it has to wait for the
+// Co Pro to do something.
+
+typedef void (*native_host_t)(void);
+
+typedef int (*native_cond_t)(void);
+
+// Called once before the Co Pro is started
+extern void native_ula_init(native_host_t host);
+
+// Record every host access to c from now on (NULL to stop)
+extern void native_ula_capture(capture_t *c);
+
+// Number of tubeContinueRunning()/tubeTick() calls made by the Co Pro
+extern uint64_t native_ula_instructions(void);
+
+// Called from the Co Pro side
+
+extern void native_ula_poll(void);
+
+extern void native_ula_tick(void);
+
+extern int native_ula_rst_active(void);
+
+// Called from the host coroutine
+
+extern uint8_t native_host_read(unsigned int addr);
+
+extern void native_host_write(unsigned int addr, uint8_t data);
+
+extern void native_host_set_rst(int active);
+
+extern void native_host_wait(native_cond_t cond);
+
+extern void native_host_sleep(int ticks);
+
+extern void native_host_yield(void);
+
+#endif
@@ -0,0 +1,319 @@
+// ns32016-check.c
+//
+// Checks the decoded instruction cache in NS32016/32016.c.
+//
+// This is built twice: ns32016-check uses the normal core, and
+// ns32016-check-uncached has NS_NO_DECODE_CACHE defined, so the core decodes
+// every instruction from memory. Both run the same random code one
+// instruction at a time, and ns32016-check compares the registers of the two
+// after every instruction, the memory around the code after every program,
+// and all of memory every MEMORY_INTERVAL instructions:
+//
+//   ns32016-check -s 1 -n 10000000
+//
+// Each program is restarted every few instructions, so that most of it runs
+// from the cache. Some of the registers, and the stack, point into the
+// program so that it often overwrites itself, and SETCFG and LPR CFG in the
+// random code flush the cache.
+//
+// The random code has no MOVM or CMPM, which with a negative length would
+// run on for billions of bytes, and no string instructions with the illegal
+// operand size (i = 2), as MOVS then copies 255 bytes from the host's stack.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+// Not unistd.h, which clashes with the read and write in NS32016/Decode.h
+#include <getopt.h>
+
+// The rest of the core is linked in, but the registers are static here
+#include "../NS32016/32016.c"
+
+// Instructions between new random programs
+#define PROGRAM_LENGTH 64
+
+// Instructions between going back to the start of the program
+#define RESTART_INTERVAL 16
+
+// Instructions between comparing, and then re-randomising, all of memory
+#define MEMORY_INTERVAL 65536
+
+// The memory around the program that is compared after each one
+#define WINDOW_BEFORE 256
+#define WINDOW_AFTER  512
+
+// Mismatches to report individually
+#define MAX_REPORTS 10
+
+volatile unsigned int copro;
+volatile unsigned int copro_memory_size;
+
+// With RESET pending, n32016_exec() returns after each instruction
+volatile int tube_irq;
+
+int tubecycles;
+
+int native_ula_ticks;
+uint64_t native_cycles;
+
+static uint32_t program_base;
+
+static uint32_t io_hash;
+static uint8_t io_counter;
+
+// Everything up to the Tube registers reads as memory
+static uint8_t memory[MEG16];
+
+unsigned char *copro_mem_reset(unsigned int length)
+{
+   memset(memory, 0, sizeof(memory));
+   return memory;
+}
+
+// Never CE or 0E, so code run from the Tube registers has no MOVM, CMPM or
+// MOVS (see is_excluded())
+uint8_t tube_parasite_read(uint32_t addr)
+{
+   return (uint8_t)((addr * 37u + io_counter++) | 1);
+}
+
+void tube_parasite_write(uint32_t addr, uint8_t val)
+{
+   io_hash = (io_hash ^ (addr << 8) ^ val) * 16777619u;
+}
+
+void tube_ack_nmi(void)
+{
+}
+
+void log_info(const char *fmt, ...)
+{
+}
+
+void log_warn(const char *fmt, ...)
+{
+}
+
+// Called after the one instruction each n32016_exec() is allowed
+void native_ula_tick(void)
+{
+   tube_irq = RESET_BIT;
+}
+
+static void usage(const char *program)
+{
+   fprintf(stderr, "usage: %s [-s <seed>] [-n <instructions>]\n", program);
+   exit(1);
+}
+
+static uint64_t rng_state;
+
+static uint32_t rng(void)
+{
+   rng_state ^= rng_state << 13;
+   rng_state ^= rng_state >> 7;
+   rng_state ^= rng_state << 17;
+   return (uint32_t)rng_state;
+}
+
+static uint32_t memory_hash(uint32_t start, uint32_t length)
+{
+   uint32_t hash = 2166136261u;
+   for (uint32_t addr = start; addr < start + length; addr++) {
+      hash = (hash ^ memory[addr & MEM_MASK]) * 16777619u;
+   }
+   return hash;
+}
+
+// Whether an instruction starting with these two bytes is left out
+static int is_excluded(uint8_t first, uint8_t second)
+{
+   if (FunctionLookup[first] == MOVM) {
+      return ((second >> 2) & 0x0F) <= CMPM - MOVM;
+   }
+   if (FunctionLookup[first] == MOVS) {
+      // Translation (bit 7) makes the size 8 bits
+      return (second & 0x83) == 0x02;
+   }
+   return 0;
+}
+
+static uint8_t random_code(uint8_t prev)
+{
+   uint8_t code = (uint8_t)rng();
+   return is_excluded(prev, code) ? (uint8_t)(code | 0x21) : code;
+}
+
+// An address near the program, so writes to it may hit the code
+static uint32_t near_program(void)
+{
+   return program_base + (rng() & 0xFF) - 0x40;
+}
+
+// Start a new random program with random registers
+static void new_program(uint64_t n)
+{
+   if (n % MEMORY_INTERVAL == 0) {
+      // Not just RAM_SIZE, as jumps to anywhere below IO_BASE read memory
+      for (uint32_t addr = 0; addr < IO_BASE; addr++) {
+         memory[addr] = random_code(memory[(addr - 1) & MEM_MASK]);
+      }
+#ifdef NS_DECODE_CACHE
+      // Written behind the core's back
+      n32016_flush_decode();
+#endif
+   }
+   // Clear of the Tube registers, and of the wrap round at the top of memory
+   program_base = WINDOW_BEFORE + (rng() % (IO_BASE - WINDOW_BEFORE - WINDOW_AFTER));
+   for (uint32_t i = 0; i < 256; i++) {
+      // Through the core, so the cache sees the new code
+      write_x8(program_base + i, random_code(memory[program_base + i - 1]));
+   }
+   for (int i = 0; i < 8; i++) {
+      r[i] = (rng() & 1) ? near_program() : rng();
+   }
+   for (int i = 0; i < 8; i++) {
+      FR.u64[i] = ((uint64_t)rng() << 32) | rng();
+   }
+   FSR = rng();
+   sp[0] = near_program() + 0x100;
+   sp[1] = (rng() & 1) ? near_program() + 0x100 : rng() & MEM_MASK;
+   fp = near_program();
+   sb = (rng() & 1) ? near_program() : rng() & MEM_MASK;
+   intbase = rng() & MEM_MASK;
+   mod = rng() & 0xFFFF;
+   uint32_t cfg = rng() & 0xFF;
+#ifdef NS_DECODE_CACHE
+   // As SETCFG would, since the FPU instructions may now decode differently
+   if (cfg != nscfg.Whole) {
+      n32016_flush_decode();
+   }
+#endif
+   nscfg.Whole = cfg;
+   // Trace mode would trap every instruction
+   psr = rng() & 0xFFD;
+   PR.BPC = (rng() & 0x10) ? program_base + (rng() & 0x3F) : 0xFFFFFFFF;
+   PR.DCR = rng();
+}
+
+// Set up for instruction n
+static void prepare(uint64_t n)
+{
+   if (n % PROGRAM_LENGTH == 0) {
+      new_program(n);
+   }
+   if (n % RESTART_INTERVAL == 0) {
+      pc = program_base;
+   }
+}
+
+// Run one instruction (and any IRQ or NMI) and describe the state afterwards
+static void step(uint64_t n, char *line, size_t size)
+{
+   uint32_t r1 = rng();
+   tube_irq = 0;
+   if ((r1 & 0x3F) == 0) {
+      tube_irq |= NMI_BIT;
+   }
+   if ((r1 & 0x3C0) == 0) {
+      tube_irq |= IRQ_BIT;
+   }
+   // The program may have written one
+   uint32_t addr = pc & MEM_MASK;
+   if (addr < IO_BASE - 1 && is_excluded(memory[addr], memory[addr + 1])) {
+      write_x8(addr, 0xA2);
+   }
+   native_ula_ticks = 1;
+   n32016_exec();
+   int len = snprintf(line, size, "%llu %06"PRIX32" %08"PRIX32" %08"PRIX32" %08"PRIX32" %08"PRIX32" %08"PRIX32" %08"PRIX32" %08"PRIX32" %08"PRIX32
+                      " %08"PRIX32" %08"PRIX32" %08"PRIX32" %08"PRIX32" %04"PRIX32" %08"PRIX32" %04"PRIX32" %08"PRIX32" %08"PRIX32" %08"PRIX32" %u",
+                      (unsigned long long)n, pc, r[0], r[1], r[2], r[3], r[4], r[5], r[6], r[7],
+                      sp[0], sp[1], fp, sb, psr, intbase, mod, nscfg.Whole, FSR, TrapFlags, io_counter);
+   for (int i = 0; i < 8; i++) {
+      len += snprintf(line + len, size - (size_t)len, " %016"PRIX64, FR.u64[i]);
+   }
+   if (n % PROGRAM_LENGTH == PROGRAM_LENGTH - 1) {
+      len += snprintf(line + len, size - (size_t)len, " %08"PRIX32" %08"PRIX32,
+                      memory_hash(program_base - WINDOW_BEFORE, WINDOW_BEFORE + WINDOW_AFTER), io_hash);
+   }
+   if (n % MEMORY_INTERVAL == MEMORY_INTERVAL - 1) {
+      snprintf(line + len, size - (size_t)len, " %08"PRIX32, memory_hash(0, MEG16));
+   }
+}
+
+static int run_random(uint64_t seed, uint64_t count, const char *program)
+{
+   char line[512];
+   rng_state = 88172645463325252ULL + seed;
+   n32016_init();
+   n32016_reset_addr(0);
+
+#ifdef NS_NO_DECODE_CACHE
+   // Print the trace for ns32016-check to compare with
+   for (uint64_t n = 0; n < count; n++) {
+      prepare(n);
+      step(n, line, sizeof(line));
+      puts(line);
+   }
+   return 0;
+#else
+   char expected[512];
+   char command[4096];
+   uint64_t mismatches = 0;
+   uint64_t n;
+
+   // The uncached build is alongside this one
+   const char *slash = strrchr(program, '/');
+   int dir_len = slash ? (int)(slash - program + 1) : 0;
+   snprintf(command, sizeof(command), "%.*sns32016-check-uncached -s %llu -n %llu",
+            dir_len, program, (unsigned long long)seed, (unsigned long long)count);
+   FILE *uncached = popen(command, "r");
+   if (!uncached) {
+      perror(command);
+      return 1;
+   }
+   for (n = 0; n < count; n++) {
+      prepare(n);
+      uint32_t addr = pc;
+      step(n, line, sizeof(line));
+      if (!fgets(expected, sizeof(expected), uncached)) {
+         fprintf(stderr, "ns32016-check: %s stopped after %llu instructions\n", command, (unsigned long long)n);
+         mismatches++;
+         break;
+      }
+      expected[strcspn(expected, "\n")] = 0;
+      if (strcmp(line, expected) != 0) {
+         mismatches++;
+         if (mismatches <= MAX_REPORTS) {
+            fprintf(stderr, "ns32016-check: after %06"PRIX32"\n  cached:   %s\n  uncached: %s\n", addr, line, expected);
+         }
+      }
+   }
+   pclose(uncached);
+
+   fprintf(stderr, "ns32016-check: %llu instructions, %llu mismatches\n",
+           (unsigned long long)n, (unsigned long long)mismatches);
+   return mismatches ? 1 : 0;
+#endif
+}
+
+int main(int argc, char **argv)
+{
+   int opt;
+   uint64_t seed = 1;
+   uint64_t count = 1000000;
+
+   while ((opt = getopt(argc, argv, "s:n:h")) != -1) {
+      switch (opt) {
+      case 's':
+         seed = strtoull(optarg, NULL, 0);
+         break;
+      case 'n':
+         count = strtoull(optarg, NULL, 0);
+         break;
+      default:
+         usage(argv[0]);
+      }
+   }
+   return run_random(seed, count, argv[0]);
+}
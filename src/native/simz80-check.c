@@ -0,0 +1,351 @@
+// simz80-check.c
+//
+// Checks the two dispatch engines in yaze/simz80.c.
+//
+// This is built twice: simz80-check uses the switch engine, and
+// simz80-check-threaded the SIMZ80_THREADED one. Either can run a CP/M
+// instruction exerciser, such as ZEXDOC or ZEXALL (zexdoc.com and
+// zexall.com from the yaze distribution, which aren't in this tree):
+//
+//   simz80-check -z zexall.com
+//   simz80-check-threaded -z zexall.com
+//
+// Only the BDOS console output calls (2 and 9) are provided, which is all
+// the exercisers use. The exit status is 1 if the output contains "ERROR".
+//
+// Without -z, simz80-check runs random programs one instruction at a time
+// on both engines, and compares the registers after every instruction and
+// the memory and I/O writes every few. The programs are biased towards the
+// CB, DD, ED and FD prefixes, and take IRQs and NMIs at random:
+//
+//   simz80-check -s 1 -n 10000000
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../yaze/simz80.c"
+
+// Instructions between new random programs
+#define PROGRAM_LENGTH 64
+
+// Instructions between re-randomising all of memory
+#define MEMORY_INTERVAL 4096
+
+// Mismatches to report individually
+#define MAX_REPORTS 10
+
+// CP/M entry points; a HALT at each returns from simz80_execute()
+#define CPM_WBOOT 0x0000
+#define CPM_BDOS  0x0005
+#define CPM_TPA   0x0100
+#define CPM_STACK 0xFE00
+
+volatile int tube_irq;
+
+int native_ula_ticks;
+uint64_t native_cycles;
+
+static uint8_t memory[0x10000];
+
+static uint32_t io_hash;
+static uint8_t io_counter;
+
+// Set for each instruction in the random programs
+static int irq_this_step;
+
+uint8_t copro_z80_read_mem(unsigned int addr)
+{
+   return memory[addr & 0xffff];
+}
+
+void copro_z80_write_mem(unsigned int addr, unsigned char data)
+{
+   memory[addr & 0xffff] = data;
+}
+
+uint8_t copro_z80_read_io(unsigned int addr)
+{
+   return (uint8_t)((addr & 0xffff) * 37u + io_counter++);
+}
+
+void copro_z80_write_io(unsigned int addr, unsigned char data)
+{
+   io_hash = (io_hash ^ ((addr & 0xffff) << 8) ^ data) * 16777619u;
+}
+
+// Called after the one instruction each simz80_execute() is allowed
+void native_ula_tick(void)
+{
+   if (irq_this_step) {
+      // simz80_execute() takes the IRQ itself and carries on, if enabled
+      irq_this_step = 0;
+      tube_irq = IRQ_BIT;
+   } else {
+      tube_irq = RESET_BIT;
+   }
+}
+
+static void usage(const char *program)
+{
+   fprintf(stderr, "usage: %s [-z <file.com>] [-s <seed>] [-n <instructions>]\n", program);
+   exit(1);
+}
+
+// ==========================================================================
+// CP/M instruction exercisers
+// ==========================================================================
+
+static int run_cpm(const char *filename)
+{
+   FILE *file = fopen(filename, "rb");
+   if (!file) {
+      perror(filename);
+      return 1;
+   }
+   size_t length = fread(memory + CPM_TPA, 1, CPM_STACK - CPM_TPA, file);
+   fclose(file);
+   if (length == 0) {
+      fprintf(stderr, "simz80-check: %s is empty\n", filename);
+      return 1;
+   }
+
+   // The exercisers set their stack from the BDOS address at 6
+   memory[CPM_WBOOT] = 0x76;
+   memory[CPM_BDOS] = 0x76;
+   memory[CPM_BDOS + 1] = CPM_STACK & 0xff;
+   memory[CPM_BDOS + 2] = CPM_STACK >> 8;
+
+   simz80_reset();
+   pc = CPM_TPA;
+   sp = CPM_STACK - 2;
+   memory[sp] = CPM_WBOOT & 0xff;
+   memory[sp + 1] = CPM_WBOOT >> 8;
+
+   // The exercisers report each failing test with "ERROR"
+   static const char error_text[] = "ERROR";
+   size_t matched = 0;
+   int errors = 0;
+   struct timespec start, end;
+   clock_gettime(CLOCK_MONOTONIC, &start);
+   while (1) {
+      tube_irq = 0;
+      native_ula_ticks = 1 << 30;
+      FASTWORK stop = simz80_execute(1);
+      if (stop & 0x10000) {
+         continue;
+      }
+      if ((stop & 0xffff) == CPM_WBOOT + 1) {
+         break;
+      }
+      if ((stop & 0xffff) != CPM_BDOS + 1) {
+         fprintf(stderr, "simz80-check: HALT at %04X\n", (stop - 1) & 0xffff);
+         return 1;
+      }
+      uint8_t function = regs[regs_sel].bc & 0xff;
+      uint16_t addr = regs[regs_sel].de;
+      char c;
+      int done = 0;
+      while (!done) {
+         if (function == 2) {
+            c = (char)(addr & 0xff);
+            done = 1;
+         } else if (function == 9) {
+            c = (char)memory[addr++];
+            if (c == '$') {
+               break;
+            }
+         } else {
+            fprintf(stderr, "simz80-check: BDOS function %u not supported\n", function);
+            return 1;
+         }
+         putchar(c);
+         matched = (c == error_text[matched]) ? matched + 1 : (c == error_text[0]);
+         if (matched == sizeof(error_text) - 1) {
+            errors++;
+            matched = 0;
+         }
+      }
+      fflush(stdout);
+      // Return from the BDOS call
+      pc = (WORD)(memory[sp] | (memory[(sp + 1) & 0xffff] << 8));
+      sp = (WORD)(sp + 2);
+   }
+   clock_gettime(CLOCK_MONOTONIC, &end);
+
+   double elapsed = (double)(end.tv_sec - start.tv_sec) + (double)(end.tv_nsec - start.tv_nsec) / 1e9;
+   fprintf(stderr, "simz80-check: %s: %d errors, %.1f s, %llu instructions (%.2f MIPS)\n",
+           filename, errors, elapsed, (unsigned long long)native_cycles,
+           elapsed > 0 ? (double)native_cycles / elapsed / 1e6 : 0.0);
+   return errors ? 1 : 0;
+}
+
+// ==========================================================================
+// Random programs
+// ==========================================================================
+
+static uint64_t rng_state;
+
+static uint32_t rng(void)
+{
+   rng_state ^= rng_state << 13;
+   rng_state ^= rng_state >> 7;
+   rng_state ^= rng_state << 17;
+   return (uint32_t)rng_state;
+}
+
+static uint8_t random_code(void)
+{
+   static const uint8_t prefixes[] = { 0xCB, 0xDD, 0xED, 0xFD };
+   uint32_t r = rng();
+   return (r & 0x300) ? (uint8_t)r : prefixes[r & 3];
+}
+
+static uint32_t memory_hash(void)
+{
+   uint32_t hash = 2166136261u;
+   for (uint32_t addr = 0; addr < sizeof(memory); addr++) {
+      hash = (hash ^ memory[addr]) * 16777619u;
+   }
+   return hash;
+}
+
+// Start a new random program with random registers
+static void new_program(uint64_t n)
+{
+   if (n % MEMORY_INTERVAL == 0) {
+      for (uint32_t addr = 0; addr < sizeof(memory); addr++) {
+         memory[addr] = random_code();
+      }
+   }
+   af[0] = (WORD)rng();
+   af[1] = (WORD)rng();
+   af_sel = rng() & 1;
+   for (int i = 0; i < 2; i++) {
+      regs[i].bc = (WORD)rng();
+      regs[i].de = (WORD)rng();
+      regs[i].hl = (WORD)rng();
+   }
+   regs_sel = rng() & 1;
+   ir = (WORD)rng();
+   ix = (WORD)rng();
+   iy = (WORD)rng();
+   sp = (WORD)rng();
+   pc = (WORD)rng();
+   IFF = (WORD)(rng() & 3);
+   for (uint32_t i = 0; i < 256; i++) {
+      memory[(pc + i) & 0xffff] = random_code();
+   }
+}
+
+// Set up for instruction n
+static void prepare(uint64_t n)
+{
+   if (n % PROGRAM_LENGTH == 0) {
+      new_program(n);
+   }
+}
+
+// Run one instruction (and any IRQ or NMI) and describe the state afterwards
+static void step(uint64_t n, char *line, size_t size)
+{
+   uint32_t r = rng();
+   if ((r & 0x3F) == 0) {
+      simz80_NMI();
+   }
+   irq_this_step = (r & 0x3C0) == 0;
+   tube_irq = 0;
+   native_ula_ticks = 1;
+   FASTWORK stop = simz80_execute(1);
+   int len = snprintf(line, size, "%llu %05X %04X %04X %u %04X %04X %04X %04X %04X %04X %u %04X %04X %04X %04X %04X %04X %04X",
+                      (unsigned long long)n, stop, af[0], af[1], af_sel,
+                      regs[0].bc, regs[0].de, regs[0].hl, regs[1].bc, regs[1].de, regs[1].hl, regs_sel,
+                      ir, ix, iy, sp, pc, IFF, io_counter);
+   if (n % PROGRAM_LENGTH == PROGRAM_LENGTH - 1) {
+      snprintf(line + len, size - (size_t)len, " %08X %08X", memory_hash(), io_hash);
+   }
+}
+
+static int run_random(uint64_t seed, uint64_t count, const char *program)
+{
+   char line[256];
+   rng_state = 88172645463325252ULL + seed;
+
+#ifdef SIMZ80_THREADED
+   // Print the trace for simz80-check to compare with
+   for (uint64_t n = 0; n < count; n++) {
+      prepare(n);
+      step(n, line, sizeof(line));
+      puts(line);
+   }
+   return 0;
+#else
+   char expected[256];
+   char command[4096];
+   uint64_t mismatches = 0;
+   uint64_t n;
+
+   // The threaded build is alongside this one
+   const char *slash = strrchr(program, '/');
+   int dir_len = slash ? (int)(slash - program + 1) : 0;
+   snprintf(command, sizeof(command), "%.*ssimz80-check-threaded -s %llu -n %llu",
+            dir_len, program, (unsigned long long)seed, (unsigned long long)count);
+   FILE *threaded = popen(command, "r");
+   if (!threaded) {
+      perror(command);
+      return 1;
+   }
+   for (n = 0; n < count; n++) {
+      prepare(n);
+      uint16_t addr = pc;
+      step(n, line, sizeof(line));
+      if (!fgets(expected, sizeof(expected), threaded)) {
+         fprintf(stderr, "simz80-check: %s stopped after %llu instructions\n", command, (unsigned long long)n);
+         mismatches++;
+         break;
+      }
+      expected[strcspn(expected, "\n")] = 0;
+      if (strcmp(line, expected) != 0) {
+         mismatches++;
+         if (mismatches <= MAX_REPORTS) {
+            fprintf(stderr, "simz80-check: after %04X\n  switch:   %s\n  threaded: %s\n", addr, line, expected);
+         }
+      }
+   }
+   pclose(threaded);
+
+   fprintf(stderr, "simz80-check: %llu instructions, %llu mismatches\n",
+           (unsigned long long)n, (unsigned long long)mismatches);
+   return mismatches ? 1 : 0;
+#endif
+}
+
+int main(int argc, char **argv)
+{
+   int opt;
+   const char *cpm_file = NULL;
+   uint64_t seed = 1;
+   uint64_t count = 1000000;
+
+   while ((opt = getopt(argc, argv, "z:s:n:h")) != -1) {
+      switch (opt) {
+      case 'z':
+         cpm_file = optarg;
+         break;
+      case 's':
+         seed = strtoull(optarg, NULL, 0);
+         break;
+      case 'n':
+         count = strtoull(optarg, NULL, 0);
+         break;
+      default:
+         usage(argv[0]);
+      }
+   }
+   if (cpm_file) {
+      return run_cpm(cpm_file);
+   }
+   return run_random(seed, count, argv[0]);
+}
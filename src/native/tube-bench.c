@@ -0,0 +1,681 @@
+// tube-bench.c
+//
+// Runs fixed workloads on each of the Co Pro cores, through the simulated
+// host (see native-mos.c), and reports the emulated speed as JSON on
+// stdout, so that changes to the cores can be compared run to run:
+//
+//   tube-bench -b BASIC2.rom > results.json
+//
+// The workloads are:
+//
+//   boot       every core: reset to the first prompt, then *HELP
+//   sphere     6502 cores: SPHERE from programs.c (needs a BASIC ROM, -b)
+//   clocksp    6502 cores: ClockSp from programs.c (needs a BASIC ROM, -b)
+//   pi-spigot  OPC5LS: opc5ls/test/pi-spigot-bruce.s (assembled by CMake)
+//   z80-loop   Z80: a counting loop (see z80_loop below), also run with an
+//              IRQ held pending while it has interrupts disabled
+//   x86-mem    80186: the client's own *F (fill) and *SR (search) over
+//              512KB of memory, which is mostly memory accesses
+//   pdp11-*    PDP-11: pdp11/test/FKACA0.BIC
+//
+// Each run is a separate process, so one core can't upset the next, and
+// a run that doesn't finish within the timeout is reported as such.
+//
+// The instruction count is the number of tubeContinueRunning()/tubeTick()
+// calls (see native-ula.c), which is one per emulated instruction for all
+// the cores here, plus any idle spinning while waiting for the host. The
+// cores don't report real cycle counts, so "mhz" is only filled in for
+// ClockSp, from the speed it measures itself (relative to a 2MHz BBC B).
+//
+// The PDP-11 diagnostics never finish (they loop printing END PASS on a
+// DL11 console), so they are run for a fixed number of instructions. Only
+// FKACA0 is used, as the others need the PSW at 0177776 or console
+// interrupts, neither of which the Co Pro's memory map has room for.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "../tube-defs.h"
+#include "../tube.h"
+#include "../tube-ula.h"
+#include "../tube-client.h"
+#include "../copro-defs.h"
+#include "../copro-lib6502.h"
+#include "../copro-65816.h"
+#include "../copro-opc5ls.h"
+#include "../copro-pdp11.h"
+#include "../copro-z80.h"
+#include "../copro-80186.h"
+#include "../copro-null.h"
+#include "../copro-65tube.h"
+#include "../copro-65tubejit.h"
+#include "../copro-armnative.h"
+#include "../pdp11/pdp11.h"
+#include "gitversion.h"
+#include "native-ula.h"
+#include "native-mos.h"
+
+#ifndef BENCH_SPIGOT_HEX
+#define BENCH_SPIGOT_HEX "pi-spigot-bruce.hex"
+#endif
+
+#ifndef BENCH_PDP11_DIR
+#define BENCH_PDP11_DIR "."
+#endif
+
+#define MAX_SELECT 64
+
+// The spigot is assembled at &1000 and is 256 words long (see
+// opc5ls/test/build.sh)
+#define SPIGOT_ADDR  0x1000
+#define SPIGOT_WORDS 256
+
+// The spigot finishes with its own RTS, which pops the return address from
+// the stack (r14), but the client calls it with the return address in r13.
+// So it is entered through the second half of its JSR macro instead:
+//
+//   sto r13, r14
+//   mov r14, r14, 0xffff
+//   mov pc, r0, 0x1000
+static const uint16_t spigot_entry[] = {
+   0x06ed, 0x10ee, 0xffff, 0x100f, SPIGOT_ADDR
+};
+
+#define SPIGOT_ENTRY_WORDS (sizeof(spigot_entry) / sizeof(spigot_entry[0]))
+#define SPIGOT_ENTRY (SPIGOT_ADDR - SPIGOT_ENTRY_WORDS)
+
+// PDP-11 diagnostics
+#define PDP11_DEFAULT_INSTRUCTIONS 50000000ULL
+#define PDP11_XCSR 0177564
+// Where to start a diagnostic with no start address (an odd one)
+#define PDP11_START 0200
+#define PDP11_CHUNK (1 << 20)
+
+typedef struct workload {
+   const char *name;
+   // Returns 1 if the workload can run on this Co Pro
+   int (*applies)(const copro_def_t *def);
+   // Fills in the MOS config, returns a reason to skip the run, or NULL
+   const char *(*prepare)(const struct workload *w, native_mos_config_t *config);
+   // Host to run instead of native_mos_run(), or NULL
+   native_host_t host;
+   // Workload specific parameter
+   const char *arg;
+} workload_t;
+
+typedef struct {
+   double seconds;
+   unsigned long long instructions;
+   double mhz;
+   char status[16];
+} result_t;
+
+static const char *basic_rom;
+static const char *spigot_hex = BENCH_SPIGOT_HEX;
+static const char *pdp11_dir = BENCH_PDP11_DIR;
+static unsigned long long pdp11_instructions = PDP11_DEFAULT_INSTRUCTIONS;
+static unsigned int timeout_secs = 60;
+static char work_dir[] = "/tmp/tube-bench-XXXXXX";
+
+// Set by the host in the child, for the result
+static const char *run_status = "ok";
+
+// ============================================================
+// Co Pro classes
+// ============================================================
+
+static int is_runnable(const copro_def_t *def)
+{
+   return def->type != TYPE_HIDDEN && def->type != TYPE_DISABLED &&
+      def->emulator != copro_null_emulator &&
+      def->emulator != copro_65tube_emulator &&
+      def->emulator != copro_65tubejit_emulator &&
+      def->emulator != copro_armnative_emulator;
+}
+
+static int any_core(const copro_def_t *def)
+{
+   return 1;
+}
+
+static int is_6502(const copro_def_t *def)
+{
+   return def->emulator == copro_lib6502_emulator || def->emulator == copro_65816_emulator;
+}
+
+static int is_opc5ls(const copro_def_t *def)
+{
+   return def->emulator == copro_opc5ls_emulator;
+}
+
+static int is_z80(const copro_def_t *def)
+{
+   return def->emulator == copro_z80_emulator;
+}
+
+static int is_80186(const copro_def_t *def)
+{
+   return def->emulator == copro_80186_emulator;
+}
+
+static int is_pdp11(const copro_def_t *def)
+{
+   return def->emulator == copro_pdp11_emulator;
+}
+
+// ============================================================
+// Workloads
+// ============================================================
+
+static const char *prepare_boot(const workload_t *w, native_mos_config_t *config)
+{
+   config->commands[config->num_commands++] = "*HELP";
+   return NULL;
+}
+
+// SPHERE and ClockSp are already in memory (see copy_test_programs()), so
+// just start BASIC and recover them with OLD
+static const char *prepare_basic(const workload_t *w, native_mos_config_t *config)
+{
+   if (!basic_rom) {
+      return "no BASIC ROM (-b)";
+   }
+   config->language = basic_rom;
+   config->language_addr = 0x8000;
+   config->commands[config->num_commands++] = w->arg;
+   config->commands[config->num_commands++] = "OLD";
+   config->commands[config->num_commands++] = "RUN";
+   return NULL;
+}
+
+// Convert the assembler's output (one 4 digit hex word per address) to a
+// little endian file the client can *RUN, as opc5ls/test/build.sh does
+static const char *prepare_spigot(const workload_t *w, native_mos_config_t *config)
+{
+   char path[512];
+   unsigned int word;
+   unsigned int addr = 0;
+   FILE *in = fopen(spigot_hex, "r");
+   if (!in) {
+      return "no assembled spigot (-s)";
+   }
+   snprintf(path, sizeof(path), "%s/PI", work_dir);
+   FILE *out = fopen(path, "wb");
+   if (!out) {
+      fclose(in);
+      return "can't write PI";
+   }
+   for (unsigned int i = 0; i < SPIGOT_ENTRY_WORDS; i++) {
+      fputc(spigot_entry[i] & 0xFF, out);
+      fputc(spigot_entry[i] >> 8, out);
+   }
+   while (addr < SPIGOT_ADDR + SPIGOT_WORDS && fscanf(in, "%x", &word) == 1) {
+      if (addr >= SPIGOT_ADDR) {
+         fputc(word & 0xFF, out);
+         fputc((word >> 8) & 0xFF, out);
+      }
+      addr++;
+   }
+   fclose(in);
+   fclose(out);
+   if (addr < SPIGOT_ADDR + SPIGOT_WORDS) {
+      return "spigot too short";
+   }
+   snprintf(path, sizeof(path), "%s/PI.inf", work_dir);
+   out = fopen(path, "w");
+   if (!out) {
+      return "can't write PI.inf";
+   }
+   fprintf(out, "$.PI %X %X\n", (unsigned int)SPIGOT_ENTRY, (unsigned int)SPIGOT_ENTRY);
+   fclose(out);
+   config->dir = work_dir;
+   config->commands[config->num_commands++] = "*RUN PI";
+   return NULL;
+}
+
+// About 13 million instructions, with interrupts disabled
+//
+// 4000 F3        DI
+// 4001 16 28     LD   D,40
+// 4003 01 00 00  LD   BC,0
+// 4006 81        ADD  A,C
+// 4007 0B        DEC  BC
+// 4008 78        LD   A,B
+// 4009 B1        OR   C
+// 400A 20 FA     JR   NZ,4006
+// 400C 15        DEC  D
+// 400D 20 F4     JR   NZ,4003
+// 400F FB        EI
+// 4010 C9        RET
+static const uint8_t z80_loop[] = {
+   0xF3, 0x16, 0x28, 0x01, 0x00, 0x00, 0x81, 0x0B, 0x78, 0xB1,
+   0x20, 0xFA, 0x15, 0x20, 0xF4, 0xFB, 0xC9
+};
+
+#define Z80_LOOP_ADDR 0x4000
+
+// Co Pro instructions to wait for the loop to have disabled interrupts
+#define Z80_LOOP_SETTLE 10000
+
+static const char *prepare_z80(const workload_t *w, native_mos_config_t *config)
+{
+   char path[512];
+   snprintf(path, sizeof(path), "%s/LOOP", work_dir);
+   FILE *f = fopen(path, "wb");
+   if (!f) {
+      return "can't write LOOP";
+   }
+   fwrite(z80_loop, 1, sizeof(z80_loop), f);
+   fclose(f);
+   snprintf(path, sizeof(path), "%s/LOOP.inf", work_dir);
+   f = fopen(path, "w");
+   if (!f) {
+      return "can't write LOOP.inf";
+   }
+   fprintf(f, "$.LOOP %X %X\n", Z80_LOOP_ADDR, Z80_LOOP_ADDR);
+   fclose(f);
+   config->dir = work_dir;
+   config->commands[config->num_commands++] = "*RUN LOOP";
+   return NULL;
+}
+
+// Once the loop is running, write a byte to R1, which raises an IRQ that
+// stays pending until the loop re-enables interrupts at the end. The
+// client takes &80 as Escape being cleared.
+static void z80_irq_execute(void)
+{
+   native_host_sleep(Z80_LOOP_SETTLE);
+   native_host_write(1, 0x80);
+}
+
+static const char *prepare_z80_irq(const workload_t *w, native_mos_config_t *config)
+{
+   config->on_execute = z80_irq_execute;
+   return prepare_z80(w, config);
+}
+
+// Fill, then search, each 64KB segment from 1000:0000 to 8000:FFFF. The
+// search string is never found, so every byte is compared.
+static const char *const x86_mem_commands[] = {
+   "*F 1000:0 FFFF 1234", "*SR 1000:0 FFFF \"ABC\"",
+   "*F 2000:0 FFFF 1234", "*SR 2000:0 FFFF \"ABC\"",
+   "*F 3000:0 FFFF 1234", "*SR 3000:0 FFFF \"ABC\"",
+   "*F 4000:0 FFFF 1234", "*SR 4000:0 FFFF \"ABC\"",
+   "*F 5000:0 FFFF 1234", "*SR 5000:0 FFFF \"ABC\"",
+   "*F 6000:0 FFFF 1234", "*SR 6000:0 FFFF \"ABC\"",
+   "*F 7000:0 FFFF 1234", "*SR 7000:0 FFFF \"ABC\"",
+   "*F 8000:0 FFFF 1234", "*SR 8000:0 FFFF \"ABC\"",
+};
+
+static const char *prepare_x86_mem(const workload_t *w, native_mos_config_t *config)
+{
+   for (unsigned int i = 0; i < sizeof(x86_mem_commands) / sizeof(x86_mem_commands[0]); i++) {
+      config->commands[config->num_commands++] = x86_mem_commands[i];
+   }
+   return NULL;
+}
+
+static uint8_t bic_image[0x10000];
+static uint16_t bic_start;
+
+// Absolute loader format: blocks of 01 00, length (including the 6 byte
+// header), load address, data, checksum. A block with no data gives the
+// start address.
+static const char *load_bic(const char *path)
+{
+   int c;
+   FILE *f = fopen(path, "rb");
+   if (!f) {
+      return "no diagnostic (-p)";
+   }
+   while ((c = fgetc(f)) != EOF) {
+      if (c != 1) {
+         continue;
+      }
+      if (fgetc(f) != 0) {
+         continue;
+      }
+      int len = fgetc(f);
+      len |= fgetc(f) << 8;
+      int addr = fgetc(f);
+      addr |= fgetc(f) << 8;
+      if (len < 6 || addr < 0) {
+         break;
+      }
+      if (len == 6) {
+         bic_start = (uint16_t)addr;
+         fclose(f);
+         return NULL;
+      }
+      for (int i = 0; i < len - 6; i++) {
+         c = fgetc(f);
+         if (c == EOF) {
+            break;
+         }
+         bic_image[(addr + i) & 0xFFFF] = (uint8_t)c;
+      }
+      // Checksum
+      fgetc(f);
+   }
+   fclose(f);
+   return "bad diagnostic";
+}
+
+static const char *prepare_pdp11(const workload_t *w, native_mos_config_t *config)
+{
+   char path[512];
+   snprintf(path, sizeof(path), "%s/%s.BIC", pdp11_dir, w->arg);
+   return load_bic(path);
+}
+
+// The diagnostics run standalone, so once the client has booted wait for
+// an instruction boundary (native_host_sleep() only returns from a tick),
+// replace the client with the diagnostic and restart the CPU at its entry
+// point. There is no DL11, so the console status register is made to read
+// as always ready, in the client ROM's now unused space.
+static void pdp11_host(void)
+{
+   native_mos_boot();
+   native_host_sleep(1);
+   uint8_t *memory = copro_mem_reset(0);
+   memcpy(memory, bic_image, PDP11_XCSR);
+   memory[PDP11_XCSR] = 0x80;
+   memory[PDP11_XCSR + 1] = 0x00;
+   pdp11_reset(bic_start & 1 ? PDP11_START : bic_start);
+   uint64_t end = native_ula_instructions() + pdp11_instructions;
+   while (native_ula_instructions() < end) {
+      uint64_t left = end - native_ula_instructions();
+      native_host_sleep(left < PDP11_CHUNK ? (int)left : PDP11_CHUNK);
+      if (m_pdp11->halted) {
+         run_status = "halted";
+         break;
+      }
+   }
+   native_mos_end();
+}
+
+static const workload_t workloads[] = {
+   { "boot",          any_core,  prepare_boot,   NULL,       NULL },
+   { "sphere",        is_6502,   prepare_basic,  NULL,       "PAGE=&800" },
+   { "clocksp",       is_6502,   prepare_basic,  NULL,       "PAGE=&1000" },
+   { "pi-spigot",     is_opc5ls, prepare_spigot, NULL,       NULL },
+   { "z80-loop",      is_z80,    prepare_z80,    NULL,       NULL },
+   { "z80-loop-irq",  is_z80,    prepare_z80_irq, NULL,      NULL },
+   { "x86-mem",       is_80186,  prepare_x86_mem, NULL,      NULL },
+   { "pdp11-fkaca0",  is_pdp11,  prepare_pdp11,  pdp11_host, "FKACA0" },
+};
+
+#define NUM_WORKLOADS (sizeof(workloads) / sizeof(workloads[0]))
+
+// ============================================================
+// Running
+// ============================================================
+
+// ClockSp finishes with "Combined Average   n.nnMHz"
+static double parse_clocksp(FILE *f)
+{
+   char buf[256];
+   double mhz = -1;
+   rewind(f);
+   while (fgets(buf, sizeof(buf), f)) {
+      char *p = strstr(buf, "Combined Average");
+      if (p) {
+         mhz = strtod(p + strlen("Combined Average"), NULL);
+      }
+   }
+   return mhz;
+}
+
+static void run_child(int fd, unsigned int n, const workload_t *w)
+{
+   native_mos_config_t config;
+   struct timespec start, end;
+   char record[128];
+
+   memset(&config, 0, sizeof(config));
+   const char *skip = w->prepare(w, &config);
+   if (skip) {
+      snprintf(record, sizeof(record), "skipped %s", skip);
+      if (write(fd, record, strlen(record)) < 0) {
+         _exit(1);
+      }
+      _exit(0);
+   }
+
+   // Keep the Co Pro output for parsing, and out of the JSON
+   FILE *out = tmpfile();
+   if (!out) {
+      _exit(1);
+   }
+   fflush(stdout);
+   dup2(fileno(out), 1);
+
+   alarm(timeout_secs);
+   copro = n;
+   native_mos_init(&config);
+   native_ula_init(w->host ? w->host : native_mos_run);
+   tube_init_hardware();
+   tube_irq = TUBE_ENABLE_BIT;
+
+   clock_gettime(CLOCK_MONOTONIC, &start);
+   copro_defs[n].emulator(copro_defs[n].type);
+   clock_gettime(CLOCK_MONOTONIC, &end);
+   fflush(stdout);
+
+   double mhz = parse_clocksp(out);
+   double elapsed = (double)(end.tv_sec - start.tv_sec) + (double)(end.tv_nsec - start.tv_nsec) / 1e9;
+   snprintf(record, sizeof(record), "%s %.6f %llu %.2f", run_status, elapsed,
+            (unsigned long long)native_ula_instructions(), mhz);
+   if (write(fd, record, strlen(record)) < 0) {
+      _exit(1);
+   }
+   _exit(0);
+}
+
+static void run(unsigned int n, const workload_t *w, result_t *result, char *reason, size_t reason_len)
+{
+   int fds[2];
+   char record[128];
+   ssize_t len = 0;
+   ssize_t got;
+   int wstatus;
+
+   memset(result, 0, sizeof(*result));
+   result->mhz = -1;
+   reason[0] = 0;
+   strcpy(result->status, "failed");
+   if (pipe(fds) < 0) {
+      return;
+   }
+   fflush(stdout);
+   pid_t pid = fork();
+   if (pid < 0) {
+      close(fds[0]);
+      close(fds[1]);
+      return;
+   }
+   if (pid == 0) {
+      close(fds[0]);
+      run_child(fds[1], n, w);
+   }
+   close(fds[1]);
+   while (len < (ssize_t)sizeof(record) - 1 && (got = read(fds[0], record + len, sizeof(record) - 1 - len)) > 0) {
+      len += got;
+   }
+   record[len] = 0;
+   close(fds[0]);
+   waitpid(pid, &wstatus, 0);
+
+   if (WIFSIGNALED(wstatus)) {
+      strcpy(result->status, WTERMSIG(wstatus) == SIGALRM ? "timeout" : "crashed");
+   } else if (!strncmp(record, "skipped ", 8)) {
+      strcpy(result->status, "skipped");
+      snprintf(reason, reason_len, "%s", record + 8);
+   } else if (sscanf(record, "%15s %lf %llu %lf", result->status, &result->seconds,
+                     &result->instructions, &result->mhz) != 4) {
+      strcpy(result->status, "failed");
+   }
+}
+
+// ============================================================
+// Output
+// ============================================================
+
+static void json_string(const char *s)
+{
+   putchar('"');
+   for (; *s; s++) {
+      if (*s == '"' || *s == '\\') {
+         putchar('\\');
+      }
+      if ((unsigned char)*s >= 32) {
+         putchar(*s);
+      }
+   }
+   putchar('"');
+}
+
+static void print_result(int first, unsigned int n, const workload_t *w, const result_t *result, const char *reason)
+{
+   printf("%s\n    {\"copro\": %u, \"name\": ", first ? "" : ",", n);
+   json_string(copro_defs[n].name);
+   printf(", \"workload\": ");
+   json_string(w->name);
+   printf(", \"status\": ");
+   json_string(result->status);
+   if (reason[0]) {
+      printf(", \"reason\": ");
+      json_string(reason);
+   }
+   if (!strcmp(result->status, "ok") || !strcmp(result->status, "halted")) {
+      double mips = result->seconds > 0 ? (double)result->instructions / result->seconds / 1e6 : 0;
+      printf(", \"seconds\": %.3f, \"instructions\": %llu, \"mips\": %.2f", result->seconds, result->instructions, mips);
+      if (result->mhz >= 0) {
+         printf(", \"mhz\": %.2f", result->mhz);
+      } else {
+         printf(", \"mhz\": null");
+      }
+   }
+   printf("}");
+   fflush(stdout);
+}
+
+// ============================================================
+// Main
+// ============================================================
+
+static void usage(const char *prog)
+{
+   unsigned int i;
+   fprintf(stderr, "usage: %s [options]\n", prog);
+   fprintf(stderr, "  -c <n>     only run this Co Pro (may be repeated)\n");
+   fprintf(stderr, "  -w <name>  only run this workload (may be repeated)\n");
+   fprintf(stderr, "  -b <file>  6502 BASIC ROM, for sphere and clocksp\n");
+   fprintf(stderr, "  -s <file>  assembled pi-spigot-bruce.hex\n");
+   fprintf(stderr, "  -p <dir>   directory of PDP-11 .BIC diagnostics\n");
+   fprintf(stderr, "  -n <n>     instructions to run each PDP-11 diagnostic for\n");
+   fprintf(stderr, "  -t <secs>  give up on a run after this many seconds (default 60)\n");
+   fprintf(stderr, "Workloads:\n");
+   for (i = 0; i < NUM_WORKLOADS; i++) {
+      fprintf(stderr, "  %s\n", workloads[i].name);
+   }
+   exit(1);
+}
+
+static int selected(const char **list, int num, const char *name)
+{
+   if (num == 0) {
+      return 1;
+   }
+   for (int i = 0; i < num; i++) {
+      if (!strcmp(list[i], name)) {
+         return 1;
+      }
+   }
+   return 0;
+}
+
+int main(int argc, char **argv)
+{
+   int opt;
+   const char *copro_list[MAX_SELECT];
+   const char *workload_list[MAX_SELECT];
+   int num_copro_list = 0;
+   int num_workload_list = 0;
+   char number[16];
+   char reason[128];
+   result_t result;
+   int first = 1;
+
+   while ((opt = getopt(argc, argv, "c:w:b:s:p:n:t:h")) != -1) {
+      switch (opt) {
+      case 'c':
+         if (num_copro_list < MAX_SELECT) {
+            copro_list[num_copro_list++] = optarg;
+         }
+         break;
+      case 'w':
+         if (num_workload_list < MAX_SELECT) {
+            workload_list[num_workload_list++] = optarg;
+         }
+         break;
+      case 'b':
+         basic_rom = optarg;
+         break;
+      case 's':
+         spigot_hex = optarg;
+         break;
+      case 'p':
+         pdp11_dir = optarg;
+         break;
+      case 'n':
+         pdp11_instructions = strtoull(optarg, NULL, 0);
+         break;
+      case 't':
+         timeout_secs = (unsigned int)strtoul(optarg, NULL, 0);
+         break;
+      default:
+         usage(argv[0]);
+      }
+   }
+
+   if (!mkdtemp(work_dir)) {
+      perror("tube-bench: mkdtemp");
+      return 1;
+   }
+
+   printf("{\n  \"version\": ");
+   json_string(GITVERSION);
+   printf(",\n  \"results\": [");
+   for (unsigned int n = 0; n < num_copros(); n++) {
+      snprintf(number, sizeof(number), "%u", n);
+      if (!is_runnable(&copro_defs[n]) || !selected(copro_list, num_copro_list, number)) {
+         continue;
+      }
+      for (unsigned int i = 0; i < NUM_WORKLOADS; i++) {
+         const workload_t *w = &workloads[i];
+         if (!w->applies(&copro_defs[n]) || !selected(workload_list, num_workload_list, w->name)) {
+            continue;
+         }
+         run(n, w, &result, reason, sizeof(reason));
+         print_result(first, n, w, &result, reason);
+         first = 0;
+         fprintf(stderr, "tube-bench: %2u %-24s %-14s %s\n", n, copro_defs[n].name, w->name, result.status);
+      }
+   }
+   printf("\n  ]\n}\n");
+
+   // Clean up the program files
+   static const char *files[] = { "PI", "PI.inf", "LOOP", "LOOP.inf" };
+   char path[512];
+   for (unsigned int i = 0; i < sizeof(files) / sizeof(files[0]); i++) {
+      snprintf(path, sizeof(path), "%s/%s", work_dir, files[i]);
+      unlink(path);
+   }
+   rmdir(work_dir);
+   return 0;
+}
@@ -0,0 +1,139 @@
+// tube-capture.c
+//
+// Reading and writing of Tube mailbox captures (see tube-capture.h)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "tube-capture.h"
+
+#define HEADER_MAGIC "TUBECAP"
+#define HEADER_SIZE  16
+#define RECORD_SIZE  12
+
+static void put32(uint8_t *p, uint32_t value)
+{
+   for (int i = 0; i < 4; i++) {
+      p[i] = (uint8_t)(value >> (i * 8));
+   }
+}
+
+static uint32_t get32(const uint8_t *p)
+{
+   return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static capture_t *capture_open(const char *path, int writing)
+{
+   capture_t *c = calloc(1, sizeof(capture_t));
+   if (!c) {
+      return NULL;
+   }
+   c->file = fopen(path, writing ? "wb" : "rb");
+   if (!c->file) {
+      fprintf(stderr, "capture: can't open %s\n", path);
+      free(c);
+      return NULL;
+   }
+   c->writing = writing;
+   return c;
+}
+
+capture_t *capture_open_write(const char *path)
+{
+   uint8_t header[HEADER_SIZE];
+   capture_t *c = capture_open(path, 1);
+   if (!c) {
+      return NULL;
+   }
+   memset(header, 0, sizeof(header));
+   memcpy(header, HEADER_MAGIC, sizeof(HEADER_MAGIC));
+   put32(header + 8, CAPTURE_VERSION);
+   fwrite(header, 1, sizeof(header), c->file);
+   return c;
+}
+
+capture_t *capture_open_read(const char *path)
+{
+   uint8_t header[HEADER_SIZE];
+   capture_t *c = capture_open(path, 0);
+   if (!c) {
+      return NULL;
+   }
+   if (fread(header, 1, sizeof(header), c->file) != sizeof(header) ||
+       memcmp(header, HEADER_MAGIC, sizeof(HEADER_MAGIC)) ||
+       get32(header + 8) != CAPTURE_VERSION) {
+      fprintf(stderr, "capture: %s is not a version %d capture\n", path, CAPTURE_VERSION);
+      fclose(c->file);
+      free(c);
+      return NULL;
+   }
+   return c;
+}
+
+static void write_record(capture_t *c, const capture_record_t *record)
+{
+   uint8_t buf[RECORD_SIZE];
+   put32(buf, (uint32_t)record->time);
+   put32(buf + 4, (uint32_t)(record->time >> 32));
+   put32(buf + 8, record->mail);
+   fwrite(buf, 1, sizeof(buf), c->file);
+}
+
+static int is_status_read(uint32_t mail)
+{
+   return (mail & (CAPTURE_RNW | CAPTURE_RST | CAPTURE_RST_RELEASE)) == CAPTURE_RNW && !(CAPTURE_ADDR(mail) & 1);
+}
+
+static void flush_status(capture_t *c)
+{
+   // Write out the merged status reads in the order they were made
+   while (1) {
+      int next = -1;
+      for (int i = 0; i < 4; i++) {
+         if (c->pending[i] && (next < 0 || c->status[i].time < c->status[next].time)) {
+            next = i;
+         }
+      }
+      if (next < 0) {
+         break;
+      }
+      write_record(c, &c->status[next]);
+      c->pending[next] = 0;
+   }
+}
+
+void capture_write(capture_t *c, uint64_t time, uint32_t mail)
+{
+   capture_record_t record;
+   record.time = time;
+   record.mail = mail;
+   if (is_status_read(mail)) {
+      int i = CAPTURE_ADDR(mail) >> 1;
+      c->status[i] = record;
+      c->pending[i] = 1;
+   } else {
+      flush_status(c);
+      write_record(c, &record);
+   }
+}
+
+int capture_read(capture_t *c, capture_record_t *record)
+{
+   uint8_t buf[RECORD_SIZE];
+   if (fread(buf, 1, sizeof(buf), c->file) != sizeof(buf)) {
+      return 0;
+   }
+   record->time = get32(buf) | ((uint64_t)get32(buf + 4) << 32);
+   record->mail = get32(buf + 8);
+   return 1;
+}
+
+void capture_close(capture_t *c)
+{
+   if (c->writing) {
+      flush_status(c);
+   }
+   fclose(c->file);
+   free(c);
+}
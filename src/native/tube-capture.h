@@ -0,0 +1,66 @@
+// tube-capture.h
+
+#ifndef TUBE_CAPTURE_H
+#define TUBE_CAPTURE_H
+
+#include <inttypes.h>
+#include <stdio.h>
+
+// Capture of the host side of a Tube session, as the stream of mailbox
+// words the VideoCore hands to tube_io_handler()
+//
+// File format (all values little endian):
+//
+//   header : "TUBECAP" 0, uint32 version, uint32 reserved
+//   record : uint64 time, uint32 mail
+//
+// time is in 2MHz host cycles since the start of the capture (the native
+// host has no clock, so its captures count one cycle per Co Pro
+// instruction instead). mail uses the tube_io_handler() layout:
+//
+//   23..16 -> D7..D0 (for a read, the value the host saw)
+//   12     -> RST (active high)
+//   11     -> RnW
+//   10..8  -> A2..A0
+//
+// plus CAPTURE_RST_RELEASE, as the mailbox has no way to say that RST has
+// gone inactive.
+//
+// A host polling status registers would fill the capture with identical
+// reads, so a run of status reads is merged down to the last read of each
+// register (the values that ended the poll).
+
+#define CAPTURE_VERSION 1
+
+#define CAPTURE_DATA(mail)  (((mail) >> 16) & 0xFF)
+#define CAPTURE_RST         (1 << 12)
+#define CAPTURE_RNW         (1 << 11)
+#define CAPTURE_ADDR(mail)  (((mail) >> 8) & 7)
+#define CAPTURE_RST_RELEASE (1 << 24)
+
+typedef struct {
+   uint64_t time;
+   uint32_t mail;
+} capture_record_t;
+
+typedef struct {
+   FILE *file;
+   int writing;
+   // Writer: the latest read of each status register in the current run
+   int pending[4];
+   capture_record_t status[4];
+} capture_t;
+
+// Returns NULL (and prints why) on failure
+extern capture_t *capture_open_write(const char *path);
+
+extern capture_t *capture_open_read(const char *path);
+
+extern void capture_write(capture_t *c, uint64_t time, uint32_t mail);
+
+// Returns 0 at the end of the capture
+extern int capture_read(capture_t *c, capture_record_t *record);
+
+extern void capture_close(capture_t *c);
+
+#endif
@@ -0,0 +1,173 @@
+// tube-host.c
+//
+// Runs a single Co Pro core as an ordinary Linux process, connected to
+// a simulated BBC Micro host (see native-mos.c) through the software
+// Tube ULA (see native-ula.c).
+//
+// Example:
+//
+//   tube-host -c 4 -e "*HELP"
+//
+// boots the Z80 Co Pro, types *HELP at it, then exits at the next prompt.
+//
+// The simulated host cannot run 6502 code, so clients that download code
+// into the host and hook the host's vectors (e.g. the Z80 1.21 and 2.00
+// clients, which write to &0200 and &2500 with OSWORD 6) only partly work.
+// The 2.00 client never reaches a prompt, so unless the input is a
+// terminal a run is stopped with an error after DEFAULT_TIMEOUT seconds.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include "../tube-defs.h"
+#include "../tube.h"
+#include "../tube-ula.h"
+#include "../copro-defs.h"
+#include "native-ula.h"
+#include "native-mos.h"
+
+// Seconds before giving up, unless reading from a terminal
+#define DEFAULT_TIMEOUT 60
+
+static native_mos_config_t config;
+
+static void usage(const char *prog)
+{
+   unsigned int i;
+   fprintf(stderr, "usage: %s [options]\n", prog);
+   fprintf(stderr, "  -c <n>     Co Pro number (default 4)\n");
+   fprintf(stderr, "  -m <n>     Co Pro memory size, as *FX 151,228,n\n");
+   fprintf(stderr, "  -e <line>  type line at the Co Pro (may be repeated)\n");
+   fprintf(stderr, "  -i         after the -e lines, read further input from stdin\n");
+   fprintf(stderr, "  -l <file>  copy a language image across after the banner\n");
+   fprintf(stderr, "  -a <addr>  language load/start address (hex, default 8000)\n");
+   fprintf(stderr, "  -d <dir>   directory for host files (default .)\n");
+   fprintf(stderr, "  -r         pass the raw VDU stream to stdout\n");
+   fprintf(stderr, "  -t <secs>  give up after this many seconds (0 for never; default %d,\n", DEFAULT_TIMEOUT);
+   fprintf(stderr, "             or never when reading from a terminal)\n");
+   fprintf(stderr, "  -w <file>  capture the host side of the session (see tube-replay)\n");
+   fprintf(stderr, "Co Pros:\n");
+   for (i = 0; i < num_copros(); i++) {
+      if (copro_defs[i].type != TYPE_HIDDEN) {
+         fprintf(stderr, "  %2u %s\n", i, copro_defs[i].name);
+      }
+   }
+   exit(1);
+}
+
+static void timeout(int sig)
+{
+   static const char msg[] = "\ntube-host: timed out, the Co Pro never got back to a prompt (see -t)\n";
+   if (write(2, msg, sizeof(msg) - 1) < 0) {
+      // Nothing more we can do
+   }
+   _exit(2);
+}
+
+int main(int argc, char **argv)
+{
+   int opt;
+   int use_stdin = 0;
+   int secs = -1;
+   unsigned int memory = 0;
+   const char *capture_path = NULL;
+   capture_t *capture = NULL;
+   struct timespec start, end;
+
+   copro = 4;
+   config.language_addr = 0x8000;
+
+   while ((opt = getopt(argc, argv, "c:m:e:il:a:d:rt:w:h")) != -1) {
+      switch (opt) {
+      case 'c':
+         copro = (unsigned int)strtoul(optarg, NULL, 0);
+         break;
+      case 'm':
+         memory = (unsigned int)strtoul(optarg, NULL, 0);
+         break;
+      case 'e':
+         if (config.num_commands < NATIVE_MOS_MAX_COMMANDS) {
+            config.commands[config.num_commands++] = optarg;
+         }
+         break;
+      case 'i':
+         use_stdin = 1;
+         break;
+      case 'l':
+         config.language = optarg;
+         break;
+      case 'a':
+         config.language_addr = (uint32_t)strtoul(optarg, NULL, 16);
+         break;
+      case 'd':
+         config.dir = optarg;
+         break;
+      case 'r':
+         config.raw_vdu = 1;
+         break;
+      case 't':
+         secs = (int)strtoul(optarg, NULL, 0);
+         break;
+      case 'w':
+         capture_path = optarg;
+         break;
+      default:
+         usage(argv[0]);
+      }
+   }
+   if (copro >= num_copros()) {
+      usage(argv[0]);
+   }
+   // With no -e lines, take all the input from stdin
+   if (use_stdin || config.num_commands == 0) {
+      config.input = stdin;
+   }
+   // Memory size is encoded as for *FX 151,228,n
+   if (memory & 128) {
+      copro_memory_size = (memory & 127) * 8 * 1024 * 1024;
+   } else {
+      copro_memory_size = (memory & 127) * 64 * 1024;
+   }
+   if (secs < 0) {
+      secs = (config.input && isatty(fileno(config.input))) ? 0 : DEFAULT_TIMEOUT;
+   }
+   if (secs) {
+      signal(SIGALRM, timeout);
+      alarm((unsigned int)secs);
+   }
+
+   if (capture_path) {
+      capture = capture_open_write(capture_path);
+      if (!capture) {
+         return 1;
+      }
+   }
+
+   native_mos_init(&config);
+   native_ula_init(native_mos_run);
+   native_ula_capture(capture);
+   tube_init_hardware();
+
+   copro_def_t *copro_def = &copro_defs[copro];
+   if (copro_def->type == TYPE_HIDDEN || copro_def->type == TYPE_DISABLED) {
+      tube_irq = 0;
+   } else {
+      tube_irq = TUBE_ENABLE_BIT;
+   }
+
+   clock_gettime(CLOCK_MONOTONIC, &start);
+   copro_def->emulator(copro_def->type);
+   clock_gettime(CLOCK_MONOTONIC, &end);
+   fflush(stdout);
+   if (capture) {
+      native_ula_capture(NULL);
+      capture_close(capture);
+   }
+
+   double elapsed = (double)(end.tv_sec - start.tv_sec) + (double)(end.tv_nsec - start.tv_nsec) / 1e9;
+   fprintf(stderr, "\ntube-host: %s: %.3f s, %llu cycles\n", copro_def->name, elapsed, (unsigned long long)native_cycles);
+   return 0;
+}
@@ -0,0 +1,226 @@
+// tube-replay.c
+//
+// Replays a capture of the host side of a Tube session (see tube-capture.h)
+// against a Co Pro, with the software Tube ULA (see native-ula.c) in place
+// of the VideoCore. Captures can be made with tube-host -w:
+//
+//   tube-host -c 6 -w save.tcap -e "*SAVE TEST 0 8000"
+//   tube-replay -c 6 save.tcap
+//
+// Writes and RST are replayed exactly as captured. Status reads are where
+// the replay keeps in step with the Co Pro: the host waits until the FIFO
+// flags (bits 7 and 6) match the capture, as the original host must have
+// done. Data reads are compared byte for byte with the capture, so the
+// same capture can be used to check that a change to the ULA, or to a
+// core, still produces exactly the same session.
+//
+// Before each access the host waits for the captured gap since the last
+// one, at -p Co Pro instructions per host cycle. The default of 1 repeats
+// a capture made by tube-host with its original timing, which matters
+// where the host deliberately gives the Co Pro time (e.g. to take the
+// last NMI of a transfer before the release). -p 0 makes the host
+// infinitely fast, only waiting where it has to.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "../tube-defs.h"
+#include "../tube.h"
+#include "../tube-ula.h"
+#include "../copro-defs.h"
+#include "native-ula.h"
+#include "native-mos.h"
+#include "tube-capture.h"
+
+// Co Pro instructions to wait for a status register to match the capture
+#define DEFAULT_STALL_LIMIT 10000000ULL
+
+// Mismatches to report individually
+#define MAX_REPORTS 20
+
+static capture_t *capture;
+static unsigned int pace = 1;
+static uint64_t stall_limit = DEFAULT_STALL_LIMIT;
+static int vdu_output;
+
+static uint64_t records;
+static uint64_t reads;
+static uint64_t mismatches;
+static int stalled;
+
+static unsigned int sync_addr;
+static uint8_t sync_value;
+static uint64_t sync_deadline;
+
+static void mismatch(const char *what, unsigned int addr, uint8_t value, uint8_t expected)
+{
+   mismatches++;
+   if (mismatches <= MAX_REPORTS) {
+      fprintf(stderr, "tube-replay: record %llu: %s %u read &%02X, captured &%02X\n",
+              (unsigned long long)records, what, addr, value, expected);
+   }
+}
+
+static int flags_match(uint8_t value)
+{
+   return !((value ^ sync_value) & 0xC0);
+}
+
+static int status_synced(void)
+{
+   return flags_match(native_host_read(sync_addr)) || native_ula_instructions() >= sync_deadline;
+}
+
+static void replay_status_read(unsigned int addr, uint8_t expected)
+{
+   sync_addr = addr;
+   sync_value = expected;
+   sync_deadline = native_ula_instructions() + stall_limit;
+   native_host_wait(status_synced);
+   uint8_t value = native_host_read(addr);
+   if (!flags_match(value)) {
+      fprintf(stderr, "tube-replay: record %llu: stalled waiting for status %u = &%02X (is &%02X)\n",
+              (unsigned long long)records, addr, expected, value);
+      stalled = 1;
+      native_mos_end();
+   }
+   if (value != expected) {
+      mismatch("status", addr, value, expected);
+   }
+}
+
+static void replay_data_read(unsigned int addr, uint8_t expected)
+{
+   uint8_t value = native_host_read(addr);
+   reads++;
+   if (vdu_output && addr == 1) {
+      putchar(value);
+   }
+   if (value != expected) {
+      mismatch("register", addr, value, expected);
+   }
+}
+
+static void replay_host(void)
+{
+   capture_record_t record;
+   uint64_t last_time = 0;
+   while (capture_read(capture, &record)) {
+      if (pace && records && record.time > last_time) {
+         uint64_t ticks = (record.time - last_time) * pace;
+         while (ticks) {
+            int n = ticks > 0x40000000 ? 0x40000000 : (int)ticks;
+            native_host_sleep(n);
+            ticks -= (uint64_t)n;
+         }
+      }
+      last_time = record.time;
+      records++;
+      uint32_t mail = record.mail;
+      unsigned int addr = CAPTURE_ADDR(mail);
+      uint8_t data = (uint8_t)CAPTURE_DATA(mail);
+      if (mail & CAPTURE_RST_RELEASE) {
+         native_host_set_rst(0);
+      } else if (mail & CAPTURE_RST) {
+         native_host_set_rst(1);
+      } else if (!(mail & CAPTURE_RNW)) {
+         native_host_write(addr, data);
+      } else if (addr & 1) {
+         replay_data_read(addr, data);
+      } else {
+         replay_status_read(addr, data);
+      }
+   }
+   // A capture normally ends with the session being ended, but in case it
+   // was cut short end it here
+   native_mos_end();
+}
+
+static void usage(const char *prog)
+{
+   unsigned int i;
+   fprintf(stderr, "usage: %s [options] <capture>\n", prog);
+   fprintf(stderr, "  -c <n>     Co Pro number (default 4)\n");
+   fprintf(stderr, "  -m <n>     Co Pro memory size, as *FX 151,228,n\n");
+   fprintf(stderr, "  -p <n>     Co Pro instructions per captured host cycle (default 1)\n");
+   fprintf(stderr, "  -s <n>     Co Pro instructions to wait for a status match (default %llu)\n",
+           (unsigned long long)DEFAULT_STALL_LIMIT);
+   fprintf(stderr, "  -v         copy the R1 (VDU) bytes read to stdout\n");
+   fprintf(stderr, "Co Pros:\n");
+   for (i = 0; i < num_copros(); i++) {
+      if (copro_defs[i].type != TYPE_HIDDEN) {
+         fprintf(stderr, "  %2u %s\n", i, copro_defs[i].name);
+      }
+   }
+   exit(1);
+}
+
+int main(int argc, char **argv)
+{
+   int opt;
+   unsigned int memory = 0;
+   struct timespec start, end;
+
+   copro = 4;
+
+   while ((opt = getopt(argc, argv, "c:m:p:s:vh")) != -1) {
+      switch (opt) {
+      case 'c':
+         copro = (unsigned int)strtoul(optarg, NULL, 0);
+         break;
+      case 'm':
+         memory = (unsigned int)strtoul(optarg, NULL, 0);
+         break;
+      case 'p':
+         pace = (unsigned int)strtoul(optarg, NULL, 0);
+         break;
+      case 's':
+         stall_limit = strtoull(optarg, NULL, 0);
+         break;
+      case 'v':
+         vdu_output = 1;
+         break;
+      default:
+         usage(argv[0]);
+      }
+   }
+   if (optind != argc - 1 || copro >= num_copros()) {
+      usage(argv[0]);
+   }
+   capture = capture_open_read(argv[optind]);
+   if (!capture) {
+      return 1;
+   }
+   // Memory size is encoded as for *FX 151,228,n
+   if (memory & 128) {
+      copro_memory_size = (memory & 127) * 8 * 1024 * 1024;
+   } else {
+      copro_memory_size = (memory & 127) * 64 * 1024;
+   }
+
+   native_ula_init(replay_host);
+   tube_init_hardware();
+
+   copro_def_t *copro_def = &copro_defs[copro];
+   if (copro_def->type == TYPE_HIDDEN || copro_def->type == TYPE_DISABLED) {
+      tube_irq = 0;
+   } else {
+      tube_irq = TUBE_ENABLE_BIT;
+   }
+
+   clock_gettime(CLOCK_MONOTONIC, &start);
+   copro_def->emulator(copro_def->type);
+   clock_gettime(CLOCK_MONOTONIC, &end);
+   fflush(stdout);
+   capture_close(capture);
+
+   double elapsed = (double)(end.tv_sec - start.tv_sec) + (double)(end.tv_nsec - start.tv_nsec) / 1e9;
+   uint64_t instructions = native_ula_instructions();
+   fprintf(stderr, "tube-replay: %s: %llu records, %llu data reads, %llu mismatches%s, %.3f s, %llu instructions (%.2f MIPS)\n",
+           copro_def->name, (unsigned long long)records, (unsigned long long)reads,
+           (unsigned long long)mismatches, stalled ? ", stalled" : "", elapsed,
+           (unsigned long long)instructions, elapsed > 0 ? (double)instructions / elapsed / 1e6 : 0.0);
+   return (mismatches || stalled) ? 1 : 0;
+}
@@ -1,4 +1,5 @@
 #include <stdio.h>
+#include <string.h>
 #include "opc5ls.h"
 #include "../tube.h"
 #include "../copro-opc5ls.h"
@@ -17,6 +18,33 @@ opc5ls_state *m_opc5ls = &s;
 #define OPC5LS_READ copro_opc5ls_read
 #define OPC5LS_WRITE copro_opc5ls_write
 
+opc5ls_decoded opc5ls_predecode[0x10000];
+
+// The predicate evaluated for each possible value of the Z, C and S flags,
+// so testing it is a single lookup
+static const uint8_t pred_mask[8] = {
+   0xFF, // 0: always
+   0x00, // 1: never
+   0xAA, // 2: Z
+   0x55, // 3: NZ
+   0xCC, // 4: C
+   0x33, // 5: NC
+   0xF0, // 6: MI
+   0x0F  // 7: PL
+};
+
+static opc5ls_decoded *predecode(uint16_t addr) {
+   opc5ls_decoded *d = &opc5ls_predecode[addr];
+   uint16_t instr = *(s.memory + addr);
+   d->operand = ((instr >> LEN) & 1) ? *(s.memory + (uint16_t) (addr + 1)) : 0;
+   d->opcode = (instr >> OPCODE) & 15;
+   d->pred_mask = pred_mask[(instr >> PRED) & 7];
+   d->src = (instr >> SRC) & 15;
+   d->dst = (instr >> DST) & 15;
+   d->len = (uint8_t) (((instr >> LEN) & 1) + 1);
+   return d;
+}
+
 static void int_action() {
    s.pc_int = s.reg[PC];
    s.psr_int = (uint16_t) (s.psr & ~SWI_MASK); // Always clear the swi flag in the saved copy
@@ -39,48 +67,29 @@ void opc5ls_execute() {
 
       DBG_PRINT("%04x ", s.reg[PC]);
 
-      // Fetch the instruction
-      register uint16_t instr = *(s.memory + s.reg[PC]++);
-
-      DBG_PRINT("%04x ", instr);
-
-      // Fetch the optional operant
-      register int operand = ((instr >> LEN) & 1) ? *(s.memory + s.reg[PC]++) : 0;
+      // Fetch the instruction and optional operand, already decoded
+      uint16_t pc = s.reg[PC];
+      const opc5ls_decoded *d = &opc5ls_predecode[pc];
+      if (!d->len) {
+         d = predecode(pc);
+      }
+      s.reg[PC] = (uint16_t) (pc + d->len);
+      register int operand = d->operand;
 
+      DBG_PRINT("%04x ", *(s.memory + pc));
       DBG_PRINT("%04x %02x", operand, s.psr);
       DBG_PRINT("\r\n");
 
-      // Evaluate the predicate
-      register int pred = (instr >> PRED) & 7;
-      switch (pred) {
-      case 0:
-         pred = 1; break;
-      case 1:
-         pred = 0; break;
-      case 2:
-         pred = s.psr & Z_MASK; break;
-      case 3:
-         pred = !(s.psr & Z_MASK); break;
-      case 4:
-         pred = s.psr & C_MASK; break;
-      case 5:
-         pred = !(s.psr & C_MASK); break;
-      case 6:
-         pred = s.psr & S_MASK; break;
-      case 7:
-         pred = !(s.psr & S_MASK); break;
-      }
-
       // Conditionally execute the instruction
-      if (pred) {
+      if ((d->pred_mask >> (s.psr & 7)) & 1) {
 
          // Force register 0 to be zero (it's overwritten by cmp)
          s.reg[0] = 0;
 
          // Decode the instruction
-         int dst = (instr >> DST) & 15;
-         int src = (instr >> SRC) & 15;
-         int opcode = (instr >> OPCODE) & 15;
+         int dst = d->dst;
+         int src = d->src;
+         int opcode = d->opcode;
          uint16_t ea_ed = (uint16_t) (s.reg[src] + operand) & 0xffff;
 
          // Setup carry going into the "ALU"
@@ -172,7 +181,7 @@ void opc5ls_execute() {
                // getpsr
                s.reg[dst] = s.psr & PSR_MASK;
             } else {
-               DBG_PRINT("Illegal PSR instruction: %04x\r\n", instr);
+               DBG_PRINT("Illegal PSR instruction: %04x\r\n", *(s.memory + pc));
             }
             break;
          }
@@ -212,6 +221,7 @@ void opc5ls_irq() {
 
 void opc5ls_init(uint16_t *memory, uint16_t pc_rst, uint16_t pc_irq) {
    s.memory = memory;
+   memset(opc5ls_predecode, 0, sizeof(opc5ls_predecode));
    s.pc_rst = pc_rst;
    s.pc_irq = pc_irq;
 }
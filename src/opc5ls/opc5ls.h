@@ -68,6 +68,26 @@ typedef struct {
 
 extern opc5ls_state *m_opc5ls;
 
+// Predecoded form of the instruction at each word of memory (kept to 8 bytes)
+typedef struct {
+   uint16_t operand;
+   uint8_t opcode;
+   uint8_t pred_mask; // bit n set if the instruction executes when psr & 7 == n
+   uint8_t src;
+   uint8_t dst;
+   uint8_t len;       // zero if the entry needs decoding
+   uint8_t unused;
+} opc5ls_decoded;
+
+extern opc5ls_decoded opc5ls_predecode[0x10000];
+
+// Memory writes must discard the instruction decoded from that word, and
+// the one before, whose operand it may be
+#define OPC5LS_INVALIDATE(addr) do { \
+      opc5ls_predecode[(uint16_t) (addr)].len = 0; \
+      opc5ls_predecode[(uint16_t) ((addr) - 1)].len = 0; \
+   } while (0)
+
 enum {
    op_mov,
    op_and,
@@ -1,4 +1,5 @@
 #include <stdio.h>
+#include <string.h>
 #include "opc6.h"
 #include "../tube.h"
 #include "../copro-opc6.h"
@@ -19,6 +20,45 @@ opc6_state *m_opc6 = &s;
 #define OPC6_READ_IO copro_opc6_read_io
 #define OPC6_WRITE_IO copro_opc6_write_io
 
+opc6_decoded opc6_predecode[0x10000];
+
+// The predicate evaluated for each possible value of the Z, C and S flags,
+// so testing it is a single lookup
+static const uint8_t pred_mask[8] = {
+   0xFF, // 0: always
+   0xFF, // 1: always (selects opcodes 16-31)
+   0xAA, // 2: Z
+   0x55, // 3: NZ
+   0xCC, // 4: C
+   0x33, // 5: NC
+   0xF0, // 6: MI
+   0x0F  // 7: PL
+};
+
+static opc6_decoded *predecode(uint16_t addr) {
+   opc6_decoded *d = &opc6_predecode[addr];
+   uint16_t instr = *(s.memory + addr);
+   int opcode = (instr >> OPCODE) & 15;
+   if (((instr >> PRED) & 7) == 1) {
+      opcode += 16;
+   }
+   if ((instr >> LEN) & 1) {
+      d->operand = *(s.memory + (uint16_t) (addr + 1));
+   } else if (opcode == op_push) {
+      d->operand = 0xffff;
+   } else if (opcode == op_pop) {
+      d->operand = 0x0001;
+   } else {
+      d->operand = 0;
+   }
+   d->opcode = (uint8_t) opcode;
+   d->pred_mask = pred_mask[(instr >> PRED) & 7];
+   d->src = (instr >> SRC) & 15;
+   d->dst = (instr >> DST) & 15;
+   d->len = (uint8_t) (((instr >> LEN) & 1) + 1);
+   return d;
+}
+
 static void int_action(int id) {
    s.pc_int = s.reg[PC];
    s.psr_int = (uint16_t) (s.psr & ~SWI_MASK); // Always clear the swi flag in the saved copy
@@ -41,59 +81,30 @@ void opc6_execute() {
 
       DBG_PRINT("%04x ", s.reg[PC]);
 
-      // Fetch the instruction
-      register uint16_t instr = *(s.memory + s.reg[PC]++);
-      DBG_PRINT("%04x ", instr);
-
-      // Extract the opcode
-      register int opcode = (instr >> OPCODE) & 15;
-
-      // Evaluate the predicate
-      register int pred = (instr >> PRED) & 7;
-      switch (pred) {
-      case 0:
-         pred = 1; break;
-      case 1:
-         pred = 1; opcode += 16; break;
-      case 2:
-         pred = s.psr & Z_MASK; break;
-      case 3:
-         pred = !(s.psr & Z_MASK); break;
-      case 4:
-         pred = s.psr & C_MASK; break;
-      case 5:
-         pred = !(s.psr & C_MASK); break;
-      case 6:
-         pred = s.psr & S_MASK; break;
-      case 7:
-         pred = !(s.psr & S_MASK); break;
+      // Fetch the instruction and operand, already decoded
+      uint16_t pc = s.reg[PC];
+      const opc6_decoded *d = &opc6_predecode[pc];
+      if (!d->len) {
+         d = predecode(pc);
       }
+      s.reg[PC] = (uint16_t) (pc + d->len);
+      DBG_PRINT("%04x ", *(s.memory + pc));
 
-      // Evaluate the operand
-      register int operand;
-
-      if ((instr >> LEN) & 1) {
-         operand = *(s.memory + s.reg[PC]++);
-      } else if (opcode == op_push) {
-         operand = 0xffff;
-      } else if (opcode == op_pop) {
-         operand = 0x0001;
-      } else {
-         operand = 0;
-      }
+      register int opcode = d->opcode;
+      register int operand = d->operand;
 
       DBG_PRINT("%04x %02x", operand, s.psr);
       DBG_PRINT("\r\n");
 
       // Conditionally execute the instruction
-      if (pred) {
+      if ((d->pred_mask >> (s.psr & 7)) & 1) {
 
          // Force register 0 to be zero (it's overwritten by cmp)
          s.reg[0] = 0;
 
          // Decode the instruction
-         int dst = (instr >> DST) & 15;
-         int src = (instr >> SRC) & 15;
+         int dst = d->dst;
+         int src = d->src;
          uint16_t ea_ed = (uint16_t) ((s.reg[src] + operand) & 0xffff);
 
          // Setup carry going into the "ALU"
@@ -266,6 +277,7 @@ void opc6_irq(int id) {
 
 void opc6_init(uint16_t *memory, uint16_t pc_rst, uint16_t pc_irq0, uint16_t pc_irq1) {
    s.memory = memory;
+   memset(opc6_predecode, 0, sizeof(opc6_predecode));
    s.pc_rst = pc_rst;
    s.pc_irq[0] = pc_irq0;
    s.pc_irq[1] = pc_irq1;
@@ -67,6 +67,26 @@ typedef struct {
 
 extern opc6_state *m_opc6;
 
+// Predecoded form of the instruction at each word of memory (kept to 8 bytes)
+typedef struct {
+   uint16_t operand;
+   uint8_t opcode;    // including the extra 16 opcodes selected by predicate 1
+   uint8_t pred_mask; // bit n set if the instruction executes when psr & 7 == n
+   uint8_t src;
+   uint8_t dst;
+   uint8_t len;       // zero if the entry needs decoding
+   uint8_t unused;
+} opc6_decoded;
+
+extern opc6_decoded opc6_predecode[0x10000];
+
+// Memory writes must discard the instruction decoded from that word, and
+// the one before, whose operand it may be
+#define OPC6_INVALIDATE(addr) do { \
+      opc6_predecode[(uint16_t) (addr)].len = 0; \
+      opc6_predecode[(uint16_t) ((addr) - 1)].len = 0; \
+   } while (0)
+
 enum {
    op_mov    = 0,
    op_and    = 1,
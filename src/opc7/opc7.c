@@ -1,4 +1,5 @@
 #include <stdio.h>
+#include <string.h>
 #include "opc7.h"
 #include "../tube.h"
 #include "../copro-opc7.h"
@@ -19,6 +20,48 @@ opc7_state *m_opc7 = &s;
 #define OPC7_READ_IO copro_opc7_read_io
 #define OPC7_WRITE_IO copro_opc7_write_io
 
+opc7_decoded opc7_predecode[OPC7_PREDECODE_SIZE];
+
+// The predicate evaluated for each possible value of the Z, C and S flags,
+// so testing it is a single lookup
+static const uint8_t pred_mask[8] = {
+   0xFF, // 0: always
+   0x00, // 1: never
+   0xAA, // 2: Z
+   0x55, // 3: NZ
+   0xCC, // 4: C
+   0x33, // 5: NC
+   0xF0, // 6: MI
+   0x0F  // 7: PL
+};
+
+static opc7_decoded *predecode(uint32_t addr) {
+   opc7_decoded *d = &opc7_predecode[addr & (OPC7_PREDECODE_SIZE - 1)];
+   uint32_t instr = *(s.memory + addr);
+   uint32_t opcode = (instr >> OPCODE) & 0x1f;
+   uint32_t operand;
+
+   // The operand is in one of two formats, and needs sign extension
+   if (opcode >= op_ljsr){
+     operand = instr & 0xfffff;
+     if (operand & 0x80000){
+       operand |=  0xfff00000;
+     }
+   } else {
+     operand = instr & 0xffff;
+     if (operand & 0x8000){
+       operand |=  0xffff0000;
+     }
+   }
+   d->addr = addr;
+   d->operand = operand;
+   d->opcode = (uint8_t) opcode;
+   d->pred_mask = pred_mask[(instr >> PRED) & 7];
+   d->src = (opcode >= op_ljsr) ? 0 : (instr >> SRC) & 15;
+   d->dst = (instr >> DST) & 15;
+   return d;
+}
+
 static void int_action(int id) {
    s.pc_int = s.reg[PC];
    s.psr_int = s.psr & ~SWI_MASK; // Always clear the swi flag in the saved copy
@@ -40,65 +83,30 @@ void opc7_execute() {
 #endif
       DBG_PRINT("%04x ", s.reg[PC]);
 
-      // Fetch the instruction
-      register uint32_t instr = *(s.memory + s.reg[PC]++);
-      DBG_PRINT("%04x ", instr);
-
-      // Extract the opcode
-      register int opcode = (instr >> OPCODE) & 0x1f;
-
-      // Evaluate the predicate
-      register uint32_t pred = (instr >> PRED) & 7;
-      switch (pred) {
-      case 0:
-         pred = 1; break;
-      case 1:
-         pred = 0; break;
-      case 2:
-         pred = s.psr & Z_MASK; break;
-      case 3:
-         pred = !(s.psr & Z_MASK); break;
-      case 4:
-         pred = s.psr & C_MASK; break;
-      case 5:
-         pred = !(s.psr & C_MASK); break;
-      case 6:
-         pred = s.psr & S_MASK; break;
-      case 7:
-         pred = !(s.psr & S_MASK); break;
+      // Fetch the instruction, already decoded (masked as for data reads,
+      // the client ROM relies on the top bit of the PC being ignored)
+      uint32_t pc = s.reg[PC]++ & 0xFFFFF;
+      const opc7_decoded *d = &opc7_predecode[pc & (OPC7_PREDECODE_SIZE - 1)];
+      if (d->addr != pc) {
+         d = predecode(pc);
       }
+      DBG_PRINT("%04x ", *(s.memory + pc));
 
-      // Evaluate the operand (one of two formats; needs sign extension)
-      register uint32_t operand;
-
-      if (opcode >= op_ljsr){
-        operand = instr & 0xfffff;
-        if (operand & 0x80000){
-          operand |=  0xfff00000;
-        }
-      } else {
-        operand = instr & 0xffff;
-        if (operand & 0x8000){
-          operand |=  0xffff0000;
-        }
-      }
+      register int opcode = d->opcode;
+      register uint32_t operand = d->operand;
 
       DBG_PRINT("%04x %02x", operand, s.psr);
       DBG_PRINT("\r\n");
 
       // Conditionally execute the instruction
-      if (pred) {
+      if ((d->pred_mask >> (s.psr & 7)) & 1) {
 
          // Force register 0 to be zero (it's overwritten by cmp)
          s.reg[0] = 0;
 
          // Decode the instruction
-         int dst = (instr >> DST) & 15;
-         int src = (instr >> SRC) & 15;
-
-         if (opcode >= op_ljsr){  // long format instruction
-           src = 0;
-         }
+         int dst = d->dst;
+         int src = d->src;
 
          uint32_t ea_ed =  s.reg[src] + operand;
 
@@ -261,6 +269,7 @@ void opc7_irq(int id) {
 
 void opc7_init(uint32_t *memory, uint32_t pc_rst, uint32_t pc_irq0, uint32_t pc_irq1) {
    s.memory = memory;
+   memset(opc7_predecode, 0xFF, sizeof(opc7_predecode));
    s.pc_rst = pc_rst;
    s.pc_irq[0] = pc_irq0;
    s.pc_irq[1] = pc_irq1;
@@ -66,6 +66,29 @@ typedef struct {
 
 extern opc7_state *m_opc7;
 
+// Predecoded instructions; there are too many words of memory for one
+// entry each, so this is direct mapped on the bottom bits of the address
+#define OPC7_PREDECODE_SIZE 0x10000
+
+typedef struct {
+   uint32_t addr;     // address decoded from, or ~0 if the entry is empty
+   uint32_t operand;  // sign extended
+   uint8_t opcode;
+   uint8_t pred_mask; // bit n set if the instruction executes when psr & 7 == n
+   uint8_t src;       // zero for the long format instructions
+   uint8_t dst;
+} opc7_decoded;
+
+extern opc7_decoded opc7_predecode[OPC7_PREDECODE_SIZE];
+
+// Memory writes must discard any instruction decoded from that word
+#define OPC7_INVALIDATE(addr) do { \
+      opc7_decoded *d_ = &opc7_predecode[(addr) & (OPC7_PREDECODE_SIZE - 1)]; \
+      if (d_->addr == (addr)) { \
+         d_->addr = ~0u; \
+      } \
+   } while (0)
+
 enum {
    op_mov    = 0,
    op_movt   = 1,
@@ -1062,254 +1062,438 @@ static void RESET(uint16_t instr) {
    //rk11::reset();
 }
 
-static void step() {
-   cpu.PC = cpu.R[7];
+// Specialised forms of MOV, CMP, BIT and ADD for the common case of both
+// operands being registers, which avoids aget() and memread()/memwrite()
 
-#ifdef INCLUDE_DEBUGGER
-      if (pdp11_debug_enabled) {
-         debug_preexec(&pdp11_cpu_debug, cpu.PC);
-      }
-#endif
+static void MOV_RR(const uint16_t instr) {
+   const uint16_t uval = cpu.R[(instr >> 6) & 7];
+   cpu.PS &= 0xFFF1;
+   if (uval & 0x8000) {
+      cpu.PS |= FLAGN;
+   }
+   setZ(uval == 0);
+   cpu.R[instr & 7] = uval;
+}
 
-   uint16_t instr = read16(cpu.PC);
-   cpu.R[7] += 2;
+static void CMP_RR(const uint16_t instr) {
+   const uint16_t val1 = cpu.R[(instr >> 6) & 7];
+   const uint16_t val2 = cpu.R[instr & 7];
+   const uint16_t sval = val1 - val2;
+   cpu.PS &= 0xFFF0;
+   setZ(sval == 0);
+   if (sval & 0x8000) {
+      cpu.PS |= FLAGN;
+   }
+   if (((val1 ^ val2) & 0x8000) && (!((val2 ^ sval) & 0x8000))) {
+      cpu.PS |= FLAGV;
+   }
+   if (val1 < val2) {
+      cpu.PS |= FLAGC;
+   }
+}
+
+static void BIT_RR(const uint16_t instr) {
+   const uint16_t uval = cpu.R[(instr >> 6) & 7] & cpu.R[instr & 7];
+   cpu.PS &= 0xFFF1;
+   setZ(uval == 0);
+   if (uval & 0x8000) {
+      cpu.PS |= FLAGN;
+   }
+}
+
+static void ADD_RR(const uint16_t instr) {
+   const uint16_t val1 = cpu.R[(instr >> 6) & 7];
+   const uint16_t val2 = cpu.R[instr & 7];
+   const uint16_t uval = val1 + val2;
+   cpu.PS &= 0xFFF0;
+   setZ(uval == 0);
+   if (uval & 0x8000) {
+      cpu.PS |= FLAGN;
+   }
+   if (!((val1 ^ val2) & 0x8000) && ((val2 ^ uval) & 0x8000)) {
+      cpu.PS |= FLAGV;
+   }
+   if ((val1 + val2) > 0xFFFF) {
+      cpu.PS |= FLAGC;
+   }
+   cpu.R[instr & 7] = uval;
+}
+
+static void BR(uint16_t instr) {
+   branch(instr & 0xFF);
+}
+
+static void BNE(uint16_t instr) {
+   if (!Z()) {
+      branch(instr & 0xFF);
+   }
+}
+
+static void BEQ(uint16_t instr) {
+   if (Z()) {
+      branch(instr & 0xFF);
+   }
+}
+
+static void BGE(uint16_t instr) {
+   if (!((!N()) xor (!V()))) {
+      branch(instr & 0xFF);
+   }
+}
+
+static void BLT(uint16_t instr) {
+   if ((!N()) xor (!V())) {
+      branch(instr & 0xFF);
+   }
+}
+
+static void BGT(uint16_t instr) {
+   if ((!((!N()) xor (!V()))) && (!Z())) {
+      branch(instr & 0xFF);
+   }
+}
+
+static void BLE(uint16_t instr) {
+   if (((!N()) xor (!V())) || Z()) {
+      branch(instr & 0xFF);
+   }
+}
+
+static void BPL(uint16_t instr) {
+   if (!N()) {
+      branch(instr & 0xFF);
+   }
+}
+
+static void BMI(uint16_t instr) {
+   if (N()) {
+      branch(instr & 0xFF);
+   }
+}
+
+static void BHI(uint16_t instr) {
+   if ((!C()) && (!Z())) {
+      branch(instr & 0xFF);
+   }
+}
+
+static void BLOS(uint16_t instr) {
+   if (C() || Z()) {
+      branch(instr & 0xFF);
+   }
+}
+
+static void BVC(uint16_t instr) {
+   if (!V()) {
+      branch(instr & 0xFF);
+   }
+}
+
+static void BVS(uint16_t instr) {
+   if (V()) {
+      branch(instr & 0xFF);
+   }
+}
+
+static void BCC(uint16_t instr) {
+   if (!C()) {
+      branch(instr & 0xFF);
+   }
+}
+
+static void BCS(uint16_t instr) {
+   if (C()) {
+      branch(instr & 0xFF);
+   }
+}
+
+static void CCC(uint16_t instr) { // CL?, SE?
+   if (instr & 020) {
+      cpu.PS = (uint16_t)( cpu.PS | (instr & 017) );
+   } else {
+      cpu.PS = (uint16_t)( cpu.PS  & ~(instr & 017));
+   }
+}
+
+static void INVALID(uint16_t instr) {
+   printf("invalid instruction\r\n");
+   trap(INTINVAL);
+}
+
+static void HALT(uint16_t instr) {
+   if (cpu.curuser) {
+      INVALID(instr);
+      return;
+   }
+   printf("HALT\r\n");
+   panic();
+}
+
+static void WAIT(uint16_t instr) {
+   if (cpu.curuser) {
+      INVALID(instr);
+   }
+}
+
+static void SETD(uint16_t instr) {
+   // not needed by UNIX, but used; therefore ignored
+}
+
+// Instruction decoding is done once, by decode() below, for every possible
+// instruction word. step() then just indexes opdecode[] with the instruction
+// to find its handler in optable[].
+
+enum {
+   OP_INVALID,
+   OP_MOV, OP_MOV_RR, OP_CMP, OP_CMP_RR, OP_BIT, OP_BIT_RR, OP_BIC, OP_BIS,
+   OP_ADD, OP_ADD_RR, OP_SUB,
+   OP_JSR, OP_MUL, OP_DIV, OP_ASH, OP_ASHC, OP_XOR, OP_SOB,
+   OP_CLR, OP_COM, OP_INC, OP_DEC, OP_NEG, OP_ADC, OP_SBC, OP_TST,
+   OP_ROR, OP_ROL, OP_ASR, OP_ASL,
+   OP_JMP, OP_SWAB, OP_MARK, OP_MFPI, OP_MTPI, OP_SXT, OP_MTPS, OP_MFPS,
+   OP_RTS, OP_SPL,
+   OP_BR, OP_BNE, OP_BEQ, OP_BGE, OP_BLT, OP_BGT, OP_BLE, OP_BPL, OP_BMI,
+   OP_BHI, OP_BLOS, OP_BVC, OP_BVS, OP_BCC, OP_BCS,
+   OP_EMTX, OP_CCC, OP_HALT, OP_WAIT, OP_RTT, OP_RESET, OP_SETD,
+   NUM_OPS
+};
+
+static void (*const optable[NUM_OPS])(uint16_t instr) = {
+   [OP_INVALID] = INVALID,
+   [OP_MOV]     = MOV,
+   [OP_MOV_RR]  = MOV_RR,
+   [OP_CMP]     = CMP,
+   [OP_CMP_RR]  = CMP_RR,
+   [OP_BIT]     = BIT,
+   [OP_BIT_RR]  = BIT_RR,
+   [OP_BIC]     = BIC,
+   [OP_BIS]     = BIS,
+   [OP_ADD]     = ADD,
+   [OP_ADD_RR]  = ADD_RR,
+   [OP_SUB]     = SUB,
+   [OP_JSR]     = JSR,
+   [OP_MUL]     = MUL,
+   [OP_DIV]     = DIV,
+   [OP_ASH]     = ASH,
+   [OP_ASHC]    = ASHC,
+   [OP_XOR]     = XOR,
+   [OP_SOB]     = SOB,
+   [OP_CLR]     = CLR,
+   [OP_COM]     = COM,
+   [OP_INC]     = INC,
+   [OP_DEC]     = _DEC,
+   [OP_NEG]     = NEG,
+   [OP_ADC]     = _ADC,
+   [OP_SBC]     = SBC,
+   [OP_TST]     = TST,
+   [OP_ROR]     = ROR,
+   [OP_ROL]     = ROL,
+   [OP_ASR]     = ASR,
+   [OP_ASL]     = ASL,
+   [OP_JMP]     = JMP,
+   [OP_SWAB]    = SWAB,
+   [OP_MARK]    = MARK,
+   [OP_MFPI]    = MFPI,
+   [OP_MTPI]    = MTPI,
+   [OP_SXT]     = SXT,
+   [OP_MTPS]    = MTPS,
+   [OP_MFPS]    = MFPS,
+   [OP_RTS]     = RTS,
+   [OP_SPL]     = SPL,
+   [OP_BR]      = BR,
+   [OP_BNE]     = BNE,
+   [OP_BEQ]     = BEQ,
+   [OP_BGE]     = BGE,
+   [OP_BLT]     = BLT,
+   [OP_BGT]     = BGT,
+   [OP_BLE]     = BLE,
+   [OP_BPL]     = BPL,
+   [OP_BMI]     = BMI,
+   [OP_BHI]     = BHI,
+   [OP_BLOS]    = BLOS,
+   [OP_BVC]     = BVC,
+   [OP_BVS]     = BVS,
+   [OP_BCC]     = BCC,
+   [OP_BCS]     = BCS,
+   [OP_EMTX]    = EMTX,
+   [OP_CCC]     = CCC,
+   [OP_HALT]    = HALT,
+   [OP_WAIT]    = WAIT,
+   [OP_RTT]     = _RTT,
+   [OP_RESET]   = RESET,
+   [OP_SETD]    = SETD
+};
+
+// One byte per instruction word, so the table is only 64KB
+static uint8_t opdecode[0x10000];
+
+static uint8_t decode(const uint16_t instr) {
+   // Word sized, with both operands in register mode
+   const bool rr = (instr & 0107070) == 0;
 
    switch ((instr >> 12) & 007) {
    case 001: // MOV
-      MOV(instr);
-      return;
+      return rr ? OP_MOV_RR : OP_MOV;
    case 002: // CMP
-      CMP(instr);
-      return;
+      return rr ? OP_CMP_RR : OP_CMP;
    case 003: // BIT
-      BIT(instr);
-      return;
+      return rr ? OP_BIT_RR : OP_BIT;
    case 004: // BIC
-      BIC(instr);
-      return;
+      return OP_BIC;
    case 005: // BIS
-      BIS(instr);
-      return;
+      return OP_BIS;
    }
    switch ((instr >> 12) & 017) {
    case 006: // ADD
-      ADD(instr);
-      return;
+      return rr ? OP_ADD_RR : OP_ADD;
    case 016: // SUB
-      SUB(instr);
-      return;
+      return OP_SUB;
    }
    switch ((instr >> 9) & 0177) {
    case 0004: // JSR
-      JSR(instr);
-      return;
+      return OP_JSR;
    case 0070: // MUL
-      MUL(instr);
-      return;
+      return OP_MUL;
    case 0071: // DIV
-      DIV(instr);
-      return;
+      return OP_DIV;
    case 0072: // ASH
-      ASH(instr);
-      return;
+      return OP_ASH;
    case 0073: // ASHC
-      ASHC(instr);
-      return;
+      return OP_ASHC;
    case 0074: // XOR
-      XOR(instr);
-      return;
+      return OP_XOR;
    case 0077: // SOB
-      SOB(instr);
-      return;
+      return OP_SOB;
    }
    switch ((instr >> 6) & 00777) {
    case 00050: // CLR
-      CLR(instr);
-      return;
+      return OP_CLR;
    case 00051: // COM
-      COM(instr);
-      return;
+      return OP_COM;
    case 00052: // INC
-      INC(instr);
-      return;
+      return OP_INC;
    case 00053: // DEC
-      _DEC(instr);
-      return;
+      return OP_DEC;
    case 00054: // NEG
-      NEG(instr);
-      return;
+      return OP_NEG;
    case 00055: // ADC
-      _ADC(instr);
-      return;
+      return OP_ADC;
    case 00056: // SBC
-      SBC(instr);
-      return;
+      return OP_SBC;
    case 00057: // TST
-      TST(instr);
-      return;
+      return OP_TST;
    case 00060: // ROR
-      ROR(instr);
-      return;
+      return OP_ROR;
    case 00061: // ROL
-      ROL(instr);
-      return;
+      return OP_ROL;
    case 00062: // ASR
-      ASR(instr);
-      return;
+      return OP_ASR;
    case 00063: // ASL
-      ASL(instr);
-      return;
+      return OP_ASL;
    }
    switch (instr & 0177700) {
    case 0000100: // JMP
-      JMP(instr);
-      return;
+      return OP_JMP;
    case 0000300: // SWAB
-      SWAB(instr);
-      return;
+      return OP_SWAB;
    case 0006400: // MARK
-      MARK(instr);
-      return;
+      return OP_MARK;
    case 0006500: // MFPI
-      MFPI(instr);
-      return;
+      return OP_MFPI;
    case 0006600: // MTPI
-      MTPI(instr);
-      return;
+      return OP_MTPI;
    case 0006700: // SXT
-      SXT(instr);
-      return;
+      return OP_SXT;
    case 0106400: // MTPS
-      MTPS(instr);
-      return;
+      return OP_MTPS;
    case 0106700: // MFPS
-      MFPS(instr);
-      return;
+      return OP_MFPS;
    }
    if ((instr & 0177770) == 0000200) { // RTS
-      RTS(instr);
-      return;
+      return OP_RTS;
    }
    if ((instr & 0177770) == 0000230) { // SPL
-      SPL(instr);
-      return;
+      return OP_SPL;
    }
    switch (instr & 0177400) {
    case 0000400:
-      branch(instr & 0xFF);
-      return;
+      return OP_BR;
    case 0001000:
-      if (!Z()) {
-         branch(instr & 0xFF);
-      }
-      return;
+      return OP_BNE;
    case 0001400:
-      if (Z()) {
-         branch(instr & 0xFF);
-      }
-      return;
+      return OP_BEQ;
    case 0002000:
-      if (!((!N()) xor (!V()))) {
-         branch(instr & 0xFF);
-      }
-      return;
+      return OP_BGE;
    case 0002400:
-      if ((!N()) xor (!V())) {
-         branch(instr & 0xFF);
-      }
-      return;
+      return OP_BLT;
    case 0003000:
-      if ((!((!N()) xor (!V()))) && (!Z())) {
-         branch(instr & 0xFF);
-      }
-      return;
+      return OP_BGT;
    case 0003400:
-      if (((!N()) xor (!V())) || Z()) {
-         branch(instr & 0xFF);
-      }
-      return;
+      return OP_BLE;
    case 0100000:
-      if (!N()) {
-         branch(instr & 0xFF);
-      }
-      return;
+      return OP_BPL;
    case 0100400:
-      if (N()) {
-         branch(instr & 0xFF);
-      }
-      return;
+      return OP_BMI;
    case 0101000:
-      if ((!C()) && (!Z())) {
-         branch(instr & 0xFF);
-      }
-      return;
+      return OP_BHI;
    case 0101400:
-      if (C() || Z()) {
-         branch(instr & 0xFF);
-      }
-      return;
+      return OP_BLOS;
    case 0102000:
-      if (!V()) {
-         branch(instr & 0xFF);
-      }
-      return;
+      return OP_BVC;
    case 0102400:
-      if (V()) {
-         branch(instr & 0xFF);
-      }
-      return;
+      return OP_BVS;
    case 0103000:
-      if (!C()) {
-         branch(instr & 0xFF);
-      }
-      return;
+      return OP_BCC;
    case 0103400:
-      if (C()) {
-         branch(instr & 0xFF);
-      }
-      return;
+      return OP_BCS;
    }
    if (((instr & 0177000) == 0104000) || (instr == 3) ||
        (instr == 4)) { // EMT TRAP IOT BPT
-      EMTX(instr);
-      return;
+      return OP_EMTX;
    }
    if ((instr & 0177740) == 0240) { // CL?, SE?
-      if (instr & 020) {
-         cpu.PS = (uint16_t)( cpu.PS | (instr & 017) );
-      } else {
-         cpu.PS = (uint16_t)( cpu.PS  & ~(instr & 017));
-      }
-      return;
+      return OP_CCC;
    }
    switch (instr) {
    case 00: // HALT
-      if (cpu.curuser) {
-         break;
-      }
-      printf("HALT\r\n");
-      panic();
-      return;
+      return OP_HALT;
    case 01: // WAIT
-      if (cpu.curuser) {
-         break;
-      }
-      return;
+      return OP_WAIT;
    case 02: // RTI
-
    case 06: // RTT
-      _RTT(instr);
-      return;
+      return OP_RTT;
    case 05: // RESET
-      RESET(instr);
-      return;
+      return OP_RESET;
+   case 0170011: // SETD
+      return OP_SETD;
    }
-   if (instr ==
-       0170011) { // SETD ; not needed by UNIX, but used; therefore ignored
-      return;
+   return OP_INVALID;
+}
+
+static void decodeinit() {
+   static bool done = false;
+   if (!done) {
+      uint32_t instr;
+      for (instr = 0; instr < 0x10000; instr++) {
+         opdecode[instr] = decode((uint16_t) instr);
+      }
+      done = true;
    }
-   printf("invalid instruction\r\n");
-   trap(INTINVAL);
+}
+
+static void step() {
+   cpu.PC = cpu.R[7];
+
+#ifdef INCLUDE_DEBUGGER
+      if (pdp11_debug_enabled) {
+         debug_preexec(&pdp11_cpu_debug, cpu.PC);
+      }
+#endif
+
+   uint16_t instr = read16(cpu.PC);
+   cpu.R[7] += 2;
+
+   optable[opdecode[instr]](instr);
 }
 
 static void trapat(uint16_t vec) { // , msg string) {
@@ -1382,6 +1566,7 @@ static void handleinterrupt() {
 }
 
 void pdp11_reset(uint16_t address) {
+   decodeinit();
    cpu.LKS = 1 << 7;
    cpu.R[7] = address;
    cpu.PS = 0;
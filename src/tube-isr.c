@@ -318,6 +318,14 @@ void copro_armnative_tube_interrupt_handler(uint32_t mail) {
 
 #else
 
+// Account for n bytes transferred at tube_address
+static void transferred(unsigned int n) {
+  while (n-- > 0) {
+    count++;
+    signature += *tube_address++;
+    signature *= 13;
+  }
+}
 
 // single byte parasite -> host (e.g. *SAVE)
 void type_0_data_transfer(void) {
@@ -336,10 +344,7 @@ void type_0_data_transfer(void) {
       // If there is an NMI condition, handle the byte
       if (intr & 2) {
         // Write the R3 data register, which should also clear the NMI
-        tubeWrite(R3_DATA, *tube_address);
-        count++;
-        signature += *tube_address++;
-        signature *= 13;
+        transferred(tube_parasite_write_burst(R3_DATA, (const uint8_t *) tube_address, 1, 1));
       }
     }
   }
@@ -362,10 +367,7 @@ void type_1_data_transfer(void) {
       // If there is an NMI condition, handle the byte
       if (intr & 2) {
         // Read the R3 data register, which should also clear the NMI
-        *tube_address = tubeRead(R3_DATA);
-        count++;
-        signature += *tube_address++;
-        signature *= 13;
+        transferred(tube_parasite_read_burst(R3_DATA, (uint8_t *) tube_address, 1, 1));
       }
     }
   }
@@ -386,16 +388,8 @@ void type_2_data_transfer(void) {
       }
       // If there is an NMI condition, handle the byte
       if (intr & 2) {
-        // Write the R3 data register, which should also clear the NMI
-        tubeWrite(R3_DATA, *tube_address);
-        count++;
-        signature += *tube_address++;
-        signature *= 13;
-        // Write the R3 data register, which should also clear the NMI
-        tubeWrite(R3_DATA, *tube_address);
-        count++;
-        signature += *tube_address++;
-        signature *= 13;
+        // Write both bytes to the R3 data register, which should also clear the NMI
+        transferred(tube_parasite_write_burst(R3_DATA, (const uint8_t *) tube_address, 2, 1));
       }
     }
   }
@@ -416,16 +410,8 @@ void type_3_data_transfer(void) {
       }
       // If there is an NMI condition, handle the byte
       if (intr & 2) {
-        // Read the R3 data register, which should also clear the NMI
-        *tube_address = tubeRead(R3_DATA);
-        count++;
-        signature += *tube_address++;
-        signature *= 13;
-        // Read the R3 data register, which should also clear the NMI
-        *tube_address = tubeRead(R3_DATA);
-        count++;
-        signature += *tube_address++;
-        signature *= 13;
+        // Read both bytes from the R3 data register, which should also clear the NMI
+        transferred(tube_parasite_read_burst(R3_DATA, (uint8_t *) tube_address, 2, 1));
       }
     }
   }
@@ -442,11 +428,8 @@ void type_6_data_transfer(void) {
       intr = tube_io_handler(mailbox);
       // If there is an NMI condition, handle the byte
       if (intr & 2) {
-        // Read the R3 data register, which should also clear the NMI
-        tubeWrite(R3_DATA, *tube_address);
-        count++;
-        signature += *tube_address++;
-        signature *= 13;
+        // Write the R3 data register, which should also clear the NMI
+        transferred(tube_parasite_write_burst(R3_DATA, (const uint8_t *) tube_address, 1, 1));
       }
     }
   }
@@ -464,10 +447,7 @@ void type_7_data_transfer(void) {
       // If there is an NMI condition, handle the byte
       if (intr & 2) {
         // Read the R3 data register, which should also clear the NMI
-        *tube_address = tubeRead(R3_DATA);
-        count++;
-        signature += *tube_address++;
-        signature *= 13;
+        transferred(tube_parasite_read_burst(R3_DATA, (uint8_t *) tube_address, 1, 1));
       }
     }
   }
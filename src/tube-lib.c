@@ -121,21 +121,42 @@ void sendBlock(unsigned char reg, unsigned int len, const unsigned char *buf)
 {
   // bytes in a block are transferred high downto low
   buf += len;
-  while (len-- > 0)
+  if (debug)
   {
-    sendByte(reg, (*--buf));
+    while (len-- > 0)
+    {
+      sendByte(reg, (*--buf));
+    }
+    return;
+  }
+  // write as many bytes as there is space for each time round
+  while (len > 0)
+  {
+    unsigned int n = tube_parasite_write_burst((uint32_t) ((reg - 1) * 2 + 1), buf - 1, len, -1);
+    buf -= n;
+    len -= n;
   }
 }
 
 // Reg is 1..4
 void receiveBlock(unsigned char reg, unsigned int len, unsigned char *buf)
 {
-  // bytes in a block are transferred high downto low
   // bytes in a block are transferred high downto low
   buf += len;
-  while (len-- > 0)
+  if (debug)
+  {
+    while (len-- > 0)
+    {
+      *--buf = receiveByte(reg);
+    }
+    return;
+  }
+  // read as many bytes as are available each time round
+  while (len > 0)
   {
-    *--buf = receiveByte(reg);
+    unsigned int n = tube_parasite_read_burst((uint32_t) ((reg - 1) * 2 + 1), buf - 1, len, -1);
+    buf -= n;
+    len -= n;
   }
 }
 
@@ -40,7 +40,9 @@
 // Another option if we go back to 8-bit values tube_regs is to use
 // CPG_Param0..CPG_Param1
 
+#ifndef NATIVE_BUILD
 static void start_vc_ula();
+#endif
 
 #define GPU_TUBE_REG_ADDR 0x7e0000a0
 #define ARM_TUBE_REG_ADDR ((GPU_TUBE_REG_ADDR & 0x00FFFFFF) | PERIPHERAL_BASE)
@@ -48,11 +50,21 @@ static void start_vc_ula();
 #include "tubevc.h"
 #include "startup.h"
 
+#ifdef NATIVE_BUILD
+#include "native/native-ula.h"
+#endif
+
 int test_pin;
-static uint32_t led_type=0;
 
+#ifdef NATIVE_BUILD
+// In the native build there is no VideoCore, so the tube registers
+// are just ordinary memory that tube_vc_access() reads from
+static volatile uint32_t tube_regs[8];
+#else
+static uint32_t led_type=0;
 static volatile uint32_t *tube_regs = (uint32_t *) ARM_TUBE_REG_ADDR;
 static uint32_t host_addr_bus;
+#endif
 
 #define HBIT_7 ((uint32_t)(1 << 25))
 #define HBIT_6 ((uint32_t)(1 << 24))
@@ -454,6 +466,9 @@ static void tube_host_write(uint32_t addr, uint8_t val)
    }
 }
 
+static inline uint8_t parasite_read_reg(uint32_t addr);
+static inline void parasite_write_reg(uint32_t addr, uint8_t val);
+
 uint8_t tube_parasite_read(uint32_t addr)
 {
    uint8_t temp = 0xAA;
@@ -482,6 +497,17 @@ uint8_t tube_parasite_read(uint32_t addr)
       return temp;
    }
    int cpsr = _disable_interrupts();
+   temp = parasite_read_reg(addr);
+   if ((cpsr & 0xc0) != 0xc0) {
+      _set_interrupts(cpsr);
+   }
+   return temp;
+}
+
+// Parasite read of a tube register, with interrupts already disabled
+static inline uint8_t parasite_read_reg(uint32_t addr)
+{
+   uint8_t temp = 0xAA;
    switch (addr & 7)
    {
    case 0: /*Register 1 stat*/
@@ -553,9 +579,6 @@ uint8_t tube_parasite_read(uint32_t addr)
       tube_index &= 0xffff;
    }
 #endif
-   if ((cpsr & 0xc0) != 0xc0) {
-      _set_interrupts(cpsr);
-   }
    return temp;
 }
 
@@ -589,6 +612,19 @@ void tube_parasite_write_banksel(uint32_t addr, uint8_t val)
 void tube_parasite_write(uint32_t addr, uint8_t val)
 {
    int cpsr = _disable_interrupts();
+   parasite_write_reg(addr, val);
+   if ((cpsr & 0xc0) != 0xc0) {
+      _set_interrupts(cpsr);
+   }
+   if (vdu_enabled && (addr & 7) == 0) {
+      // Write to &FEF8
+      fb_writec(val);
+   }
+}
+
+// Parasite write of a tube register, with interrupts already disabled
+static inline void parasite_write_reg(uint32_t addr, uint8_t val)
+{
 #ifdef DEBUG_TUBE
    if (addr & 1) {
       tube_buffer[tube_index++] = TUBE_WRITE_MARKER | ((addr & 7) << 8) | val;
@@ -660,13 +696,76 @@ void tube_parasite_write(uint32_t addr, uint8_t val)
       // tube_updateints_IRQ(); // the above can't change IRQ flag
       break;
    }
+}
+
+// Burst transfers, for moving blocks of data through one of the data
+// registers (addr 1, 3, 5 or 7) without masking interrupts for each byte.
+//
+// Up to len bytes are moved, stepping through buf by step (1 or -1). A
+// read stops when the register has no more data, and a write stops when
+// it is full. Interrupts are disabled for the whole burst, so the host
+// can't change the register state part way through. Returns the number
+// of bytes moved, which may be zero.
+
+unsigned int tube_parasite_read_burst(uint32_t addr, uint8_t *buf, unsigned int len, int step)
+{
+   unsigned int n = 0;
+   // The A bit of the matching status register
+   const uint8_t *stat = &pstat[(addr >> 1) & 3];
+   int cpsr = _disable_interrupts();
+   while (n < len && (*stat & 0x80)) {
+      *buf = parasite_read_reg(addr);
+      buf += step;
+      n++;
+   }
    if ((cpsr & 0xc0) != 0xc0) {
       _set_interrupts(cpsr);
    }
-   if (vdu_enabled && (addr & 7) == 0) {
-      // Write to &FEF8
-      fb_writec(val);
+   return n;
+}
+
+unsigned int tube_parasite_write_burst(uint32_t addr, const uint8_t *buf, unsigned int len, int step)
+{
+   unsigned int n = 0;
+   int cpsr = _disable_interrupts();
+   if ((addr & 7) == 1) {
+      // Register 1 has a 24 byte FIFO, so fill as much of it as possible
+      // and update the status registers once at the end
+      while (n < len && ph1len < 24) {
+#ifdef DEBUG_TUBE
+         tube_buffer[tube_index++] = TUBE_WRITE_MARKER | (1 << 8) | *buf;
+         tube_index &= 0xffff;
+#endif
+         if (ph1len == 0) {
+            PH1_0 = BYTE_TO_WORD(*buf);
+         } else {
+            ph1[ph1wrpos] = *buf;
+            if (ph1wrpos == 23)
+               ph1wrpos = 0;
+            else
+               ph1wrpos++;
+         }
+         ph1len++;
+         buf += step;
+         n++;
+      }
+      if (n) {
+         HSTAT1 |= HBIT_7;
+         if (ph1len == 24) PSTAT1 &= (uint8_t)~0x40;
+      }
+   } else {
+      // The F bit of the matching status register
+      const uint8_t *stat = &pstat[(addr >> 1) & 3];
+      while (n < len && (*stat & 0x40)) {
+         parasite_write_reg(addr, *buf);
+         buf += step;
+         n++;
+      }
+   }
+   if ((cpsr & 0xc0) != 0xc0) {
+      _set_interrupts(cpsr);
    }
+   return n;
 }
 
 // Returns bit 0 set if IRQ is asserted by the tube
@@ -709,6 +808,36 @@ int tube_io_handler(uint32_t mail)
    return tube_irq;
 }
 
+#ifdef NATIVE_BUILD
+
+// Software replacement for the VideoCore half of the ULA
+//
+// mail uses the same format as tube_io_handler(). For a host read the
+// value returned is the one the VideoCore would have driven onto the
+// data bus from the pre-loaded tube_regs[], before the ARM is told
+// about the read so it can pre-load the next value.
+
+uint8_t tube_vc_access(uint32_t mail)
+{
+   uint8_t data = 0;
+   if ((mail & (1 << 11)) && !(mail & (1 << 12))) {
+      data = (uint8_t)WORD_TO_BYTE(tube_regs[(mail >> 8) & 7]);
+   }
+   tube_io_handler(mail);
+   return data;
+}
+
+void tube_init_hardware()
+{
+   hp1 = hp2 = hp4 = hp3[0]= hp3[1]=0;
+}
+
+int tube_is_rst_active() {
+   return native_ula_rst_active();
+}
+
+#else
+
 void tube_init_hardware()
 {
    uint32_t revision = get_revision();
@@ -876,6 +1005,8 @@ void tube_init_hardware()
 int tube_is_rst_active() {
    return ((RPI_GpioBase->GPLEV0 & NRST_MASK) == 0) ;
 }
+
+#endif
 #if 0
 static void tube_wait_for_rst_active() {
    while (!tube_is_rst_active());
@@ -946,6 +1077,7 @@ void disable_tube() {
    }
 }
 
+#ifndef NATIVE_BUILD
 static void start_vc_ula()
 {
    unsigned int func,r0,r1, r2,r3,r4,r5;
@@ -997,3 +1129,4 @@ static void start_vc_ula()
 // }
 
 }
+#endif
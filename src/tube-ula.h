@@ -29,10 +29,18 @@ extern void tube_parasite_write(uint32_t addr, uint8_t val);
 
 extern void tube_parasite_write_banksel(uint32_t addr, uint8_t val);
 
+extern unsigned int tube_parasite_read_burst(uint32_t addr, uint8_t *buf, unsigned int len, int step);
+
+extern unsigned int tube_parasite_write_burst(uint32_t addr, const uint8_t *buf, unsigned int len, int step);
+
 //extern void tube_reset();
 
 extern int tube_io_handler(uint32_t mail);
 
+#ifdef NATIVE_BUILD
+extern uint8_t tube_vc_access(uint32_t mail);
+#endif
+
 extern void tube_init_hardware();
 
 extern int tube_is_rst_active();
@@ -20,10 +20,39 @@ extern volatile int tube_irq;
 
 // For Pi Direct we can just execute cycles until and event 
 
+#ifdef NATIVE_BUILD
+
+// The native build has no FIQ, so the simulated host also gets a look in
+// if a core runs for a while without touching the tube, in case the
+// Co Pro is idling (e.g. in SYNC) waiting for the host. Cores that don't
+// use tubeContinueRunning() call tubeTick() once per instruction instead.
+
+extern int native_ula_ticks;
+
+extern void native_ula_tick(void);
+
+#define tubeTick() do { if (--native_ula_ticks <= 0) native_ula_tick(); } while (0)
+
+#define tubeContinueRunning() ((--native_ula_ticks > 0 || (native_ula_tick(), 1)) && !(tube_irq & (RESET_BIT | NMI_BIT | IRQ_BIT)))
+
+// The native build counts the cycles reported by each core, so the
+// tube-host harness can work out an emulated speed (not tube_cycles, as
+// several cores already use that name for a local)
+
+extern uint64_t native_cycles;
+
+#define tubeUseCycles(n) native_cycles += (n)
+
+#else
+
+#define tubeTick()
+
 #define tubeContinueRunning() (!(tube_irq & (RESET_BIT | NMI_BIT | IRQ_BIT)))
 
 #define tubeUseCycles(n)
 
+#endif
+
 // In B-Em use the following 
 //
 //#define tubeContinueRunning() (tube_cycles)
@@ -64,26 +64,67 @@ static WORD sp;
 static WORD pc;
 static WORD IFF;
 
-static const unsigned char partab[256] = {
-   4,0,0,4,0,4,4,0,0,4,4,0,4,0,0,4,
-   0,4,4,0,4,0,0,4,4,0,0,4,0,4,4,0,
-   0,4,4,0,4,0,0,4,4,0,0,4,0,4,4,0,
-   4,0,0,4,0,4,4,0,0,4,4,0,4,0,0,4,
-   0,4,4,0,4,0,0,4,4,0,0,4,0,4,4,0,
-   4,0,0,4,0,4,4,0,0,4,4,0,4,0,0,4,
-   4,0,0,4,0,4,4,0,0,4,4,0,4,0,0,4,
-   0,4,4,0,4,0,0,4,4,0,0,4,0,4,4,0,
-   0,4,4,0,4,0,0,4,4,0,0,4,0,4,4,0,
-   4,0,0,4,0,4,4,0,0,4,4,0,4,0,0,4,
-   4,0,0,4,0,4,4,0,0,4,4,0,4,0,0,4,
-   0,4,4,0,4,0,0,4,4,0,0,4,0,4,4,0,
-   4,0,0,4,0,4,4,0,0,4,4,0,4,0,0,4,
-   0,4,4,0,4,0,0,4,4,0,0,4,0,4,4,0,
-   0,4,4,0,4,0,0,4,4,0,0,4,0,4,4,0,
-   4,0,0,4,0,4,4,0,0,4,4,0,4,0,0,4,
+/* Flag lookup tables, indexed by the 8-bit result */
+
+/* S, Z, P/V (parity) and the undocumented bits 5 and 3 for a result */
+static const BYTE szp_table[256] = {
+   0x44,0x00,0x00,0x04,0x00,0x04,0x04,0x00,0x08,0x0c,0x0c,0x08,0x0c,0x08,0x08,0x0c,
+   0x00,0x04,0x04,0x00,0x04,0x00,0x00,0x04,0x0c,0x08,0x08,0x0c,0x08,0x0c,0x0c,0x08,
+   0x20,0x24,0x24,0x20,0x24,0x20,0x20,0x24,0x2c,0x28,0x28,0x2c,0x28,0x2c,0x2c,0x28,
+   0x24,0x20,0x20,0x24,0x20,0x24,0x24,0x20,0x28,0x2c,0x2c,0x28,0x2c,0x28,0x28,0x2c,
+   0x00,0x04,0x04,0x00,0x04,0x00,0x00,0x04,0x0c,0x08,0x08,0x0c,0x08,0x0c,0x0c,0x08,
+   0x04,0x00,0x00,0x04,0x00,0x04,0x04,0x00,0x08,0x0c,0x0c,0x08,0x0c,0x08,0x08,0x0c,
+   0x24,0x20,0x20,0x24,0x20,0x24,0x24,0x20,0x28,0x2c,0x2c,0x28,0x2c,0x28,0x28,0x2c,
+   0x20,0x24,0x24,0x20,0x24,0x20,0x20,0x24,0x2c,0x28,0x28,0x2c,0x28,0x2c,0x2c,0x28,
+   0x80,0x84,0x84,0x80,0x84,0x80,0x80,0x84,0x8c,0x88,0x88,0x8c,0x88,0x8c,0x8c,0x88,
+   0x84,0x80,0x80,0x84,0x80,0x84,0x84,0x80,0x88,0x8c,0x8c,0x88,0x8c,0x88,0x88,0x8c,
+   0xa4,0xa0,0xa0,0xa4,0xa0,0xa4,0xa4,0xa0,0xa8,0xac,0xac,0xa8,0xac,0xa8,0xa8,0xac,
+   0xa0,0xa4,0xa4,0xa0,0xa4,0xa0,0xa0,0xa4,0xac,0xa8,0xa8,0xac,0xa8,0xac,0xac,0xa8,
+   0x84,0x80,0x80,0x84,0x80,0x84,0x84,0x80,0x88,0x8c,0x8c,0x88,0x8c,0x88,0x88,0x8c,
+   0x80,0x84,0x84,0x80,0x84,0x80,0x80,0x84,0x8c,0x88,0x88,0x8c,0x88,0x8c,0x8c,0x88,
+   0xa0,0xa4,0xa4,0xa0,0xa4,0xa0,0xa0,0xa4,0xac,0xa8,0xa8,0xac,0xa8,0xac,0xac,0xa8,
+   0xa4,0xa0,0xa0,0xa4,0xa0,0xa4,0xa4,0xa0,0xa8,0xac,0xac,0xa8,0xac,0xa8,0xa8,0xac,
 };
 
-#define parity(x)   partab[(x)&0xff]
+/* S, Z, H, P/V (overflow) and bits 5 and 3 after an 8-bit INC */
+static const BYTE inc_table[256] = {
+   0x50,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x08,0x08,0x08,0x08,0x08,0x08,0x08,0x08,
+   0x10,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x08,0x08,0x08,0x08,0x08,0x08,0x08,0x08,
+   0x30,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x28,0x28,0x28,0x28,0x28,0x28,0x28,0x28,
+   0x30,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x28,0x28,0x28,0x28,0x28,0x28,0x28,0x28,
+   0x10,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x08,0x08,0x08,0x08,0x08,0x08,0x08,0x08,
+   0x10,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x08,0x08,0x08,0x08,0x08,0x08,0x08,0x08,
+   0x30,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x28,0x28,0x28,0x28,0x28,0x28,0x28,0x28,
+   0x30,0x20,0x20,0x20,0x20,0x20,0x20,0x20,0x28,0x28,0x28,0x28,0x28,0x28,0x28,0x28,
+   0x94,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x88,0x88,0x88,0x88,0x88,0x88,0x88,0x88,
+   0x90,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x88,0x88,0x88,0x88,0x88,0x88,0x88,0x88,
+   0xb0,0xa0,0xa0,0xa0,0xa0,0xa0,0xa0,0xa0,0xa8,0xa8,0xa8,0xa8,0xa8,0xa8,0xa8,0xa8,
+   0xb0,0xa0,0xa0,0xa0,0xa0,0xa0,0xa0,0xa0,0xa8,0xa8,0xa8,0xa8,0xa8,0xa8,0xa8,0xa8,
+   0x90,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x88,0x88,0x88,0x88,0x88,0x88,0x88,0x88,
+   0x90,0x80,0x80,0x80,0x80,0x80,0x80,0x80,0x88,0x88,0x88,0x88,0x88,0x88,0x88,0x88,
+   0xb0,0xa0,0xa0,0xa0,0xa0,0xa0,0xa0,0xa0,0xa8,0xa8,0xa8,0xa8,0xa8,0xa8,0xa8,0xa8,
+   0xb0,0xa0,0xa0,0xa0,0xa0,0xa0,0xa0,0xa0,0xa8,0xa8,0xa8,0xa8,0xa8,0xa8,0xa8,0xa8,
+};
+
+/* S, Z, H, P/V (overflow), N and bits 5 and 3 after an 8-bit DEC */
+static const BYTE dec_table[256] = {
+   0x42,0x02,0x02,0x02,0x02,0x02,0x02,0x02,0x0a,0x0a,0x0a,0x0a,0x0a,0x0a,0x0a,0x1a,
+   0x02,0x02,0x02,0x02,0x02,0x02,0x02,0x02,0x0a,0x0a,0x0a,0x0a,0x0a,0x0a,0x0a,0x1a,
+   0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x2a,0x2a,0x2a,0x2a,0x2a,0x2a,0x2a,0x3a,
+   0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x2a,0x2a,0x2a,0x2a,0x2a,0x2a,0x2a,0x3a,
+   0x02,0x02,0x02,0x02,0x02,0x02,0x02,0x02,0x0a,0x0a,0x0a,0x0a,0x0a,0x0a,0x0a,0x1a,
+   0x02,0x02,0x02,0x02,0x02,0x02,0x02,0x02,0x0a,0x0a,0x0a,0x0a,0x0a,0x0a,0x0a,0x1a,
+   0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x2a,0x2a,0x2a,0x2a,0x2a,0x2a,0x2a,0x3a,
+   0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x2a,0x2a,0x2a,0x2a,0x2a,0x2a,0x2a,0x3e,
+   0x82,0x82,0x82,0x82,0x82,0x82,0x82,0x82,0x8a,0x8a,0x8a,0x8a,0x8a,0x8a,0x8a,0x9a,
+   0x82,0x82,0x82,0x82,0x82,0x82,0x82,0x82,0x8a,0x8a,0x8a,0x8a,0x8a,0x8a,0x8a,0x9a,
+   0xa2,0xa2,0xa2,0xa2,0xa2,0xa2,0xa2,0xa2,0xaa,0xaa,0xaa,0xaa,0xaa,0xaa,0xaa,0xba,
+   0xa2,0xa2,0xa2,0xa2,0xa2,0xa2,0xa2,0xa2,0xaa,0xaa,0xaa,0xaa,0xaa,0xaa,0xaa,0xba,
+   0x82,0x82,0x82,0x82,0x82,0x82,0x82,0x82,0x8a,0x8a,0x8a,0x8a,0x8a,0x8a,0x8a,0x9a,
+   0x82,0x82,0x82,0x82,0x82,0x82,0x82,0x82,0x8a,0x8a,0x8a,0x8a,0x8a,0x8a,0x8a,0x9a,
+   0xa2,0xa2,0xa2,0xa2,0xa2,0xa2,0xa2,0xa2,0xaa,0xaa,0xaa,0xaa,0xaa,0xaa,0xaa,0xba,
+   0xa2,0xa2,0xa2,0xa2,0xa2,0xa2,0xa2,0xa2,0xaa,0xaa,0xaa,0xaa,0xaa,0xaa,0xaa,0xba,
+};
 
 #define POP(x)   do {            \
    WORD y=GetBYTE_pp(SP);\
@@ -140,17 +181,11 @@ static const unsigned char partab[256] = {
     iy = (WORD)IY;                        \
     sp = (WORD)SP
 
-#define SET_FLAG_INC(temp)\
-      AF = (uint32_t)((AF & (uint32_t)~0xfe) | (temp & 0xa8) |\
-         (uint32_t)(((temp & 0xff) == 0) << 6) |\
-         (uint32_t)(((temp & 0xf) == 0) << 4) |\
-         (uint32_t)((temp == 0x80) << 2))
+#define SET_FLAG_INC(temp) \
+      AF = (AF & (uint32_t)~0xfe) | inc_table[(temp) & 0xff]
 
 #define SET_FLAG_DEC(temp) \
-      AF = (AF & (uint32_t)~0xfe) | (temp & 0xa8) |\
-         (uint32_t)(((temp & 0xff) == 0) << 6) |\
-         (uint32_t)(((temp & 0xf) == 0xf) << 4) |\
-         (uint32_t)((temp == 0x7f) << 2) | 2;\
+      AF = (AF & (uint32_t)~0xfe) | dec_table[(temp) & 0xff]
 
 #define SET_FLAG_CP(temp,sum,cbits) \
       AF = (AF & (uint32_t)~0xff) | (sum & 0x80) |\
@@ -431,6 +466,64 @@ cpu_debug_t simz80_cpu_debug = {
 
 #endif
 
+/*
+ * Instruction dispatch
+ *
+ * The instruction bodies below are shared by two dispatch engines. By
+ * default they are the cases of a switch on the opcode (and on the
+ * second byte for the DD, ED and FD prefixes), and control returns to the
+ * top of the loop after each instruction. Building with SIMZ80_THREADED
+ * (GCC only, as it uses labels as values) turns them into labels that are
+ * reached through 256 entry handler tables instead, and each instruction
+ * checks for a Tube event and jumps straight to the next handler itself.
+ * The CB prefix is decoded by its register and operation fields in either
+ * case.
+ */
+
+#if defined(SIMZ80_THREADED) && (!defined(__GNUC__) || defined(__STRICT_ANSI__))
+#undef SIMZ80_THREADED
+#endif
+
+#ifdef INCLUDE_DEBUGGER
+#define DEBUG_PREEXEC()                        \
+    if (simz80_debug_enabled) {                \
+       last_PC = (WORD)PC;                     \
+       SAVE_STATE();                           \
+       debug_preexec(&simz80_cpu_debug, last_PC); \
+       LOAD_STATE();                           \
+    }
+#else
+#define DEBUG_PREEXEC()
+#endif
+
+#ifdef SIMZ80_THREADED
+
+#define OP(n)              op_##n
+#define PREFIX_OP(p, n)    p##_##n
+#define PREFIX_DEFAULT(p)  p##_default
+#define DISPATCH()         goto *main_ops[GetBYTE_pp(PC)];
+#define DISPATCH_PREFIX(p) goto *p##_ops[op = GetBYTE_pp(PC)];
+#define NEXT                                   \
+    do {                                       \
+       tubeUseCycles(1);                       \
+       if (!tubeContinueRunning()) {           \
+          goto tube_event;                     \
+       }                                       \
+       DEBUG_PREEXEC();                        \
+       DISPATCH()                              \
+    } while (0)
+
+#else
+
+#define OP(n)              case 0x##n
+#define PREFIX_OP(p, n)    case 0x##n
+#define PREFIX_DEFAULT(p)  default
+#define DISPATCH()         switch(GetBYTE_pp(PC))
+#define DISPATCH_PREFIX(p) switch (op = GetBYTE_pp(PC))
+#define NEXT               break
+
+#endif
+
 /**********************************************************
  * Z80 emulation
  **********************************************************/
@@ -451,52 +544,186 @@ simz80_execute(int tube_cycles)
 #ifdef MMU
     FASTREG tmp2;
 #endif
+#ifdef SIMZ80_THREADED
+    static void *const main_ops[256] = {
+        &&op_00, &&op_01, &&op_02, &&op_03, &&op_04, &&op_05, &&op_06, &&op_07,
+        &&op_08, &&op_09, &&op_0A, &&op_0B, &&op_0C, &&op_0D, &&op_0E, &&op_0F,
+        &&op_10, &&op_11, &&op_12, &&op_13, &&op_14, &&op_15, &&op_16, &&op_17,
+        &&op_18, &&op_19, &&op_1A, &&op_1B, &&op_1C, &&op_1D, &&op_1E, &&op_1F,
+        &&op_20, &&op_21, &&op_22, &&op_23, &&op_24, &&op_25, &&op_26, &&op_27,
+        &&op_28, &&op_29, &&op_2A, &&op_2B, &&op_2C, &&op_2D, &&op_2E, &&op_2F,
+        &&op_30, &&op_31, &&op_32, &&op_33, &&op_34, &&op_35, &&op_36, &&op_37,
+        &&op_38, &&op_39, &&op_3A, &&op_3B, &&op_3C, &&op_3D, &&op_3E, &&op_3F,
+        &&op_40, &&op_41, &&op_42, &&op_43, &&op_44, &&op_45, &&op_46, &&op_47,
+        &&op_48, &&op_49, &&op_4A, &&op_4B, &&op_4C, &&op_4D, &&op_4E, &&op_4F,
+        &&op_50, &&op_51, &&op_52, &&op_53, &&op_54, &&op_55, &&op_56, &&op_57,
+        &&op_58, &&op_59, &&op_5A, &&op_5B, &&op_5C, &&op_5D, &&op_5E, &&op_5F,
+        &&op_60, &&op_61, &&op_62, &&op_63, &&op_64, &&op_65, &&op_66, &&op_67,
+        &&op_68, &&op_69, &&op_6A, &&op_6B, &&op_6C, &&op_6D, &&op_6E, &&op_6F,
+        &&op_70, &&op_71, &&op_72, &&op_73, &&op_74, &&op_75, &&op_76, &&op_77,
+        &&op_78, &&op_79, &&op_7A, &&op_7B, &&op_7C, &&op_7D, &&op_7E, &&op_7F,
+        &&op_80, &&op_81, &&op_82, &&op_83, &&op_84, &&op_85, &&op_86, &&op_87,
+        &&op_88, &&op_89, &&op_8A, &&op_8B, &&op_8C, &&op_8D, &&op_8E, &&op_8F,
+        &&op_90, &&op_91, &&op_92, &&op_93, &&op_94, &&op_95, &&op_96, &&op_97,
+        &&op_98, &&op_99, &&op_9A, &&op_9B, &&op_9C, &&op_9D, &&op_9E, &&op_9F,
+        &&op_A0, &&op_A1, &&op_A2, &&op_A3, &&op_A4, &&op_A5, &&op_A6, &&op_A7,
+        &&op_A8, &&op_A9, &&op_AA, &&op_AB, &&op_AC, &&op_AD, &&op_AE, &&op_AF,
+        &&op_B0, &&op_B1, &&op_B2, &&op_B3, &&op_B4, &&op_B5, &&op_B6, &&op_B7,
+        &&op_B8, &&op_B9, &&op_BA, &&op_BB, &&op_BC, &&op_BD, &&op_BE, &&op_BF,
+        &&op_C0, &&op_C1, &&op_C2, &&op_C3, &&op_C4, &&op_C5, &&op_C6, &&op_C7,
+        &&op_C8, &&op_C9, &&op_CA, &&op_CB, &&op_CC, &&op_CD, &&op_CE, &&op_CF,
+        &&op_D0, &&op_D1, &&op_D2, &&op_D3, &&op_D4, &&op_D5, &&op_D6, &&op_D7,
+        &&op_D8, &&op_D9, &&op_DA, &&op_DB, &&op_DC, &&op_DD, &&op_DE, &&op_DF,
+        &&op_E0, &&op_E1, &&op_E2, &&op_E3, &&op_E4, &&op_E5, &&op_E6, &&op_E7,
+        &&op_E8, &&op_E9, &&op_EA, &&op_EB, &&op_EC, &&op_ED, &&op_EE, &&op_EF,
+        &&op_F0, &&op_F1, &&op_F2, &&op_F3, &&op_F4, &&op_F5, &&op_F6, &&op_F7,
+        &&op_F8, &&op_F9, &&op_FA, &&op_FB, &&op_FC, &&op_FD, &&op_FE, &&op_FF
+    };
+    static void *const dd_ops[256] = {
+        &&dd_default, &&dd_default, &&dd_default, &&dd_default, &&dd_default, &&dd_default, &&dd_default, &&dd_default,
+        &&dd_default, &&dd_09, &&dd_default, &&dd_default, &&dd_default, &&dd_default, &&dd_default, &&dd_default,
+        &&dd_default, &&dd_default, &&dd_default, &&dd_default, &&dd_default, &&dd_default, &&dd_default, &&dd_default,
+        &&dd_default, &&dd_19, &&dd_default, &&dd_default, &&dd_default, &&dd_default, &&dd_default, &&dd_default,
+        &&dd_default, &&dd_21, &&dd_22, &&dd_23, &&dd_24, &&dd_25, &&dd_26, &&dd_default,
+        &&dd_default, &&dd_29, &&dd_2A, &&dd_2B, &&dd_2C, &&dd_2D, &&dd_2E, &&dd_default,
+        &&dd_default, &&dd_default, &&dd_default, &&dd_default, &&dd_34, &&dd_35, &&dd_36, &&dd_default,
+        &&dd_default, &&dd_39, &&dd_default, &&dd_default, &&dd_default, &&dd_default, &&dd_default, &&dd_default,
+        &&dd_default, &&dd_default, &&dd_default, &&dd_default, &&dd_44, &&dd_45, &&dd_46, &&dd_default,
+        &&dd_default, &&dd_default, &&dd_default, &&dd_default, &&dd_4C, &&dd_4D, &&dd_4E, &&dd_default,
+        &&dd_default, &&dd_default, &&dd_default, &&dd_default, &&dd_54, &&dd_55, &&dd_56, &&dd_default,
+        &&dd_default, &&dd_default, &&dd_default, &&dd_default, &&dd_5C, &&dd_5D, &&dd_5E, &&dd_default,
+        &&dd_60, &&dd_61, &&dd_62, &&dd_63, &&dd_64, &&dd_65, &&dd_66, &&dd_67,
+        &&dd_68, &&dd_69, &&dd_6A, &&dd_6B, &&dd_6C, &&dd_6D, &&dd_6E, &&dd_6F,
+        &&dd_70, &&dd_71, &&dd_72, &&dd_73, &&dd_74, &&dd_75, &&dd_default, &&dd_77,
+        &&dd_default, &&dd_default, &&dd_default, &&dd_default, &&dd_7C, &&dd_7D, &&dd_7E, &&dd_default,
+        &&dd_default, &&dd_default, &&dd_default, &&dd_default, &&dd_84, &&dd_85, &&dd_86, &&dd_default,
+        &&dd_default, &&dd_default, &&dd_default, &&dd_default, &&dd_8C, &&dd_8D, &&dd_8E, &&dd_default,
+        &&dd_default, &&dd_default, &&dd_default, &&dd_default, &&dd_94, &&dd_95, &&dd_96, &&dd_default,
+        &&dd_default, &&dd_default, &&dd_default, &&dd_default, &&dd_9C, &&dd_9D, &&dd_9E, &&dd_default,
+        &&dd_default, &&dd_default, &&dd_default, &&dd_default, &&dd_A4, &&dd_A5, &&dd_A6, &&dd_default,
+        &&dd_default, &&dd_default, &&dd_default, &&dd_default, &&dd_AC, &&dd_AD, &&dd_AE, &&dd_default,
+        &&dd_default, &&dd_default, &&dd_default, &&dd_default, &&dd_B4, &&dd_B5, &&dd_B6, &&dd_default,
+        &&dd_default, &&dd_default, &&dd_default, &&dd_default, &&dd_BC, &&dd_BD, &&dd_BE, &&dd_default,
+        &&dd_default, &&dd_default, &&dd_default, &&dd_default, &&dd_default, &&dd_default, &&dd_default, &&dd_default,
+        &&dd_default, &&dd_default, &&dd_default, &&dd_CB, &&dd_default, &&dd_default, &&dd_default, &&dd_default,
+        &&dd_default, &&dd_default, &&dd_default, &&dd_default, &&dd_default, &&dd_default, &&dd_default, &&dd_default,
+        &&dd_default, &&dd_default, &&dd_default, &&dd_default, &&dd_default, &&dd_default, &&dd_default, &&dd_default,
+        &&dd_default, &&dd_E1, &&dd_default, &&dd_E3, &&dd_default, &&dd_E5, &&dd_default, &&dd_default,
+        &&dd_default, &&dd_E9, &&dd_default, &&dd_default, &&dd_default, &&dd_default, &&dd_default, &&dd_default,
+        &&dd_default, &&dd_default, &&dd_default, &&dd_default, &&dd_default, &&dd_default, &&dd_default, &&dd_default,
+        &&dd_default, &&dd_F9, &&dd_default, &&dd_default, &&dd_default, &&dd_default, &&dd_default, &&dd_default
+    };
+    static void *const ed_ops[256] = {
+        &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default,
+        &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default,
+        &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default,
+        &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default,
+        &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default,
+        &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default,
+        &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default,
+        &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default,
+        &&ed_40, &&ed_41, &&ed_42, &&ed_43, &&ed_44, &&ed_45, &&ed_46, &&ed_47,
+        &&ed_48, &&ed_49, &&ed_4A, &&ed_4B, &&ed_4C, &&ed_4D, &&ed_4E, &&ed_4F,
+        &&ed_50, &&ed_51, &&ed_52, &&ed_53, &&ed_54, &&ed_55, &&ed_56, &&ed_57,
+        &&ed_58, &&ed_59, &&ed_5A, &&ed_5B, &&ed_5C, &&ed_5D, &&ed_5E, &&ed_5F,
+        &&ed_60, &&ed_61, &&ed_62, &&ed_63, &&ed_64, &&ed_65, &&ed_66, &&ed_67,
+        &&ed_68, &&ed_69, &&ed_6A, &&ed_6B, &&ed_6C, &&ed_6D, &&ed_6E, &&ed_6F,
+        &&ed_70, &&ed_71, &&ed_72, &&ed_73, &&ed_74, &&ed_75, &&ed_76, &&ed_default,
+        &&ed_78, &&ed_79, &&ed_7A, &&ed_7B, &&ed_7C, &&ed_7D, &&ed_7E, &&ed_default,
+        &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default,
+        &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default,
+        &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default,
+        &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default,
+        &&ed_A0, &&ed_A1, &&ed_A2, &&ed_A3, &&ed_default, &&ed_default, &&ed_default, &&ed_default,
+        &&ed_A8, &&ed_A9, &&ed_AA, &&ed_AB, &&ed_default, &&ed_default, &&ed_default, &&ed_default,
+        &&ed_B0, &&ed_B1, &&ed_B2, &&ed_B3, &&ed_default, &&ed_default, &&ed_default, &&ed_default,
+        &&ed_B8, &&ed_B9, &&ed_BA, &&ed_BB, &&ed_default, &&ed_default, &&ed_default, &&ed_default,
+        &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default,
+        &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default,
+        &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default,
+        &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default,
+        &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default,
+        &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default,
+        &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default,
+        &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default, &&ed_default
+    };
+    static void *const fd_ops[256] = {
+        &&fd_default, &&fd_default, &&fd_default, &&fd_default, &&fd_default, &&fd_default, &&fd_default, &&fd_default,
+        &&fd_default, &&fd_09, &&fd_default, &&fd_default, &&fd_default, &&fd_default, &&fd_default, &&fd_default,
+        &&fd_default, &&fd_default, &&fd_default, &&fd_default, &&fd_default, &&fd_default, &&fd_default, &&fd_default,
+        &&fd_default, &&fd_19, &&fd_default, &&fd_default, &&fd_default, &&fd_default, &&fd_default, &&fd_default,
+        &&fd_default, &&fd_21, &&fd_22, &&fd_23, &&fd_24, &&fd_25, &&fd_26, &&fd_default,
+        &&fd_default, &&fd_29, &&fd_2A, &&fd_2B, &&fd_2C, &&fd_2D, &&fd_2E, &&fd_default,
+        &&fd_default, &&fd_default, &&fd_default, &&fd_default, &&fd_34, &&fd_35, &&fd_36, &&fd_default,
+        &&fd_default, &&fd_39, &&fd_default, &&fd_default, &&fd_default, &&fd_default, &&fd_default, &&fd_default,
+        &&fd_default, &&fd_default, &&fd_default, &&fd_default, &&fd_44, &&fd_45, &&fd_46, &&fd_default,
+        &&fd_default, &&fd_default, &&fd_default, &&fd_default, &&fd_4C, &&fd_4D, &&fd_4E, &&fd_default,
+        &&fd_default, &&fd_default, &&fd_default, &&fd_default, &&fd_54, &&fd_55, &&fd_56, &&fd_default,
+        &&fd_default, &&fd_default, &&fd_default, &&fd_default, &&fd_5C, &&fd_5D, &&fd_5E, &&fd_default,
+        &&fd_60, &&fd_61, &&fd_62, &&fd_63, &&fd_64, &&fd_65, &&fd_66, &&fd_67,
+        &&fd_68, &&fd_69, &&fd_6A, &&fd_6B, &&fd_6C, &&fd_6D, &&fd_6E, &&fd_6F,
+        &&fd_70, &&fd_71, &&fd_72, &&fd_73, &&fd_74, &&fd_75, &&fd_default, &&fd_77,
+        &&fd_default, &&fd_default, &&fd_default, &&fd_default, &&fd_7C, &&fd_7D, &&fd_7E, &&fd_default,
+        &&fd_default, &&fd_default, &&fd_default, &&fd_default, &&fd_84, &&fd_85, &&fd_86, &&fd_default,
+        &&fd_default, &&fd_default, &&fd_default, &&fd_default, &&fd_8C, &&fd_8D, &&fd_8E, &&fd_default,
+        &&fd_default, &&fd_default, &&fd_default, &&fd_default, &&fd_94, &&fd_95, &&fd_96, &&fd_default,
+        &&fd_default, &&fd_default, &&fd_default, &&fd_default, &&fd_9C, &&fd_9D, &&fd_9E, &&fd_default,
+        &&fd_default, &&fd_default, &&fd_default, &&fd_default, &&fd_A4, &&fd_A5, &&fd_A6, &&fd_default,
+        &&fd_default, &&fd_default, &&fd_default, &&fd_default, &&fd_AC, &&fd_AD, &&fd_AE, &&fd_default,
+        &&fd_default, &&fd_default, &&fd_default, &&fd_default, &&fd_B4, &&fd_B5, &&fd_B6, &&fd_default,
+        &&fd_default, &&fd_default, &&fd_default, &&fd_default, &&fd_BC, &&fd_BD, &&fd_BE, &&fd_default,
+        &&fd_default, &&fd_default, &&fd_default, &&fd_default, &&fd_default, &&fd_default, &&fd_default, &&fd_default,
+        &&fd_default, &&fd_default, &&fd_default, &&fd_CB, &&fd_default, &&fd_default, &&fd_default, &&fd_default,
+        &&fd_default, &&fd_default, &&fd_default, &&fd_default, &&fd_default, &&fd_default, &&fd_default, &&fd_default,
+        &&fd_default, &&fd_default, &&fd_default, &&fd_default, &&fd_default, &&fd_default, &&fd_default, &&fd_default,
+        &&fd_default, &&fd_E1, &&fd_default, &&fd_E3, &&fd_default, &&fd_E5, &&fd_default, &&fd_default,
+        &&fd_default, &&fd_E9, &&fd_default, &&fd_default, &&fd_default, &&fd_default, &&fd_default, &&fd_default,
+        &&fd_default, &&fd_default, &&fd_default, &&fd_default, &&fd_default, &&fd_default, &&fd_default, &&fd_default,
+        &&fd_default, &&fd_F9, &&fd_default, &&fd_default, &&fd_default, &&fd_default, &&fd_default, &&fd_default
+    };
 
- do {
-#ifdef INCLUDE_DEBUGGER
-   if (simz80_debug_enabled) {
-     last_PC = (WORD)PC;
-     SAVE_STATE();
-     debug_preexec(&simz80_cpu_debug, last_PC);
-     LOAD_STATE();
-   }
+    /* GCC can't tell that op is always set before a prefix handler runs */
+    op = 0;
 #endif
-   switch(GetBYTE_pp(PC)) {
-   case 0x00:         /* NOP */
-      break;
-   case 0x01:         /* LD BC,nnnn */
+
+ do {
+   DEBUG_PREEXEC();
+   DISPATCH() {
+   OP(00):         /* NOP */
+      NEXT;
+   OP(01):         /* LD BC,nnnn */
       BC = GetWORD(PC);
       PC += 2;
-      break;
-   case 0x02:         /* LD (BC),A */
+      NEXT;
+   OP(02):         /* LD (BC),A */
       PutBYTE(BC, hreg(AF));
-      break;
-   case 0x03:         /* INC BC */
+      NEXT;
+   OP(03):         /* INC BC */
       ++BC;
-      break;
-   case 0x04:         /* INC B */
+      NEXT;
+   OP(04):         /* INC B */
       BC += 0x100;
       temp = hreg(BC);
       SET_FLAG_INC(temp);
-      break;
-   case 0x05:         /* DEC B */
+      NEXT;
+   OP(05):         /* DEC B */
       BC -= 0x100;
       temp = hreg(BC);
       SET_FLAG_DEC(temp);
-      break;
-   case 0x06:         /* LD B,nn */
+      NEXT;
+   OP(06):         /* LD B,nn */
       Sethreg(BC, GetBYTE_pp(PC));
-      break;
-   case 0x07:         /* RLCA */
+      NEXT;
+   OP(07):         /* RLCA */
       AF = ((AF >> 7) & 0x0128) | ((AF << 1) & ~0x1ffu) |
          (AF & 0xc4) | ((AF >> 15) & 1);
-      break;
-   case 0x08:         /* EX AF,AF' */
+      NEXT;
+   OP(08):         /* EX AF,AF' */
       af[af_sel] = (WORD)AF;
       af_sel = 1 - af_sel;
       AF = af[af_sel];
-      break;
-   case 0x09:         /* ADD HL,BC */
+      NEXT;
+   OP(09):         /* ADD HL,BC */
       HL &= 0xffff;
       BC &= 0xffff;
       sum = HL + BC;
@@ -504,66 +731,66 @@ simz80_execute(int tube_cycles)
       HL = sum;
       AF = (AF & ~0x3bu) | ((sum >> 8) & 0x28) |
          (cbits & 0x10) | ((cbits >> 8) & 1);
-      break;
-   case 0x0A:         /* LD A,(BC) */
+      NEXT;
+   OP(0A):         /* LD A,(BC) */
       Sethreg(AF, GetBYTE(BC));
-      break;
-   case 0x0B:         /* DEC BC */
+      NEXT;
+   OP(0B):         /* DEC BC */
       --BC;
-      break;
-   case 0x0C:         /* INC C */
+      NEXT;
+   OP(0C):         /* INC C */
       temp = lreg(BC)+1;
       Setlreg(BC, temp);
       SET_FLAG_INC(temp);
-      break;
-   case 0x0D:         /* DEC C */
+      NEXT;
+   OP(0D):         /* DEC C */
       temp = lreg(BC)-1;
       Setlreg(BC, temp);
       SET_FLAG_DEC(temp);
-      break;
-   case 0x0E:         /* LD C,nn */
+      NEXT;
+   OP(0E):         /* LD C,nn */
       Setlreg(BC, GetBYTE_pp(PC));
-      break;
-   case 0x0F:         /* RRCA */
+      NEXT;
+   OP(0F):         /* RRCA */
       temp = hreg(AF);
       sum = temp >> 1;
       AF = ((temp & 1) << 15) | (sum << 8) |
          (sum & 0x28) | (AF & 0xc4) | (temp & 1);
-      break;
-   case 0x10:         /* DJNZ dd */
+      NEXT;
+   OP(10):         /* DJNZ dd */
       PC += ((BC -= 0x100) & 0xff00) ? (WORD)((signed char) GetBYTE(PC) + 1) : 1;
-      break;
-   case 0x11:         /* LD DE,nnnn */
+      NEXT;
+   OP(11):         /* LD DE,nnnn */
       DE = GetWORD(PC);
       PC += 2;
-      break;
-   case 0x12:         /* LD (DE),A */
+      NEXT;
+   OP(12):         /* LD (DE),A */
       PutBYTE(DE, hreg(AF));
-      break;
-   case 0x13:         /* INC DE */
+      NEXT;
+   OP(13):         /* INC DE */
       ++DE;
-      break;
-   case 0x14:         /* INC D */
+      NEXT;
+   OP(14):         /* INC D */
       DE += 0x100;
       temp = hreg(DE);
       SET_FLAG_INC(temp);
-      break;
-   case 0x15:         /* DEC D */
+      NEXT;
+   OP(15):         /* DEC D */
       DE -= 0x100;
       temp = hreg(DE);
       SET_FLAG_DEC(temp);
-      break;
-   case 0x16:         /* LD D,nn */
+      NEXT;
+   OP(16):         /* LD D,nn */
       Sethreg(DE, GetBYTE_pp(PC));
-      break;
-   case 0x17:         /* RLA */
+      NEXT;
+   OP(17):         /* RLA */
       AF = ((AF << 8) & 0x0100) | ((AF >> 7) & 0x28) | ((AF << 1) & ~0x01ffu) |
          (AF & 0xc4) | ((AF >> 15) & 1);
-      break;
-   case 0x18:         /* JR dd */
+      NEXT;
+   OP(18):         /* JR dd */
       PC += (1) ? (WORD)((signed char) GetBYTE(PC) + 1 ): 1;
-      break;
-   case 0x19:         /* ADD HL,DE */
+      NEXT;
+   OP(19):         /* ADD HL,DE */
       HL &= 0xffff;
       DE &= 0xffff;
       sum = HL + DE;
@@ -571,61 +798,61 @@ simz80_execute(int tube_cycles)
       HL = sum;
       AF = (AF & ~0x3bu) | ((sum >> 8) & 0x28) |
          (cbits & 0x10) | ((cbits >> 8) & 1);
-      break;
-   case 0x1A:         /* LD A,(DE) */
+      NEXT;
+   OP(1A):         /* LD A,(DE) */
       Sethreg(AF, GetBYTE(DE));
-      break;
-   case 0x1B:         /* DEC DE */
+      NEXT;
+   OP(1B):         /* DEC DE */
       --DE;
-      break;
-   case 0x1C:         /* INC E */
+      NEXT;
+   OP(1C):         /* INC E */
       temp = lreg(DE)+1;
       Setlreg(DE, temp);
       SET_FLAG_INC(temp);
-      break;
-   case 0x1D:         /* DEC E */
+      NEXT;
+   OP(1D):         /* DEC E */
       temp = lreg(DE)-1;
       Setlreg(DE, temp);
       SET_FLAG_DEC(temp);
-      break;
-   case 0x1E:         /* LD E,nn */
+      NEXT;
+   OP(1E):         /* LD E,nn */
       Setlreg(DE, GetBYTE_pp(PC));
-      break;
-   case 0x1F:         /* RRA */
+      NEXT;
+   OP(1F):         /* RRA */
       temp = hreg(AF);
       sum = temp >> 1;
       AF = ((AF & 1) << 15) | (sum << 8) |
          (sum & 0x28) | (AF & 0xc4) | (temp & 1);
-      break;
-   case 0x20:         /* JR NZ,dd */
+      NEXT;
+   OP(20):         /* JR NZ,dd */
       PC += (!TSTFLAG(Z)) ? (uint32_t)((signed char) GetBYTE(PC) + 1 ): 1;
-      break;
-   case 0x21:         /* LD HL,nnnn */
+      NEXT;
+   OP(21):         /* LD HL,nnnn */
       HL = GetWORD(PC);
       PC += 2;
-      break;
-   case 0x22:         /* LD (nnnn),HL */
+      NEXT;
+   OP(22):         /* LD (nnnn),HL */
       temp = GetWORD(PC);
       PutWORD(temp, HL);
       PC += 2;
-      break;
-   case 0x23:         /* INC HL */
+      NEXT;
+   OP(23):         /* INC HL */
       ++HL;
-      break;
-   case 0x24:         /* INC H */
+      NEXT;
+   OP(24):         /* INC H */
       HL += 0x100;
       temp = hreg(HL);
       SET_FLAG_INC(temp);
-      break;
-   case 0x25:         /* DEC H */
+      NEXT;
+   OP(25):         /* DEC H */
       HL -= 0x100;
       temp = hreg(HL);
-      SET_FLAG_DEC(temp)
-      break;
-   case 0x26:         /* LD H,nn */
+      SET_FLAG_DEC(temp);
+      NEXT;
+   OP(26):         /* LD H,nn */
       Sethreg(HL, GetBYTE_pp(PC));
-      break;
-   case 0x27:         /* DAA */
+      NEXT;
+   OP(27):         /* DAA */
       acu = hreg(AF);
       temp = ldig(acu);
       cbits = TSTFLAG(C);
@@ -650,79 +877,78 @@ simz80_execute(int tube_cycles)
       }
       cbits |= (acu >> 8) & 1;
       acu &= 0xff;
-      AF = (acu << 8) | (acu & 0xa8) | (uint32_t)((acu == 0) << 6) |
-         (AF & 0x12) | partab[acu] | cbits;
-      break;
-   case 0x28:         /* JR Z,dd */
+      AF = (acu << 8) | szp_table[acu] | (AF & 0x12) | cbits;
+      NEXT;
+   OP(28):         /* JR Z,dd */
       PC += (TSTFLAG(Z)) ? (uint32_t)((signed char) GetBYTE(PC) + 1 ): 1;
-      break;
-   case 0x29:         /* ADD HL,HL */
+      NEXT;
+   OP(29):         /* ADD HL,HL */
       HL &= 0xffff;
       sum = HL + HL;
       cbits = (/*HL ^ HL ^ */sum) >> 8;
       HL = sum;
       AF = (AF & ~0x3bu) | ((sum >> 8) & 0x28) |
          (cbits & 0x10) | ((cbits >> 8) & 1);
-      break;
-   case 0x2A:         /* LD HL,(nnnn) */
+      NEXT;
+   OP(2A):         /* LD HL,(nnnn) */
       temp = GetWORD(PC);
       HL = GetWORD(temp);
       PC += 2;
-      break;
-   case 0x2B:         /* DEC HL */
+      NEXT;
+   OP(2B):         /* DEC HL */
       --HL;
-      break;
-   case 0x2C:         /* INC L */
+      NEXT;
+   OP(2C):         /* INC L */
       temp = lreg(HL)+1;
       Setlreg(HL, temp);
       SET_FLAG_INC(temp);
-      break;
-   case 0x2D:         /* DEC L */
+      NEXT;
+   OP(2D):         /* DEC L */
       temp = lreg(HL)-1;
       Setlreg(HL, temp);
       SET_FLAG_DEC(temp);
-      break;
-   case 0x2E:         /* LD L,nn */
+      NEXT;
+   OP(2E):         /* LD L,nn */
       Setlreg(HL, GetBYTE_pp(PC));
-      break;
-   case 0x2F:         /* CPL */
+      NEXT;
+   OP(2F):         /* CPL */
       AF = (~AF & ~0xffu) | (AF & 0xc5) | ((~AF >> 8) & 0x28) | 0x12;
-      break;
-   case 0x30:         /* JR NC,dd */
+      NEXT;
+   OP(30):         /* JR NC,dd */
       PC += (!TSTFLAG(C)) ? (uint32_t)((signed char) GetBYTE(PC) + 1) : 1;
-      break;
-   case 0x31:         /* LD SP,nnnn */
+      NEXT;
+   OP(31):         /* LD SP,nnnn */
       SP = GetWORD(PC);
       PC += 2;
-      break;
-   case 0x32:         /* LD (nnnn),A */
+      NEXT;
+   OP(32):         /* LD (nnnn),A */
       temp = GetWORD(PC);
       PutBYTE(temp, hreg(AF));
       PC += 2;
-      break;
-   case 0x33:         /* INC SP */
+      NEXT;
+   OP(33):         /* INC SP */
       ++SP;
-      break;
-   case 0x34:         /* INC (HL) */
+      NEXT;
+   OP(34):         /* INC (HL) */
       temp = GetBYTE(HL)+1;
       PutBYTE(HL, temp);
       SET_FLAG_INC(temp);
-      break;
-   case 0x35:         /* DEC (HL) */
+      NEXT;
+   OP(35):         /* DEC (HL) */
       temp = GetBYTE(HL)-1;
       PutBYTE(HL, temp);
       SET_FLAG_DEC(temp);
-      break;
-   case 0x36:         /* LD (HL),nn */
+      NEXT;
+   OP(36):         /* LD (HL),nn */
       PutBYTE(HL, GetBYTE_pp(PC));
-      break;
-   case 0x37:         /* SCF */
+      NEXT;
+   OP(37):         /* SCF */
       AF = (AF&~0x3bu)|((AF>>8)&0x28)|1;
-      break;
-   case 0x38:         /* JR C,dd */
+      NEXT;
+   OP(38):         /* JR C,dd */
       PC += (TSTFLAG(C)) ? (uint32_t)((signed char) GetBYTE(PC) + 1 ): 1;
-      break;
-   case 0x39:         /* ADD HL,SP */
+      NEXT;
+   OP(39):         /* ADD HL,SP */
       HL &= 0xffff;
       SP &= 0xffff;
       sum = HL + SP;
@@ -730,653 +956,645 @@ simz80_execute(int tube_cycles)
       HL = sum;
       AF = (AF & ~0x3bu) | ((sum >> 8) & 0x28) |
          (cbits & 0x10) | ((cbits >> 8) & 1);
-      break;
-   case 0x3A:         /* LD A,(nnnn) */
+      NEXT;
+   OP(3A):         /* LD A,(nnnn) */
       temp = GetWORD(PC);
       Sethreg(AF, GetBYTE(temp));
       PC += 2;
-      break;
-   case 0x3B:         /* DEC SP */
+      NEXT;
+   OP(3B):         /* DEC SP */
       --SP;
-      break;
-   case 0x3C:         /* INC A */
+      NEXT;
+   OP(3C):         /* INC A */
       AF += 0x100;
       temp = hreg(AF);
       SET_FLAG_INC(temp);
-      break;
-   case 0x3D:         /* DEC A */
+      NEXT;
+   OP(3D):         /* DEC A */
       AF -= 0x100;
       temp = hreg(AF);
       SET_FLAG_DEC(temp);
-      break;
-   case 0x3E:         /* LD A,nn */
+      NEXT;
+   OP(3E):         /* LD A,nn */
       Sethreg(AF, GetBYTE_pp(PC));
-      break;
-   case 0x3F:         /* CCF */
+      NEXT;
+   OP(3F):         /* CCF */
       AF = (AF&~0x3bu)|((AF>>8)&0x28)|((AF&1)<<4)|(~AF&1);
-      break;
-   case 0x40:         /* LD B,B */
+      NEXT;
+   OP(40):         /* LD B,B */
       /* nop */
-      break;
-   case 0x41:         /* LD B,C */
+      NEXT;
+   OP(41):         /* LD B,C */
       BC = (BC & 255) | ((BC & 255) << 8);
-      break;
-   case 0x42:         /* LD B,D */
+      NEXT;
+   OP(42):         /* LD B,D */
       BC = (BC & 255) | (DE & ~255u);
-      break;
-   case 0x43:         /* LD B,E */
+      NEXT;
+   OP(43):         /* LD B,E */
       BC = (BC & 255) | ((DE & 255) << 8);
-      break;
-   case 0x44:         /* LD B,H */
+      NEXT;
+   OP(44):         /* LD B,H */
       BC = (BC & 255) | (HL & ~255u);
-      break;
-   case 0x45:         /* LD B,L */
+      NEXT;
+   OP(45):         /* LD B,L */
       BC = (BC & 255) | ((HL & 255) << 8);
-      break;
-   case 0x46:         /* LD B,(HL) */
+      NEXT;
+   OP(46):         /* LD B,(HL) */
       Sethreg(BC, GetBYTE(HL));
-      break;
-   case 0x47:         /* LD B,A */
+      NEXT;
+   OP(47):         /* LD B,A */
       BC = (BC & 255) | (AF & ~255u);
-      break;
-   case 0x48:         /* LD C,B */
+      NEXT;
+   OP(48):         /* LD C,B */
       BC = (BC & ~255u) | ((BC >> 8) & 255);
-      break;
-   case 0x49:         /* LD C,C */
+      NEXT;
+   OP(49):         /* LD C,C */
       /* nop */
-      break;
-   case 0x4A:         /* LD C,D */
+      NEXT;
+   OP(4A):         /* LD C,D */
       BC = (BC & ~255u) | ((DE >> 8) & 255);
-      break;
-   case 0x4B:         /* LD C,E */
+      NEXT;
+   OP(4B):         /* LD C,E */
       BC = (BC & ~255u) | (DE & 255);
-      break;
-   case 0x4C:         /* LD C,H */
+      NEXT;
+   OP(4C):         /* LD C,H */
       BC = (BC & ~255u) | ((HL >> 8) & 255);
-      break;
-   case 0x4D:         /* LD C,L */
+      NEXT;
+   OP(4D):         /* LD C,L */
       BC = (BC & ~255u) | (HL & 255);
-      break;
-   case 0x4E:         /* LD C,(HL) */
+      NEXT;
+   OP(4E):         /* LD C,(HL) */
       Setlreg(BC, GetBYTE(HL));
-      break;
-   case 0x4F:         /* LD C,A */
+      NEXT;
+   OP(4F):         /* LD C,A */
       BC = (BC & ~255u) | ((AF >> 8) & 255);
-      break;
-   case 0x50:         /* LD D,B */
+      NEXT;
+   OP(50):         /* LD D,B */
       DE = (DE & 255) | (BC & ~255u);
-      break;
-   case 0x51:         /* LD D,C */
+      NEXT;
+   OP(51):         /* LD D,C */
       DE = (DE & 255) | ((BC & 255) << 8);
-      break;
-   case 0x52:         /* LD D,D */
+      NEXT;
+   OP(52):         /* LD D,D */
       /* nop */
-      break;
-   case 0x53:         /* LD D,E */
+      NEXT;
+   OP(53):         /* LD D,E */
       DE = (DE & 255) | ((DE & 255) << 8);
-      break;
-   case 0x54:         /* LD D,H */
+      NEXT;
+   OP(54):         /* LD D,H */
       DE = (DE & 255) | (HL & ~255u);
-      break;
-   case 0x55:         /* LD D,L */
+      NEXT;
+   OP(55):         /* LD D,L */
       DE = (DE & 255) | ((HL & 255) << 8);
-      break;
-   case 0x56:         /* LD D,(HL) */
+      NEXT;
+   OP(56):         /* LD D,(HL) */
       Sethreg(DE, GetBYTE(HL));
-      break;
-   case 0x57:         /* LD D,A */
+      NEXT;
+   OP(57):         /* LD D,A */
       DE = (DE & 255) | (AF & ~255u);
-      break;
-   case 0x58:         /* LD E,B */
+      NEXT;
+   OP(58):         /* LD E,B */
       DE = (DE & ~255u) | ((BC >> 8) & 255);
-      break;
-   case 0x59:         /* LD E,C */
+      NEXT;
+   OP(59):         /* LD E,C */
       DE = (DE & ~255u) | (BC & 255);
-      break;
-   case 0x5A:         /* LD E,D */
+      NEXT;
+   OP(5A):         /* LD E,D */
       DE = (DE & ~255u) | ((DE >> 8) & 255);
-      break;
-   case 0x5B:         /* LD E,E */
+      NEXT;
+   OP(5B):         /* LD E,E */
       /* nop */
-      break;
-   case 0x5C:         /* LD E,H */
+      NEXT;
+   OP(5C):         /* LD E,H */
       DE = (DE & ~255u) | ((HL >> 8) & 255);
-      break;
-   case 0x5D:         /* LD E,L */
+      NEXT;
+   OP(5D):         /* LD E,L */
       DE = (DE & ~255u) | (HL & 255);
-      break;
-   case 0x5E:         /* LD E,(HL) */
+      NEXT;
+   OP(5E):         /* LD E,(HL) */
       Setlreg(DE, GetBYTE(HL));
-      break;
-   case 0x5F:         /* LD E,A */
+      NEXT;
+   OP(5F):         /* LD E,A */
       DE = (DE & ~255u) | ((AF >> 8) & 255);
-      break;
-   case 0x60:         /* LD H,B */
+      NEXT;
+   OP(60):         /* LD H,B */
       HL = (HL & 255) | (BC & ~255u);
-      break;
-   case 0x61:         /* LD H,C */
+      NEXT;
+   OP(61):         /* LD H,C */
       HL = (HL & 255) | ((BC & 255) << 8);
-      break;
-   case 0x62:         /* LD H,D */
+      NEXT;
+   OP(62):         /* LD H,D */
       HL = (HL & 255) | (DE & ~255u);
-      break;
-   case 0x63:         /* LD H,E */
+      NEXT;
+   OP(63):         /* LD H,E */
       HL = (HL & 255) | ((DE & 255) << 8);
-      break;
-   case 0x64:         /* LD H,H */
+      NEXT;
+   OP(64):         /* LD H,H */
       /* nop */
-      break;
-   case 0x65:         /* LD H,L */
+      NEXT;
+   OP(65):         /* LD H,L */
       HL = (HL & 255) | ((HL & 255) << 8);
-      break;
-   case 0x66:         /* LD H,(HL) */
+      NEXT;
+   OP(66):         /* LD H,(HL) */
       Sethreg(HL, GetBYTE(HL));
-      break;
-   case 0x67:         /* LD H,A */
+      NEXT;
+   OP(67):         /* LD H,A */
       HL = (HL & 255) | (AF & ~255u);
-      break;
-   case 0x68:         /* LD L,B */
+      NEXT;
+   OP(68):         /* LD L,B */
       HL = (HL & ~255u) | ((BC >> 8) & 255);
-      break;
-   case 0x69:         /* LD L,C */
+      NEXT;
+   OP(69):         /* LD L,C */
       HL = (HL & ~255u) | (BC & 255);
-      break;
-   case 0x6A:         /* LD L,D */
+      NEXT;
+   OP(6A):         /* LD L,D */
       HL = (HL & ~255u) | ((DE >> 8) & 255);
-      break;
-   case 0x6B:         /* LD L,E */
+      NEXT;
+   OP(6B):         /* LD L,E */
       HL = (HL & ~255u) | (DE & 255);
-      break;
-   case 0x6C:         /* LD L,H */
+      NEXT;
+   OP(6C):         /* LD L,H */
       HL = (HL & ~255u) | ((HL >> 8) & 255);
-      break;
-   case 0x6D:         /* LD L,L */
+      NEXT;
+   OP(6D):         /* LD L,L */
       /* nop */
-      break;
-   case 0x6E:         /* LD L,(HL) */
+      NEXT;
+   OP(6E):         /* LD L,(HL) */
       Setlreg(HL, GetBYTE(HL));
-      break;
-   case 0x6F:         /* LD L,A */
+      NEXT;
+   OP(6F):         /* LD L,A */
       HL = (HL & ~255u) | ((AF >> 8) & 255);
-      break;
-   case 0x70:         /* LD (HL),B */
+      NEXT;
+   OP(70):         /* LD (HL),B */
       PutBYTE(HL, hreg(BC));
-      break;
-   case 0x71:         /* LD (HL),C */
+      NEXT;
+   OP(71):         /* LD (HL),C */
       PutBYTE(HL, lreg(BC));
-      break;
-   case 0x72:         /* LD (HL),D */
+      NEXT;
+   OP(72):         /* LD (HL),D */
       PutBYTE(HL, hreg(DE));
-      break;
-   case 0x73:         /* LD (HL),E */
+      NEXT;
+   OP(73):         /* LD (HL),E */
       PutBYTE(HL, lreg(DE));
-      break;
-   case 0x74:         /* LD (HL),H */
+      NEXT;
+   OP(74):         /* LD (HL),H */
       PutBYTE(HL, hreg(HL));
-      break;
-   case 0x75:         /* LD (HL),L */
+      NEXT;
+   OP(75):         /* LD (HL),L */
       PutBYTE(HL, lreg(HL));
-      break;
-   case 0x76:         /* HALT */
+      NEXT;
+   OP(76):         /* HALT */
       SAVE_STATE();
       return PC&0xffff;
-   case 0x77:         /* LD (HL),A */
+   OP(77):         /* LD (HL),A */
       PutBYTE(HL, hreg(AF));
-      break;
-   case 0x78:         /* LD A,B */
+      NEXT;
+   OP(78):         /* LD A,B */
       AF = (AF & 255) | (BC & ~255u);
-      break;
-   case 0x79:         /* LD A,C */
+      NEXT;
+   OP(79):         /* LD A,C */
       AF = (AF & 255) | ((BC & 255) << 8);
-      break;
-   case 0x7A:         /* LD A,D */
+      NEXT;
+   OP(7A):         /* LD A,D */
       AF = (AF & 255) | (DE & ~255u);
-      break;
-   case 0x7B:         /* LD A,E */
+      NEXT;
+   OP(7B):         /* LD A,E */
       AF = (AF & 255) | ((DE & 255) << 8);
-      break;
-   case 0x7C:         /* LD A,H */
+      NEXT;
+   OP(7C):         /* LD A,H */
       AF = (AF & 255) | (HL & ~255u);
-      break;
-   case 0x7D:         /* LD A,L */
+      NEXT;
+   OP(7D):         /* LD A,L */
       AF = (AF & 255) | ((HL & 255) << 8);
-      break;
-   case 0x7E:         /* LD A,(HL) */
+      NEXT;
+   OP(7E):         /* LD A,(HL) */
       Sethreg(AF, GetBYTE(HL));
-      break;
-   case 0x7F:         /* LD A,A */
+      NEXT;
+   OP(7F):         /* LD A,A */
       /* nop */
-      break;
-   case 0x80:         /* ADD A,B */
+      NEXT;
+   OP(80):         /* ADD A,B */
       temp = hreg(BC);
       acu = hreg(AF);
       sum = acu + temp;
       cbits = acu ^ temp ^ sum;
       SET_FLAG_ADC(sum,cbits);
-      break;
-   case 0x81:         /* ADD A,C */
+      NEXT;
+   OP(81):         /* ADD A,C */
       temp = lreg(BC);
       acu = hreg(AF);
       sum = acu + temp;
       cbits = acu ^ temp ^ sum;
       SET_FLAG_ADC(sum,cbits);
-      break;
-   case 0x82:         /* ADD A,D */
+      NEXT;
+   OP(82):         /* ADD A,D */
       temp = hreg(DE);
       acu = hreg(AF);
       sum = acu + temp;
       cbits = acu ^ temp ^ sum;
       SET_FLAG_ADC(sum,cbits);
-      break;
-   case 0x83:         /* ADD A,E */
+      NEXT;
+   OP(83):         /* ADD A,E */
       temp = lreg(DE);
       acu = hreg(AF);
       sum = acu + temp;
       cbits = acu ^ temp ^ sum;
       SET_FLAG_ADC(sum,cbits);
-      break;
-   case 0x84:         /* ADD A,H */
+      NEXT;
+   OP(84):         /* ADD A,H */
       temp = hreg(HL);
       acu = hreg(AF);
       sum = acu + temp;
       cbits = acu ^ temp ^ sum;
       SET_FLAG_ADC(sum,cbits);
-      break;
-   case 0x85:         /* ADD A,L */
+      NEXT;
+   OP(85):         /* ADD A,L */
       temp = lreg(HL);
       acu = hreg(AF);
       sum = acu + temp;
       cbits = acu ^ temp ^ sum;
       SET_FLAG_ADC(sum,cbits);
-      break;
-   case 0x86:         /* ADD A,(HL) */
+      NEXT;
+   OP(86):         /* ADD A,(HL) */
       temp = GetBYTE(HL);
       acu = hreg(AF);
       sum = acu + temp;
       cbits = acu ^ temp ^ sum;
       SET_FLAG_ADC(sum,cbits);
-      break;
-   case 0x87:         /* ADD A,A */
+      NEXT;
+   OP(87):         /* ADD A,A */
       temp = hreg(AF);
       acu = hreg(AF);
       sum = acu + temp;
       cbits = acu ^ temp ^ sum;
       SET_FLAG_ADC(sum,cbits);
-      break;
-   case 0x88:         /* ADC A,B */
+      NEXT;
+   OP(88):         /* ADC A,B */
       temp = hreg(BC);
       acu = hreg(AF);
       sum = acu + temp + TSTFLAG(C);
       cbits = acu ^ temp ^ sum;
       SET_FLAG_ADC(sum,cbits);
-      break;
-   case 0x89:         /* ADC A,C */
+      NEXT;
+   OP(89):         /* ADC A,C */
       temp = lreg(BC);
       acu = hreg(AF);
       sum = acu + temp + TSTFLAG(C);
       cbits = acu ^ temp ^ sum;
       SET_FLAG_ADC(sum,cbits);
-      break;
-   case 0x8A:         /* ADC A,D */
+      NEXT;
+   OP(8A):         /* ADC A,D */
       temp = hreg(DE);
       acu = hreg(AF);
       sum = acu + temp + TSTFLAG(C);
       cbits = acu ^ temp ^ sum;
       SET_FLAG_ADC(sum,cbits);
-      break;
-   case 0x8B:         /* ADC A,E */
+      NEXT;
+   OP(8B):         /* ADC A,E */
       temp = lreg(DE);
       acu = hreg(AF);
       sum = acu + temp + TSTFLAG(C);
       cbits = acu ^ temp ^ sum;
       SET_FLAG_ADC(sum,cbits);
-      break;
-   case 0x8C:         /* ADC A,H */
+      NEXT;
+   OP(8C):         /* ADC A,H */
       temp = hreg(HL);
       acu = hreg(AF);
       sum = acu + temp + TSTFLAG(C);
       cbits = acu ^ temp ^ sum;
       SET_FLAG_ADC(sum,cbits);
-      break;
-   case 0x8D:         /* ADC A,L */
+      NEXT;
+   OP(8D):         /* ADC A,L */
       temp = lreg(HL);
       acu = hreg(AF);
       sum = acu + temp + TSTFLAG(C);
       cbits = acu ^ temp ^ sum;
       SET_FLAG_ADC(sum,cbits);
-      break;
-   case 0x8E:         /* ADC A,(HL) */
+      NEXT;
+   OP(8E):         /* ADC A,(HL) */
       temp = GetBYTE(HL);
       acu = hreg(AF);
       sum = acu + temp + TSTFLAG(C);
       cbits = acu ^ temp ^ sum;
       SET_FLAG_ADC(sum,cbits);
-      break;
-   case 0x8F:         /* ADC A,A */
+      NEXT;
+   OP(8F):         /* ADC A,A */
       temp = hreg(AF);
       acu = hreg(AF);
       sum = acu + temp + TSTFLAG(C);
       cbits = acu ^ temp ^ sum;
       SET_FLAG_ADC(sum,cbits);
-      break;
-   case 0x90:         /* SUB B */
+      NEXT;
+   OP(90):         /* SUB B */
       temp = hreg(BC);
       acu = hreg(AF);
       sum = acu - temp;
       cbits = acu ^ temp ^ sum;
       SET_FLAG_SBC(sum,cbits);
-      break;
-   case 0x91:         /* SUB C */
+      NEXT;
+   OP(91):         /* SUB C */
       temp = lreg(BC);
       acu = hreg(AF);
       sum = acu - temp;
       cbits = acu ^ temp ^ sum;
       SET_FLAG_SBC(sum,cbits);
-      break;
-   case 0x92:         /* SUB D */
+      NEXT;
+   OP(92):         /* SUB D */
       temp = hreg(DE);
       acu = hreg(AF);
       sum = acu - temp;
       cbits = acu ^ temp ^ sum;
       SET_FLAG_SBC(sum,cbits);
-      break;
-   case 0x93:         /* SUB E */
+      NEXT;
+   OP(93):         /* SUB E */
       temp = lreg(DE);
       acu = hreg(AF);
       sum = acu - temp;
       cbits = acu ^ temp ^ sum;
       SET_FLAG_SBC(sum,cbits);
-      break;
-   case 0x94:         /* SUB H */
+      NEXT;
+   OP(94):         /* SUB H */
       temp = hreg(HL);
       acu = hreg(AF);
       sum = acu - temp;
       cbits = acu ^ temp ^ sum;
       SET_FLAG_SBC(sum,cbits);
-      break;
-   case 0x95:         /* SUB L */
+      NEXT;
+   OP(95):         /* SUB L */
       temp = lreg(HL);
       acu = hreg(AF);
       sum = acu - temp;
       cbits = acu ^ temp ^ sum;
       SET_FLAG_SBC(sum,cbits);
-      break;
-   case 0x96:         /* SUB (HL) */
+      NEXT;
+   OP(96):         /* SUB (HL) */
       temp = GetBYTE(HL);
       acu = hreg(AF);
       sum = acu - temp;
       cbits = acu ^ temp ^ sum;
       SET_FLAG_SBC(sum,cbits);
-      break;
-   case 0x97:         /* SUB A */
+      NEXT;
+   OP(97):         /* SUB A */
       temp = hreg(AF);
       acu = hreg(AF);
       sum = acu - temp;
       cbits = acu ^ temp ^ sum;
       SET_FLAG_SBC(sum,cbits);
-      break;
-   case 0x98:         /* SBC A,B */
+      NEXT;
+   OP(98):         /* SBC A,B */
       temp = hreg(BC);
       acu = hreg(AF);
       sum = acu - temp - TSTFLAG(C);
       cbits = acu ^ temp ^ sum;
       SET_FLAG_SBC(sum,cbits);
-      break;
-   case 0x99:         /* SBC A,C */
+      NEXT;
+   OP(99):         /* SBC A,C */
       temp = lreg(BC);
       acu = hreg(AF);
       sum = acu - temp - TSTFLAG(C);
       cbits = acu ^ temp ^ sum;
       SET_FLAG_SBC(sum,cbits);
-      break;
-   case 0x9A:         /* SBC A,D */
+      NEXT;
+   OP(9A):         /* SBC A,D */
       temp = hreg(DE);
       acu = hreg(AF);
       sum = acu - temp - TSTFLAG(C);
       cbits = acu ^ temp ^ sum;
       SET_FLAG_SBC(sum,cbits);
-      break;
-   case 0x9B:         /* SBC A,E */
+      NEXT;
+   OP(9B):         /* SBC A,E */
       temp = lreg(DE);
       acu = hreg(AF);
       sum = acu - temp - TSTFLAG(C);
       cbits = acu ^ temp ^ sum;
       SET_FLAG_SBC(sum,cbits);
-      break;
-   case 0x9C:         /* SBC A,H */
+      NEXT;
+   OP(9C):         /* SBC A,H */
       temp = hreg(HL);
       acu = hreg(AF);
       sum = acu - temp - TSTFLAG(C);
       cbits = acu ^ temp ^ sum;
       SET_FLAG_SBC(sum,cbits);
-      break;
-   case 0x9D:         /* SBC A,L */
+      NEXT;
+   OP(9D):         /* SBC A,L */
       temp = lreg(HL);
       acu = hreg(AF);
       sum = acu - temp - TSTFLAG(C);
       cbits = acu ^ temp ^ sum;
       SET_FLAG_SBC(sum,cbits);
-      break;
-   case 0x9E:         /* SBC A,(HL) */
+      NEXT;
+   OP(9E):         /* SBC A,(HL) */
       temp = GetBYTE(HL);
       acu = hreg(AF);
       sum = acu - temp - TSTFLAG(C);
       cbits = acu ^ temp ^ sum;
       SET_FLAG_SBC(sum,cbits);
-      break;
-   case 0x9F:         /* SBC A,A */
+      NEXT;
+   OP(9F):         /* SBC A,A */
       temp = hreg(AF);
       acu = hreg(AF);
       sum = acu - temp - TSTFLAG(C);
       cbits = acu ^ temp ^ sum;
       SET_FLAG_SBC(sum,cbits);
-      break;
-   case 0xA0:         /* AND B */
+      NEXT;
+   OP(A0):         /* AND B */
       sum = ((AF & (BC)) >> 8) & 0xff;
-      AF = (sum << 8) | (sum & 0xa8) |
-         (uint32_t)((sum == 0) << 6) | 0x10 | partab[sum];
-      break;
-   case 0xA1:         /* AND C */
+      AF = (sum << 8) | szp_table[sum] | 0x10;
+      NEXT;
+   OP(A1):         /* AND C */
       sum = ((AF >> 8) & BC) & 0xff;
-      AF = (sum << 8) | (sum & 0xa8) | 0x10 |
-         (uint32_t)((sum == 0) << 6) | partab[sum];
-      break;
-   case 0xA2:         /* AND D */
+      AF = (sum << 8) | szp_table[sum] | 0x10;
+      NEXT;
+   OP(A2):         /* AND D */
       sum = ((AF & (DE)) >> 8) & 0xff;
-      AF = (sum << 8) | (sum & 0xa8) |
-         (uint32_t)((sum == 0) << 6) | 0x10 | partab[sum];
-      break;
-   case 0xA3:         /* AND E */
+      AF = (sum << 8) | szp_table[sum] | 0x10;
+      NEXT;
+   OP(A3):         /* AND E */
       sum = ((AF >> 8) & DE) & 0xff;
-      AF = (sum << 8) | (sum & 0xa8) | 0x10 |
-         (uint32_t)((sum == 0) << 6) | partab[sum];
-      break;
-   case 0xA4:         /* AND H */
+      AF = (sum << 8) | szp_table[sum] | 0x10;
+      NEXT;
+   OP(A4):         /* AND H */
       sum = ((AF & (HL)) >> 8) & 0xff;
-      AF = (sum << 8) | (sum & 0xa8) |
-         (uint32_t)((sum == 0) << 6) | 0x10 | partab[sum];
-      break;
-   case 0xA5:         /* AND L */
+      AF = (sum << 8) | szp_table[sum] | 0x10;
+      NEXT;
+   OP(A5):         /* AND L */
       sum = ((AF >> 8) & HL) & 0xff;
-      AF = (sum << 8) | (sum & 0xa8) | 0x10 |
-         (uint32_t)((sum == 0) << 6) | partab[sum];
-      break;
-   case 0xA6:         /* AND (HL) */
+      AF = (sum << 8) | szp_table[sum] | 0x10;
+      NEXT;
+   OP(A6):         /* AND (HL) */
       sum = ((AF >> 8) & GetBYTE(HL)) & 0xff;
-      AF = (sum << 8) | (sum & 0xa8) | 0x10 |
-         (uint32_t)((sum == 0) << 6) | partab[sum];
-      break;
-   case 0xA7:         /* AND A */
+      AF = (sum << 8) | szp_table[sum] | 0x10;
+      NEXT;
+   OP(A7):         /* AND A */
       sum = ((AF /*& (AF)*/) >> 8) & 0xff;
-      AF = (sum << 8) | (sum & 0xa8) |
-         (uint32_t)((sum == 0) << 6) | 0x10 | partab[sum];
-      break;
-   case 0xA8:         /* XOR B */
+      AF = (sum << 8) | szp_table[sum] | 0x10;
+      NEXT;
+   OP(A8):         /* XOR B */
       sum = ((AF ^ (BC)) >> 8) & 0xff;
-      AF = (sum << 8) | (sum & 0xa8) | ((uint32_t)(sum == 0) << 6) | partab[sum];
-      break;
-   case 0xA9:         /* XOR C */
+      AF = (sum << 8) | szp_table[sum];
+      NEXT;
+   OP(A9):         /* XOR C */
       sum = ((AF >> 8) ^ BC) & 0xff;
-      AF = (sum << 8) | (sum & 0xa8) | (uint32_t)((sum == 0) << 6) | partab[sum];
-      break;
-   case 0xAA:         /* XOR D */
+      AF = (sum << 8) | szp_table[sum];
+      NEXT;
+   OP(AA):         /* XOR D */
       sum = ((AF ^ (DE)) >> 8) & 0xff;
-      AF = (sum << 8) | (sum & 0xa8) | (uint32_t)((sum == 0) << 6) | partab[sum];
-      break;
-   case 0xAB:         /* XOR E */
+      AF = (sum << 8) | szp_table[sum];
+      NEXT;
+   OP(AB):         /* XOR E */
       sum = ((AF >> 8) ^ DE) & 0xff;
-      AF = (sum << 8) | (sum & 0xa8) | (uint32_t)((sum == 0) << 6) | partab[sum];
-      break;
-   case 0xAC:         /* XOR H */
+      AF = (sum << 8) | szp_table[sum];
+      NEXT;
+   OP(AC):         /* XOR H */
       sum = ((AF ^ (HL)) >> 8) & 0xff;
-      AF = (sum << 8) | (sum & 0xa8) | (uint32_t)((sum == 0) << 6) | partab[sum];
-      break;
-   case 0xAD:         /* XOR L */
+      AF = (sum << 8) | szp_table[sum];
+      NEXT;
+   OP(AD):         /* XOR L */
       sum = ((AF >> 8) ^ HL) & 0xff;
-      AF = (sum << 8) | (sum & 0xa8) | (uint32_t)((sum == 0) << 6) | partab[sum];
-      break;
-   case 0xAE:         /* XOR (HL) */
+      AF = (sum << 8) | szp_table[sum];
+      NEXT;
+   OP(AE):         /* XOR (HL) */
       sum = ((AF >> 8) ^ GetBYTE(HL)) & 0xff;
-      AF = (sum << 8) | (sum & 0xa8) | (uint32_t)((sum == 0) << 6) | partab[sum];
-      break;
-   case 0xAF:         /* XOR A */
+      AF = (sum << 8) | szp_table[sum];
+      NEXT;
+   OP(AF):         /* XOR A */
       sum = 0;//((AF ^ (AF)) >> 8) & 0xff;
-      AF = /*(sum << 8) | (sum & 0xa8) | */(1 << 6) | partab[sum];
-      break;
-   case 0xB0:         /* OR B */
+      AF = szp_table[0];
+      NEXT;
+   OP(B0):         /* OR B */
       sum = ((AF | (BC)) >> 8) & 0xff;
-      AF = (sum << 8) | (sum & 0xa8) | (uint32_t)((sum == 0) << 6) | partab[sum];
-      break;
-   case 0xB1:         /* OR C */
+      AF = (sum << 8) | szp_table[sum];
+      NEXT;
+   OP(B1):         /* OR C */
       sum = ((AF >> 8) | BC) & 0xff;
-      AF = (sum << 8) | (sum & 0xa8) | (uint32_t)((sum == 0) << 6) | partab[sum];
-      break;
-   case 0xB2:         /* OR D */
+      AF = (sum << 8) | szp_table[sum];
+      NEXT;
+   OP(B2):         /* OR D */
       sum = ((AF | (DE)) >> 8) & 0xff;
-      AF = (sum << 8) | (sum & 0xa8) | (uint32_t)((sum == 0) << 6) | partab[sum];
-      break;
-   case 0xB3:         /* OR E */
+      AF = (sum << 8) | szp_table[sum];
+      NEXT;
+   OP(B3):         /* OR E */
       sum = ((AF >> 8) | DE) & 0xff;
-      AF = (sum << 8) | (sum & 0xa8) | (uint32_t)((sum == 0) << 6) | partab[sum];
-      break;
-   case 0xB4:         /* OR H */
+      AF = (sum << 8) | szp_table[sum];
+      NEXT;
+   OP(B4):         /* OR H */
       sum = ((AF | (HL)) >> 8) & 0xff;
-      AF = (sum << 8) | (sum & 0xa8) | (uint32_t)((sum == 0) << 6) | partab[sum];
-      break;
-   case 0xB5:         /* OR L */
+      AF = (sum << 8) | szp_table[sum];
+      NEXT;
+   OP(B5):         /* OR L */
       sum = ((AF >> 8) | HL) & 0xff;
-      AF = (sum << 8) | (sum & 0xa8) | (uint32_t)((sum == 0) << 6) | partab[sum];
-      break;
-   case 0xB6:         /* OR (HL) */
+      AF = (sum << 8) | szp_table[sum];
+      NEXT;
+   OP(B6):         /* OR (HL) */
       sum = ((AF >> 8) | GetBYTE(HL)) & 0xff;
-      AF = (sum << 8) | (sum & 0xa8) | (uint32_t)((sum == 0) << 6) | partab[sum];
-      break;
-   case 0xB7:         /* OR A */
+      AF = (sum << 8) | szp_table[sum];
+      NEXT;
+   OP(B7):         /* OR A */
       sum = ((AF /*| (AF)*/) >> 8) & 0xff;
-      AF = (sum << 8) | (sum & 0xa8) | (uint32_t)((sum == 0) << 6) | partab[sum];
-      break;
-   case 0xB8:         /* CP B */
+      AF = (sum << 8) | szp_table[sum];
+      NEXT;
+   OP(B8):         /* CP B */
       temp = hreg(BC);
       AF = (AF & (uint32_t)~0x28) | (temp & 0x28);
       acu = hreg(AF);
       sum = acu - temp;
       cbits = acu ^ temp ^ sum;
       SET_FLAG_CP(temp,sum,cbits);
-      break;
-   case 0xB9:         /* CP C */
+      NEXT;
+   OP(B9):         /* CP C */
       temp = lreg(BC);
       AF = (AF & (uint32_t)~0x28) | (temp & 0x28);
       acu = hreg(AF);
       sum = acu - temp;
       cbits = acu ^ temp ^ sum;
       SET_FLAG_CP(temp,sum,cbits);
-      break;
-   case 0xBA:         /* CP D */
+      NEXT;
+   OP(BA):         /* CP D */
       temp = hreg(DE);
       AF = (AF & (uint32_t)~0x28) | (temp & 0x28);
       acu = hreg(AF);
       sum = acu - temp;
       cbits = acu ^ temp ^ sum;
       SET_FLAG_CP(temp,sum,cbits);
-      break;
-   case 0xBB:         /* CP E */
+      NEXT;
+   OP(BB):         /* CP E */
       temp = lreg(DE);
       AF = (AF & (uint32_t)~0x28) | (temp & 0x28);
       acu = hreg(AF);
       sum = acu - temp;
       cbits = acu ^ temp ^ sum;
       SET_FLAG_CP(temp,sum,cbits);
-      break;
-   case 0xBC:         /* CP H */
+      NEXT;
+   OP(BC):         /* CP H */
       temp = hreg(HL);
       AF = (AF & (uint32_t)~0x28) | (temp & 0x28);
       acu = hreg(AF);
       sum = acu - temp;
       cbits = acu ^ temp ^ sum;
       SET_FLAG_CP(temp,sum,cbits);
-      break;
-   case 0xBD:         /* CP L */
+      NEXT;
+   OP(BD):         /* CP L */
       temp = lreg(HL);
       AF = (AF & (uint32_t)~0x28) | (temp & 0x28);
       acu = hreg(AF);
       sum = acu - temp;
       cbits = acu ^ temp ^ sum;
       SET_FLAG_CP(temp,sum,cbits);
-      break;
-   case 0xBE:         /* CP (HL) */
+      NEXT;
+   OP(BE):         /* CP (HL) */
       temp = GetBYTE(HL);
       AF = (AF & (uint32_t)~0x28) | (temp & 0x28);
       acu = hreg(AF);
       sum = acu - temp;
       cbits = acu ^ temp ^ sum;
       SET_FLAG_CP(temp,sum,cbits);
-      break;
-   case 0xBF:         /* CP A */
+      NEXT;
+   OP(BF):         /* CP A */
       temp = hreg(AF);
       AF = (AF & (uint32_t)~0x28) | (temp & 0x28);
       acu = hreg(AF);
       sum = acu - temp;
       cbits = acu ^ temp ^ sum;
       SET_FLAG_CP(temp,sum,cbits);
-      break;
-   case 0xC0:         /* RET NZ */
+      NEXT;
+   OP(C0):         /* RET NZ */
       if (!TSTFLAG(Z)) POP(PC);
-      break;
-   case 0xC1:         /* POP BC */
+      NEXT;
+   OP(C1):         /* POP BC */
       POP(BC);
-      break;
-   case 0xC2:         /* JP NZ,nnnn */
+      NEXT;
+   OP(C2):         /* JP NZ,nnnn */
       JPC(!TSTFLAG(Z));
-      break;
-   case 0xC3:         /* JP nnnn */
+      NEXT;
+   OP(C3):         /* JP nnnn */
       JPC(1);
-      break;
-   case 0xC4:         /* CALL NZ,nnnn */
+      NEXT;
+   OP(C4):         /* CALL NZ,nnnn */
       CALLC(!TSTFLAG(Z));
-      break;
-   case 0xC5:         /* PUSH BC */
+      NEXT;
+   OP(C5):         /* PUSH BC */
       PUSH(BC);
-      break;
-   case 0xC6:         /* ADD A,nn */
+      NEXT;
+   OP(C6):         /* ADD A,nn */
       temp = GetBYTE_pp(PC);
       acu = hreg(AF);
       sum = acu + temp;
       cbits = acu ^ temp ^ sum;
       SET_FLAG_ADC(sum,cbits);
-      break;
-   case 0xC7:         /* RST 0 */
+      NEXT;
+   OP(C7):         /* RST 0 */
       PUSH(PC); PC = 0;
-      break;
-   case 0xC8:         /* RET Z */
+      NEXT;
+   OP(C8):         /* RET Z */
       if (TSTFLAG(Z)) POP(PC);
-      break;
-   case 0xC9:         /* RET */
+      NEXT;
+   OP(C9):         /* RET */
       POP(PC);
-      break;
-   case 0xCA:         /* JP Z,nnnn */
+      NEXT;
+   OP(CA):         /* JP Z,nnnn */
       JPC(TSTFLAG(Z));
-      break;
-   case 0xCB:         /* CB prefix */
+      NEXT;
+   OP(CB):         /* CB prefix */
       adr = HL;
       switch ((op = GetBYTE(PC)) & 7) {
           /*
@@ -1438,9 +1656,7 @@ simz80_execute(int tube_cycles)
             temp = acu >> 1;
             cbits = acu & 1;
          cbshflg1:
-            AF = (AF & (uint32_t)~0xff) | (temp & 0xa8) |
-               ((temp & 0xff)?0:(1<< 6)) |
-               parity(temp) | (cbits ?1:0);
+            AF = (AF & (uint32_t)~0xff) | szp_table[temp & 0xff] | (cbits ? 1 : 0);
          }
          break;
       case 0x40:      /* BIT */
@@ -1470,55 +1686,55 @@ simz80_execute(int tube_cycles)
       case 6: PutBYTE(adr, temp);  break;
       case 7: Sethreg(AF, temp); break;
       }
-      break;
-   case 0xCC:         /* CALL Z,nnnn */
+      NEXT;
+   OP(CC):         /* CALL Z,nnnn */
       CALLC(TSTFLAG(Z));
-      break;
-   case 0xCD:         /* CALL nnnn */
+      NEXT;
+   OP(CD):         /* CALL nnnn */
       CALLC(1);
-      break;
-   case 0xCE:         /* ADC A,nn */
+      NEXT;
+   OP(CE):         /* ADC A,nn */
       temp = GetBYTE_pp(PC);
       acu = hreg(AF);
       sum = acu + temp + TSTFLAG(C);
       cbits = acu ^ temp ^ sum;
       SET_FLAG_ADC(sum,cbits);
-      break;
-   case 0xCF:         /* RST 8 */
+      NEXT;
+   OP(CF):         /* RST 8 */
       PUSH(PC); PC = 8;
-      break;
-   case 0xD0:         /* RET NC */
+      NEXT;
+   OP(D0):         /* RET NC */
       if (!TSTFLAG(C)) POP(PC);
-      break;
-   case 0xD1:         /* POP DE */
+      NEXT;
+   OP(D1):         /* POP DE */
       POP(DE);
-      break;
-   case 0xD2:         /* JP NC,nnnn */
+      NEXT;
+   OP(D2):         /* JP NC,nnnn */
       JPC(!TSTFLAG(C));
-      break;
-   case 0xD3:         /* OUT (nn),A */
+      NEXT;
+   OP(D3):         /* OUT (nn),A */
       Output(GetBYTE_pp(PC) | (hreg(AF)<<8), hreg(AF));
-      break;
-   case 0xD4:         /* CALL NC,nnnn */
+      NEXT;
+   OP(D4):         /* CALL NC,nnnn */
       CALLC(!TSTFLAG(C));
-      break;
-   case 0xD5:         /* PUSH DE */
+      NEXT;
+   OP(D5):         /* PUSH DE */
       PUSH(DE);
-      break;
-   case 0xD6:         /* SUB nn */
+      NEXT;
+   OP(D6):         /* SUB nn */
       temp = GetBYTE_pp(PC);
       acu = hreg(AF);
       sum = acu - temp;
       cbits = acu ^ temp ^ sum;
       SET_FLAG_SBC(sum,cbits);
-      break;
-   case 0xD7:         /* RST 10H */
+      NEXT;
+   OP(D7):         /* RST 10H */
       PUSH(PC); PC = 0x10;
-      break;
-   case 0xD8:         /* RET C */
+      NEXT;
+   OP(D8):         /* RET C */
       if (TSTFLAG(C)) POP(PC);
-      break;
-   case 0xD9:         /* EXX */
+      NEXT;
+   OP(D9):         /* EXX */
       regs[regs_sel].bc = (WORD)BC;
       regs[regs_sel].de = (WORD)DE;
       regs[regs_sel].hl = (WORD)HL;
@@ -1526,19 +1742,19 @@ simz80_execute(int tube_cycles)
       BC = regs[regs_sel].bc;
       DE = regs[regs_sel].de;
       HL = regs[regs_sel].hl;
-      break;
-   case 0xDA:         /* JP C,nnnn */
+      NEXT;
+   OP(DA):         /* JP C,nnnn */
       JPC(TSTFLAG(C));
-      break;
-   case 0xDB:         /* IN A,(nn) */
+      NEXT;
+   OP(DB):         /* IN A,(nn) */
       Sethreg(AF, Input(GetBYTE_pp(PC) | (hreg(AF)<<8)));
-      break;
-   case 0xDC:         /* CALL C,nnnn */
+      NEXT;
+   OP(DC):         /* CALL C,nnnn */
       CALLC(TSTFLAG(C));
-      break;
-   case 0xDD:         /* DD prefix */
-      switch (op = GetBYTE_pp(PC)) {
-      case 0x09:         /* ADD IX,BC */
+      NEXT;
+   OP(DD):         /* DD prefix */
+      DISPATCH_PREFIX(dd) {
+      PREFIX_OP(dd, 09):         /* ADD IX,BC */
          IX &= 0xffff;
          BC &= 0xffff;
          sum = IX + BC;
@@ -1546,8 +1762,8 @@ simz80_execute(int tube_cycles)
          IX = sum;
          AF = (AF & ~0x3bu) | ((sum >> 8) & 0x28) |
             (cbits & 0x10) | ((cbits >> 8) & 1);
-         break;
-      case 0x19:         /* ADD IX,DE */
+         NEXT;
+      PREFIX_OP(dd, 19):         /* ADD IX,DE */
          IX &= 0xffff;
          DE &= 0xffff;
          sum = IX + DE;
@@ -1555,78 +1771,78 @@ simz80_execute(int tube_cycles)
          IX = sum;
          AF = (AF & ~0x3bu) | ((sum >> 8) & 0x28) |
             (cbits & 0x10) | ((cbits >> 8) & 1);
-         break;
-      case 0x21:         /* LD IX,nnnn */
+         NEXT;
+      PREFIX_OP(dd, 21):         /* LD IX,nnnn */
          IX = GetWORD(PC);
          PC += 2;
-         break;
-      case 0x22:         /* LD (nnnn),IX */
+         NEXT;
+      PREFIX_OP(dd, 22):         /* LD (nnnn),IX */
          temp = GetWORD(PC);
          PutWORD(temp, IX);
          PC += 2;
-         break;
-      case 0x23:         /* INC IX */
+         NEXT;
+      PREFIX_OP(dd, 23):         /* INC IX */
          ++IX;
-         break;
-      case 0x24:         /* INC IXH */
+         NEXT;
+      PREFIX_OP(dd, 24):         /* INC IXH */
          IX += 0x100;
          temp = hreg(IX);
          SET_FLAG_INC(temp);
-         break;
-      case 0x25:         /* DEC IXH */
+         NEXT;
+      PREFIX_OP(dd, 25):         /* DEC IXH */
          IX -= 0x100;
          temp = hreg(IX);
          SET_FLAG_DEC(temp);
-         break;
-      case 0x26:         /* LD IXH,nn */
+         NEXT;
+      PREFIX_OP(dd, 26):         /* LD IXH,nn */
          Sethreg(IX, GetBYTE_pp(PC));
-         break;
-      case 0x29:         /* ADD IX,IX */
+         NEXT;
+      PREFIX_OP(dd, 29):         /* ADD IX,IX */
          IX &= 0xffff;
          sum = IX + IX;
          cbits = (/*IX ^ IX ^ */sum) >> 8;
          IX = sum;
          AF = (AF & ~0x3bu) | ((sum >> 8) & 0x28) |
             (cbits & 0x10) | ((cbits >> 8) & 1);
-         break;
-      case 0x2A:         /* LD IX,(nnnn) */
+         NEXT;
+      PREFIX_OP(dd, 2A):         /* LD IX,(nnnn) */
          temp = GetWORD(PC);
          IX = GetWORD(temp);
          PC += 2;
-         break;
-      case 0x2B:         /* DEC IX */
+         NEXT;
+      PREFIX_OP(dd, 2B):         /* DEC IX */
          --IX;
-         break;
-      case 0x2C:         /* INC IXL */
+         NEXT;
+      PREFIX_OP(dd, 2C):         /* INC IXL */
          temp = lreg(IX)+1;
          Setlreg(IX, temp);
          SET_FLAG_INC(temp);
-         break;
-      case 0x2D:         /* DEC IXL */
+         NEXT;
+      PREFIX_OP(dd, 2D):         /* DEC IXL */
          temp = lreg(IX)-1;
          Setlreg(IX, temp);
          SET_FLAG_DEC(temp);
-         break;
-      case 0x2E:         /* LD IXL,nn */
+         NEXT;
+      PREFIX_OP(dd, 2E):         /* LD IXL,nn */
          Setlreg(IX, GetBYTE_pp(PC));
-         break;
-      case 0x34:         /* INC (IX+dd) */
+         NEXT;
+      PREFIX_OP(dd, 34):         /* INC (IX+dd) */
          adr = IX + (uint32_t)((signed char) GetBYTE_pp(PC));
          temp = GetBYTE(adr)+1;
          PutBYTE(adr, temp);
          SET_FLAG_INC(temp);
-         break;
-      case 0x35:         /* DEC (IX+dd) */
+         NEXT;
+      PREFIX_OP(dd, 35):         /* DEC (IX+dd) */
          adr = IX + (uint32_t)((signed char) GetBYTE_pp(PC));
          temp = GetBYTE(adr)-1;
          PutBYTE(adr, temp);
          SET_FLAG_DEC(temp);
-         break;
-      case 0x36:         /* LD (IX+dd),nn */
+         NEXT;
+      PREFIX_OP(dd, 36):         /* LD (IX+dd),nn */
          adr = IX + (uint32_t)((signed char) GetBYTE_pp(PC));
          PutBYTE(adr, GetBYTE_pp(PC));
-         break;
-      case 0x39:         /* ADD IX,SP */
+         NEXT;
+      PREFIX_OP(dd, 39):         /* ADD IX,SP */
          IX &= 0xffff;
          SP &= 0xffff;
          sum = IX + SP;
@@ -1634,282 +1850,279 @@ simz80_execute(int tube_cycles)
          IX = sum;
          AF = (AF & ~0x3bu) | ((sum >> 8) & 0x28) |
             (cbits & 0x10) | ((cbits >> 8) & 1);
-         break;
-      case 0x44:         /* LD B,IXH */
+         NEXT;
+      PREFIX_OP(dd, 44):         /* LD B,IXH */
          Sethreg(BC, hreg(IX));
-         break;
-      case 0x45:         /* LD B,IXL */
+         NEXT;
+      PREFIX_OP(dd, 45):         /* LD B,IXL */
          Sethreg(BC, lreg(IX));
-         break;
-      case 0x46:         /* LD B,(IX+dd) */
+         NEXT;
+      PREFIX_OP(dd, 46):         /* LD B,(IX+dd) */
          adr = IX + (uint32_t)((signed char) GetBYTE_pp(PC));
          Sethreg(BC, GetBYTE(adr));
-         break;
-      case 0x4C:         /* LD C,IXH */
+         NEXT;
+      PREFIX_OP(dd, 4C):         /* LD C,IXH */
          Setlreg(BC, hreg(IX));
-         break;
-      case 0x4D:         /* LD C,IXL */
+         NEXT;
+      PREFIX_OP(dd, 4D):         /* LD C,IXL */
          Setlreg(BC, lreg(IX));
-         break;
-      case 0x4E:         /* LD C,(IX+dd) */
+         NEXT;
+      PREFIX_OP(dd, 4E):         /* LD C,(IX+dd) */
          adr = IX + (uint32_t)((signed char) GetBYTE_pp(PC));
          Setlreg(BC, GetBYTE(adr));
-         break;
-      case 0x54:         /* LD D,IXH */
+         NEXT;
+      PREFIX_OP(dd, 54):         /* LD D,IXH */
          Sethreg(DE, hreg(IX));
-         break;
-      case 0x55:         /* LD D,IXL */
+         NEXT;
+      PREFIX_OP(dd, 55):         /* LD D,IXL */
          Sethreg(DE, lreg(IX));
-         break;
-      case 0x56:         /* LD D,(IX+dd) */
+         NEXT;
+      PREFIX_OP(dd, 56):         /* LD D,(IX+dd) */
          adr = IX + (uint32_t)((signed char) GetBYTE_pp(PC));
          Sethreg(DE, GetBYTE(adr));
-         break;
-      case 0x5C:         /* LD E,H */
+         NEXT;
+      PREFIX_OP(dd, 5C):         /* LD E,H */
          Setlreg(DE, hreg(IX));
-         break;
-      case 0x5D:         /* LD E,L */
+         NEXT;
+      PREFIX_OP(dd, 5D):         /* LD E,L */
          Setlreg(DE, lreg(IX));
-         break;
-      case 0x5E:         /* LD E,(IX+dd) */
+         NEXT;
+      PREFIX_OP(dd, 5E):         /* LD E,(IX+dd) */
          adr = IX + (uint32_t)((signed char) GetBYTE_pp(PC));
          Setlreg(DE, GetBYTE(adr));
-         break;
-      case 0x60:         /* LD IXH,B */
+         NEXT;
+      PREFIX_OP(dd, 60):         /* LD IXH,B */
          Sethreg(IX, hreg(BC));
-         break;
-      case 0x61:         /* LD IXH,C */
+         NEXT;
+      PREFIX_OP(dd, 61):         /* LD IXH,C */
          Sethreg(IX, lreg(BC));
-         break;
-      case 0x62:         /* LD IXH,D */
+         NEXT;
+      PREFIX_OP(dd, 62):         /* LD IXH,D */
          Sethreg(IX, hreg(DE));
-         break;
-      case 0x63:         /* LD IXH,E */
+         NEXT;
+      PREFIX_OP(dd, 63):         /* LD IXH,E */
          Sethreg(IX, lreg(DE));
-         break;
-      case 0x64:         /* LD IXH,IXH */
+         NEXT;
+      PREFIX_OP(dd, 64):         /* LD IXH,IXH */
          /* nop */
-         break;
-      case 0x65:         /* LD IXH,IXL */
+         NEXT;
+      PREFIX_OP(dd, 65):         /* LD IXH,IXL */
          Sethreg(IX, lreg(IX));
-         break;
-      case 0x66:         /* LD H,(IX+dd) */
+         NEXT;
+      PREFIX_OP(dd, 66):         /* LD H,(IX+dd) */
          adr = IX + (uint32_t)((signed char) GetBYTE_pp(PC));
          Sethreg(HL, GetBYTE(adr));
-         break;
-      case 0x67:         /* LD IXH,A */
+         NEXT;
+      PREFIX_OP(dd, 67):         /* LD IXH,A */
          Sethreg(IX, hreg(AF));
-         break;
-      case 0x68:         /* LD IXL,B */
+         NEXT;
+      PREFIX_OP(dd, 68):         /* LD IXL,B */
          Setlreg(IX, hreg(BC));
-         break;
-      case 0x69:         /* LD IXL,C */
+         NEXT;
+      PREFIX_OP(dd, 69):         /* LD IXL,C */
          Setlreg(IX, lreg(BC));
-         break;
-      case 0x6A:         /* LD IXL,D */
+         NEXT;
+      PREFIX_OP(dd, 6A):         /* LD IXL,D */
          Setlreg(IX, hreg(DE));
-         break;
-      case 0x6B:         /* LD IXL,E */
+         NEXT;
+      PREFIX_OP(dd, 6B):         /* LD IXL,E */
          Setlreg(IX, lreg(DE));
-         break;
-      case 0x6C:         /* LD IXL,IXH */
+         NEXT;
+      PREFIX_OP(dd, 6C):         /* LD IXL,IXH */
          Setlreg(IX, hreg(IX));
-         break;
-      case 0x6D:         /* LD IXL,IXL */
+         NEXT;
+      PREFIX_OP(dd, 6D):         /* LD IXL,IXL */
          /* nop */
-         break;
-      case 0x6E:         /* LD L,(IX+dd) */
+         NEXT;
+      PREFIX_OP(dd, 6E):         /* LD L,(IX+dd) */
          adr = IX + (uint32_t)((signed char) GetBYTE_pp(PC));
          Setlreg(HL, GetBYTE(adr));
-         break;
-      case 0x6F:         /* LD IXL,A */
+         NEXT;
+      PREFIX_OP(dd, 6F):         /* LD IXL,A */
          Setlreg(IX, hreg(AF));
-         break;
-      case 0x70:         /* LD (IX+dd),B */
+         NEXT;
+      PREFIX_OP(dd, 70):         /* LD (IX+dd),B */
          adr = IX + (uint32_t)((signed char) GetBYTE_pp(PC));
          PutBYTE(adr, hreg(BC));
-         break;
-      case 0x71:         /* LD (IX+dd),C */
+         NEXT;
+      PREFIX_OP(dd, 71):         /* LD (IX+dd),C */
          adr = IX + (uint32_t)((signed char) GetBYTE_pp(PC));
          PutBYTE(adr, lreg(BC));
-         break;
-      case 0x72:         /* LD (IX+dd),D */
+         NEXT;
+      PREFIX_OP(dd, 72):         /* LD (IX+dd),D */
          adr = IX + (uint32_t)((signed char) GetBYTE_pp(PC));
          PutBYTE(adr, hreg(DE));
-         break;
-      case 0x73:         /* LD (IX+dd),E */
+         NEXT;
+      PREFIX_OP(dd, 73):         /* LD (IX+dd),E */
          adr = IX + (uint32_t)((signed char) GetBYTE_pp(PC));
          PutBYTE(adr, lreg(DE));
-         break;
-      case 0x74:         /* LD (IX+dd),H */
+         NEXT;
+      PREFIX_OP(dd, 74):         /* LD (IX+dd),H */
          adr = IX + (uint32_t)((signed char) GetBYTE_pp(PC));
          PutBYTE(adr, hreg(HL));
-         break;
-      case 0x75:         /* LD (IX+dd),L */
+         NEXT;
+      PREFIX_OP(dd, 75):         /* LD (IX+dd),L */
          adr = IX + (uint32_t)((signed char) GetBYTE_pp(PC));
          PutBYTE(adr, lreg(HL));
-         break;
-      case 0x77:         /* LD (IX+dd),A */
+         NEXT;
+      PREFIX_OP(dd, 77):         /* LD (IX+dd),A */
          adr = IX + (uint32_t)((signed char) GetBYTE_pp(PC));
          PutBYTE(adr, hreg(AF));
-         break;
-      case 0x7C:         /* LD A,IXH */
+         NEXT;
+      PREFIX_OP(dd, 7C):         /* LD A,IXH */
          Sethreg(AF, hreg(IX));
-         break;
-      case 0x7D:         /* LD A,IXL */
+         NEXT;
+      PREFIX_OP(dd, 7D):         /* LD A,IXL */
          Sethreg(AF, lreg(IX));
-         break;
-      case 0x7E:         /* LD A,(IX+dd) */
+         NEXT;
+      PREFIX_OP(dd, 7E):         /* LD A,(IX+dd) */
          adr = IX + (uint32_t)((signed char) GetBYTE_pp(PC));
          Sethreg(AF, GetBYTE(adr));
-         break;
-      case 0x84:         /* ADD A,IXH */
+         NEXT;
+      PREFIX_OP(dd, 84):         /* ADD A,IXH */
          temp = hreg(IX);
          acu = hreg(AF);
          sum = acu + temp;
          cbits = acu ^ temp ^ sum;
          SET_FLAG_ADC(sum,cbits);
-         break;
-      case 0x85:         /* ADD A,IXL */
+         NEXT;
+      PREFIX_OP(dd, 85):         /* ADD A,IXL */
          temp = lreg(IX);
          acu = hreg(AF);
          sum = acu + temp;
          cbits = acu ^ temp ^ sum;
          SET_FLAG_ADC(sum,cbits);
-         break;
-      case 0x86:         /* ADD A,(IX+dd) */
+         NEXT;
+      PREFIX_OP(dd, 86):         /* ADD A,(IX+dd) */
          adr = IX + (uint32_t)((signed char) GetBYTE_pp(PC));
          temp = GetBYTE(adr);
          acu = hreg(AF);
          sum = acu + temp;
          cbits = acu ^ temp ^ sum;
          SET_FLAG_ADC(sum,cbits);
-         break;
-      case 0x8C:         /* ADC A,IXH */
+         NEXT;
+      PREFIX_OP(dd, 8C):         /* ADC A,IXH */
          temp = hreg(IX);
          acu = hreg(AF);
          sum = acu + temp + TSTFLAG(C);
          cbits = acu ^ temp ^ sum;
          SET_FLAG_ADC(sum,cbits);
-         break;
-      case 0x8D:         /* ADC A,IXL */
+         NEXT;
+      PREFIX_OP(dd, 8D):         /* ADC A,IXL */
          temp = lreg(IX);
          acu = hreg(AF);
          sum = acu + temp + TSTFLAG(C);
          cbits = acu ^ temp ^ sum;
          SET_FLAG_ADC(sum,cbits);
-         break;
-      case 0x8E:         /* ADC A,(IX+dd) */
+         NEXT;
+      PREFIX_OP(dd, 8E):         /* ADC A,(IX+dd) */
          adr = IX + (uint32_t)((signed char) GetBYTE_pp(PC));
          temp = GetBYTE(adr);
          acu = hreg(AF);
          sum = acu + temp + TSTFLAG(C);
          cbits = acu ^ temp ^ sum;
          SET_FLAG_ADC(sum,cbits);
-         break;
-      case 0x94:         /* SUB IXH */
+         NEXT;
+      PREFIX_OP(dd, 94):         /* SUB IXH */
          temp = hreg(IX);
          acu = hreg(AF);
          sum = acu - temp;
          cbits = acu ^ temp ^ sum;
          SET_FLAG_SBC(sum,cbits);
-         break;
-      case 0x95:         /* SUB IXL */
+         NEXT;
+      PREFIX_OP(dd, 95):         /* SUB IXL */
          temp = lreg(IX);
          acu = hreg(AF);
          sum = acu - temp;
          cbits = acu ^ temp ^ sum;
          SET_FLAG_SBC(sum,cbits);
-         break;
-      case 0x96:         /* SUB (IX+dd) */
+         NEXT;
+      PREFIX_OP(dd, 96):         /* SUB (IX+dd) */
          adr = IX + (uint32_t)((signed char) GetBYTE_pp(PC));
          temp = GetBYTE(adr);
          acu = hreg(AF);
          sum = acu - temp;
          cbits = acu ^ temp ^ sum;
          SET_FLAG_SBC(sum,cbits);
-         break;
-      case 0x9C:         /* SBC A,IXH */
+         NEXT;
+      PREFIX_OP(dd, 9C):         /* SBC A,IXH */
          temp = hreg(IX);
          acu = hreg(AF);
          sum = acu - temp - TSTFLAG(C);
          cbits = acu ^ temp ^ sum;
          SET_FLAG_SBC(sum,cbits);
-         break;
-      case 0x9D:         /* SBC A,IXL */
+         NEXT;
+      PREFIX_OP(dd, 9D):         /* SBC A,IXL */
          temp = lreg(IX);
          acu = hreg(AF);
          sum = acu - temp - TSTFLAG(C);
          cbits = acu ^ temp ^ sum;
          SET_FLAG_SBC(sum,cbits);
-         break;
-      case 0x9E:         /* SBC A,(IX+dd) */
+         NEXT;
+      PREFIX_OP(dd, 9E):         /* SBC A,(IX+dd) */
          adr = IX + (uint32_t)((signed char) GetBYTE_pp(PC));
          temp = GetBYTE(adr);
          acu = hreg(AF);
          sum = acu - temp - TSTFLAG(C);
          cbits = acu ^ temp ^ sum;
          SET_FLAG_SBC(sum,cbits);
-         break;
-      case 0xA4:         /* AND IXH */
+         NEXT;
+      PREFIX_OP(dd, A4):         /* AND IXH */
          sum = ((AF & (IX)) >> 8) & 0xff;
-         AF = (sum << 8) | (sum & 0xa8) |
-            (uint32_t)((sum == 0) << 6) | 0x10 | partab[sum];
-         break;
-      case 0xA5:         /* AND IXL */
+         AF = (sum << 8) | szp_table[sum] | 0x10;
+         NEXT;
+      PREFIX_OP(dd, A5):         /* AND IXL */
          sum = ((AF >> 8) & IX) & 0xff;
-         AF = (sum << 8) | (sum & 0xa8) | 0x10 |
-            (uint32_t)((sum == 0) << 6) | partab[sum];
-         break;
-      case 0xA6:         /* AND (IX+dd) */
+         AF = (sum << 8) | szp_table[sum] | 0x10;
+         NEXT;
+      PREFIX_OP(dd, A6):         /* AND (IX+dd) */
          adr = IX + (uint32_t)((signed char) GetBYTE_pp(PC));
          sum = ((AF >> 8) & GetBYTE(adr)) & 0xff;
-         AF = (uint32_t)(sum << 8) | (sum & 0xa8) | 0x10 |
-            (uint32_t)((sum == 0) << 6) | partab[sum];
-         break;
-      case 0xAC:         /* XOR IXH */
+         AF = (sum << 8) | szp_table[sum] | 0x10;
+         NEXT;
+      PREFIX_OP(dd, AC):         /* XOR IXH */
          sum = ((AF ^ (IX)) >> 8) & 0xff;
-         AF = (sum << 8) | (sum & 0xa8) | (uint32_t)((sum == 0) << 6) | partab[sum];
-         break;
-      case 0xAD:         /* XOR IXL */
+         AF = (sum << 8) | szp_table[sum];
+         NEXT;
+      PREFIX_OP(dd, AD):         /* XOR IXL */
          sum = ((AF >> 8) ^ IX) & 0xff;
-         AF = (sum << 8) | (sum & 0xa8) | (uint32_t)((sum == 0) << 6) | partab[sum];
-         break;
-      case 0xAE:         /* XOR (IX+dd) */
+         AF = (sum << 8) | szp_table[sum];
+         NEXT;
+      PREFIX_OP(dd, AE):         /* XOR (IX+dd) */
          adr = IX + (uint32_t)((signed char) GetBYTE_pp(PC));
          sum = ((AF >> 8) ^ GetBYTE(adr)) & 0xff;
-         AF = (sum << 8) | (sum & 0xa8) | (uint32_t)((sum == 0) << 6) | partab[sum];
-         break;
-      case 0xB4:         /* OR IXH */
+         AF = (sum << 8) | szp_table[sum];
+         NEXT;
+      PREFIX_OP(dd, B4):         /* OR IXH */
          sum = ((AF | (IX)) >> 8) & 0xff;
-         AF = (sum << 8) | (sum & 0xa8) | (uint32_t)((sum == 0) << 6) | partab[sum];
-         break;
-      case 0xB5:         /* OR IXL */
+         AF = (sum << 8) | szp_table[sum];
+         NEXT;
+      PREFIX_OP(dd, B5):         /* OR IXL */
          sum = ((AF >> 8) | IX) & 0xff;
-         AF = (sum << 8) | (sum & 0xa8) | (uint32_t)((sum == 0) << 6) | partab[sum];
-         break;
-      case 0xB6:         /* OR (IX+dd) */
+         AF = (sum << 8) | szp_table[sum];
+         NEXT;
+      PREFIX_OP(dd, B6):         /* OR (IX+dd) */
          adr = IX + (uint32_t)((signed char) GetBYTE_pp(PC));
          sum = ((AF >> 8) | GetBYTE(adr)) & 0xff;
-         AF = (sum << 8) | (sum & 0xa8) | (uint32_t)((sum == 0) << 6) | partab[sum];
-         break;
-      case 0xBC:         /* CP IXH */
+         AF = (sum << 8) | szp_table[sum];
+         NEXT;
+      PREFIX_OP(dd, BC):         /* CP IXH */
          temp = hreg(IX);
          AF = (AF & (uint32_t)~0x28) | (temp & 0x28);
          acu = hreg(AF);
          sum = acu - temp;
          cbits = acu ^ temp ^ sum;
          SET_FLAG_CP(temp,sum,cbits);
-         break;
-      case 0xBD:         /* CP IXL */
+         NEXT;
+      PREFIX_OP(dd, BD):         /* CP IXL */
          temp = lreg(IX);
          AF = (AF & (uint32_t)~0x28) | (temp & 0x28);
          acu = hreg(AF);
          sum = acu - temp;
          cbits = acu ^ temp ^ sum;
          SET_FLAG_CP(temp,sum,cbits);
-         break;
-      case 0xBE:         /* CP (IX+dd) */
+         NEXT;
+      PREFIX_OP(dd, BE):         /* CP (IX+dd) */
          adr = IX + (uint32_t)((signed char) GetBYTE_pp(PC));
          temp = GetBYTE(adr);
          AF = (AF & (uint32_t)~0x28) | (temp & 0x28);
@@ -1917,8 +2130,8 @@ simz80_execute(int tube_cycles)
          sum = acu - temp;
          cbits = acu ^ temp ^ sum;
          SET_FLAG_CP(temp,sum,cbits);
-         break;
-      case 0xCB:         /* CB prefix */
+         NEXT;
+      PREFIX_OP(dd, CB):         /* CB prefix */
          adr = IX + (uint32_t)((signed char) GetBYTE_pp(PC));
          switch ((op = GetBYTE(PC)) & 7) {
              /*
@@ -1980,9 +2193,7 @@ simz80_execute(int tube_cycles)
                temp = acu >> 1;
                cbits = acu & 1;
             cbshflg2:
-               AF = (AF & (uint32_t)~0xff) | (temp & 0xa8) |
-                  ((temp & 0xff)?0:(1<< 6)) |
-                  parity(temp) | (cbits?1:0);
+               AF = (AF & (uint32_t)~0xff) | szp_table[temp & 0xff] | (cbits ? 1 : 0);
             }
             break;
          case 0x40:      /* BIT */
@@ -2012,89 +2223,86 @@ simz80_execute(int tube_cycles)
          case 6: PutBYTE(adr, temp);  break;
          case 7: Sethreg(AF, temp); break;
          }
-         break;
-      case 0xE1:         /* POP IX */
+         NEXT;
+      PREFIX_OP(dd, E1):         /* POP IX */
          POP(IX);
-         break;
-      case 0xE3:         /* EX (SP),IX */
+         NEXT;
+      PREFIX_OP(dd, E3):         /* EX (SP),IX */
          temp = IX; POP(IX); PUSH(temp);
-         break;
-      case 0xE5:         /* PUSH IX */
+         NEXT;
+      PREFIX_OP(dd, E5):         /* PUSH IX */
          PUSH(IX);
-         break;
-      case 0xE9:         /* JP (IX) */
+         NEXT;
+      PREFIX_OP(dd, E9):         /* JP (IX) */
          PC = IX;
-         break;
-      case 0xF9:         /* LD SP,IX */
+         NEXT;
+      PREFIX_OP(dd, F9):         /* LD SP,IX */
          SP = IX;
-         break;
-      default: PC--;      /* ignore DD */
+         NEXT;
+      PREFIX_DEFAULT(dd): PC--;      /* ignore DD */
       }
-      break;
-   case 0xDE:         /* SBC A,nn */
+      NEXT;
+   OP(DE):         /* SBC A,nn */
       temp = GetBYTE_pp(PC);
       acu = hreg(AF);
       sum = acu - temp - TSTFLAG(C);
       cbits = acu ^ temp ^ sum;
       SET_FLAG_SBC(sum,cbits);
-      break;
-   case 0xDF:         /* RST 18H */
+      NEXT;
+   OP(DF):         /* RST 18H */
       PUSH(PC); PC = 0x18;
-      break;
-   case 0xE0:         /* RET PO */
+      NEXT;
+   OP(E0):         /* RET PO */
       if (!TSTFLAG(P)) POP(PC);
-      break;
-   case 0xE1:         /* POP HL */
+      NEXT;
+   OP(E1):         /* POP HL */
       POP(HL);
-      break;
-   case 0xE2:         /* JP PO,nnnn */
+      NEXT;
+   OP(E2):         /* JP PO,nnnn */
       JPC(!TSTFLAG(P));
-      break;
-   case 0xE3:         /* EX (SP),HL */
+      NEXT;
+   OP(E3):         /* EX (SP),HL */
       temp = HL; POP(HL); PUSH(temp);
-      break;
-   case 0xE4:         /* CALL PO,nnnn */
+      NEXT;
+   OP(E4):         /* CALL PO,nnnn */
       CALLC(!TSTFLAG(P));
-      break;
-   case 0xE5:         /* PUSH HL */
+      NEXT;
+   OP(E5):         /* PUSH HL */
       PUSH(HL);
-      break;
-   case 0xE6:         /* AND nn */
+      NEXT;
+   OP(E6):         /* AND nn */
       sum = ((AF >> 8) & GetBYTE_pp(PC)) & 0xff;
-      AF = (uint32_t)(sum << 8) | (sum & 0xa8) | 0x10 |
-         (uint32_t)((sum == 0) << 6) | partab[sum];
-      break;
-   case 0xE7:         /* RST 20H */
+      AF = (sum << 8) | szp_table[sum] | 0x10;
+      NEXT;
+   OP(E7):         /* RST 20H */
       PUSH(PC); PC = 0x20;
-      break;
-   case 0xE8:         /* RET PE */
+      NEXT;
+   OP(E8):         /* RET PE */
       if (TSTFLAG(P)) POP(PC);
-      break;
-   case 0xE9:         /* JP (HL) */
+      NEXT;
+   OP(E9):         /* JP (HL) */
       PC = HL;
-      break;
-   case 0xEA:         /* JP PE,nnnn */
+      NEXT;
+   OP(EA):         /* JP PE,nnnn */
       JPC(TSTFLAG(P));
-      break;
-   case 0xEB:         /* EX DE,HL */
+      NEXT;
+   OP(EB):         /* EX DE,HL */
       temp = HL; HL = DE; DE = temp;
-      break;
-   case 0xEC:         /* CALL PE,nnnn */
+      NEXT;
+   OP(EC):         /* CALL PE,nnnn */
       CALLC(TSTFLAG(P));
-      break;
-   case 0xED:         /* ED prefix */
-      switch (op = GetBYTE_pp(PC)) {
-      case 0x40:         /* IN B,(C) */
+      NEXT;
+   OP(ED):         /* ED prefix */
+      DISPATCH_PREFIX(ed) {
+      PREFIX_OP(ed, 40):         /* IN B,(C) */
          temp = Input(BC);
          Sethreg(BC, temp);
-         AF = (AF & (uint32_t)~0xfe) | (temp & 0xa8) |
-            (uint32_t)(((temp & 0xff) == 0) << 6) |
-            parity(temp);
-         break;
-      case 0x41:         /* OUT (C),B */
+         AF = (AF & (uint32_t)~0xfe) | szp_table[temp & 0xff];
+         NEXT;
+      PREFIX_OP(ed, 41):         /* OUT (C),B */
          Output(BC, hreg(BC));
-         break;
-      case 0x42:         /* SBC HL,BC */
+         NEXT;
+      PREFIX_OP(ed, 42):         /* SBC HL,BC */
          HL &= 0xffff;
          BC &= 0xffff;
          sum = HL - BC - TSTFLAG(C);
@@ -2104,57 +2312,55 @@ simz80_execute(int tube_cycles)
             (uint32_t)(((sum & 0xffff) == 0) << 6) |
             (((cbits >> 6) ^ (cbits >> 5)) & 4) |
             (cbits & 0x10) | 2 | ((cbits >> 8) & 1);
-         break;
-      case 0x43:         /* LD (nnnn),BC */
+         NEXT;
+      PREFIX_OP(ed, 43):         /* LD (nnnn),BC */
          temp = GetWORD(PC);
          PutWORD(temp, BC);
          PC += 2;
-         break;
-      case 0x44:         /* NEG */
-      case 0x4C:
-      case 0x54:
-      case 0x5C:
-      case 0x64:
-      case 0x6C:
-      case 0x74:
-      case 0x7C:
+         NEXT;
+      PREFIX_OP(ed, 44):         /* NEG */
+      PREFIX_OP(ed, 4C):
+      PREFIX_OP(ed, 54):
+      PREFIX_OP(ed, 5C):
+      PREFIX_OP(ed, 64):
+      PREFIX_OP(ed, 6C):
+      PREFIX_OP(ed, 74):
+      PREFIX_OP(ed, 7C):
          temp = hreg(AF);
          AF = (-(AF & 0xff00) & 0xff00);
          AF |= ((AF >> 8) & 0xa8) | (uint32_t)(((AF & 0xff00) == 0) << 6) |
             (uint32_t)(((temp & 0x0f) != 0) << 4) | (uint32_t)((temp == 0x80) << 2) |
             2 | (temp?1:0);
-         break;
-      case 0x45:         /* RETN */
-      case 0x4D:         /* RETI - functionally identical to RETN */
-      case 0x55:
-      case 0x5D:
-      case 0x65:
-      case 0x6D:
-      case 0x75:
-      case 0x7D:
+         NEXT;
+      PREFIX_OP(ed, 45):         /* RETN */
+      PREFIX_OP(ed, 4D):         /* RETI - functionally identical to RETN */
+      PREFIX_OP(ed, 55):
+      PREFIX_OP(ed, 5D):
+      PREFIX_OP(ed, 65):
+      PREFIX_OP(ed, 6D):
+      PREFIX_OP(ed, 75):
+      PREFIX_OP(ed, 7D):
          IFF |= IFF >> 1;
          POP(PC);
-         break;
-      case 0x46:         /* IM 0 */
-      case 0x4E:
-      case 0x66:
-      case 0x6E:
+         NEXT;
+      PREFIX_OP(ed, 46):         /* IM 0 */
+      PREFIX_OP(ed, 4E):
+      PREFIX_OP(ed, 66):
+      PREFIX_OP(ed, 6E):
          /* interrupt mode 0 */
-         break;
-      case 0x47:         /* LD I,A */
+         NEXT;
+      PREFIX_OP(ed, 47):         /* LD I,A */
          ir = (WORD)((ir & 255) | (AF & (uint32_t)~255));
-         break;
-      case 0x48:         /* IN C,(C) */
+         NEXT;
+      PREFIX_OP(ed, 48):         /* IN C,(C) */
          temp = Input(BC);
          Setlreg(BC, temp);
-         AF = (AF & (uint32_t)~0xfe) | (temp & 0xa8) |
-            (uint32_t)(((temp & 0xff) == 0) << 6) |
-            parity(temp);
-         break;
-      case 0x49:         /* OUT (C),C */
+         AF = (AF & (uint32_t)~0xfe) | szp_table[temp & 0xff];
+         NEXT;
+      PREFIX_OP(ed, 49):         /* OUT (C),C */
          Output(BC, lreg(BC));
-         break;
-      case 0x4A:         /* ADC HL,BC */
+         NEXT;
+      PREFIX_OP(ed, 4A):         /* ADC HL,BC */
          HL &= 0xffff;
          BC &= 0xffff;
          sum = HL + BC + TSTFLAG(C);
@@ -2164,26 +2370,24 @@ simz80_execute(int tube_cycles)
             (uint32_t)(((sum & 0xffff) == 0) << 6) |
             (((cbits >> 6) ^ (cbits >> 5)) & 4) |
             (cbits & 0x10) | ((cbits >> 8) & 1);
-         break;
-      case 0x4B:         /* LD BC,(nnnn) */
+         NEXT;
+      PREFIX_OP(ed, 4B):         /* LD BC,(nnnn) */
          temp = GetWORD(PC);
          BC = GetWORD(temp);
          PC += 2;
-         break;
-      case 0x4F:         /* LD R,A */
+         NEXT;
+      PREFIX_OP(ed, 4F):         /* LD R,A */
          ir = (WORD)((ir & (WORD)~255) | ((AF >> 8) & 255));
-         break;
-      case 0x50:         /* IN D,(C) */
+         NEXT;
+      PREFIX_OP(ed, 50):         /* IN D,(C) */
          temp = Input(BC);
          Sethreg(DE, temp);
-         AF = (AF & (uint32_t)~0xfe) | (temp & 0xa8) |
-            (uint32_t)(((temp & 0xff) == 0) << 6) |
-            parity(temp);
-         break;
-      case 0x51:         /* OUT (C),D */
+         AF = (AF & (uint32_t)~0xfe) | szp_table[temp & 0xff];
+         NEXT;
+      PREFIX_OP(ed, 51):         /* OUT (C),D */
          Output(BC, hreg(DE));
-         break;
-      case 0x52:         /* SBC HL,DE */
+         NEXT;
+      PREFIX_OP(ed, 52):         /* SBC HL,DE */
          HL &= 0xffff;
          DE &= 0xffff;
          sum = HL - DE - TSTFLAG(C);
@@ -2193,30 +2397,28 @@ simz80_execute(int tube_cycles)
             (uint32_t)(((sum & 0xffff) == 0) << 6) |
             (((cbits >> 6) ^ (cbits >> 5)) & 4) |
             (cbits & 0x10) | 2 | ((cbits >> 8) & 1);
-         break;
-      case 0x53:         /* LD (nnnn),DE */
+         NEXT;
+      PREFIX_OP(ed, 53):         /* LD (nnnn),DE */
          temp = GetWORD(PC);
          PutWORD(temp, DE);
          PC += 2;
-         break;
-      case 0x56:         /* IM 1 */
-      case 0x76:
+         NEXT;
+      PREFIX_OP(ed, 56):         /* IM 1 */
+      PREFIX_OP(ed, 76):
          /* interrupt mode 1 */
-         break;
-      case 0x57:         /* LD A,I */
+         NEXT;
+      PREFIX_OP(ed, 57):         /* LD A,I */
          AF = (AF & 0x29) | (ir & (uint32_t)~255) | ((ir >> 8) & 0x80) | (uint32_t)(((ir & ~255) == 0) << 6) | ((IFF & 2) << 1);
-         break;
-      case 0x58:         /* IN E,(C) */
+         NEXT;
+      PREFIX_OP(ed, 58):         /* IN E,(C) */
          temp = Input(BC);
          Setlreg(DE, temp);
-         AF = (AF & (uint32_t)~0xfe) | (temp & 0xa8) |
-            (uint32_t)(((temp & 0xff) == 0) << 6) |
-            parity(temp);
-         break;
-      case 0x59:         /* OUT (C),E */
+         AF = (AF & (uint32_t)~0xfe) | szp_table[temp & 0xff];
+         NEXT;
+      PREFIX_OP(ed, 59):         /* OUT (C),E */
          Output(BC, lreg(DE));
-         break;
-      case 0x5A:         /* ADC HL,DE */
+         NEXT;
+      PREFIX_OP(ed, 5A):         /* ADC HL,DE */
          HL &= 0xffff;
          DE &= 0xffff;
          sum = HL + DE + TSTFLAG(C);
@@ -2226,31 +2428,29 @@ simz80_execute(int tube_cycles)
             (uint32_t)(((sum & 0xffff) == 0) << 6) |
             (((cbits >> 6) ^ (cbits >> 5)) & 4) |
             (cbits & 0x10) | ((cbits >> 8) & 1);
-         break;
-      case 0x5B:         /* LD DE,(nnnn) */
+         NEXT;
+      PREFIX_OP(ed, 5B):         /* LD DE,(nnnn) */
          temp = GetWORD(PC);
          DE = GetWORD(temp);
          PC += 2;
-         break;
-      case 0x5E:         /* IM 2 */
-      case 0x7E:
+         NEXT;
+      PREFIX_OP(ed, 5E):         /* IM 2 */
+      PREFIX_OP(ed, 7E):
          /* interrupt mode 2 */
-         break;
-      case 0x5F:         /* LD A,R */
+         NEXT;
+      PREFIX_OP(ed, 5F):         /* LD A,R */
          AF = (AF & 0x29) | (uint32_t)((ir & 255) << 8) | (ir & 0x80) | (uint32_t)(((ir & 255) == 0) << 6) | (uint32_t)((IFF & 2) << 1);
           ir = (ir + 1) & 0xff;
-         break;
-      case 0x60:         /* IN H,(C) */
+         NEXT;
+      PREFIX_OP(ed, 60):         /* IN H,(C) */
          temp = Input(BC);
          Sethreg(HL, temp);
-         AF = (AF & (uint32_t)~0xfe) | (temp & 0xa8) |
-            (uint32_t)(((temp & 0xff) == 0) << 6) |
-            parity(temp);
-         break;
-      case 0x61:         /* OUT (C),H */
+         AF = (AF & (uint32_t)~0xfe) | szp_table[temp & 0xff];
+         NEXT;
+      PREFIX_OP(ed, 61):         /* OUT (C),H */
          Output(BC, hreg(HL));
-         break;
-      case 0x62:         /* SBC HL,HL */
+         NEXT;
+      PREFIX_OP(ed, 62):         /* SBC HL,HL */
          //HL &= 0xffff;
          sum = /*HL - HL*/0 - TSTFLAG(C);
          cbits = (/*HL ^ HL ^*/ sum) >> 8;
@@ -2259,31 +2459,28 @@ simz80_execute(int tube_cycles)
             (uint32_t)(((sum & 0xffff) == 0) << 6) |
             (((cbits >> 6) ^ (cbits >> 5)) & 4) |
             (cbits & 0x10) | 2 | ((cbits >> 8) & 1);
-         break;
-      case 0x63:         /* LD (nnnn),HL */
+         NEXT;
+      PREFIX_OP(ed, 63):         /* LD (nnnn),HL */
          temp = GetWORD(PC);
          PutWORD(temp, HL);
          PC += 2;
-         break;
-      case 0x67:         /* RRD */
+         NEXT;
+      PREFIX_OP(ed, 67):         /* RRD */
          temp = GetBYTE(HL);
          acu = hreg(AF);
          PutBYTE(HL, hdig(temp) | (ldig(acu) << 4));
          acu = (acu & 0xf0) | ldig(temp);
-         AF = (acu << 8) | (acu & 0xa8) | (uint32_t)(((acu & 0xff) == 0) << 6) |
-            partab[acu] | (AF & 1);
-         break;
-      case 0x68:         /* IN L,(C) */
+         AF = (acu << 8) | szp_table[acu] | (AF & 1);
+         NEXT;
+      PREFIX_OP(ed, 68):         /* IN L,(C) */
          temp = Input(BC);
          Setlreg(HL, temp);
-         AF = (AF & (uint32_t)~0xfe) | (temp & 0xa8) |
-            (uint32_t)(((temp & 0xff) == 0) << 6) |
-            parity(temp);
-         break;
-      case 0x69:         /* OUT (C),L */
+         AF = (AF & (uint32_t)~0xfe) | szp_table[temp & 0xff];
+         NEXT;
+      PREFIX_OP(ed, 69):         /* OUT (C),L */
          Output(BC, lreg(HL));
-         break;
-      case 0x6A:         /* ADC HL,HL */
+         NEXT;
+      PREFIX_OP(ed, 6A):         /* ADC HL,HL */
          HL &= 0xffff;
          sum = HL + HL + TSTFLAG(C);
          cbits = (/*HL ^ HL ^ */sum) >> 8;
@@ -2292,31 +2489,28 @@ simz80_execute(int tube_cycles)
             (uint32_t)(((sum & 0xffff) == 0) << 6) |
             (((cbits >> 6) ^ (cbits >> 5)) & 4) |
             (cbits & 0x10) | ((cbits >> 8) & 1);
-         break;
-      case 0x6B:         /* LD HL,(nnnn) */
+         NEXT;
+      PREFIX_OP(ed, 6B):         /* LD HL,(nnnn) */
          temp = GetWORD(PC);
          HL = GetWORD(temp);
          PC += 2;
-         break;
-      case 0x6F:         /* RLD */
+         NEXT;
+      PREFIX_OP(ed, 6F):         /* RLD */
          temp = GetBYTE(HL);
          acu = hreg(AF);
          PutBYTE(HL, (ldig(temp) << 4) | ldig(acu));
          acu = (acu & 0xf0) | hdig(temp);
-         AF = (acu << 8) | (acu & 0xa8) | (uint32_t)(((acu & 0xff) == 0) << 6) |
-            partab[acu] | (AF & 1);
-         break;
-      case 0x70:         /* IN F,(C) */
+         AF = (acu << 8) | szp_table[acu] | (AF & 1);
+         NEXT;
+      PREFIX_OP(ed, 70):         /* IN F,(C) */
          temp = Input(BC);
          Setlreg(temp, temp);
-         AF = (AF &(uint32_t) ~0xfe) | (temp & 0xa8) |
-            (uint32_t)(((temp & 0xff) == 0) << 6) |
-            parity(temp);
-         break;
-      case 0x71:         /* OUT (C),0 */
+         AF = (AF & (uint32_t)~0xfe) | szp_table[temp & 0xff];
+         NEXT;
+      PREFIX_OP(ed, 71):         /* OUT (C),0 */
          Output(BC, 0);
-         break;
-      case 0x72:         /* SBC HL,SP */
+         NEXT;
+      PREFIX_OP(ed, 72):         /* SBC HL,SP */
          HL &= 0xffff;
          SP &= 0xffff;
          sum = HL - SP - TSTFLAG(C);
@@ -2326,23 +2520,21 @@ simz80_execute(int tube_cycles)
             (uint32_t)(((sum & 0xffff) == 0) << 6) |
             (((cbits >> 6) ^ (cbits >> 5)) & 4) |
             (cbits & 0x10) | 2 | ((cbits >> 8) & 1);
-         break;
-      case 0x73:         /* LD (nnnn),SP */
+         NEXT;
+      PREFIX_OP(ed, 73):         /* LD (nnnn),SP */
          temp = GetWORD(PC);
          PutWORD(temp, SP);
          PC += 2;
-         break;
-      case 0x78:         /* IN A,(C) */
+         NEXT;
+      PREFIX_OP(ed, 78):         /* IN A,(C) */
          temp = Input(BC);
          Sethreg(AF, temp);
-         AF = (AF & (uint32_t)~0xfe) | (temp & 0xa8) |
-            (uint32_t)(((temp & 0xff) == 0) << 6) |
-            parity(temp);
-         break;
-      case 0x79:         /* OUT (C),A */
+         AF = (AF & (uint32_t)~0xfe) | szp_table[temp & 0xff];
+         NEXT;
+      PREFIX_OP(ed, 79):         /* OUT (C),A */
          Output(BC, hreg(AF));
-         break;
-      case 0x7A:         /* ADC HL,SP */
+         NEXT;
+      PREFIX_OP(ed, 7A):         /* ADC HL,SP */
          HL &= 0xffff;
          SP &= 0xffff;
          sum = HL + SP + TSTFLAG(C);
@@ -2352,20 +2544,20 @@ simz80_execute(int tube_cycles)
             (uint32_t)(((sum & 0xffff) == 0) << 6) |
             (((cbits >> 6) ^ (cbits >> 5)) & 4) |
             (cbits & 0x10) | ((cbits >> 8) & 1);
-         break;
-      case 0x7B:         /* LD SP,(nnnn) */
+         NEXT;
+      PREFIX_OP(ed, 7B):         /* LD SP,(nnnn) */
          temp = GetWORD(PC);
          SP = GetWORD(temp);
          PC += 2;
-         break;
-      case 0xA0:         /* LDI */
+         NEXT;
+      PREFIX_OP(ed, A0):         /* LDI */
          acu = GetBYTE_pp(HL);
          PutBYTE_pp(DE, acu);
          acu += hreg(AF);
          AF = (AF & (uint32_t)~0x3e) | (acu & 8) | (uint32_t)((acu & 2) << 4) |
             (uint32_t)(((--BC & 0xffff) != 0) << 2);
-         break;
-      case 0xA1:         /* CPI */
+         NEXT;
+      PREFIX_OP(ed, A1):         /* CPI */
          acu = hreg(AF);
          temp = GetBYTE_pp(HL);
          sum = acu - temp;
@@ -2376,8 +2568,8 @@ simz80_execute(int tube_cycles)
             ((--BC & 0xffff)?(1<<2):0 ) | 2;
          if ((sum & 15) == 8 && (cbits & 16) != 0)
             AF &= (uint32_t)~8;
-         break;
-      case 0xA2:         /* INI */
+         NEXT;
+      PREFIX_OP(ed, A2):         /* INI */
          PutBYTE(HL, Input(BC)); ++HL;
          Sethreg(BC, hreg(BC) - 1);
 //         SETFLAG(N, 1);
@@ -2386,8 +2578,8 @@ simz80_execute(int tube_cycles)
          AF = (AF & (uint32_t)~0xff) | (temp & 0xbb) |
             (uint32_t)(((temp & 0xff) == 0) << 6) |
             (uint32_t)((temp == 0x7f) << 2);   // Not exact, but close
-         break;
-      case 0xA3:         /* OUTI */
+         NEXT;
+      PREFIX_OP(ed, A3):         /* OUTI */
          Output(BC, GetBYTE(HL)); ++HL;
          Sethreg(BC, hreg(BC) - 1);
 //         SETFLAG(N, 1);
@@ -2396,15 +2588,15 @@ simz80_execute(int tube_cycles)
          AF = (AF & (uint32_t)~0xff) | (temp & 0xbb) |
             (uint32_t)(((temp & 0xff) == 0) << 6) |
             (uint32_t)((temp == 0x7f) << 2);   // Not exact, but close
-         break;
-      case 0xA8:         /* LDD */
+         NEXT;
+      PREFIX_OP(ed, A8):         /* LDD */
          acu = GetBYTE_mm(HL);
          PutBYTE_mm(DE, acu);
          acu += hreg(AF);
          AF = (AF & (uint32_t)~0x3e) | (acu & 8) | (uint32_t)((acu & 2) << 4) |
             (uint32_t)(((--BC & 0xffff) != 0) << 2);
-         break;
-      case 0xA9:         /* CPD */
+         NEXT;
+      PREFIX_OP(ed, A9):         /* CPD */
          acu = hreg(AF);
          temp = GetBYTE_mm(HL);
          sum = acu - temp;
@@ -2415,8 +2607,8 @@ simz80_execute(int tube_cycles)
             ((--BC & 0xffff)?(1<<2):0) | 2;
          if ((sum & 15) == 8 && (cbits & 16) != 0)
             AF &= (uint32_t)~8;
-         break;
-      case 0xAA:         /* IND */
+         NEXT;
+      PREFIX_OP(ed, AA):         /* IND */
          PutBYTE(HL, Input(BC)); --HL;
          Sethreg(BC, hreg(BC) - 1);
 //         SETFLAG(N, 1);
@@ -2425,8 +2617,8 @@ simz80_execute(int tube_cycles)
          AF = (AF & (uint32_t)~0xff) | (temp & 0xbb) |
             (uint32_t)(((temp & 0xff) == 0) << 6) |
             (uint32_t)((temp == 0x7f) << 2);   // Not exact, but close
-         break;
-      case 0xAB:         /* OUTD */
+         NEXT;
+      PREFIX_OP(ed, AB):         /* OUTD */
          Output(BC, GetBYTE(HL)); --HL;
          Sethreg(BC, hreg(BC) - 1);
 //         SETFLAG(N, 1);
@@ -2435,8 +2627,8 @@ simz80_execute(int tube_cycles)
          AF = (AF & (uint32_t)~0xff) | (temp & 0xbb) |
             (uint32_t)(((temp & 0xff) == 0) << 6) |
             (uint32_t)((temp == 0x7f) << 2);   // Not exact, but close
-         break;
-      case 0xB0:         /* LDIR */
+         NEXT;
+      PREFIX_OP(ed, B0):         /* LDIR */
          BC &= 0xffff;
          if (BC == 0) BC |= 0x10000;
          do {
@@ -2445,8 +2637,8 @@ simz80_execute(int tube_cycles)
          } while (--BC);
          acu += hreg(AF);
          AF = (AF & (uint32_t)~0x3e) | (acu & 8) | (uint32_t)((acu & 2) << 4);
-         break;
-      case 0xB1:         /* CPIR */
+         NEXT;
+      PREFIX_OP(ed, B1):         /* CPIR */
          acu = hreg(AF);
          BC &= 0xffff;
          if (BC == 0) BC |= 0x10000;
@@ -2462,8 +2654,8 @@ simz80_execute(int tube_cycles)
             op << 2 | 2;
          if ((sum & 15) == 8 && (cbits & 16) != 0)
             AF &= (uint32_t)~8;
-         break;
-      case 0xB2:         /* INIR */
+         NEXT;
+      PREFIX_OP(ed, B2):         /* INIR */
          temp = hreg(BC);
          if (temp == 0) temp |= 0x100;
          do {
@@ -2473,8 +2665,8 @@ simz80_execute(int tube_cycles)
 //         SETFLAG(N, 1);
 //         SETFLAG(Z, 1);
          AF = (AF & (uint32_t)~0xff) | 0x42;   // Not exact, but close
-         break;
-      case 0xB3:         /* OTIR */
+         NEXT;
+      PREFIX_OP(ed, B3):         /* OTIR */
          temp = hreg(BC);
          if (temp == 0) temp |= 0x100;
          do {
@@ -2484,8 +2676,8 @@ simz80_execute(int tube_cycles)
 //         SETFLAG(N, 1);
 //         SETFLAG(Z, 1);
          AF = (AF & (uint32_t)~0xff) | 0x42;   // Not exact, but close
-         break;
-      case 0xB8:         /* LDDR */
+         NEXT;
+      PREFIX_OP(ed, B8):         /* LDDR */
          BC &= 0xffff;
          if (BC == 0) BC |= 0x10000;
          do {
@@ -2494,8 +2686,8 @@ simz80_execute(int tube_cycles)
          } while (--BC);
          acu += hreg(AF);
          AF = (AF & (uint32_t)~0x3e) | (acu & 8) | (uint32_t)((acu & 2) << 4);
-         break;
-      case 0xB9:         /* CPDR */
+         NEXT;
+      PREFIX_OP(ed, B9):         /* CPDR */
          acu = hreg(AF);
          BC &= 0xffff;
          if (BC == 0) BC |= 0x10000;
@@ -2511,8 +2703,8 @@ simz80_execute(int tube_cycles)
             op << 2 | 2;
          if ((sum & 15) == 8 && (cbits & 16) != 0)
             AF &= (uint32_t)~8;
-         break;
-      case 0xBA:         /* INDR */
+         NEXT;
+      PREFIX_OP(ed, BA):         /* INDR */
          temp = hreg(BC);
          if (temp == 0) temp |= 0x100;
          do {
@@ -2522,8 +2714,8 @@ simz80_execute(int tube_cycles)
 //         SETFLAG(N, 1);
 //         SETFLAG(Z, 1);
          AF = (AF & (uint32_t)~0xff) | 0x42;   // Not exact, but close
-         break;
-      case 0xBB:         /* OTDR */
+         NEXT;
+      PREFIX_OP(ed, BB):         /* OTDR */
          temp = hreg(BC);
          if (temp == 0) temp |= 0x100;
          do {
@@ -2533,60 +2725,60 @@ simz80_execute(int tube_cycles)
 //         SETFLAG(N, 1);
 //         SETFLAG(Z, 1);
          AF = (AF & (uint32_t)~0xff) | 0x42;   // Not exact, but close
-         break;
-      default: if (0x40 <= op && op <= 0x7f) PC--;      /* ignore ED */
+         NEXT;
+      PREFIX_DEFAULT(ed): if (0x40 <= op && op <= 0x7f) PC--;      /* ignore ED */
       }
-      break;
-   case 0xEE:         /* XOR nn */
+      NEXT;
+   OP(EE):         /* XOR nn */
       sum = ((AF >> 8) ^ GetBYTE_pp(PC)) & 0xff;
-      AF = (sum << 8) | (sum & 0xa8) | (uint32_t)((sum == 0) << 6) | partab[sum];
-      break;
-   case 0xEF:         /* RST 28H */
+      AF = (sum << 8) | szp_table[sum];
+      NEXT;
+   OP(EF):         /* RST 28H */
       PUSH(PC); PC = 0x28;
-      break;
-   case 0xF0:         /* RET P */
+      NEXT;
+   OP(F0):         /* RET P */
       if (!TSTFLAG(S)) POP(PC);
-      break;
-   case 0xF1:         /* POP AF */
+      NEXT;
+   OP(F1):         /* POP AF */
       POP(AF);
-      break;
-   case 0xF2:         /* JP P,nnnn */
+      NEXT;
+   OP(F2):         /* JP P,nnnn */
       JPC(!TSTFLAG(S));
-      break;
-   case 0xF3:         /* DI */
+      NEXT;
+   OP(F3):         /* DI */
       IFF = 0;
-      break;
-   case 0xF4:         /* CALL P,nnnn */
+      NEXT;
+   OP(F4):         /* CALL P,nnnn */
       CALLC(!TSTFLAG(S));
-      break;
-   case 0xF5:         /* PUSH AF */
+      NEXT;
+   OP(F5):         /* PUSH AF */
       PUSH(AF);
-      break;
-   case 0xF6:         /* OR nn */
+      NEXT;
+   OP(F6):         /* OR nn */
       sum = ((AF >> 8) | GetBYTE_pp(PC)) & 0xff;
-      AF = (sum << 8) | (sum & 0xa8) | (uint32_t)((sum == 0) << 6) | partab[sum];
-      break;
-   case 0xF7:         /* RST 30H */
+      AF = (sum << 8) | szp_table[sum];
+      NEXT;
+   OP(F7):         /* RST 30H */
       PUSH(PC); PC = 0x30;
-      break;
-   case 0xF8:         /* RET M */
+      NEXT;
+   OP(F8):         /* RET M */
       if (TSTFLAG(S)) POP(PC);
-      break;
-   case 0xF9:         /* LD SP,HL */
+      NEXT;
+   OP(F9):         /* LD SP,HL */
       SP = HL;
-      break;
-   case 0xFA:         /* JP M,nnnn */
+      NEXT;
+   OP(FA):         /* JP M,nnnn */
       JPC(TSTFLAG(S));
-      break;
-   case 0xFB:         /* EI */
+      NEXT;
+   OP(FB):         /* EI */
       IFF = 3;
-      break;
-   case 0xFC:         /* CALL M,nnnn */
+      NEXT;
+   OP(FC):         /* CALL M,nnnn */
       CALLC(TSTFLAG(S));
-      break;
-   case 0xFD:         /* FD prefix */
-      switch (op = GetBYTE_pp(PC)) {
-      case 0x09:         /* ADD IY,BC */
+      NEXT;
+   OP(FD):         /* FD prefix */
+      DISPATCH_PREFIX(fd) {
+      PREFIX_OP(fd, 09):         /* ADD IY,BC */
          IY &= 0xffff;
          BC &= 0xffff;
          sum = IY + BC;
@@ -2594,8 +2786,8 @@ simz80_execute(int tube_cycles)
          IY = sum;
          AF = (AF & ~0x3bu) | ((sum >> 8) & 0x28) |
             (cbits & 0x10) | ((cbits >> 8) & 1);
-         break;
-      case 0x19:         /* ADD IY,DE */
+         NEXT;
+      PREFIX_OP(fd, 19):         /* ADD IY,DE */
          IY &= 0xffff;
          DE &= 0xffff;
          sum = IY + DE;
@@ -2603,78 +2795,78 @@ simz80_execute(int tube_cycles)
          IY = sum;
          AF = (AF & ~0x3bu) | ((sum >> 8) & 0x28) |
             (cbits & 0x10) | ((cbits >> 8) & 1);
-         break;
-      case 0x21:         /* LD IY,nnnn */
+         NEXT;
+      PREFIX_OP(fd, 21):         /* LD IY,nnnn */
          IY = GetWORD(PC);
          PC += 2;
-         break;
-      case 0x22:         /* LD (nnnn),IY */
+         NEXT;
+      PREFIX_OP(fd, 22):         /* LD (nnnn),IY */
          temp = GetWORD(PC);
          PutWORD(temp, IY);
          PC += 2;
-         break;
-      case 0x23:         /* INC IY */
+         NEXT;
+      PREFIX_OP(fd, 23):         /* INC IY */
          ++IY;
-         break;
-      case 0x24:         /* INC IYH */
+         NEXT;
+      PREFIX_OP(fd, 24):         /* INC IYH */
          IY += 0x100;
          temp = hreg(IY);
          SET_FLAG_INC(temp);
-         break;
-      case 0x25:         /* DEC IYH */
+         NEXT;
+      PREFIX_OP(fd, 25):         /* DEC IYH */
          IY -= 0x100;
          temp = hreg(IY);
          SET_FLAG_DEC(temp);
-         break;
-      case 0x26:         /* LD IYH,nn */
+         NEXT;
+      PREFIX_OP(fd, 26):         /* LD IYH,nn */
          Sethreg(IY, GetBYTE_pp(PC));
-         break;
-      case 0x29:         /* ADD IY,IY */
+         NEXT;
+      PREFIX_OP(fd, 29):         /* ADD IY,IY */
          IY &= 0xffff;
          sum = IY + IY;
          cbits = (/*IY ^ IY ^ */sum) >> 8;
          IY = sum;
          AF = (AF & ~0x3bu) | ((sum >> 8) & 0x28) |
             (cbits & 0x10) | ((cbits >> 8) & 1);
-         break;
-      case 0x2A:         /* LD IY,(nnnn) */
+         NEXT;
+      PREFIX_OP(fd, 2A):         /* LD IY,(nnnn) */
          temp = GetWORD(PC);
          IY = GetWORD(temp);
          PC += 2;
-         break;
-      case 0x2B:         /* DEC IY */
+         NEXT;
+      PREFIX_OP(fd, 2B):         /* DEC IY */
          --IY;
-         break;
-      case 0x2C:         /* INC IYL */
+         NEXT;
+      PREFIX_OP(fd, 2C):         /* INC IYL */
          temp = lreg(IY)+1;
          Setlreg(IY, temp);
          SET_FLAG_INC(temp);
-         break;
-      case 0x2D:         /* DEC IYL */
+         NEXT;
+      PREFIX_OP(fd, 2D):         /* DEC IYL */
          temp = lreg(IY)-1;
          Setlreg(IY, temp);
          SET_FLAG_DEC(temp);
-         break;
-      case 0x2E:         /* LD IYL,nn */
+         NEXT;
+      PREFIX_OP(fd, 2E):         /* LD IYL,nn */
          Setlreg(IY, GetBYTE_pp(PC));
-         break;
-      case 0x34:         /* INC (IY+dd) */
+         NEXT;
+      PREFIX_OP(fd, 34):         /* INC (IY+dd) */
          adr = IY + (uint16_t)((signed char) GetBYTE_pp(PC));
          temp = GetBYTE(adr)+1;
          PutBYTE(adr, temp);
          SET_FLAG_INC(temp);
-         break;
-      case 0x35:         /* DEC (IY+dd) */
+         NEXT;
+      PREFIX_OP(fd, 35):         /* DEC (IY+dd) */
          adr = IY + (uint16_t)((signed char) GetBYTE_pp(PC));
          temp = GetBYTE(adr)-1;
          PutBYTE(adr, temp);
          SET_FLAG_DEC(temp);
-         break;
-      case 0x36:         /* LD (IY+dd),nn */
+         NEXT;
+      PREFIX_OP(fd, 36):         /* LD (IY+dd),nn */
          adr = IY + (uint16_t)((signed char) GetBYTE_pp(PC));
          PutBYTE(adr, GetBYTE_pp(PC));
-         break;
-      case 0x39:         /* ADD IY,SP */
+         NEXT;
+      PREFIX_OP(fd, 39):         /* ADD IY,SP */
          IY &= 0xffff;
          SP &= 0xffff;
          sum = IY + SP;
@@ -2682,282 +2874,279 @@ simz80_execute(int tube_cycles)
          IY = sum;
          AF = (AF & ~0x3bu) | ((sum >> 8) & 0x28) |
             (cbits & 0x10) | ((cbits >> 8) & 1);
-         break;
-      case 0x44:         /* LD B,IYH */
+         NEXT;
+      PREFIX_OP(fd, 44):         /* LD B,IYH */
          Sethreg(BC, hreg(IY));
-         break;
-      case 0x45:         /* LD B,IYL */
+         NEXT;
+      PREFIX_OP(fd, 45):         /* LD B,IYL */
          Sethreg(BC, lreg(IY));
-         break;
-      case 0x46:         /* LD B,(IY+dd) */
+         NEXT;
+      PREFIX_OP(fd, 46):         /* LD B,(IY+dd) */
          adr = IY + (uint16_t)((signed char) GetBYTE_pp(PC));
          Sethreg(BC, GetBYTE(adr));
-         break;
-      case 0x4C:         /* LD C,IYH */
+         NEXT;
+      PREFIX_OP(fd, 4C):         /* LD C,IYH */
          Setlreg(BC, hreg(IY));
-         break;
-      case 0x4D:         /* LD C,IYL */
+         NEXT;
+      PREFIX_OP(fd, 4D):         /* LD C,IYL */
          Setlreg(BC, lreg(IY));
-         break;
-      case 0x4E:         /* LD C,(IY+dd) */
+         NEXT;
+      PREFIX_OP(fd, 4E):         /* LD C,(IY+dd) */
          adr = IY + (uint16_t)((signed char) GetBYTE_pp(PC));
          Setlreg(BC, GetBYTE(adr));
-         break;
-      case 0x54:         /* LD D,IYH */
+         NEXT;
+      PREFIX_OP(fd, 54):         /* LD D,IYH */
          Sethreg(DE, hreg(IY));
-         break;
-      case 0x55:         /* LD D,IYL */
+         NEXT;
+      PREFIX_OP(fd, 55):         /* LD D,IYL */
          Sethreg(DE, lreg(IY));
-         break;
-      case 0x56:         /* LD D,(IY+dd) */
+         NEXT;
+      PREFIX_OP(fd, 56):         /* LD D,(IY+dd) */
          adr = IY + (uint16_t)((signed char) GetBYTE_pp(PC));
          Sethreg(DE, GetBYTE(adr));
-         break;
-      case 0x5C:         /* LD E,H */
+         NEXT;
+      PREFIX_OP(fd, 5C):         /* LD E,H */
          Setlreg(DE, hreg(IY));
-         break;
-      case 0x5D:         /* LD E,L */
+         NEXT;
+      PREFIX_OP(fd, 5D):         /* LD E,L */
          Setlreg(DE, lreg(IY));
-         break;
-      case 0x5E:         /* LD E,(IY+dd) */
+         NEXT;
+      PREFIX_OP(fd, 5E):         /* LD E,(IY+dd) */
          adr = IY + (uint16_t)((signed char) GetBYTE_pp(PC));
          Setlreg(DE, GetBYTE(adr));
-         break;
-      case 0x60:         /* LD IYH,B */
+         NEXT;
+      PREFIX_OP(fd, 60):         /* LD IYH,B */
          Sethreg(IY, hreg(BC));
-         break;
-      case 0x61:         /* LD IYH,C */
+         NEXT;
+      PREFIX_OP(fd, 61):         /* LD IYH,C */
          Sethreg(IY, lreg(BC));
-         break;
-      case 0x62:         /* LD IYH,D */
+         NEXT;
+      PREFIX_OP(fd, 62):         /* LD IYH,D */
          Sethreg(IY, hreg(DE));
-         break;
-      case 0x63:         /* LD IYH,E */
+         NEXT;
+      PREFIX_OP(fd, 63):         /* LD IYH,E */
          Sethreg(IY, lreg(DE));
-         break;
-      case 0x64:         /* LD IYH,IYH */
+         NEXT;
+      PREFIX_OP(fd, 64):         /* LD IYH,IYH */
          /* nop */
-         break;
-      case 0x65:         /* LD IYH,IYL */
+         NEXT;
+      PREFIX_OP(fd, 65):         /* LD IYH,IYL */
          Sethreg(IY, lreg(IY));
-         break;
-      case 0x66:         /* LD H,(IY+dd) */
+         NEXT;
+      PREFIX_OP(fd, 66):         /* LD H,(IY+dd) */
          adr = IY + (uint16_t)((signed char) GetBYTE_pp(PC));
          Sethreg(HL, GetBYTE(adr));
-         break;
-      case 0x67:         /* LD IYH,A */
+         NEXT;
+      PREFIX_OP(fd, 67):         /* LD IYH,A */
          Sethreg(IY, hreg(AF));
-         break;
-      case 0x68:         /* LD IYL,B */
+         NEXT;
+      PREFIX_OP(fd, 68):         /* LD IYL,B */
          Setlreg(IY, hreg(BC));
-         break;
-      case 0x69:         /* LD IYL,C */
+         NEXT;
+      PREFIX_OP(fd, 69):         /* LD IYL,C */
          Setlreg(IY, lreg(BC));
-         break;
-      case 0x6A:         /* LD IYL,D */
+         NEXT;
+      PREFIX_OP(fd, 6A):         /* LD IYL,D */
          Setlreg(IY, hreg(DE));
-         break;
-      case 0x6B:         /* LD IYL,E */
+         NEXT;
+      PREFIX_OP(fd, 6B):         /* LD IYL,E */
          Setlreg(IY, lreg(DE));
-         break;
-      case 0x6C:         /* LD IYL,IYH */
+         NEXT;
+      PREFIX_OP(fd, 6C):         /* LD IYL,IYH */
          Setlreg(IY, hreg(IY));
-         break;
-      case 0x6D:         /* LD IYL,IYL */
+         NEXT;
+      PREFIX_OP(fd, 6D):         /* LD IYL,IYL */
          /* nop */
-         break;
-      case 0x6E:         /* LD L,(IY+dd) */
+         NEXT;
+      PREFIX_OP(fd, 6E):         /* LD L,(IY+dd) */
          adr = IY + (uint16_t)((signed char) GetBYTE_pp(PC));
          Setlreg(HL, GetBYTE(adr));
-         break;
-      case 0x6F:         /* LD IYL,A */
+         NEXT;
+      PREFIX_OP(fd, 6F):         /* LD IYL,A */
          Setlreg(IY, hreg(AF));
-         break;
-      case 0x70:         /* LD (IY+dd),B */
+         NEXT;
+      PREFIX_OP(fd, 70):         /* LD (IY+dd),B */
          adr = IY + (uint16_t)((signed char) GetBYTE_pp(PC));
          PutBYTE(adr, hreg(BC));
-         break;
-      case 0x71:         /* LD (IY+dd),C */
+         NEXT;
+      PREFIX_OP(fd, 71):         /* LD (IY+dd),C */
          adr = IY + (uint16_t)((signed char) GetBYTE_pp(PC));
          PutBYTE(adr, lreg(BC));
-         break;
-      case 0x72:         /* LD (IY+dd),D */
+         NEXT;
+      PREFIX_OP(fd, 72):         /* LD (IY+dd),D */
          adr = IY + (uint16_t)((signed char) GetBYTE_pp(PC));
          PutBYTE(adr, hreg(DE));
-         break;
-      case 0x73:         /* LD (IY+dd),E */
+         NEXT;
+      PREFIX_OP(fd, 73):         /* LD (IY+dd),E */
          adr = IY + (uint16_t)((signed char) GetBYTE_pp(PC));
          PutBYTE(adr, lreg(DE));
-         break;
-      case 0x74:         /* LD (IY+dd),H */
+         NEXT;
+      PREFIX_OP(fd, 74):         /* LD (IY+dd),H */
          adr = IY + (uint16_t)((signed char) GetBYTE_pp(PC));
          PutBYTE(adr, hreg(HL));
-         break;
-      case 0x75:         /* LD (IY+dd),L */
+         NEXT;
+      PREFIX_OP(fd, 75):         /* LD (IY+dd),L */
          adr = IY + (uint16_t)((signed char) GetBYTE_pp(PC));
          PutBYTE(adr, lreg(HL));
-         break;
-      case 0x77:         /* LD (IY+dd),A */
+         NEXT;
+      PREFIX_OP(fd, 77):         /* LD (IY+dd),A */
          adr = IY + (uint16_t)((signed char) GetBYTE_pp(PC));
          PutBYTE(adr, hreg(AF));
-         break;
-      case 0x7C:         /* LD A,IYH */
+         NEXT;
+      PREFIX_OP(fd, 7C):         /* LD A,IYH */
          Sethreg(AF, hreg(IY));
-         break;
-      case 0x7D:         /* LD A,IYL */
+         NEXT;
+      PREFIX_OP(fd, 7D):         /* LD A,IYL */
          Sethreg(AF, lreg(IY));
-         break;
-      case 0x7E:         /* LD A,(IY+dd) */
+         NEXT;
+      PREFIX_OP(fd, 7E):         /* LD A,(IY+dd) */
          adr = IY + (uint16_t)((signed char) GetBYTE_pp(PC));
          Sethreg(AF, GetBYTE(adr));
-         break;
-      case 0x84:         /* ADD A,IYH */
+         NEXT;
+      PREFIX_OP(fd, 84):         /* ADD A,IYH */
          temp = hreg(IY);
          acu = hreg(AF);
          sum = acu + temp;
          cbits = acu ^ temp ^ sum;
          SET_FLAG_ADC(sum,cbits);
-         break;
-      case 0x85:         /* ADD A,IYL */
+         NEXT;
+      PREFIX_OP(fd, 85):         /* ADD A,IYL */
          temp = lreg(IY);
          acu = hreg(AF);
          sum = acu + temp;
          cbits = acu ^ temp ^ sum;
          SET_FLAG_ADC(sum,cbits);
-         break;
-      case 0x86:         /* ADD A,(IY+dd) */
+         NEXT;
+      PREFIX_OP(fd, 86):         /* ADD A,(IY+dd) */
          adr = IY + (uint16_t)((signed char) GetBYTE_pp(PC));
          temp = GetBYTE(adr);
          acu = hreg(AF);
          sum = acu + temp;
          cbits = acu ^ temp ^ sum;
          SET_FLAG_ADC(sum,cbits);
-         break;
-      case 0x8C:         /* ADC A,IYH */
+         NEXT;
+      PREFIX_OP(fd, 8C):         /* ADC A,IYH */
          temp = hreg(IY);
          acu = hreg(AF);
          sum = acu + temp + TSTFLAG(C);
          cbits = acu ^ temp ^ sum;
          SET_FLAG_ADC(sum,cbits);
-         break;
-      case 0x8D:         /* ADC A,IYL */
+         NEXT;
+      PREFIX_OP(fd, 8D):         /* ADC A,IYL */
          temp = lreg(IY);
          acu = hreg(AF);
          sum = acu + temp + TSTFLAG(C);
          cbits = acu ^ temp ^ sum;
          SET_FLAG_ADC(sum,cbits);
-         break;
-      case 0x8E:         /* ADC A,(IY+dd) */
+         NEXT;
+      PREFIX_OP(fd, 8E):         /* ADC A,(IY+dd) */
          adr = IY + (uint16_t)((signed char) GetBYTE_pp(PC));
          temp = GetBYTE(adr);
          acu = hreg(AF);
          sum = acu + temp + TSTFLAG(C);
          cbits = acu ^ temp ^ sum;
          SET_FLAG_ADC(sum,cbits);
-         break;
-      case 0x94:         /* SUB IYH */
+         NEXT;
+      PREFIX_OP(fd, 94):         /* SUB IYH */
          temp = hreg(IY);
          acu = hreg(AF);
          sum = acu - temp;
          cbits = acu ^ temp ^ sum;
          SET_FLAG_SBC(sum,cbits);
-         break;
-      case 0x95:         /* SUB IYL */
+         NEXT;
+      PREFIX_OP(fd, 95):         /* SUB IYL */
          temp = lreg(IY);
          acu = hreg(AF);
          sum = acu - temp;
          cbits = acu ^ temp ^ sum;
          SET_FLAG_SBC(sum,cbits);
-         break;
-      case 0x96:         /* SUB (IY+dd) */
+         NEXT;
+      PREFIX_OP(fd, 96):         /* SUB (IY+dd) */
          adr = IY + (uint16_t)((signed char) GetBYTE_pp(PC));
          temp = GetBYTE(adr);
          acu = hreg(AF);
          sum = acu - temp;
          cbits = acu ^ temp ^ sum;
          SET_FLAG_SBC(sum,cbits);
-         break;
-      case 0x9C:         /* SBC A,IYH */
+         NEXT;
+      PREFIX_OP(fd, 9C):         /* SBC A,IYH */
          temp = hreg(IY);
          acu = hreg(AF);
          sum = acu - temp - TSTFLAG(C);
          cbits = acu ^ temp ^ sum;
          SET_FLAG_SBC(sum,cbits);
-         break;
-      case 0x9D:         /* SBC A,IYL */
+         NEXT;
+      PREFIX_OP(fd, 9D):         /* SBC A,IYL */
          temp = lreg(IY);
          acu = hreg(AF);
          sum = acu - temp - TSTFLAG(C);
          cbits = acu ^ temp ^ sum;
          SET_FLAG_SBC(sum,cbits);
-         break;
-      case 0x9E:         /* SBC A,(IY+dd) */
+         NEXT;
+      PREFIX_OP(fd, 9E):         /* SBC A,(IY+dd) */
          adr = IY + (uint16_t)((signed char) GetBYTE_pp(PC));
          temp = GetBYTE(adr);
          acu = hreg(AF);
          sum = acu - temp - TSTFLAG(C);
          cbits = acu ^ temp ^ sum;
          SET_FLAG_SBC(sum,cbits);
-         break;
-      case 0xA4:         /* AND IYH */
+         NEXT;
+      PREFIX_OP(fd, A4):         /* AND IYH */
          sum = ((AF & (IY)) >> 8) & 0xff;
-         AF = (uint32_t)(sum << 8) | (sum & 0xa8) |
-            (uint32_t)((sum == 0) << 6) | 0x10 | partab[sum];
-         break;
-      case 0xA5:         /* AND IYL */
+         AF = (sum << 8) | szp_table[sum] | 0x10;
+         NEXT;
+      PREFIX_OP(fd, A5):         /* AND IYL */
          sum = ((AF >> 8) & IY) & 0xff;
-         AF = (uint32_t)(sum << 8) | (sum & 0xa8) | 0x10 |
-            (uint32_t)((sum == 0) << 6) | partab[sum];
-         break;
-      case 0xA6:         /* AND (IY+dd) */
+         AF = (sum << 8) | szp_table[sum] | 0x10;
+         NEXT;
+      PREFIX_OP(fd, A6):         /* AND (IY+dd) */
          adr = IY + (uint16_t)((signed char) GetBYTE_pp(PC));
          sum = ((AF >> 8) & GetBYTE(adr)) & 0xff;
-         AF = (uint32_t)(sum << 8) | (sum & 0xa8) | 0x10 |
-            (uint32_t)((sum == 0) << 6) | partab[sum];
-         break;
-      case 0xAC:         /* XOR IYH */
+         AF = (sum << 8) | szp_table[sum] | 0x10;
+         NEXT;
+      PREFIX_OP(fd, AC):         /* XOR IYH */
          sum = ((AF ^ (IY)) >> 8) & 0xff;
-         AF = (sum << 8) | (sum & 0xa8) | (uint32_t)((sum == 0) << 6) | partab[sum];
-         break;
-      case 0xAD:         /* XOR IYL */
+         AF = (sum << 8) | szp_table[sum];
+         NEXT;
+      PREFIX_OP(fd, AD):         /* XOR IYL */
          sum = ((AF >> 8) ^ IY) & 0xff;
-         AF = (sum << 8) | (sum & 0xa8) | (uint32_t)((sum == 0) << 6) | partab[sum];
-         break;
-      case 0xAE:         /* XOR (IY+dd) */
+         AF = (sum << 8) | szp_table[sum];
+         NEXT;
+      PREFIX_OP(fd, AE):         /* XOR (IY+dd) */
          adr = IY + (uint16_t)((signed char) GetBYTE_pp(PC));
          sum = ((AF >> 8) ^ GetBYTE(adr)) & 0xff;
-         AF = (sum << 8) | (sum & 0xa8) | (uint32_t)((sum == 0) << 6) | partab[sum];
-         break;
-      case 0xB4:         /* OR IYH */
+         AF = (sum << 8) | szp_table[sum];
+         NEXT;
+      PREFIX_OP(fd, B4):         /* OR IYH */
          sum = ((AF | (IY)) >> 8) & 0xff;
-         AF = (sum << 8) | (sum & 0xa8) | (uint32_t)((sum == 0) << 6) | partab[sum];
-         break;
-      case 0xB5:         /* OR IYL */
+         AF = (sum << 8) | szp_table[sum];
+         NEXT;
+      PREFIX_OP(fd, B5):         /* OR IYL */
          sum = ((AF >> 8) | IY) & 0xff;
-         AF = (sum << 8) | (sum & 0xa8) | (uint32_t)((sum == 0) << 6) | partab[sum];
-         break;
-      case 0xB6:         /* OR (IY+dd) */
+         AF = (sum << 8) | szp_table[sum];
+         NEXT;
+      PREFIX_OP(fd, B6):         /* OR (IY+dd) */
          adr = IY + (uint16_t)((signed char) GetBYTE_pp(PC));
          sum = ((AF >> 8) | GetBYTE(adr)) & 0xff;
-         AF = (sum << 8) | (sum & 0xa8) | (uint32_t)((sum == 0) << 6) | partab[sum];
-         break;
-      case 0xBC:         /* CP IYH */
+         AF = (sum << 8) | szp_table[sum];
+         NEXT;
+      PREFIX_OP(fd, BC):         /* CP IYH */
          temp = hreg(IY);
          AF = (AF & (uint32_t)~0x28) | (temp & 0x28);
          acu = hreg(AF);
          sum = acu - temp;
          cbits = acu ^ temp ^ sum;
          SET_FLAG_CP(temp,sum,cbits);
-         break;
-      case 0xBD:         /* CP IYL */
+         NEXT;
+      PREFIX_OP(fd, BD):         /* CP IYL */
          temp = lreg(IY);
          AF = (AF & (uint32_t)~0x28) | (temp & 0x28);
          acu = hreg(AF);
          sum = acu - temp;
          cbits = acu ^ temp ^ sum;
          SET_FLAG_CP(temp,sum,cbits);
-         break;
-      case 0xBE:         /* CP (IY+dd) */
+         NEXT;
+      PREFIX_OP(fd, BE):         /* CP (IY+dd) */
          adr = IY + (uint16_t)((signed char) GetBYTE_pp(PC));
          temp = GetBYTE(adr);
          AF = (AF & (uint32_t)~0x28) | (temp & 0x28);
@@ -2965,8 +3154,8 @@ simz80_execute(int tube_cycles)
          sum = acu - temp;
          cbits = acu ^ temp ^ sum;
          SET_FLAG_CP(temp,sum,cbits);
-         break;
-      case 0xCB:         /* CB prefix */
+         NEXT;
+      PREFIX_OP(fd, CB):         /* CB prefix */
          adr = IY + (uint32_t)((signed char) GetBYTE_pp(PC));
          switch ((op = GetBYTE(PC)) & 7) {
              /*
@@ -3029,9 +3218,7 @@ simz80_execute(int tube_cycles)
                temp = acu >> 1;
                cbits = acu & 1;
             cbshflg3:
-               AF = (AF & (uint32_t)~0xff) | (temp & 0xa8) |
-                  (uint32_t)((temp & 0xff)?0:(1 << 6)) |
-                  parity(temp) | (cbits?1:0) ;
+               AF = (AF & (uint32_t)~0xff) | szp_table[temp & 0xff] | (cbits ? 1 : 0);
             }
             break;
          case 0x40:      /* BIT */
@@ -3061,38 +3248,56 @@ simz80_execute(int tube_cycles)
          case 6: PutBYTE(adr, temp);  break;
          case 7: Sethreg(AF, temp); break;
          }
-         break;
-      case 0xE1:         /* POP IY */
+         NEXT;
+      PREFIX_OP(fd, E1):         /* POP IY */
          POP(IY);
-         break;
-      case 0xE3:         /* EX (SP),IY */
+         NEXT;
+      PREFIX_OP(fd, E3):         /* EX (SP),IY */
          temp = IY; POP(IY); PUSH(temp);
-         break;
-      case 0xE5:         /* PUSH IY */
+         NEXT;
+      PREFIX_OP(fd, E5):         /* PUSH IY */
          PUSH(IY);
-         break;
-      case 0xE9:         /* JP (IY) */
+         NEXT;
+      PREFIX_OP(fd, E9):         /* JP (IY) */
          PC = IY;
-         break;
-      case 0xF9:         /* LD SP,IY */
+         NEXT;
+      PREFIX_OP(fd, F9):         /* LD SP,IY */
          SP = IY;
-         break;
-      default: PC--;      /* ignore DD */
+         NEXT;
+      PREFIX_DEFAULT(fd): PC--;      /* ignore DD */
       }
-      break;
-   case 0xFE:         /* CP nn */
+      NEXT;
+   OP(FE):         /* CP nn */
       temp = GetBYTE_pp(PC);
       AF = (AF & (uint32_t)~0x28) | (temp & 0x28);
       acu = hreg(AF);
       sum = acu - temp;
       cbits = acu ^ temp ^ sum;
       SET_FLAG_CP(temp,sum,cbits);
-      break;
-   case 0xFF:         /* RST 38H */
+      NEXT;
+   OP(FF):         /* RST 38H */
       PUSH(PC); PC = 0x38;
+      NEXT;
     }
     tubeUseCycles(1);
-    } while (tubeContinueRunning());
+    if (tubeContinueRunning()) {
+       continue;
+    }
+#ifdef SIMZ80_THREADED
+ tube_event:
+#endif
+    /* RST and NMI are left to the caller. IRQ is level sensitive, so it
+       is taken here if enabled, and otherwise ignored until it is, rather
+       than returning after every instruction while it is masked */
+    if (tube_irq & (RESET_BIT | NMI_BIT)) {
+       break;
+    }
+    if (IFF & 1) {
+       IFF = (WORD)(IFF & ~1);
+       PUSH(PC);
+       PC = GetWORD(0xfffe);
+    }
+    } while (1);
 /* make registers visible for debugging if interrupted */
     SAVE_STATE();
     return (PC&0xffff)|0x10000;   /* flag non-bios stop */